@@ -27,6 +27,7 @@
 %attribute(massif::TerrainOptions, float, Exaggeration, getExaggeration, setExaggeration)
 %attribute(massif::TerrainOptions, bool, SeamlessTileEdgesEnabled, isSeamlessTileEdgesEnabled, setSeamlessTileEdgesEnabled)
 %attribute(massif::TerrainOptions, bool, ElevationPrefetchEnabled, isElevationPrefetchEnabled, setElevationPrefetchEnabled)
+%attribute(massif::TerrainOptions, bool, DecodedHeightsEnabled, isDecodedHeightsEnabled, setDecodedHeightsEnabled)
 %attribute(massif::TerrainOptions, int, MeshResolution, getMeshResolution, setMeshResolution)
 %attribute(massif::TerrainOptions, bool, TileEdgeStitchingEnabled, isTileEdgeStitchingEnabled, setTileEdgeStitchingEnabled)
 %attribute(massif::TerrainOptions, bool, DrapeFillsEnabled, isDrapeFillsEnabled, setDrapeFillsEnabled)
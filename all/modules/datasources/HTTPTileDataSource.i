@@ -27,6 +27,7 @@
 %attribute(massif::HTTPTileDataSource, bool, TMSScheme, isTMSScheme, setTMSScheme)
 %attribute(massif::HTTPTileDataSource, bool, MaxAgeHeaderCheck, isMaxAgeHeaderCheck, setMaxAgeHeaderCheck)
 %attribute(massif::HTTPTileDataSource, int, Timeout, getTimeout, setTimeout)
+%attribute(massif::HTTPTileDataSource, int, RangeGapTolerance, getRangeGapTolerance, setRangeGapTolerance)
 %attributeval(massif::HTTPTileDataSource, %arg(std::map<std::string, std::string>), HTTPHeaders, getHTTPHeaders, setHTTPHeaders)
 
 %feature("director") massif::HTTPTileDataSource;
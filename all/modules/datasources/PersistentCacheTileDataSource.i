@@ -23,8 +23,10 @@
 !polymorphic_shared_ptr(massif::PersistentCacheTileDataSource, datasources.PersistentCacheTileDataSource)
 
 %attribute(massif::PersistentCacheTileDataSource, bool, CacheOnlyMode, isCacheOnlyMode, setCacheOnlyMode)
+%attribute(massif::PersistentCacheTileDataSource, int, DownloadConcurrency, getDownloadConcurrency, setDownloadConcurrency)
 %attribute(massif::PersistentCacheTileDataSource, bool, Open, isOpen)
 %std_exceptions(massif::PersistentCacheTileDataSource::PersistentCacheTileDataSource)
+%std_exceptions(massif::PersistentCacheTileDataSource::setDownloadConcurrency)
 %std_exceptions(massif::PersistentCacheTileDataSource::startDownloadArea)
 
 %feature("director") massif::PersistentCacheTileDataSource;
@@ -11,6 +11,7 @@
 %}
 
 %include <std_shared_ptr.i>
+%include <std_string.i>
 %include <massifswig.i>
 
 %import "core/BinaryData.i"
@@ -19,10 +20,15 @@
 
 %attribute(massif::TileData, long long, MaxAge, getMaxAge, setMaxAge)
 %attribute(massif::TileData, bool, ReplaceWithParent, isReplaceWithParent, setReplaceWithParent)
+%attributestring(massif::TileData, std::string, EntityTag, getEntityTag, setEntityTag)
+%attributestring(massif::TileData, std::string, LastModified, getLastModified, setLastModified)
 %attributestring(massif::TileData, std::shared_ptr<massif::BinaryData>, Data, getData)
 
 %ignore massif::TileData::getMetadata;
 %ignore massif::TileData::setMetadata;
+%ignore massif::TileData::getMetadataMap;
+%ignore massif::TileData::getNativeTile;
+%ignore massif::TileData::setNativeTile;
 
 !standard_equals(massif::TileData);
 
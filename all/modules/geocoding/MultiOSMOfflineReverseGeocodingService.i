@@ -8,7 +8,7 @@
 
 #if defined(_MASSIF_GEOCODING_SUPPORT) && defined(_MASSIF_OFFLINE_SUPPORT)
 
-!proxy_imports(massif::MultiOSMOfflineReverseGeocodingService, geocoding.ReverseGeocodingService, geocoding.ReverseGeocodingRequest, geocoding.GeocodingResult, projections.Projection)
+!proxy_imports(massif::MultiOSMOfflineReverseGeocodingService, core.MapPos, core.MapPosVector, geocoding.ReverseGeocodingService, geocoding.ReverseGeocodingRequest, geocoding.GeocodingResult, projections.Projection)
 
 %{
 #include "geocoding/MultiOSMOfflineReverseGeocodingService.h"
@@ -19,6 +19,7 @@
 %include <std_shared_ptr.i>
 %include <massifswig.i>
 
+%import "core/MapPos.i"
 %import "geocoding/ReverseGeocodingService.i"
 %import "geocoding/ReverseGeocodingRequest.i"
 %import "geocoding/GeocodingResult.i"
@@ -27,6 +28,7 @@
 
 %std_io_exceptions(massif::MultiOSMOfflineReverseGeocodingService::MultiOSMOfflineReverseGeocodingService)
 %std_io_exceptions(massif::MultiOSMOfflineReverseGeocodingService::calculateAddresses)
+%std_io_exceptions(massif::MultiOSMOfflineReverseGeocodingService::calculateAddressesBatch)
 
 %feature("director") massif::MultiOSMOfflineReverseGeocodingService;
 
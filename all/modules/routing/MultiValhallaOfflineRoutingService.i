@@ -5,7 +5,7 @@
 
 #if defined(_MASSIF_ROUTING_SUPPORT) && defined(_MASSIF_VALHALLA_ROUTING_SUPPORT)
 
-!proxy_imports(massif::MultiValhallaOfflineRoutingService, core.Variant, routing.RoutingService, routing.RoutingRequest, routing.RoutingResult, routing.RouteMatchingRequest, routing.RouteMatchingResult)
+!proxy_imports(massif::MultiValhallaOfflineRoutingService, core.Variant, routing.RoutingService, routing.RoutingRequest, routing.RoutingResult, routing.RouteMatchingRequest, routing.RouteMatchingResult, routing.RoutingMatrixRequest, routing.RoutingMatrixResult)
 
 %{
 #include "routing/MultiValhallaOfflineRoutingService.h"
@@ -24,6 +24,7 @@
 
 %std_io_exceptions(massif::MultiValhallaOfflineRoutingService::matchRoute)
 %std_io_exceptions(massif::MultiValhallaOfflineRoutingService::calculateRoute)
+%std_io_exceptions(massif::MultiValhallaOfflineRoutingService::calculateMatrix)
 
 %feature("director") massif::MultiValhallaOfflineRoutingService;
 
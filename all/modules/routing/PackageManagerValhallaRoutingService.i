@@ -5,7 +5,7 @@
 
 #if defined(_MASSIF_ROUTING_SUPPORT) && defined(_MASSIF_VALHALLA_ROUTING_SUPPORT) && defined(_MASSIF_PACKAGEMANAGER_SUPPORT)
 
-!proxy_imports(massif::PackageManagerValhallaRoutingService, packagemanager.PackageManager, core.Variant, routing.RoutingService, routing.RoutingRequest, routing.RoutingResult, routing.RouteMatchingRequest, routing.RouteMatchingResult)
+!proxy_imports(massif::PackageManagerValhallaRoutingService, packagemanager.PackageManager, core.Variant, routing.RoutingService, routing.RoutingRequest, routing.RoutingResult, routing.RouteMatchingRequest, routing.RouteMatchingResult, routing.RoutingMatrixRequest, routing.RoutingMatrixResult)
 
 %{
 #include "routing/PackageManagerValhallaRoutingService.h"
@@ -26,6 +26,7 @@
 %std_exceptions(massif::PackageManagerValhallaRoutingService::PackageManagerValhallaRoutingService)
 %std_io_exceptions(massif::PackageManagerValhallaRoutingService::matchRoute)
 %std_io_exceptions(massif::PackageManagerValhallaRoutingService::calculateRoute)
+%std_io_exceptions(massif::PackageManagerValhallaRoutingService::calculateMatrix)
 
 %feature("director") massif::PackageManagerValhallaRoutingService;
 
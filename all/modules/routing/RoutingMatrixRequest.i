@@ -0,0 +1,40 @@
+#ifndef _ROUTINGMATRIXREQUEST_I
+#define _ROUTINGMATRIXREQUEST_I
+
+#pragma SWIG nowarn=325
+
+%module RoutingMatrixRequest
+
+#ifdef _MASSIF_ROUTING_SUPPORT
+
+!proxy_imports(massif::RoutingMatrixRequest, core.MapPos, core.MapPosVector, core.Variant, projections.Projection)
+
+%{
+#include "routing/RoutingMatrixRequest.h"
+#include "components/Exceptions.h"
+#include <memory>
+%}
+
+%include <std_shared_ptr.i>
+%include <std_string.i>
+%include <massifswig.i>
+
+%import "core/MapPos.i"
+%import "core/Variant.i"
+%import "projections/Projection.i"
+
+!shared_ptr(massif::RoutingMatrixRequest, routing.RoutingMatrixRequest)
+
+%attributestring(massif::RoutingMatrixRequest, std::shared_ptr<massif::Projection>, Projection, getProjection)
+%attributeval(massif::RoutingMatrixRequest, std::vector<massif::MapPos>, Sources, getSources)
+%attributeval(massif::RoutingMatrixRequest, std::vector<massif::MapPos>, Targets, getTargets)
+%ignore massif::RoutingMatrixRequest::getCustomParameters;
+%std_exceptions(massif::RoutingMatrixRequest::RoutingMatrixRequest)
+!standard_equals(massif::RoutingMatrixRequest);
+!custom_tostring(massif::RoutingMatrixRequest);
+
+%include "routing/RoutingMatrixRequest.h"
+
+#endif
+
+#endif
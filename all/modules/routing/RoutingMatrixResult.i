@@ -0,0 +1,39 @@
+#ifndef _ROUTINGMATRIXRESULT_I
+#define _ROUTINGMATRIXRESULT_I
+
+#pragma SWIG nowarn=325
+
+%module RoutingMatrixResult
+
+#ifdef _MASSIF_ROUTING_SUPPORT
+
+!proxy_imports(massif::RoutingMatrixResult, core.DoubleVector)
+
+%{
+#include "routing/RoutingMatrixResult.h"
+#include "components/Exceptions.h"
+#include <memory>
+%}
+
+%include <std_shared_ptr.i>
+%include <massifswig.i>
+
+%import "core/DoubleVector.i"
+
+!shared_ptr(massif::RoutingMatrixResult, routing.RoutingMatrixResult)
+
+%attribute(massif::RoutingMatrixResult, int, SourceCount, getSourceCount)
+%attribute(massif::RoutingMatrixResult, int, TargetCount, getTargetCount)
+%attributeval(massif::RoutingMatrixResult, std::vector<double>, Times, getTimes)
+%attributeval(massif::RoutingMatrixResult, std::vector<double>, Distances, getDistances)
+%std_exceptions(massif::RoutingMatrixResult::RoutingMatrixResult)
+%std_exceptions(massif::RoutingMatrixResult::getTime)
+%std_exceptions(massif::RoutingMatrixResult::getDistance)
+!standard_equals(massif::RoutingMatrixResult);
+!custom_tostring(massif::RoutingMatrixResult);
+
+%include "routing/RoutingMatrixResult.h"
+
+#endif
+
+#endif
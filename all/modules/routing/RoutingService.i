@@ -8,7 +8,7 @@
 
 #ifdef _MASSIF_ROUTING_SUPPORT
 
-!proxy_imports(massif::RoutingService, routing.RoutingRequest, routing.RoutingResult, routing.RouteMatchingRequest, routing.RouteMatchingResult)
+!proxy_imports(massif::RoutingService, routing.RoutingRequest, routing.RoutingResult, routing.RouteMatchingRequest, routing.RouteMatchingResult, routing.RoutingMatrixRequest, routing.RoutingMatrixResult)
 
 %{
 #include "routing/RoutingService.h"
@@ -24,6 +24,8 @@
 %import "routing/RoutingResult.i"
 %import "routing/RouteMatchingRequest.i"
 %import "routing/RouteMatchingResult.i"
+%import "routing/RoutingMatrixRequest.i"
+%import "routing/RoutingMatrixResult.i"
 
 !polymorphic_shared_ptr(massif::RoutingService, routing.RoutingService)
 
@@ -31,6 +33,7 @@
 %std_exceptions(massif::RoutingService::setProfile)
 %std_io_exceptions(massif::RoutingService::matchRoute)
 %std_io_exceptions(massif::RoutingService::calculateRoute)
+%std_io_exceptions(massif::RoutingService::calculateMatrix)
 
 %feature("director") massif::RoutingService;
 
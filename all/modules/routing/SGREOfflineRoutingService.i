@@ -5,7 +5,7 @@
 
 #if defined(_MASSIF_ROUTING_SUPPORT) && defined(_MASSIF_OFFLINE_SUPPORT)
 
-!proxy_imports(massif::SGREOfflineRoutingService, core.Variant, geometry.FeatureCollection, projections.Projection, routing.RoutingService, routing.RoutingRequest, routing.RoutingResult, routing.RouteMatchingRequest, routing.RouteMatchingResult)
+!proxy_imports(massif::SGREOfflineRoutingService, core.Variant, geometry.FeatureCollection, projections.Projection, routing.RoutingService, routing.RoutingRequest, routing.RoutingResult, routing.RouteMatchingRequest, routing.RouteMatchingResult, routing.RoutingMatrixRequest, routing.RoutingMatrixResult)
 
 %{
 #include "routing/SGREOfflineRoutingService.h"
@@ -27,6 +27,7 @@
 %std_io_exceptions(massif::SGREOfflineRoutingService::SGREOfflineRoutingService)
 %std_io_exceptions(massif::SGREOfflineRoutingService::matchRoute)
 %std_io_exceptions(massif::SGREOfflineRoutingService::calculateRoute)
+%std_io_exceptions(massif::SGREOfflineRoutingService::calculateMatrix)
 
 %feature("director") massif::SGREOfflineRoutingService;
 
@@ -5,7 +5,7 @@
 
 #if defined(_MASSIF_ROUTING_SUPPORT) && defined(_MASSIF_VALHALLA_ROUTING_SUPPORT) && defined(_MASSIF_OFFLINE_SUPPORT)
 
-!proxy_imports(massif::ValhallaOfflineRoutingService, core.Variant, routing.RoutingService, routing.RoutingRequest, routing.RoutingResult, routing.RouteMatchingRequest, routing.RouteMatchingResult, datasources.TileDataSource, rastertiles.ElevationDecoder)
+!proxy_imports(massif::ValhallaOfflineRoutingService, core.Variant, routing.RoutingService, routing.RoutingRequest, routing.RoutingResult, routing.RouteMatchingRequest, routing.RouteMatchingResult, routing.RoutingMatrixRequest, routing.RoutingMatrixResult, datasources.TileDataSource, rastertiles.ElevationDecoder)
 
 %{
 #include "routing/ValhallaOfflineRoutingService.h"
@@ -27,6 +27,7 @@
 %std_io_exceptions(massif::ValhallaOfflineRoutingService::ValhallaOfflineRoutingService)
 %std_io_exceptions(massif::ValhallaOfflineRoutingService::matchRoute)
 %std_io_exceptions(massif::ValhallaOfflineRoutingService::calculateRoute)
+%std_io_exceptions(massif::ValhallaOfflineRoutingService::calculateMatrix)
 
 %feature("director") massif::ValhallaOfflineRoutingService;
 
@@ -18,6 +18,7 @@
 %staticattribute(massif::Log, bool, ShowWarn, IsShowWarn, SetShowWarn)
 %staticattribute(massif::Log, bool, ShowInfo, IsShowInfo, SetShowInfo)
 %staticattribute(massif::Log, bool, ShowDebug, IsShowDebug, SetShowDebug)
+%staticattribute(massif::Log, bool, AsyncOutput, IsAsyncOutput, SetAsyncOutput)
 %staticattributestring(massif::Log, std::string, Tag, GetTag, SetTag)
 !staticattributestring_polymorphic(massif::Log, utils.LogEventListener, LogEventListener, GetLogEventListener, SetLogEventListener)
 %ignore massif::Log::Fatalf;
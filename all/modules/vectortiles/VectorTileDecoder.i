@@ -31,6 +31,9 @@
 %ignore massif::VectorTileDecoder::getSymbolizerContextSettings;
 %ignore massif::VectorTileDecoder::setPixelScale;
 %ignore massif::VectorTileDecoder::OnChangeListener;
+%ignore massif::VectorTileDecoder::FeatureAttributes;
+%ignore massif::VectorTileDecoder::FeatureFilter;
+%ignore massif::VectorTileDecoder::filterFeatures;
 %ignore massif::VectorTileDecoder::registerOnChangeListener;
 %ignore massif::VectorTileDecoder::unregisterOnChangeListener;
 !standard_equals(massif::VectorTileDecoder);
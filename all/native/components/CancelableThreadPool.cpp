@@ -1,6 +1,7 @@
 #include "CancelableThreadPool.h"
 #include "utils/Log.h"
 #include "utils/ThreadUtils.h"
+#include "utils/TraceProfiler.h"
 
 #include <limits>
 
@@ -96,7 +97,7 @@ namespace massif {
                 }
             }
             if (createWorker) {
-                Log::Debugf("CancelableThreadPool: Adding worker to the pool (size %d)", (int)_workers.size());
+                LOG_DEBUGF("CancelableThreadPool: Adding worker to the pool (size %d)", (int)_workers.size());
                 _workers.push_back(std::make_shared<TaskWorker>(shared_from_this(), priority));
                 _threads.push_back(std::thread(&TaskWorker::operator(), _workers.back()));
             }
@@ -140,6 +141,7 @@ namespace massif {
         
     void CancelableThreadPool::TaskWorker::operator ()() {
         ThreadUtils::SetThreadPriority(ThreadPriority::MINIMUM);
+        TRACE_THREAD_NAME("ThreadPoolWorker");
         while (true) {
             auto threadPool = _threadPool.lock();
             if (!threadPool) {
@@ -217,7 +219,7 @@ namespace massif {
             for (std::size_t index = 0; index < _workers.size(); index++) {
                 if (_workers[index].get() == &worker) {
                     // Remove thread and worker
-                    Log::Debugf("CancelableThreadPool: Removing worker from the pool (size %d)", (int)index);
+                    LOG_DEBUGF("CancelableThreadPool: Removing worker from the pool (size %d)", (int)index);
                     _workers.erase(_workers.begin() + index);
                     _threads.at(index).detach();
                     _threads.erase(_threads.begin() + index);
@@ -92,6 +92,17 @@ namespace massif {
         }
     }
 
+    bool TerrainOptions::isDecodedHeightsEnabled() const {
+        return _elevationManager->isDecodedHeightsEnabled();
+    }
+
+    void TerrainOptions::setDecodedHeightsEnabled(bool enabled) {
+        if (_elevationManager->isDecodedHeightsEnabled() != enabled) {
+            _elevationManager->setDecodedHeightsEnabled(enabled);
+            notifyOptionChanged("DecodedHeightsEnabled");
+        }
+    }
+
     bool TerrainOptions::isElevationPrefetchEnabled() const {
         return _elevationManager->isNeighbourPrefetchEnabled();
     }
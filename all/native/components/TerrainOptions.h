@@ -111,6 +111,22 @@ namespace massif {
          */
         void setSeamlessTileEdgesEnabled(bool enabled);
 
+        /**
+         * Returns whether decoded elevation heights are kept in memory.
+         * @return True if elevation tiles are decoded to heights once and kept. The default is true.
+         */
+        bool isDecodedHeightsEnabled() const;
+        /**
+         * Enables or disables keeping decoded elevation heights. When enabled, every elevation tile
+         * is decoded into a float height array when it is loaded, and all CPU-side height queries
+         * (contour lines, billboard occlusion, element placement, clicks) read that array instead
+         * of decoding the encoded tile bitmap per sample. Costs 4 bytes per elevation texel, which
+         * counts against the elevation cache budget. Disable to save memory when few CPU-side
+         * height queries are made. The heights are the same either way.
+         * @param enabled True to keep decoded heights of elevation tiles.
+         */
+        void setDecodedHeightsEnabled(bool enabled);
+
         /**
          * Returns whether elevation tile prefetching is enabled.
          * @return True if visible tiles and their neighbours are requested from the elevation data source. The default is true.
@@ -17,10 +17,10 @@ namespace massif {
     
     std::shared_ptr<TileData> AssetTileDataSource::loadTile(const MapTile& tile) {
         const std::string& path = buildAssetPath(_basePath, tile);
-        Log::Infof("AssetTileDataSource::loadTile: Loading %s", path.c_str());
+        LOG_INFOF("AssetTileDataSource::loadTile: Loading %s", path.c_str());
         std::shared_ptr<BinaryData> data = AssetUtils::LoadAsset(path);
         if (!data) {
-            Log::Infof("AssetTileDataSource::loadTile: Failed to load %s", path.c_str());
+            LOG_INFOF("AssetTileDataSource::loadTile: Failed to load %s", path.c_str());
             return std::shared_ptr<TileData>();
         }
         auto tileData = std::make_shared<TileData>(data);
@@ -161,12 +161,12 @@ namespace massif {
         // Find tile area in raster space
         int minU, minV, maxU, maxV;
         if (!BitmapFilterTable::calculateFilterBounds(ProjectiveTransform(invTransform), _tileSize, _tileSize, _bitmap->getWidth(), _bitmap->getHeight(), minU, minV, maxU, maxV, MAX_FILTER_WIDTH)) {
-            Log::Infof("BitmapOverlayRasterTileDataSource: Tile %s outside of bitmap", mapTile.toString().c_str());
+            LOG_INFOF("BitmapOverlayRasterTileDataSource: Tile %s outside of bitmap", mapTile.toString().c_str());
             return std::shared_ptr<TileData>();
         }
 
         // Calculate filter table
-        Log::Infof("BitmapOverlayRasterTileDataSource: Tile %s inside the raster dataset", mapTile.toString().c_str());
+        LOG_INFOF("BitmapOverlayRasterTileDataSource: Tile %s inside the raster dataset", mapTile.toString().c_str());
         BitmapFilterTable filterTable(0, 0, _bitmap->getWidth(), _bitmap->getHeight());
         filterTable.calculateFilterTable(ProjectiveTransform(invTransform), _tileSize, _tileSize, FILTER_SCALE, MAX_FILTER_WIDTH);
         
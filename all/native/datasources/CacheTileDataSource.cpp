@@ -11,7 +11,8 @@ namespace massif {
     
     CacheTileDataSource::CacheTileDataSource(const std::shared_ptr<TileDataSource>& dataSource) :
         TileDataSource(),
-        _dataSource(dataSource)
+        _dataSource(dataSource),
+        _coalescedLoadCount(0)
     {
         if (!dataSource) {
             throw NullArgumentException("Null dataSource");
@@ -64,6 +65,10 @@ namespace massif {
         }
     }
 
+    bool CacheTileDataSource::isBatchLoadSupported() const {
+        return _dataSource->isBatchLoadSupported();
+    }
+
     void CacheTileDataSource::notifyTilesChanged(bool removeTiles) {
         clear();
         TileDataSource::notifyTilesChanged(removeTiles);
@@ -72,6 +77,10 @@ namespace massif {
     std::shared_ptr<TileDataSource> CacheTileDataSource::getDataSource() const {
         return _dataSource.get();
     }
+
+    unsigned int CacheTileDataSource::getCoalescedLoadCount() const {
+        return _coalescedLoadCount.load();
+    }
     
     CacheTileDataSource::DataSourceListener::DataSourceListener(CacheTileDataSource& cacheDataSource) :
         _cacheDataSource(cacheDataSource)
@@ -10,6 +10,8 @@
 #include "datasources/TileDataSource.h"
 #include "components/DirectorPtr.h"
 
+#include <atomic>
+
 namespace massif {
     
     /**
@@ -35,6 +37,10 @@ namespace massif {
 
         virtual void notifyTilesChanged(bool removeTiles);
 
+#ifndef SWIG
+        virtual bool isBatchLoadSupported() const;
+#endif
+
         /**
          * Returns the original data source that the cache uses.
          * @return The original data source.
@@ -57,6 +63,13 @@ namespace massif {
          */
         virtual void setCapacity(std::size_t capacityInBytes) = 0;
 
+        /**
+         * Returns the number of tile loads that were served by joining an already
+         * in-flight load of the same tile instead of loading it from the original data source again.
+         * @return The number of coalesced tile loads since the data source was created.
+         */
+        unsigned int getCoalescedLoadCount() const;
+
     protected:
         class DataSourceListener : public TileDataSource::OnChangeListener {
         public:
@@ -84,6 +97,8 @@ namespace massif {
         void applyCacheTileMetadata(const std::shared_ptr<TileData>& tileData, const MapTile& tile) const;
 
         const DirectorPtr<TileDataSource> _dataSource;
+
+        std::atomic<unsigned int> _coalescedLoadCount;
         
     private:
         std::shared_ptr<DataSourceListener> _dataSourceListener;
@@ -15,6 +15,7 @@
 #include "rastertiles/MapBoxElevationDataDecoder.h"
 #include "utils/TileUtils.h"
 #include "utils/Log.h"
+#include "vectortiles/NativeVectorTile.h"
 
 #include <algorithm>
 #include <cmath>
@@ -23,9 +24,11 @@
 #include <limits>
 #include <vector>
 
-#include <mbvtbuilder/MBVTTileBuilder.h>
+#include <cglib/vec.h>
 
-#include <mapnikvt/mbvtpackage/MBVTPackage.pb.h>
+#include <mapnikvt/Value.h>
+#include <mapnikvt/Geometry.h>
+#include <mapnikvt/FeatureData.h>
 
 namespace {
 
@@ -346,6 +349,74 @@ namespace {
         return polylines;
     }
 
+    // Douglas-Peucker over tile-local vertices, in place - the simplification the tile builder
+    // used to apply. The tolerance is in tile units (tile pixels / 256).
+    void simplifyLine(std::vector<cglib::vec2<float> >& line, float tolerance) {
+        if (!(tolerance > 0.0f) || line.size() <= 2) {
+            return;
+        }
+
+        std::vector<std::uint8_t> keep(line.size(), 0);
+        keep.front() = keep.back() = 1;
+        std::vector<std::pair<std::size_t, std::size_t> > ranges;
+        ranges.emplace_back(0, line.size() - 1);
+        float tolerance2 = tolerance * tolerance;
+        while (!ranges.empty()) {
+            std::size_t first = ranges.back().first;
+            std::size_t last = ranges.back().second;
+            ranges.pop_back();
+
+            // Distance to the chord, or to its first point when the chord is a closed ring's.
+            cglib::vec2<float> a = line[first];
+            cglib::vec2<float> ab = line[last] - a;
+            float ab2 = cglib::dot_product(ab, ab);
+            float maxDist2 = 0.0f;
+            std::size_t maxIndex = first;
+            for (std::size_t i = first + 1; i < last; i++) {
+                cglib::vec2<float> ap = line[i] - a;
+                float t = ab2 > 0.0f ? std::min(std::max(cglib::dot_product(ap, ab) / ab2, 0.0f), 1.0f) : 0.0f;
+                cglib::vec2<float> d = ap - ab * t;
+                float dist2 = cglib::dot_product(d, d);
+                if (dist2 > maxDist2) {
+                    maxDist2 = dist2;
+                    maxIndex = i;
+                }
+            }
+            if (maxDist2 > tolerance2) {
+                keep[maxIndex] = 1;
+                ranges.emplace_back(first, maxIndex);
+                ranges.emplace_back(maxIndex, last);
+            }
+        }
+
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < line.size(); i++) {
+            if (keep[i]) {
+                line[count++] = line[i];
+            }
+        }
+        line.resize(count);
+    }
+
+    std::shared_ptr<const massif::mvt::FeatureData> createContourFeatureData(long long ele, long long div, bool stub) {
+        std::vector<std::pair<std::string, massif::mvt::Value> > variables;
+        variables.emplace_back("ele", massif::mvt::Value(ele));
+        variables.emplace_back("div", massif::mvt::Value(div));
+        variables.emplace_back("stub", massif::mvt::Value(static_cast<long long>(stub ? 1 : 0)));
+        return std::make_shared<const massif::mvt::FeatureData>(massif::mvt::FeatureData::GeometryType::LINE_GEOMETRY, std::move(variables));
+    }
+
+    // Contour tiles go to the vector tile layer as features in memory: the binary data is empty
+    // and never decoded.
+    std::shared_ptr<massif::TileData> createNativeTileData(const std::string& layerName, std::vector<massif::NativeVectorTile::Feature> features) {
+        std::vector<massif::NativeVectorTile::Layer> layers;
+        layers.emplace_back(layerName);
+        layers.back().features = std::move(features);
+        auto tileData = std::make_shared<massif::TileData>(std::make_shared<massif::BinaryData>(std::vector<unsigned char>()));
+        tileData->setNativeTile(std::make_shared<const massif::NativeVectorTile>(std::move(layers)));
+        return tileData;
+    }
+
 }
 
 namespace massif {
@@ -587,24 +658,15 @@ namespace massif {
             labelInterval = interval;
         }
 
-        // The tile's footprint. Note the getFlipped(): grid v = 0 is the tile's SOUTH edge, as in
-        // the DEM bitmap and in ElevationManager; the builder takes the raw tile x/y, so the same
-        // footprint comes back without a double flip.
-        std::shared_ptr<Projection> projection = getProjection();
-        MapBounds bounds = TileUtils::CalculateMapTileBounds(mapTile.getFlipped(), projection);
-        double minX = bounds.getMin().getX(), minY = bounds.getMin().getY();
-        double sizeX = bounds.getMax().getX() - minX;
-        double sizeY = bounds.getMax().getY() - minY;
-        auto uvToWgs84 = [&](const GridPoint& p) -> mbvtbuilder::MBVTTileBuilder::Point {
-            MapPos pos(minX + std::min(std::max(p.first, 0.0), 1.0) * sizeX,
-                       minY + std::min(std::max(p.second, 0.0), 1.0) * sizeY);
-            MapPos wgs84 = projection->toWgs84(pos);
-            return mbvtbuilder::MBVTTileBuilder::Point(wgs84.getX(), wgs84.getY());
+        // Tile-local vertices, as the vector tile decoder takes them: y = 0 is the tile's NORTH
+        // edge, while grid v = 0 is its SOUTH edge, as in the DEM bitmap and in ElevationManager.
+        auto uvToTile = [](const GridPoint& p) {
+            return cglib::vec2<float>(static_cast<float>(std::min(std::max(p.first, 0.0), 1.0)),
+                                      static_cast<float>(1.0 - std::min(std::max(p.second, 0.0), 1.0)));
         };
+        float tolerance = _simplifyTolerance.load() / static_cast<float>(LABEL_TILE_SIZE);
 
-        mbvtbuilder::MBVTTileBuilder tileBuilder(zoom, zoom);
-        tileBuilder.setSimplifyTolerance(_simplifyTolerance);
-        int layerIndex = tileBuilder.createLayer(layerName);
+        std::vector<NativeVectorTile::Feature> features;
 
         // Their grid alignment: seeds sit at the same geographic positions across zoom levels, so a
         // label does not jump when the tile it comes from is replaced by a finer one.
@@ -621,36 +683,25 @@ namespace massif {
                     continue;
                 }
                 long long ele = static_cast<long long>(std::llround(level));
-                std::vector<mbvtbuilder::MBVTTileBuilder::Point> line;
+                std::vector<cglib::vec2<float> > line;
                 line.reserve(stub.size());
                 for (const GridPoint& gp : stub) {
-                    line.push_back(uvToWgs84(gp));
+                    line.push_back(uvToTile(gp));
                 }
-                mbvtbuilder::MBVTTileBuilder::MultiLineString lines;
+                simplifyLine(line, tolerance);
+                std::vector<std::vector<cglib::vec2<float> > > lines;
                 lines.push_back(std::move(line));
 
-                picojson::object props;
-                props["ele"] = picojson::value(static_cast<std::int64_t>(ele));
-                props["div"] = picojson::value(static_cast<std::int64_t>(computeDiv(ele)));
-                // So a style that draws contour LINES from this layer can exclude the stubs, which
-                // are only long enough to carry text: '#contour[stub=0] { line-width: .. }'.
-                props["stub"] = picojson::value(static_cast<std::int64_t>(1));
-                tileBuilder.addMultiLineString(layerIndex, std::move(lines), picojson::value(static_cast<std::int64_t>(ele)), picojson::value(props), false);
+                // 'stub' = 1, so a style that draws contour LINES from this layer can exclude the
+                // stubs, which are only long enough to carry text: '#contour[stub=0] { line-width: .. }'.
+                auto geometry = std::make_shared<const mvt::Geometry>(mvt::LineGeometry(std::move(lines)));
+                features.emplace_back(ele, geometry, createContourFeatureData(ele, computeDiv(ele), true));
             }
         }
 
-        try {
-            protobuf::encoded_message encodedTile;
-            tileBuilder.buildTile(zoom, mapTile.getX(), mapTile.getY(), encodedTile);
-            auto data = std::make_shared<BinaryData>(reinterpret_cast<const unsigned char*>(encodedTile.data().data()), encodedTile.data().size());
-            auto tileData = std::make_shared<TileData>(data);
-            applyTileMetadata(tileData, mapTile);
-            return tileData;
-        }
-        catch (const std::exception& ex) {
-            Log::Errorf("ContourTileDataSource::loadTile: Failed to build contour label tile %s: %s", mapTile.toString().c_str(), ex.what());
-            return std::shared_ptr<TileData>();
-        }
+        std::shared_ptr<TileData> tileData = createNativeTileData(layerName, std::move(features));
+        applyTileMetadata(tileData, mapTile);
+        return tileData;
     }
 
     namespace {
@@ -761,19 +812,9 @@ namespace massif {
         // Below the useful contour zoom, emit an empty (but valid) tile without fetching or decoding the
         // DEM. This keeps zoomed-out frames cheap even though the layer may request many such tiles.
         if (zoom < _minVisibleZoom.load()) {
-            try {
-                mbvtbuilder::MBVTTileBuilder emptyBuilder(zoom, zoom);
-                emptyBuilder.createLayer(layerName);
-                protobuf::encoded_message encodedTile;
-                emptyBuilder.buildTile(zoom, mapTile.getX(), mapTile.getY(), encodedTile);
-                auto data = std::make_shared<BinaryData>(reinterpret_cast<const unsigned char*>(encodedTile.data().data()), encodedTile.data().size());
-                auto tileData = std::make_shared<TileData>(data);
-                applyTileMetadata(tileData, mapTile);
-                return tileData;
-            }
-            catch (const std::exception& ex) {
-                return std::shared_ptr<TileData>();
-            }
+            std::shared_ptr<TileData> tileData = createNativeTileData(layerName, std::vector<NativeVectorTile::Feature>());
+            applyTileMetadata(tileData, mapTile);
+            return tileData;
         }
 
         // Label stubs off the terrain's own elevation, which is how tangram generates them: their
@@ -938,33 +979,18 @@ namespace massif {
             }
         }
 
-        // Geographic bounds of this tile (EPSG3857). Note the getFlipped(): the DEM bitmap's
-        // south edge (grid row 0) corresponds to the flipped tile's minimum-y bound, matching
-        // ElevationManager. The MBVT builder is called with the raw tile x/y (as GeoJSONVectorTileDataSource
-        // does), so the same footprint is reproduced without a double flip.
-        std::shared_ptr<Projection> projection = getProjection();
-        MapBounds bounds = TileUtils::CalculateMapTileBounds(mapTile.getFlipped(), projection);
-        double minX = bounds.getMin().getX(), minY = bounds.getMin().getY();
-        double sizeX = bounds.getMax().getX() - minX;
-        double sizeY = bounds.getMax().getY() - minY;
-
-        auto gridToWgs84 = [&](const GridPoint& p) -> mbvtbuilder::MBVTTileBuilder::Point {
-            // Node 0 -> tile min edge, node W-1/H-1 -> tile max edge (even resample spans full extent).
-            double fx = p.first / static_cast<double>(W - 1);
-            double fy = p.second / static_cast<double>(H - 1);
-            if (fx > 1.0) fx = 1.0;
-            if (fy > 1.0) fy = 1.0;
-            MapPos pos3857(minX + fx * sizeX, minY + fy * sizeY);
-            MapPos wgs84 = projection->toWgs84(pos3857);
-            return mbvtbuilder::MBVTTileBuilder::Point(wgs84.getX(), wgs84.getY());
+        // Tile-local vertices, as the vector tile decoder takes them. Node 0 -> tile min edge, node
+        // W-1/H-1 -> tile max edge (even resample spans full extent); grid row 0 is the tile's SOUTH
+        // edge, as in the DEM bitmap and ElevationManager, while tile-local y = 0 is its NORTH edge.
+        auto gridToTile = [W, H](const GridPoint& p) {
+            double fx = std::min(p.first / static_cast<double>(W - 1), 1.0);
+            double fy = std::min(p.second / static_cast<double>(H - 1), 1.0);
+            return cglib::vec2<float>(static_cast<float>(fx), static_cast<float>(1.0 - fy));
         };
+        float tolerance = simplifyTolerance / static_cast<float>(LABEL_TILE_SIZE);
 
         double interval = getIntervalForZoom(zoom);
 
-        mbvtbuilder::MBVTTileBuilder tileBuilder(zoom, zoom);
-        tileBuilder.setSimplifyTolerance(simplifyTolerance);
-        int layerIndex = tileBuilder.createLayer(layerName);
-
         // Label stubs instead of traced contours: a short polyline ON a contour per seed, which is
         // all a label needs. Tangram's ContourTextStyleBuilder (core/src/style/contourTextStyle.cpp)
         // generates its contour labels this way and carries no contour geometry at all - the lines
@@ -1003,6 +1029,8 @@ namespace massif {
         }
         LinkBuffers linkBuffers;
         linkBuffers.resize(static_cast<std::size_t>(W) * H * 2);
+        std::vector<NativeVectorTile::Feature> features;
+        features.reserve(static_cast<std::size_t>(std::max(0LL, lastLevel - firstLevel + 1)));
 
         for (long long l = firstLevel; l <= lastLevel; l++) {
             double level = l * interval;
@@ -1013,39 +1041,28 @@ namespace massif {
                 continue;
             }
 
-            mbvtbuilder::MBVTTileBuilder::MultiLineString lines;
+            std::vector<std::vector<cglib::vec2<float> > > lines;
             lines.reserve(polylines.size());
             for (const Polyline& pl : polylines) {
-                std::vector<mbvtbuilder::MBVTTileBuilder::Point> line;
+                std::vector<cglib::vec2<float> > line;
                 line.reserve(pl.size());
                 for (const GridPoint& gp : pl) {
-                    line.push_back(gridToWgs84(gp));
+                    line.push_back(gridToTile(gp));
                 }
+                simplifyLine(line, tolerance);
                 lines.push_back(std::move(line));
             }
 
-            picojson::object props;
-            props["ele"] = picojson::value(static_cast<std::int64_t>(ele));
-            props["div"] = picojson::value(static_cast<std::int64_t>(computeDiv(ele)));
-            // Always present, so a style can filter on it in both modes: an undefined attribute
-            // does not compare equal to 0, so a '[stub=0]' line rule would drop the traced
+            // 'stub' is always present, so a style can filter on it in both modes: an undefined
+            // attribute does not compare equal to 0, so a '[stub=0]' line rule would drop the traced
             // geometry too if only the stubs carried it.
-            props["stub"] = picojson::value(static_cast<std::int64_t>(0));
-            tileBuilder.addMultiLineString(layerIndex, std::move(lines), picojson::value(static_cast<std::int64_t>(ele)), picojson::value(props), false);
+            auto geometry = std::make_shared<const mvt::Geometry>(mvt::LineGeometry(std::move(lines)));
+            features.emplace_back(ele, geometry, createContourFeatureData(ele, computeDiv(ele), false));
         }
 
-        try {
-            protobuf::encoded_message encodedTile;
-            tileBuilder.buildTile(zoom, mapTile.getX(), mapTile.getY(), encodedTile);
-            auto data = std::make_shared<BinaryData>(reinterpret_cast<const unsigned char*>(encodedTile.data().data()), encodedTile.data().size());
-            auto tileData = std::make_shared<TileData>(data);
-            applyTileMetadata(tileData, mapTile);
-            return tileData;
-        }
-        catch (const std::exception& ex) {
-            Log::Errorf("ContourTileDataSource::loadTile: Failed to build contour tile %s: %s", mapTile.toString().c_str(), ex.what());
-            return std::shared_ptr<TileData>();
-        }
+        std::shared_ptr<TileData> tileData = createNativeTileData(layerName, std::move(features));
+        applyTileMetadata(tileData, mapTile);
+        return tileData;
     }
 
     ContourTileDataSource::DataSourceListener::DataSourceListener(ContourTileDataSource& dataSource) :
@@ -28,8 +28,9 @@ namespace massif {
      * is shared (e.g. with a HillshadeRasterTileLayer) so terrain tiles are fetched
      * only once.
      *
-     * The generated tiles are standard Mapbox Vector Tiles containing a single line
-     * layer (default name "contour"). Each contour feature carries two attributes:
+     * The generated tiles contain a single line layer (default name "contour"). They are
+     * handed to the vector tile layer as in-memory features rather than encoded Mapbox Vector
+     * Tiles, so their binary data is empty. Each contour feature carries two attributes:
      *   - 'ele': the contour elevation in meters.
      *   - 'div': the largest "nice" divisor of the elevation (1000, 500, 250, 200,
      *            100, 50, 20 or 10), matching the gdal_contour based pipeline. This
@@ -15,33 +15,262 @@
 #include "utils/Const.h"
 #include "utils/Log.h"
 
-#include <mbvtbuilder/MBVTTileBuilder.h>
+#include "vectortiles/NativeVectorTile.h"
+#include "datasources/components/GeoJSONTileIndex.h"
 
-#include <mapnikvt/mbvtpackage/MBVTPackage.pb.h>
+#include <functional>
+
+#include <picojson/picojson.h>
 
 namespace
 {
 
-    massif::mbvtbuilder::MBVTTileBuilder::Point convertPoint(const std::shared_ptr<massif::Projection> &projection, const massif::MapPos &mapPos)
+    struct GeometryParts
+    {
+        std::vector<massif::MapPos> points;
+        std::vector<std::vector<massif::MapPos>> lines;
+        std::vector<std::vector<std::vector<massif::MapPos>>> polygons;
+    };
+
+    // Same id mapping as removeGeoJSONFeature: numbers are used as is, strings are hashed
+    std::optional<std::uint64_t> readFeatureId(const picojson::value &id)
+    {
+        if (id.is<std::int64_t>())
+        {
+            return static_cast<std::uint64_t>(id.get<std::int64_t>());
+        }
+        if (id.is<std::string>())
+        {
+            return std::hash<std::string>()(id.get<std::string>());
+        }
+        return std::optional<std::uint64_t>();
+    }
+
+    massif::mvt::Value convertJSONValue(const picojson::value &value)
+    {
+        if (value.is<std::string>())
+        {
+            return massif::mvt::Value(value.get<std::string>());
+        }
+        if (value.is<bool>())
+        {
+            return massif::mvt::Value(value.get<bool>());
+        }
+        if (value.is<std::int64_t>())
+        {
+            return massif::mvt::Value(static_cast<long long>(value.get<std::int64_t>()));
+        }
+        if (value.is<double>())
+        {
+            return massif::mvt::Value(value.get<double>());
+        }
+        if (value.is<picojson::object>())
+        {
+            std::map<std::string, massif::mvt::Value> members;
+            const picojson::object &obj = value.get<picojson::object>();
+            for (auto it = obj.begin(); it != obj.end(); it++)
+            {
+                members[it->first] = convertJSONValue(it->second);
+            }
+            return massif::mvt::Value(std::make_shared<const massif::mvt::ValueObject>(std::move(members)));
+        }
+        if (value.is<picojson::array>())
+        {
+            std::vector<massif::mvt::Value> elements;
+            const picojson::array &arr = value.get<picojson::array>();
+            for (auto it = arr.begin(); it != arr.end(); it++)
+            {
+                elements.push_back(convertJSONValue(*it));
+            }
+            return massif::mvt::Value(std::make_shared<const massif::mvt::ValueArray>(std::move(elements)));
+        }
+        return massif::mvt::Value();
+    }
+
+    std::vector<std::pair<std::string, massif::mvt::Value>> readProperties(const picojson::value &properties)
+    {
+        std::vector<std::pair<std::string, massif::mvt::Value>> variables;
+        if (properties.is<picojson::object>())
+        {
+            const picojson::object &obj = properties.get<picojson::object>();
+            for (auto it = obj.begin(); it != obj.end(); it++)
+            {
+                if (!it->second.is<picojson::null>())
+                {
+                    variables.emplace_back(it->first, convertJSONValue(it->second));
+                }
+            }
+        }
+        return variables;
+    }
+
+    const picojson::array &readArray(const picojson::value &value)
+    {
+        if (!value.is<picojson::array>())
+        {
+            throw massif::ParseException("GeoJSON coordinates must be arrays", value.serialize());
+        }
+        return value.get<picojson::array>();
+    }
+
+    massif::MapPos readPosition(const picojson::value &value)
     {
-        massif::MapPos wgs84Pos = projection ? projection->toWgs84(mapPos) : mapPos;
-        return massif::mbvtbuilder::MBVTTileBuilder::Point(wgs84Pos.getX(), wgs84Pos.getY());
+        const picojson::array &coords = readArray(value);
+        if (coords.size() < 2 || !coords[0].is<double>() || !coords[1].is<double>())
+        {
+            throw massif::ParseException("Invalid GeoJSON position", value.serialize());
+        }
+        return massif::MapPos(coords[0].get<double>(), coords[1].get<double>());
     }
 
-    std::vector<massif::mbvtbuilder::MBVTTileBuilder::Point> convertPoints(const std::shared_ptr<massif::Projection> &projection, const std::vector<massif::MapPos> &mapPoses)
+    std::vector<massif::MapPos> readPositions(const picojson::value &value)
     {
-        std::vector<massif::mbvtbuilder::MBVTTileBuilder::Point> points;
+        std::vector<massif::MapPos> mapPoses;
+        for (const picojson::value &position : readArray(value))
+        {
+            mapPoses.push_back(readPosition(position));
+        }
+        return mapPoses;
+    }
+
+    std::vector<std::vector<massif::MapPos>> readPositionsList(const picojson::value &value)
+    {
+        std::vector<std::vector<massif::MapPos>> mapPosesList;
+        for (const picojson::value &positions : readArray(value))
+        {
+            mapPosesList.push_back(readPositions(positions));
+        }
+        return mapPosesList;
+    }
+
+    void readGeometry(const picojson::value &geometry, GeometryParts &parts)
+    {
+        if (geometry.is<picojson::null>())
+        {
+            return;
+        }
+        if (!geometry.is<picojson::object>() || !geometry.get("type").is<std::string>())
+        {
+            throw massif::ParseException("Invalid GeoJSON geometry", geometry.serialize());
+        }
+
+        const std::string &type = geometry.get("type").get<std::string>();
+        if (type == "GeometryCollection")
+        {
+            for (const picojson::value &subGeometry : readArray(geometry.get("geometries")))
+            {
+                readGeometry(subGeometry, parts);
+            }
+            return;
+        }
+
+        const picojson::value &coords = geometry.get("coordinates");
+        if (type == "Point")
+        {
+            parts.points.push_back(readPosition(coords));
+        }
+        else if (type == "MultiPoint")
+        {
+            std::vector<massif::MapPos> points = readPositions(coords);
+            parts.points.insert(parts.points.end(), points.begin(), points.end());
+        }
+        else if (type == "LineString")
+        {
+            parts.lines.push_back(readPositions(coords));
+        }
+        else if (type == "MultiLineString")
+        {
+            for (const picojson::value &line : readArray(coords))
+            {
+                parts.lines.push_back(readPositions(line));
+            }
+        }
+        else if (type == "Polygon")
+        {
+            parts.polygons.push_back(readPositionsList(coords));
+        }
+        else if (type == "MultiPolygon")
+        {
+            for (const picojson::value &polygon : readArray(coords))
+            {
+                parts.polygons.push_back(readPositionsList(polygon));
+            }
+        }
+        else
+        {
+            throw massif::ParseException("Unsupported GeoJSON geometry type: " + type);
+        }
+    }
+
+    // A feature with mixed geometry types becomes one index feature per type, sharing the id
+    void addFeatures(const std::optional<std::uint64_t> &id, const GeometryParts &parts, const std::vector<std::pair<std::string, massif::mvt::Value>> &properties, std::vector<std::shared_ptr<const massif::GeoJSONTileIndex::Feature>> &features)
+    {
+        if (auto feature = massif::GeoJSONTileIndex::CreatePointFeature(id, parts.points, properties))
+        {
+            features.push_back(feature);
+        }
+        if (auto feature = massif::GeoJSONTileIndex::CreateLineFeature(id, parts.lines, properties))
+        {
+            features.push_back(feature);
+        }
+        if (auto feature = massif::GeoJSONTileIndex::CreatePolygonFeature(id, parts.polygons, properties))
+        {
+            features.push_back(feature);
+        }
+    }
+
+    void readFeature(const picojson::value &feature, std::vector<std::shared_ptr<const massif::GeoJSONTileIndex::Feature>> &features)
+    {
+        if (!feature.is<picojson::object>() || !feature.get("type").is<std::string>() || feature.get("type").get<std::string>() != "Feature")
+        {
+            throw massif::ParseException("Expected GeoJSON Feature", feature.serialize());
+        }
+
+        GeometryParts parts;
+        readGeometry(feature.get("geometry"), parts);
+        addFeatures(readFeatureId(feature.get("id")), parts, readProperties(feature.get("properties")), features);
+    }
+
+    std::vector<std::shared_ptr<const massif::GeoJSONTileIndex::Feature>> readFeatureCollection(const picojson::value &featureCollection)
+    {
+        if (!featureCollection.is<picojson::object>() || !featureCollection.get("type").is<std::string>() || featureCollection.get("type").get<std::string>() != "FeatureCollection")
+        {
+            throw massif::ParseException("Expected GeoJSON FeatureCollection", featureCollection.serialize());
+        }
+
+        std::vector<std::shared_ptr<const massif::GeoJSONTileIndex::Feature>> features;
+        for (const picojson::value &feature : readArray(featureCollection.get("features")))
+        {
+            readFeature(feature, features);
+        }
+        return features;
+    }
+
+    picojson::value parseGeoJSON(const std::string &geoJSON)
+    {
+        picojson::value val;
+        std::string err = picojson::parse(val, geoJSON);
+        if (!err.empty())
+        {
+            throw massif::ParseException(std::string("GeoJSON parsing failed: ") + err, geoJSON);
+        }
+        return val;
+    }
+
+    std::vector<massif::MapPos> convertPoints(const std::shared_ptr<massif::Projection> &projection, const std::vector<massif::MapPos> &mapPoses)
+    {
+        std::vector<massif::MapPos> points;
         points.reserve(mapPoses.size());
         for (const massif::MapPos &mapPos : mapPoses)
         {
-            points.push_back(convertPoint(projection, mapPos));
+            points.push_back(projection ? projection->toWgs84(mapPos) : mapPos);
         }
         return points;
     }
 
-    std::vector<std::vector<massif::mbvtbuilder::MBVTTileBuilder::Point>> convertPointsList(const std::shared_ptr<massif::Projection> &projection, const std::vector<std::vector<massif::MapPos>> &mapPosesList)
+    std::vector<std::vector<massif::MapPos>> convertPointsList(const std::shared_ptr<massif::Projection> &projection, const std::vector<std::vector<massif::MapPos>> &mapPosesList)
     {
-        std::vector<std::vector<massif::mbvtbuilder::MBVTTileBuilder::Point>> pointsList;
+        std::vector<std::vector<massif::MapPos>> pointsList;
         pointsList.reserve(mapPosesList.size());
         for (const std::vector<massif::MapPos> &mapPoses : mapPosesList)
         {
@@ -56,7 +285,9 @@ namespace massif
 {
 
     GeoJSONVectorTileDataSource::GeoJSONVectorTileDataSource(int minZoom, int maxZoom) : TileDataSource(minZoom, maxZoom),
-                                                                                         _tileBuilder(std::make_unique<mbvtbuilder::MBVTTileBuilder>(minZoom, maxZoom)),
+                                                                                         _tileIndex(std::make_unique<GeoJSONTileIndex>(maxZoom)),
+                                                                                         _simplifyTolerance(1.0f),
+                                                                                         _defaultLayerBuffer(4.0f),
                                                                                          _mutex()
     {
     }
@@ -67,43 +298,34 @@ namespace massif
 
     float GeoJSONVectorTileDataSource::getSimplifyTolerance() const
     {
-        std::lock_guard<std::mutex> lock(_mutex);
-        return _tileBuilder->getSimplifyTolerance();
+        return _simplifyTolerance.load();
     }
 
     void GeoJSONVectorTileDataSource::setSimplifyTolerance(float tolerance)
     {
-        {
-            std::lock_guard<std::mutex> lock(_mutex);
-            _tileBuilder->setSimplifyTolerance(tolerance);
-        }
+        // Vertices are ranked when added, so the index stays valid for any tolerance
+        _simplifyTolerance.store(tolerance);
         notifyTilesChanged(false);
     }
 
     float GeoJSONVectorTileDataSource::getDefaultLayerBuffer() const
     {
         std::lock_guard<std::mutex> lock(_mutex);
-        return _tileBuilder->getDefaultLayerBuffer();
+        return _defaultLayerBuffer;
     }
 
     void GeoJSONVectorTileDataSource::setDefaultLayerBuffer(float buffer)
     {
         std::lock_guard<std::mutex> lock(_mutex);
-        _tileBuilder->setDefaultLayerBuffer(buffer);
+        _defaultLayerBuffer = buffer;
     }
 
     int GeoJSONVectorTileDataSource::createLayer(const std::string &name)
     {
         int layerIndex = -1;
-        try
         {
             std::lock_guard<std::mutex> lock(_mutex);
-            layerIndex = _tileBuilder->createLayer(name);
-        }
-        catch (const std::exception &ex)
-        {
-            Log::Errorf("GeoJSONVectorTileDataSource::createLayer: Failed to create layer: %s", ex.what());
-            throw GenericException("Failed to create layer", ex.what());
+            layerIndex = _tileIndex->createLayer(name, _defaultLayerBuffer);
         }
         notifyTilesChanged(false);
         return layerIndex;
@@ -113,9 +335,10 @@ namespace massif
     {
         try
         {
+            // Parsed and projected before locking, only the index update is serialized
+            std::vector<std::shared_ptr<const GeoJSONTileIndex::Feature>> features = readFeatureCollection(geoJSON.toPicoJSON());
             std::lock_guard<std::mutex> lock(_mutex);
-            _tileBuilder->clearLayer(layerIndex);
-            _tileBuilder->importGeoJSONFeatureCollection(layerIndex, geoJSON.toPicoJSON());
+            _tileIndex->setLayerFeatures(layerIndex, _defaultLayerBuffer, features);
         }
         catch (const std::exception &ex)
         {
@@ -129,8 +352,10 @@ namespace massif
     {
         try
         {
+            std::vector<std::shared_ptr<const GeoJSONTileIndex::Feature>> features;
+            readFeature(geoJSON.toPicoJSON(), features);
             std::lock_guard<std::mutex> lock(_mutex);
-            _tileBuilder->importGeoJSONFeature(layerIndex, geoJSON.toPicoJSON(), false);
+            _tileIndex->addFeatures(layerIndex, _defaultLayerBuffer, features, false);
         }
         catch (const std::exception &ex)
         {
@@ -144,8 +369,10 @@ namespace massif
     {
         try
         {
+            std::vector<std::shared_ptr<const GeoJSONTileIndex::Feature>> features;
+            readFeature(geoJSON.toPicoJSON(), features);
             std::lock_guard<std::mutex> lock(_mutex);
-            _tileBuilder->importGeoJSONFeature(layerIndex, geoJSON.toPicoJSON(), true);
+            _tileIndex->addFeatures(layerIndex, _defaultLayerBuffer, features, true);
         }
         catch (const std::exception &ex)
         {
@@ -159,15 +386,9 @@ namespace massif
     {
         try
         {
-            picojson::value val;
-            std::string err = picojson::parse(val, geoJSON);
-            if (!err.empty())
-            {
-                throw ParseException(std::string("GeoJSON parsing failed: ") + err, geoJSON);
-            }
+            std::vector<std::shared_ptr<const GeoJSONTileIndex::Feature>> features = readFeatureCollection(parseGeoJSON(geoJSON));
             std::lock_guard<std::mutex> lock(_mutex);
-            _tileBuilder->clearLayer(layerIndex);
-            _tileBuilder->importGeoJSONFeatureCollection(layerIndex, val);
+            _tileIndex->setLayerFeatures(layerIndex, _defaultLayerBuffer, features);
         }
         catch (const std::exception &ex)
         {
@@ -181,14 +402,10 @@ namespace massif
     {
         try
         {
-            picojson::value val;
-            std::string err = picojson::parse(val, geoJSON);
-            if (!err.empty())
-            {
-                throw ParseException(std::string("GeoJSON parsing failed: ") + err, geoJSON);
-            }
+            std::vector<std::shared_ptr<const GeoJSONTileIndex::Feature>> features;
+            readFeature(parseGeoJSON(geoJSON), features);
             std::lock_guard<std::mutex> lock(_mutex);
-            _tileBuilder->importGeoJSONFeature(layerIndex, val, false);
+            _tileIndex->addFeatures(layerIndex, _defaultLayerBuffer, features, false);
         }
         catch (const std::exception &ex)
         {
@@ -202,14 +419,10 @@ namespace massif
     {
         try
         {
-            picojson::value val;
-            std::string err = picojson::parse(val, geoJSON);
-            if (!err.empty())
-            {
-                throw ParseException(std::string("GeoJSON parsing failed: ") + err, geoJSON);
-            }
+            std::vector<std::shared_ptr<const GeoJSONTileIndex::Feature>> features;
+            readFeature(parseGeoJSON(geoJSON), features);
             std::lock_guard<std::mutex> lock(_mutex);
-            _tileBuilder->importGeoJSONFeature(layerIndex, val, true);
+            _tileIndex->addFeatures(layerIndex, _defaultLayerBuffer, features, true);
         }
         catch (const std::exception &ex)
         {
@@ -223,21 +436,13 @@ namespace massif
     {
         try
         {
-            std::lock_guard<std::mutex> lock(_mutex);
-                picojson::value idValue = id.toPicoJSON();
-                std::uint64_t idInt;
-            if (idValue.is<std::int64_t>())
+            std::optional<std::uint64_t> featureId = readFeatureId(id.toPicoJSON());
+            if (!featureId)
             {
-                idInt =  idValue.get<std::int64_t>();
-            }
-            else if (idValue.is<std::string>())
-            {
-                idInt = std::hash<std::string>()(idValue.get<std::string>());
-            } else {
                 throw ParseException(std::string("removeGeoJSONFeature failed: id must be a string or a number Variant"));
-
             }
-            _tileBuilder->removeGeoJSONFeature(layerIndex, idInt);
+            std::lock_guard<std::mutex> lock(_mutex);
+            _tileIndex->removeFeatures(layerIndex, *featureId);
         }
         catch (const std::exception &ex)
         {
@@ -256,66 +461,57 @@ namespace massif
 
         try
         {
-            std::lock_guard<std::mutex> lock(_mutex);
-            _tileBuilder->clearLayer(layerIndex);
+            std::vector<std::shared_ptr<const GeoJSONTileIndex::Feature>> features;
             for (int n = 0; n < featureCollection->getFeatureCount(); n++)
             {
                 const std::shared_ptr<Feature> &feature = featureCollection->getFeature(n);
                 const std::shared_ptr<Geometry> &geometry = feature->getGeometry();
-                // Feature does not have a id member like GeoJSON specs so i cant pass it here
-                picojson::value id;
-                picojson::value properties = feature->getProperties().toPicoJSON();
+                GeometryParts parts;
 
                 if (auto point = std::dynamic_pointer_cast<PointGeometry>(geometry))
                 {
-                    mbvtbuilder::MBVTTileBuilder::MultiPoint points = {convertPoint(projection, point->getPos())};
-                    _tileBuilder->addMultiPoint(layerIndex, std::move(points), id, std::move(properties), false);
+                    parts.points = convertPoints(projection, {point->getPos()});
                 }
                 else if (auto line = std::dynamic_pointer_cast<LineGeometry>(geometry))
                 {
-                    mbvtbuilder::MBVTTileBuilder::MultiLineString lines = {convertPoints(projection, line->getPoses())};
-                    _tileBuilder->addMultiLineString(layerIndex, std::move(lines), id, std::move(properties), false);
+                    parts.lines.push_back(convertPoints(projection, line->getPoses()));
                 }
                 else if (auto polygon = std::dynamic_pointer_cast<PolygonGeometry>(geometry))
                 {
-                    mbvtbuilder::MBVTTileBuilder::MultiPolygon polygons = {convertPointsList(projection, polygon->getRings())};
-                    _tileBuilder->addMultiPolygon(layerIndex, std::move(polygons), id, std::move(properties), false);
+                    parts.polygons.push_back(convertPointsList(projection, polygon->getRings()));
                 }
                 else if (auto multiPoint = std::dynamic_pointer_cast<MultiPointGeometry>(geometry))
                 {
-                    mbvtbuilder::MBVTTileBuilder::MultiPoint points;
-                    points.reserve(multiPoint->getGeometryCount());
                     for (int i = 0; i < multiPoint->getGeometryCount(); i++)
                     {
-                        points.push_back(convertPoint(projection, multiPoint->getGeometry(i)->getPos()));
+                        parts.points.push_back(convertPoints(projection, {multiPoint->getGeometry(i)->getPos()}).front());
                     }
-                    _tileBuilder->addMultiPoint(layerIndex, std::move(points), id, std::move(properties), false);
                 }
                 else if (auto multiLine = std::dynamic_pointer_cast<MultiLineGeometry>(geometry))
                 {
-                    mbvtbuilder::MBVTTileBuilder::MultiLineString lines;
-                    lines.reserve(multiLine->getGeometryCount());
                     for (int i = 0; i < multiLine->getGeometryCount(); i++)
                     {
-                        lines.push_back(convertPoints(projection, multiLine->getGeometry(i)->getPoses()));
+                        parts.lines.push_back(convertPoints(projection, multiLine->getGeometry(i)->getPoses()));
                     }
-                    _tileBuilder->addMultiLineString(layerIndex, std::move(lines), id, std::move(properties), false);
                 }
                 else if (auto multiPolygon = std::dynamic_pointer_cast<MultiPolygonGeometry>(geometry))
                 {
-                    mbvtbuilder::MBVTTileBuilder::MultiPolygon polygons;
-                    polygons.reserve(multiPolygon->getGeometryCount());
                     for (int i = 0; i < multiPolygon->getGeometryCount(); i++)
                     {
-                        polygons.push_back(convertPointsList(projection, multiPolygon->getGeometry(i)->getRings()));
+                        parts.polygons.push_back(convertPointsList(projection, multiPolygon->getGeometry(i)->getRings()));
                     }
-                    _tileBuilder->addMultiPolygon(layerIndex, std::move(polygons), id, std::move(properties), false);
                 }
                 else
                 {
                     throw InvalidArgumentException("Unsupported geometry type in feature collection");
                 }
+
+                // Feature does not have a id member like GeoJSON specs so i cant pass it here
+                addFeatures(std::optional<std::uint64_t>(), parts, readProperties(feature->getProperties().toPicoJSON()), features);
             }
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            _tileIndex->setLayerFeatures(layerIndex, _defaultLayerBuffer, features);
         }
         catch (const std::exception &ex)
         {
@@ -327,42 +523,28 @@ namespace massif
 
     void GeoJSONVectorTileDataSource::deleteLayer(int layerIndex)
     {
-        try
         {
             std::lock_guard<std::mutex> lock(_mutex);
-            _tileBuilder->deleteLayer(layerIndex);
-        }
-        catch (const std::exception &ex)
-        {
-            Log::Errorf("GeoJSONVectorTileDataSource::deleteLayer: Failed to delete layer: %s", ex.what());
+            _tileIndex->deleteLayer(layerIndex);
         }
         notifyTilesChanged(false);
     }
 
     MapBounds GeoJSONVectorTileDataSource::getDataExtent() const
     {
-        std::lock_guard<std::mutex> lock(_mutex);
-        MapBounds mapBounds;
-        for (int layerIndex : _tileBuilder->getLayerIndices())
-        {
-            // NOTE: layerBounds are flipped
-            auto layerBounds = _tileBuilder->getLayerBounds(layerIndex);
-            mapBounds.expandToContain(MapPos(layerBounds.min(0), -layerBounds.max(1)));
-            mapBounds.expandToContain(MapPos(layerBounds.max(0), -layerBounds.min(1)));
-        }
-        return mapBounds;
+        return _tileIndex->getSnapshot()->getBounds();
     }
 
     std::shared_ptr<TileData> GeoJSONVectorTileDataSource::loadTile(const MapTile &mapTile)
     {
-        std::lock_guard<std::mutex> lock(_mutex);
-        Log::Infof("GeoJSONVectorTileDataSource::loadTile: Loading %s", mapTile.toString().c_str());
+        LOG_INFOF("GeoJSONVectorTileDataSource::loadTile: Loading %s", mapTile.toString().c_str());
         try
         {
-            protobuf::encoded_message encodedTile;
-            _tileBuilder->buildTile(mapTile.getZoom(), mapTile.getX(), mapTile.getY(), encodedTile);
-            auto data = std::make_shared<BinaryData>(reinterpret_cast<const unsigned char *>(encodedTile.data().data()), encodedTile.data().size());
-            return std::make_shared<TileData>(data);
+            // No lock: the snapshot is immutable, and edits publish a new one
+            std::shared_ptr<const GeoJSONTileIndex::Snapshot> snapshot = _tileIndex->getSnapshot();
+            auto tileData = std::make_shared<TileData>(std::make_shared<BinaryData>());
+            tileData->setNativeTile(snapshot->buildTile(mapTile.getZoom(), mapTile.getX(), mapTile.getY(), _simplifyTolerance.load()));
+            return tileData;
         }
         catch (const std::exception &ex)
         {
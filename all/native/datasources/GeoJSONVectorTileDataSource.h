@@ -10,20 +10,20 @@
 #include "core/Variant.h"
 #include "datasources/TileDataSource.h"
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <string>
 
 namespace massif {
-    namespace mbvtbuilder {
-        class MBVTTileBuilder;
-    }
-
+    class GeoJSONTileIndex;
     class Projection;
     class FeatureCollection;
     
     /**
      * A tile data source that builds vector tiles from GeoJSON inputs.
+     * Features are kept in a tile index that is clipped and simplified ahead of time, so tiles are
+     * built from it concurrently and without locking, and edits only rebuild the tiles they touch.
      */
     class GeoJSONVectorTileDataSource : public TileDataSource {
     public:
@@ -142,8 +142,10 @@ namespace massif {
         virtual std::shared_ptr<TileData> loadTile(const MapTile& mapTile);
     
     private:
-        std::unique_ptr<mbvtbuilder::MBVTTileBuilder> _tileBuilder;
-        mutable std::mutex _mutex;
+        const std::unique_ptr<GeoJSONTileIndex> _tileIndex;
+        std::atomic<float> _simplifyTolerance;
+        float _defaultLayerBuffer;
+        mutable std::mutex _mutex; // serializes edits, tiles are loaded from index snapshots
     };
     
 }
@@ -9,6 +9,7 @@
 
 #include <cinttypes>
 #include <algorithm>
+#include <condition_variable>
 
 namespace massif {
 
@@ -20,10 +21,12 @@ namespace massif {
         _maxAgeHeaderCheck(false),
         _timeout(-1),
         _headers(),
+        _rangeGapTolerance(DEFAULT_RANGE_GAP_TOLERANCE),
         _httpClient(true),
         _randomGenerator(),
         _mutex(),
-        _pmtilesCache()
+        _pmtilesCache(),
+        _pendingTiles()
     {
     }
     
@@ -108,55 +111,220 @@ namespace massif {
         notifyTilesChanged(false);
     }
     
+    int HTTPTileDataSource::getRangeGapTolerance() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _rangeGapTolerance;
+    }
+
+    void HTTPTileDataSource::setRangeGapTolerance(int bytes) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _rangeGapTolerance = std::max(0, bytes);
+    }
+
+    bool HTTPTileDataSource::isBatchLoadSupported() const {
+        // PMTiles batches coalesce range requests. Plain tile batches pay off only if the client downloads them concurrently,
+        // a synchronous client would fetch the whole batch serially while the per-tile loads wait for it.
+        return isPMTilesURL(getBaseURL()) || _httpClient.isAsyncSupported();
+    }
+
+    std::vector<std::shared_ptr<TileData> > HTTPTileDataSource::loadTiles(const std::vector<MapTile>& mapTiles) {
+        std::string baseURL = getBaseURL();
+        if (mapTiles.size() < 2) {
+            return TileDataSource::loadTiles(mapTiles);
+        }
+        if (isPMTilesURL(baseURL)) {
+            return loadPMTiles(baseURL, mapTiles);
+        }
+        return loadHTTPTiles(baseURL, mapTiles);
+    }
+
     std::shared_ptr<TileData> HTTPTileDataSource::loadTile(const MapTile& mapTile) {
-        std::string baseURL;
+        std::string baseURL = getBaseURL();
+
+        // Check if this is a PMTiles URL
+        if (isPMTilesURL(baseURL)) {
+            auto tileData = loadPMTile(baseURL, mapTile);
+            applyTileMetadata(tileData, mapTile);
+            return tileData;
+        }
+
+        // If the tile is part of a batch that is currently being fetched, wait for it instead of requesting it again
+        std::shared_future<std::shared_ptr<TileData> > pendingTile = findPendingTile(mapTile);
+        if (pendingTile.valid()) {
+            return pendingTile.get();
+        }
+        return loadHTTPTile(baseURL, mapTile, std::shared_ptr<TileData>());
+    }
+
+    std::shared_ptr<TileData> HTTPTileDataSource::revalidateTile(const MapTile& mapTile, const std::shared_ptr<TileData>& expiredTileData) {
+        std::string baseURL = getBaseURL();
+        if (isPMTilesURL(baseURL) || !expiredTileData || !expiredTileData->getData()) {
+            return loadTile(mapTile);
+        }
+        return loadHTTPTile(baseURL, mapTile, expiredTileData);
+    }
+    
+    std::shared_ptr<TileData> HTTPTileDataSource::loadHTTPTile(const std::string& baseURL, const MapTile& mapTile, const std::shared_ptr<TileData>& expiredTileData) {
         std::map<std::string, std::string> headers;
         bool maxAgeHeaderCheck;
         {
             std::lock_guard<std::mutex> lock(_mutex);
-            baseURL = _baseURL;
             headers = _headers;
             maxAgeHeaderCheck = _maxAgeHeaderCheck;
         }
 
-        std::shared_ptr<TileData> tileData;
-        // Check if this is a PMTiles URL
-        if (isPMTilesURL(baseURL)) {
-            auto tileData = loadPMTile(baseURL, mapTile);
-            applyTileMetadata(tileData, mapTile);
-            return tileData;
-        } else {
+        std::string url = buildTileURL(baseURL, mapTile);
+        if (url.empty()) {
+            return std::shared_ptr<TileData>();
+        }
 
-            std::string url = buildTileURL(baseURL, mapTile);
-            if (url.empty()) {
+        // With validators from the expired copy the server can answer 304 instead of sending the tile again
+        std::string entityTag = expiredTileData ? expiredTileData->getEntityTag() : std::string();
+        std::string lastModified = expiredTileData ? expiredTileData->getLastModified() : std::string();
+        if (!entityTag.empty()) {
+            headers["If-None-Match"] = entityTag;
+        }
+        if (!lastModified.empty()) {
+            headers["If-Modified-Since"] = lastModified;
+        }
+
+        LOG_INFOF("HTTPTileDataSource::loadTile: Loading %s", url.c_str());
+        std::map<std::string, std::string> responseHeaders;
+        std::shared_ptr<BinaryData> responseData;
+        int statusCode = -1;
+        try {
+            if (_httpClient.get(url, headers, responseHeaders, responseData, &statusCode) != 0) {
+                Log::Errorf("HTTPTileDataSource::loadTile: Failed to load %s", url.c_str());
                 return std::shared_ptr<TileData>();
             }
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("HTTPTileDataSource::loadTile: Exception while loading tile %d/%d/%d: %s", mapTile.getZoom(), mapTile.getX(), mapTile.getY(), ex.what());
+            return std::shared_ptr<TileData>();
+        }
 
-            Log::Infof("HTTPTileDataSource::loadTile: Loading %s", url.c_str());
-            std::map<std::string, std::string> responseHeaders;
-            std::shared_ptr<BinaryData> responseData;
-            try {
-                if (_httpClient.get(url, headers, responseHeaders, responseData) != 0) {
-                    Log::Errorf("HTTPTileDataSource::loadTile: Failed to load %s", url.c_str());
-                    return std::shared_ptr<TileData>();
+        return createHTTPTileData(mapTile, url, statusCode, responseHeaders, responseData, expiredTileData, maxAgeHeaderCheck);
+    }
+
+    std::vector<std::shared_ptr<TileData> > HTTPTileDataSource::loadHTTPTiles(const std::string& baseURL, const std::vector<MapTile>& mapTiles) {
+        struct TileResponse {
+            std::string url;
+            int code = -1;
+            int statusCode = -1;
+            std::map<std::string, std::string> headers;
+            std::shared_ptr<BinaryData> data;
+        };
+
+        std::vector<std::shared_ptr<TileData> > tileDatas(mapTiles.size());
+
+        PendingTileBatch batch(*this, mapTiles);
+        const std::vector<std::size_t>& ownIndices = batch.getOwnIndices();
+        std::map<std::string, std::string> headers;
+        bool maxAgeHeaderCheck;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            headers = _headers;
+            maxAgeHeaderCheck = _maxAgeHeaderCheck;
+        }
+
+        // Issue all requests at once. The client multiplexes them over its connection pool,
+        // so this thread only waits once for the whole batch instead of once per tile.
+        std::vector<TileResponse> responses(ownIndices.size());
+        std::size_t remainingCount = ownIndices.size();
+        std::mutex responseMutex;
+        std::condition_variable responseCondition;
+        std::size_t issuedCount = 0;
+        try {
+            for (; issuedCount < ownIndices.size(); issuedCount++) {
+                std::size_t k = issuedCount;
+                responses[k].url = buildTileURL(baseURL, mapTiles[ownIndices[k]]);
+                if (responses[k].url.empty()) {
+                    std::lock_guard<std::mutex> lock(responseMutex);
+                    remainingCount--;
+                    continue;
                 }
+
+                LOG_INFOF("HTTPTileDataSource::loadTiles: Loading %s", responses[k].url.c_str());
+                _httpClient.getAsync(responses[k].url, headers, [&, k](int code, int statusCode, const std::map<std::string, std::string>& responseHeaders, const std::shared_ptr<BinaryData>& responseData) {
+                    std::lock_guard<std::mutex> lock(responseMutex);
+                    responses[k].code = code;
+                    responses[k].statusCode = statusCode;
+                    responses[k].headers = responseHeaders;
+                    responses[k].data = responseData;
+                    if (--remainingCount == 0) {
+                        responseCondition.notify_all();
+                    }
+                });
             }
-            catch (const std::exception& ex) {
-                Log::Errorf("HTTPTileDataSource::loadTile: Exception while loading tile %d/%d/%d: %s", mapTile.getZoom(), mapTile.getX(), mapTile.getY(), ex.what());
-                return std::shared_ptr<TileData>();
+        }
+        catch (const std::exception& ex) {
+            // The requests already issued write to this frame, so they are still waited for
+            Log::Errorf("HTTPTileDataSource::loadTiles: Failed to issue requests: %s", ex.what());
+            std::lock_guard<std::mutex> lock(responseMutex);
+            for (std::size_t k = issuedCount; k < ownIndices.size(); k++) {
+                responses[k].url.clear();
             }
-            auto tileData = std::make_shared<TileData>(responseData);
-            if (maxAgeHeaderCheck) {
-                int maxAge = NetworkUtils::GetMaxAgeHTTPHeader(responseHeaders);
-                if (maxAge >= 0) {
-                    tileData->setMaxAge(maxAge * 1000);
-                }
+            remainingCount -= ownIndices.size() - issuedCount;
+        }
+        {
+            std::unique_lock<std::mutex> lock(responseMutex);
+            responseCondition.wait(lock, [&remainingCount]() { return remainingCount == 0; });
+        }
+
+        for (std::size_t k = 0; k < ownIndices.size(); k++) {
+            const TileResponse& response = responses[k];
+            if (response.url.empty()) {
+                continue;
             }
-            applyTileMetadata(tileData, mapTile);
-            return tileData;
+            if (response.code != 0) {
+                Log::Errorf("HTTPTileDataSource::loadTiles: Failed to load %s", response.url.c_str());
+                continue;
+            }
+            tileDatas[ownIndices[k]] = createHTTPTileData(mapTiles[ownIndices[k]], response.url, response.statusCode, response.headers, response.data, std::shared_ptr<TileData>(), maxAgeHeaderCheck);
         }
+
+        batch.complete(tileDatas);
+        return tileDatas;
+    }
+
+    std::shared_ptr<TileData> HTTPTileDataSource::createHTTPTileData(const MapTile& mapTile, const std::string& url, int statusCode, const std::map<std::string, std::string>& responseHeaders, const std::shared_ptr<BinaryData>& responseData, const std::shared_ptr<TileData>& expiredTileData, bool maxAgeHeaderCheck) const {
+        std::string entityTag = expiredTileData ? expiredTileData->getEntityTag() : std::string();
+        std::string lastModified = expiredTileData ? expiredTileData->getLastModified() : std::string();
+
+        std::shared_ptr<TileData> tileData;
+        std::string responseEntityTag = NetworkUtils::GetHTTPHeader(responseHeaders, "ETag");
+        std::string responseLastModified = NetworkUtils::GetHTTPHeader(responseHeaders, "Last-Modified");
+        if (statusCode == 304 && expiredTileData) {
+            // Keep the cached bytes. A 304 may carry updated validators, otherwise the old ones stay valid
+            LOG_INFOF("HTTPTileDataSource::loadTile: Not modified %s", url.c_str());
+            tileData = std::make_shared<TileData>(expiredTileData->getData());
+            tileData->setEntityTag(responseEntityTag.empty() ? entityTag : responseEntityTag);
+            tileData->setLastModified(responseLastModified.empty() ? lastModified : responseLastModified);
+        } else {
+            tileData = std::make_shared<TileData>(responseData);
+            tileData->setEntityTag(responseEntityTag);
+            tileData->setLastModified(responseLastModified);
+        }
+
+        if (maxAgeHeaderCheck) {
+            int maxAge = NetworkUtils::GetMaxAgeHTTPHeader(responseHeaders);
+            if (maxAge >= 0) {
+                tileData->setMaxAge(maxAge * 1000);
+            }
+        }
+        applyTileMetadata(tileData, mapTile);
+        return tileData;
     }
     
+    std::shared_future<std::shared_ptr<TileData> > HTTPTileDataSource::findPendingTile(const MapTile& mapTile) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _pendingTiles.find(mapTile.getTileId());
+        if (it != _pendingTiles.end()) {
+            return it->second;
+        }
+        return std::shared_future<std::shared_ptr<TileData> >();
+    }
+
     std::string HTTPTileDataSource::buildTileURL(const std::string& baseURL, const MapTile& tile) const {
         bool tmsScheme = false;
         std::string subdomain;
@@ -205,103 +373,19 @@ namespace massif {
     }
     
     std::shared_ptr<TileData> HTTPTileDataSource::loadPMTile(const std::string& baseURL, const MapTile& mapTile) {
+        // If the tile is part of a batch that is currently being fetched, wait for it instead of requesting it again
+        std::shared_future<std::shared_ptr<TileData> > pendingTile = findPendingTile(mapTile);
+        if (pendingTile.valid()) {
+            return pendingTile.get();
+        }
+
         try {
             std::string url = normalizePMTilesURL(baseURL);
             
-            // Initialize PMTiles cache if needed (with mutex protection)
-            {
-                std::unique_lock<std::mutex> lock(_mutex);
-                if (!_pmtilesCache || _pmtilesCache->url != url) {
-                    Log::Infof("HTTPTileDataSource::loadPMTile: Initializing PMTiles archive from %s", url.c_str());
-                    
-                    // Create a new cache object
-                    auto newCache = std::make_unique<PMTilesCache>();
-                    newCache->url = url;
-                    
-                    // Unlock during HTTP requests to allow parallel tile fetches
-                    lock.unlock();
-                    
-                    // Read header
-                    newCache->header = readPMTilesHeader(url);
-                    
-                    // Read and decode root directory
-                    std::vector<uint8_t> rootDirData = httpRangeRequest(url, newCache->header.rootDirectoryOffset, newCache->header.rootDirectoryLength);
-                    std::vector<uint8_t> decompressed = pmtiles::decompressData(rootDirData, newCache->header.internalCompression);
-                    newCache->rootDirectory = pmtiles::decodeDirectory(decompressed);
-                    
-                    // Re-lock and update cache atomically
-                    lock.lock();
-                    // Check again in case another thread initialized it while we were unlocked
-                    if (!_pmtilesCache || _pmtilesCache->url != url) {
-                        _pmtilesCache = std::move(newCache);
-                        Log::Infof("HTTPTileDataSource::loadPMTile: PMTiles header loaded, tiles: %" PRIu64 ", zoom: %d-%d", 
-                                   _pmtilesCache->header.numTileEntries, _pmtilesCache->header.minZoom, _pmtilesCache->header.maxZoom);
-                    }
-                }
-            }
-            
-            // Convert tile coordinates to PMTiles TileID
-            uint64_t tileId = pmtiles::zxyToTileId(mapTile.getZoom(), mapTile.getX(), mapTile.getY());
-            
-            // Search for tile in cache (with mutex protection)
             pmtiles::DirectoryEntry entry;
-            bool found = false;
             pmtiles::Header header;
-            
-            {
-                std::unique_lock<std::mutex> lock(_mutex);
-                
-                // Search for tile in root directory
-                found = pmtiles::findTileEntry(_pmtilesCache->rootDirectory, tileId, entry);
-                
-                // If not found in root, search in leaf directories
-                if (!found) {
-                    // Binary search in root directory to find the leaf directory
-                    auto it = std::lower_bound(_pmtilesCache->rootDirectory.begin(), _pmtilesCache->rootDirectory.end(), tileId,
-                        [](const pmtiles::DirectoryEntry& entry, uint64_t id) { return entry.tileId < id; });
-                    
-                    if (it != _pmtilesCache->rootDirectory.begin()) {
-                        --it;
-                        
-                        // Check if this points to a leaf directory
-                        if (it->runLength == 0) {
-                            // Check if leaf directory is cached
-                            uint64_t leafKey = it->offset;
-                            auto leafIt = _pmtilesCache->leafDirectoryCache.find(leafKey);
-                            if (leafIt == _pmtilesCache->leafDirectoryCache.end()) {
-                                // Need to load leaf directory - unlock during HTTP request
-                                uint64_t leafOffset = it->offset;
-                                uint32_t leafLength = it->length;
-                                header = _pmtilesCache->header;
-                                
-                                lock.unlock();
-                                std::vector<pmtiles::DirectoryEntry> leafDir = loadPMTilesLeafDirectory(url, header, leafOffset, leafLength);
-                                lock.lock();
-
-                                // Insert into cache (might already be there if another thread loaded it)
-                                leafIt = _pmtilesCache->leafDirectoryCache.insert({leafKey, std::move(leafDir)}).first;
-                            }
-                            
-                            found = pmtiles::findTileEntry(leafIt->second, tileId, entry);
-                        }
-                    }
-                }
-                
-                // Copy header for use outside the lock
-                header = _pmtilesCache->header;
-            }
-            
-            if (!found) {
-                // Tile not found, try parent tile
-                if (mapTile.getZoom() > getMinZoom()) {
-                    Log::Infof("HTTPTileDataSource::loadPMTile: Tile not found, redirecting to parent");
-                    auto tileData = std::make_shared<TileData>(std::shared_ptr<BinaryData>());
-                    tileData->setReplaceWithParent(true);
-                    return tileData;
-                } else {
-                    Log::Infof("HTTPTileDataSource::loadPMTile: Tile not found");
-                    return std::shared_ptr<TileData>();
-                }
+            if (!findPMTileEntry(url, mapTile, entry, header)) {
+                return createMissingPMTile(mapTile);
             }
             
             // Read tile data (without mutex - independent HTTP request)
@@ -311,7 +395,7 @@ namespace massif {
             // Decompress if needed
             std::vector<uint8_t> tileBytes = pmtiles::decompressData(compressedData, header.tileCompression);
             
-            auto data = std::make_shared<BinaryData>(tileBytes.data(), tileBytes.size());
+            auto data = std::make_shared<BinaryData>(std::move(tileBytes));
             return std::make_shared<TileData>(data);
         }
         catch (const std::exception& ex) {
@@ -319,6 +403,173 @@ namespace massif {
             return std::shared_ptr<TileData>();
         }
     }
+
+    std::vector<std::shared_ptr<TileData> > HTTPTileDataSource::loadPMTiles(const std::string& baseURL, const std::vector<MapTile>& mapTiles) {
+        struct RangeTile {
+            std::size_t index;
+            pmtiles::DirectoryEntry entry;
+        };
+
+        std::vector<std::shared_ptr<TileData> > tileDatas(mapTiles.size());
+
+        // Tiles already pending in another batch are simply waited for at the end
+        PendingTileBatch batch(*this, mapTiles);
+        const std::vector<std::size_t>& ownIndices = batch.getOwnIndices();
+
+        std::string url = normalizePMTilesURL(baseURL);
+        pmtiles::Header header;
+        std::vector<RangeTile> rangeTiles;
+        for (std::size_t index : ownIndices) {
+            try {
+                RangeTile rangeTile;
+                rangeTile.index = index;
+                if (findPMTileEntry(url, mapTiles[index], rangeTile.entry, header)) {
+                    rangeTiles.push_back(rangeTile);
+                } else {
+                    tileDatas[index] = createMissingPMTile(mapTiles[index]);
+                }
+            }
+            catch (const std::exception& ex) {
+                Log::Errorf("HTTPTileDataSource::loadPMTiles: Failed to find tile: %s", ex.what());
+            }
+        }
+
+        // Tiles that are next to each other in the archive (PMTiles clusters them along the Hilbert curve)
+        // are fetched with a single range request, tolerating small gaps of unneeded bytes between them.
+        std::sort(rangeTiles.begin(), rangeTiles.end(), [](const RangeTile& rangeTile1, const RangeTile& rangeTile2) {
+            return rangeTile1.entry.offset < rangeTile2.entry.offset;
+        });
+        uint64_t gapTolerance = static_cast<uint64_t>(getRangeGapTolerance());
+        for (std::size_t i = 0; i < rangeTiles.size(); ) {
+            uint64_t rangeStart = rangeTiles[i].entry.offset;
+            uint64_t rangeEnd = rangeStart + rangeTiles[i].entry.length;
+            std::size_t j = i + 1;
+            while (j < rangeTiles.size()) {
+                const pmtiles::DirectoryEntry& entry = rangeTiles[j].entry;
+                uint64_t entryEnd = std::max(rangeEnd, entry.offset + entry.length);
+                if (entry.offset > rangeEnd + gapTolerance || entryEnd - rangeStart > MAX_COALESCED_RANGE_SIZE) {
+                    break;
+                }
+                rangeEnd = entryEnd;
+                j++;
+            }
+
+            try {
+                std::vector<uint8_t> rangeData = httpRangeRequest(url, header.tileDataOffset + rangeStart, rangeEnd - rangeStart);
+                for (std::size_t k = i; k < j; k++) {
+                    const pmtiles::DirectoryEntry& entry = rangeTiles[k].entry;
+                    uint64_t offset = entry.offset - rangeStart;
+                    if (offset + entry.length > rangeData.size()) {
+                        Log::Errorf("HTTPTileDataSource::loadPMTiles: Truncated range response for tile %s", mapTiles[rangeTiles[k].index].toString().c_str());
+                        continue;
+                    }
+                    try {
+                        std::vector<uint8_t> tileBytes = pmtiles::decompressData(rangeData.data() + offset, entry.length, header.tileCompression);
+                        tileDatas[rangeTiles[k].index] = std::make_shared<TileData>(std::make_shared<BinaryData>(std::move(tileBytes)));
+                    }
+                    catch (const std::exception& ex) {
+                        Log::Errorf("HTTPTileDataSource::loadPMTiles: Failed to decompress tile: %s", ex.what());
+                    }
+                }
+            }
+            catch (const std::exception& ex) {
+                Log::Errorf("HTTPTileDataSource::loadPMTiles: Failed to load tile range: %s", ex.what());
+            }
+            i = j;
+        }
+
+        for (std::size_t index : ownIndices) {
+            applyTileMetadata(tileDatas[index], mapTiles[index]);
+        }
+
+        batch.complete(tileDatas);
+        return tileDatas;
+    }
+
+    bool HTTPTileDataSource::findPMTileEntry(const std::string& url, const MapTile& mapTile, pmtiles::DirectoryEntry& entry, pmtiles::Header& header) {
+        // Initialize PMTiles cache if needed (with mutex protection)
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (!_pmtilesCache || _pmtilesCache->url != url) {
+                LOG_INFOF("HTTPTileDataSource::loadPMTile: Initializing PMTiles archive from %s", url.c_str());
+                
+                // Create a new cache object
+                auto newCache = std::make_unique<PMTilesCache>();
+                newCache->url = url;
+                
+                // Unlock during HTTP requests to allow parallel tile fetches
+                lock.unlock();
+                
+                // Read header
+                newCache->header = readPMTilesHeader(url);
+                
+                // Read and decode root directory
+                std::vector<uint8_t> rootDirData = httpRangeRequest(url, newCache->header.rootDirectoryOffset, newCache->header.rootDirectoryLength);
+                std::vector<uint8_t> decompressed = pmtiles::decompressData(rootDirData, newCache->header.internalCompression);
+                newCache->rootDirectory = pmtiles::decodeDirectory(decompressed);
+                
+                // Re-lock and update cache atomically
+                lock.lock();
+                // Check again in case another thread initialized it while we were unlocked
+                if (!_pmtilesCache || _pmtilesCache->url != url) {
+                    _pmtilesCache = std::move(newCache);
+                    LOG_INFOF("HTTPTileDataSource::loadPMTile: PMTiles header loaded, tiles: %" PRIu64 ", zoom: %d-%d", 
+                               _pmtilesCache->header.numTileEntries, _pmtilesCache->header.minZoom, _pmtilesCache->header.maxZoom);
+                }
+            }
+        }
+        
+        // Convert tile coordinates to PMTiles TileID
+        uint64_t tileId = pmtiles::zxyToTileId(mapTile.getZoom(), mapTile.getX(), mapTile.getY());
+        
+        // Search for tile in cache (with mutex protection)
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (!_pmtilesCache || _pmtilesCache->url != url) {
+            return false; // URL changed meanwhile
+        }
+        header = _pmtilesCache->header;
+        
+        const pmtiles::DirectoryEntry* rootEntry = pmtiles::findEntry(_pmtilesCache->rootDirectory, tileId);
+        if (!rootEntry) {
+            return false;
+        }
+        if (rootEntry->runLength > 0) {
+            entry = *rootEntry;
+            return true;
+        }
+
+        // The root entry points to a leaf directory. Check if it is cached
+        uint64_t leafKey = rootEntry->offset;
+        auto leafIt = _pmtilesCache->leafDirectoryCache.find(leafKey);
+        if (leafIt == _pmtilesCache->leafDirectoryCache.end()) {
+            // Need to load leaf directory - unlock during HTTP request
+            uint32_t leafLength = rootEntry->length;
+            
+            lock.unlock();
+            std::vector<pmtiles::DirectoryEntry> leafDir = loadPMTilesLeafDirectory(url, header, leafKey, leafLength);
+            lock.lock();
+
+            if (!_pmtilesCache || _pmtilesCache->url != url) {
+                return false; // URL changed meanwhile
+            }
+            // Insert into cache (might already be there if another thread loaded it)
+            leafIt = _pmtilesCache->leafDirectoryCache.insert({leafKey, std::move(leafDir)}).first;
+        }
+        
+        return pmtiles::findTileEntry(leafIt->second, tileId, entry);
+    }
+
+    std::shared_ptr<TileData> HTTPTileDataSource::createMissingPMTile(const MapTile& mapTile) const {
+        // Tile not found, try parent tile
+        if (mapTile.getZoom() > getMinZoom()) {
+            LOG_INFOF("HTTPTileDataSource::loadPMTile: Tile not found, redirecting to parent");
+            auto tileData = std::make_shared<TileData>(std::shared_ptr<BinaryData>());
+            tileData->setReplaceWithParent(true);
+            return tileData;
+        }
+        LOG_INFOF("HTTPTileDataSource::loadPMTile: Tile not found");
+        return std::shared_ptr<TileData>();
+    }
     
     pmtiles::Header HTTPTileDataSource::readPMTilesHeader(const std::string& url) {
         // Read 127-byte header
@@ -370,6 +621,61 @@ namespace massif {
         std::vector<uint8_t> decompressed = pmtiles::decompressData(leafDirData, header.internalCompression);
         return pmtiles::decodeDirectory(decompressed);
     }
+
+    HTTPTileDataSource::PendingTileBatch::PendingTileBatch(HTTPTileDataSource& dataSource, const std::vector<MapTile>& mapTiles) :
+        _dataSource(dataSource),
+        _mapTiles(mapTiles),
+        _ownIndices(),
+        _promises(),
+        _foreignFutures(),
+        _released(false)
+    {
+        std::lock_guard<std::mutex> lock(_dataSource._mutex);
+        for (std::size_t i = 0; i < _mapTiles.size(); i++) {
+            long long tileId = _mapTiles[i].getTileId();
+            auto it = _dataSource._pendingTiles.find(tileId);
+            if (it != _dataSource._pendingTiles.end()) {
+                _foreignFutures[i] = it->second;
+                continue;
+            }
+            _dataSource._pendingTiles[tileId] = _promises[i].get_future().share();
+            _ownIndices.push_back(i);
+        }
+    }
+
+    HTTPTileDataSource::PendingTileBatch::~PendingTileBatch() {
+        if (!_released) {
+            // The batch failed, its waiters get no tiles as if their loads had failed
+            release(std::vector<std::shared_ptr<TileData> >(_mapTiles.size()));
+        }
+    }
+
+    const std::vector<std::size_t>& HTTPTileDataSource::PendingTileBatch::getOwnIndices() const {
+        return _ownIndices;
+    }
+
+    void HTTPTileDataSource::PendingTileBatch::complete(std::vector<std::shared_ptr<TileData> >& tileDatas) {
+        release(tileDatas);
+        for (auto& foreignFuture : _foreignFutures) {
+            tileDatas[foreignFuture.first] = foreignFuture.second.get();
+        }
+    }
+
+    void HTTPTileDataSource::PendingTileBatch::release(const std::vector<std::shared_ptr<TileData> >& tileDatas) {
+        _released = true;
+        {
+            std::lock_guard<std::mutex> lock(_dataSource._mutex);
+            for (std::size_t index : _ownIndices) {
+                _dataSource._pendingTiles.erase(_mapTiles[index].getTileId());
+            }
+        }
+        for (auto& promise : _promises) {
+            promise.second.set_value(tileDatas[promise.first]);
+        }
+    }
+
+    const int HTTPTileDataSource::DEFAULT_RANGE_GAP_TOLERANCE = 16 * 1024;
+    const uint64_t HTTPTileDataSource::MAX_COALESCED_RANGE_SIZE = 4 * 1024 * 1024;
     
 }
 
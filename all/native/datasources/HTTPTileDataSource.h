@@ -11,6 +11,7 @@
 #include "datasources/components/PMTilesUtils.h"
 #include "network/HTTPClient.h"
 
+#include <future>
 #include <random>
 #include <string>
 #include <map>
@@ -77,6 +78,8 @@ namespace massif {
         /**
          * Returns true/false based on whether the max-age header check is used.
          * If this is enabled, SDK will automatically refresh the tiles when tiles have expired.
+         * Expired tiles with an ETag or Last-Modified header are refreshed with a conditional request,
+         * so unchanged tiles are not downloaded again.
          * @return True if max-age header check is used. False otherwise.
          */
         bool isMaxAgeHeaderCheck() const;
@@ -109,16 +112,69 @@ namespace massif {
          * @param headers A map of HTTP headers that will be used in subsequent requests.
          */
         void setHTTPHeaders(const std::map<std::string, std::string>& headers);
+
+        /**
+         * Returns the gap tolerance used when coalescing PMTiles range requests.
+         * @return The maximum number of unneeded bytes between two tiles fetched with a single range request.
+         */
+        int getRangeGapTolerance() const;
+        /**
+         * Sets the gap tolerance used when coalescing PMTiles range requests. When a batch of tiles is loaded
+         * from a PMTiles archive, tiles whose byte ranges are at most this many bytes apart are fetched with
+         * a single ranged GET request. 0 merges only exactly adjacent tiles. The default is 16KB.
+         * @param bytes The new gap tolerance in bytes.
+         */
+        void setRangeGapTolerance(int bytes);
     
         virtual std::shared_ptr<TileData> loadTile(const MapTile& mapTile);
+
+#ifndef SWIG
+        virtual bool isBatchLoadSupported() const;
+        virtual std::vector<std::shared_ptr<TileData> > loadTiles(const std::vector<MapTile>& mapTiles);
+        virtual std::shared_ptr<TileData> revalidateTile(const MapTile& mapTile, const std::shared_ptr<TileData>& expiredTileData);
+#endif
     
     protected:
+        // Registers the tiles of a batch as pending, so that concurrent single tile loads join the batch.
+        // The tiles are unregistered and their waiters released on destruction, even if the batch fails.
+        class PendingTileBatch {
+        public:
+            PendingTileBatch(HTTPTileDataSource& dataSource, const std::vector<MapTile>& mapTiles);
+            ~PendingTileBatch();
+
+            const std::vector<std::size_t>& getOwnIndices() const;
+
+            // Publishes the own tiles of the batch and fills in the tiles loaded by other batches
+            void complete(std::vector<std::shared_ptr<TileData> >& tileDatas);
+
+        private:
+            void release(const std::vector<std::shared_ptr<TileData> >& tileDatas);
+
+            HTTPTileDataSource& _dataSource;
+            const std::vector<MapTile>& _mapTiles;
+            std::vector<std::size_t> _ownIndices;
+            std::map<std::size_t, std::promise<std::shared_ptr<TileData> > > _promises;
+            std::map<std::size_t, std::shared_future<std::shared_ptr<TileData> > > _foreignFutures;
+            bool _released;
+        };
+
+        static const int DEFAULT_RANGE_GAP_TOLERANCE;
+        static const uint64_t MAX_COALESCED_RANGE_SIZE;
+
         virtual std::string buildTileURL(const std::string& baseURL, const MapTile& tile) const;
+
+        std::shared_ptr<TileData> loadHTTPTile(const std::string& baseURL, const MapTile& mapTile, const std::shared_ptr<TileData>& expiredTileData);
+        std::vector<std::shared_ptr<TileData> > loadHTTPTiles(const std::string& baseURL, const std::vector<MapTile>& mapTiles);
+        std::shared_ptr<TileData> createHTTPTileData(const MapTile& mapTile, const std::string& url, int statusCode, const std::map<std::string, std::string>& responseHeaders, const std::shared_ptr<BinaryData>& responseData, const std::shared_ptr<TileData>& expiredTileData, bool maxAgeHeaderCheck) const;
+        std::shared_future<std::shared_ptr<TileData> > findPendingTile(const MapTile& mapTile) const;
         
         // PMTiles support
         bool isPMTilesURL(const std::string& url) const;
         std::string normalizePMTilesURL(const std::string& url) const;
         std::shared_ptr<TileData> loadPMTile(const std::string& baseURL, const MapTile& mapTile);
+        std::vector<std::shared_ptr<TileData> > loadPMTiles(const std::string& baseURL, const std::vector<MapTile>& mapTiles);
+        bool findPMTileEntry(const std::string& url, const MapTile& mapTile, pmtiles::DirectoryEntry& entry, pmtiles::Header& header);
+        std::shared_ptr<TileData> createMissingPMTile(const MapTile& mapTile) const;
         pmtiles::Header readPMTilesHeader(const std::string& url);
         std::vector<uint8_t> httpRangeRequest(const std::string& url, uint64_t offset, uint64_t length);
         std::vector<pmtiles::DirectoryEntry> loadPMTilesLeafDirectory(const std::string& url, const pmtiles::Header& header, uint64_t offset, uint32_t length);
@@ -129,6 +185,7 @@ namespace massif {
         bool _maxAgeHeaderCheck;
         int _timeout;
         std::map<std::string, std::string> _headers;
+        int _rangeGapTolerance;
         HTTPClient _httpClient;
         mutable std::default_random_engine _randomGenerator;
         mutable std::mutex _mutex;
@@ -141,6 +198,7 @@ namespace massif {
             std::map<uint64_t, std::vector<pmtiles::DirectoryEntry>> leafDirectoryCache;
         };
         mutable std::unique_ptr<PMTilesCache> _pmtilesCache;
+        std::map<long long, std::shared_future<std::shared_ptr<TileData> > > _pendingTiles; // tiles of in-flight batches, joined by single tile loads
     };
     
 }
@@ -17,8 +17,11 @@ namespace massif {
 
     MBTilesTileDataSource::MBTilesTileDataSource(const std::string& path) :
         TileDataSource(),
+        _path(path),
         _scheme(MBTilesScheme::MBTILES_SCHEME_TMS),
         _database(OpenDatabase(path)),
+        _idleTileConnections(),
+        _tileConnectionMutex(),
         _cachedMinZoom(),
         _cachedMaxZoom(),
         _cachedDataExtent(),
@@ -28,8 +31,11 @@ namespace massif {
 
     MBTilesTileDataSource::MBTilesTileDataSource(int minZoom, int maxZoom, const std::string& path) :
         TileDataSource(minZoom, maxZoom),
+        _path(path),
         _scheme(MBTilesScheme::MBTILES_SCHEME_TMS),
         _database(OpenDatabase(path)),
+        _idleTileConnections(),
+        _tileConnectionMutex(),
         _cachedMinZoom(minZoom),
         _cachedMaxZoom(maxZoom),
         _cachedDataExtent(),
@@ -39,8 +45,11 @@ namespace massif {
     
     MBTilesTileDataSource::MBTilesTileDataSource(int minZoom, int maxZoom, const std::string& path, MBTilesScheme::MBTilesScheme scheme) :
         TileDataSource(minZoom, maxZoom),
+        _path(path),
         _scheme(scheme),
         _database(OpenDatabase(path)),
+        _idleTileConnections(),
+        _tileConnectionMutex(),
         _cachedMinZoom(minZoom),
         _cachedMaxZoom(maxZoom),
         _cachedDataExtent(),
@@ -143,12 +152,7 @@ namespace massif {
     }
 
     std::shared_ptr<TileData> MBTilesTileDataSource::loadTile(const MapTile& mapTile) {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
-        Log::Infof("MBTilesTileDataSource::loadTile: Loading %s", mapTile.toString().c_str());
-        if (!_database) {
-            Log::Errorf("MBTilesTileDataSource::loadTile: Failed to load %s: Couldn't connect to the database", mapTile.toString().c_str());
-            return std::shared_ptr<TileData>();
-        }
+        LOG_INFOF("MBTilesTileDataSource::loadTile: Loading %s", mapTile.toString().c_str());
 
         if (getMaxOverzoomLevel() >= 0 && mapTile.getZoom() > getMaxZoomWithOverzoom()) {
             // we explicitly return an empty tile to not draw overzoom
@@ -156,47 +160,89 @@ namespace massif {
             tileData->setIsOverZoom(true);
             return  tileData;
         }
+
+        // Tiles are read through a pool of connections, so that concurrent loads do not serialize on a single connection
+        std::unique_ptr<TileConnection> connection;
         try {
-            // Make the query and check for database error
-            sqlite3pp::query query(*_database, "SELECT tile_data FROM tiles WHERE zoom_level=:zoom AND tile_column=:x AND tile_row=:y");
+            connection = acquireTileConnection();
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("MBTilesTileDataSource::loadTile: Failed to load %s: Couldn't connect to the database: %s", mapTile.toString().c_str(), ex.what());
+            return std::shared_ptr<TileData>();
+        }
+
+        std::shared_ptr<BinaryData> data;
+        try {
+            // Reuse the prepared query and check for database error
+            sqlite3pp::query& query = *connection->tileQuery;
+            query.reset();
             query.bind(":zoom", mapTile.getZoom());
             query.bind(":x", mapTile.getX());
             query.bind(":y", _scheme == MBTilesScheme::MBTILES_SCHEME_XYZ ? mapTile.getY() : (1 << (mapTile.getZoom())) - 1 - mapTile.getY());
 
             auto it = query.begin();
-            if (it == query.end()) {
-                std::shared_ptr<TileData> tileData = std::make_shared<TileData>(std::shared_ptr<BinaryData>());
-                if (mapTile.getZoom() > getMinZoom()) {
-                    Log::Infof("MBTilesTileDataSource::loadTile: Tile data doesn't exist in the database, redirecting to parent");
-                    tileData->setReplaceWithParent(true);
-                } else {
-                    Log::Infof("MBTilesTileDataSource::loadTile: Tile data doesn't exist in the database");
-                    return std::shared_ptr<TileData>();
-                }
-                return tileData;
+            if (it != query.end()) {
+                std::size_t dataSize = (*it).column_bytes(0);
+                const unsigned char* dataPtr = static_cast<const unsigned char*>((*it).get<const void*>(0));
+                data = std::make_shared<BinaryData>(dataPtr, dataSize);
             }
-            
-            std::size_t dataSize = (*it).column_bytes(0);
-            const unsigned char* dataPtr = static_cast<const unsigned char*>((*it).get<const void*>(0));
-            auto data = std::make_shared<BinaryData>(dataPtr, dataSize);
-            query.finish();
-    
-            auto tileData = std::make_shared<TileData>(data);
-            applyTileMetadata(tileData, mapTile);
-            return tileData;
+            query.reset();
         }
         catch (const std::exception& ex) {
             Log::Errorf("MBTilesTileDataSource::loadTile: Failed to query tile data from the database: %s", ex.what());
-            return std::shared_ptr<TileData>();
+            return std::shared_ptr<TileData>(); // the connection is dropped, as its state is unknown
+        }
+        releaseTileConnection(std::move(connection));
+
+        if (!data) {
+            std::shared_ptr<TileData> tileData = std::make_shared<TileData>(std::shared_ptr<BinaryData>());
+            if (mapTile.getZoom() > getMinZoom()) {
+                LOG_INFOF("MBTilesTileDataSource::loadTile: Tile data doesn't exist in the database, redirecting to parent");
+                tileData->setReplaceWithParent(true);
+            } else {
+                LOG_INFOF("MBTilesTileDataSource::loadTile: Tile data doesn't exist in the database");
+                return std::shared_ptr<TileData>();
+            }
+            return tileData;
+        }
+
+        auto tileData = std::make_shared<TileData>(data);
+        applyTileMetadata(tileData, mapTile);
+        return tileData;
+    }
+
+    std::unique_ptr<MBTilesTileDataSource::TileConnection> MBTilesTileDataSource::acquireTileConnection() {
+        {
+            std::lock_guard<std::mutex> lock(_tileConnectionMutex);
+            if (!_idleTileConnections.empty()) {
+                std::unique_ptr<TileConnection> connection = std::move(_idleTileConnections.back());
+                _idleTileConnections.pop_back();
+                return connection;
+            }
+        }
+
+        auto connection = std::make_unique<TileConnection>();
+        connection->database = OpenDatabase(_path);
+        connection->tileQuery = std::make_unique<sqlite3pp::query>(*connection->database, "SELECT tile_data FROM tiles WHERE zoom_level=:zoom AND tile_column=:x AND tile_row=:y");
+        return connection;
+    }
+
+    void MBTilesTileDataSource::releaseTileConnection(std::unique_ptr<TileConnection> connection) {
+        std::lock_guard<std::mutex> lock(_tileConnectionMutex);
+        if (static_cast<int>(_idleTileConnections.size()) < MAX_IDLE_TILE_CONNECTIONS) {
+            _idleTileConnections.push_back(std::move(connection));
         }
     }
 
     std::unique_ptr<sqlite3pp::database> MBTilesTileDataSource::OpenDatabase(const std::string& path) {
         auto database = std::make_unique<sqlite3pp::database>();
-        if (database->connect_v2(path.c_str(), SQLITE_OPEN_READONLY) != SQLITE_OK) {
+        // Each connection is used by one thread at a time (the metadata connection under the mutex, tile connections checked out of the pool),
+        // so SQLite's own per-connection locking is not needed
+        if (database->connect_v2(path.c_str(), SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX) != SQLITE_OK) {
             throw FileException("Failed to open database file", path);
         }
         database->execute("PRAGMA temp_store=MEMORY");
+        database->execute(("PRAGMA mmap_size=" + boost::lexical_cast<std::string>(MMAP_SIZE)).c_str());
         return database;
     }
 
@@ -326,6 +372,11 @@ namespace massif {
         }
         return result;
     }
+
+    // Enough for the tile worker threads; connections above this are closed when released
+    const int MBTilesTileDataSource::MAX_IDLE_TILE_CONNECTIONS = 8;
+    // Upper bound of the memory mapped region per connection. The mapping is shared between connections by the OS page cache.
+    const long long MBTilesTileDataSource::MMAP_SIZE = 1LL << 30;
 }
 
 #endif
@@ -13,10 +13,13 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <vector>
 
 namespace sqlite3pp {
     class database;
+    class query;
 }
     
 namespace massif {
@@ -95,13 +98,27 @@ namespace massif {
         virtual std::shared_ptr<TileData> loadTile(const MapTile& mapTile);
 
     private:
+        struct TileConnection {
+            std::unique_ptr<sqlite3pp::database> database;
+            std::unique_ptr<sqlite3pp::query> tileQuery;
+        };
+
         static std::unique_ptr<sqlite3pp::database> OpenDatabase(const std::string& path);
 
+        std::unique_ptr<TileConnection> acquireTileConnection();
+        void releaseTileConnection(std::unique_ptr<TileConnection> connection);
+
         bool loadZoomLevels(int& minZoom, int& maxZoom) const;
         bool loadDataExtent(MapBounds& mapBounds) const;
 
+        static const int MAX_IDLE_TILE_CONNECTIONS;
+        static const long long MMAP_SIZE;
+
+        std::string _path;
         MBTilesScheme::MBTilesScheme _scheme;
         std::unique_ptr<sqlite3pp::database> _database;
+        std::vector<std::unique_ptr<TileConnection> > _idleTileConnections; // read-only connections with a prepared tile query, checked out per loadTile call
+        std::mutex _tileConnectionMutex;
         mutable std::optional<int> _cachedMinZoom;
         mutable std::optional<int> _cachedMaxZoom;
         mutable std::optional<MapBounds> _cachedDataExtent;
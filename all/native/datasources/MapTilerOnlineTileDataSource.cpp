@@ -79,7 +79,7 @@ namespace massif {
         std::map<std::string, std::string> tagMap;
         tagMap["key"] = _key;
         std::string url = GeneralUtils::ReplaceTags(_serviceURL.empty() ? MAPTILER_SERVICE_URL : _serviceURL, tagMap);
-        Log::Debugf("MapTilerOnlineTileDataSource::loadConfiguration: Loading %s", url.c_str());
+        LOG_DEBUGF("MapTilerOnlineTileDataSource::loadConfiguration: Loading %s", url.c_str());
 
         std::map<std::string, std::string> requestHeaders = NetworkUtils::CreateAppRefererHeader();
         std::map<std::string, std::string> responseHeaders;
@@ -130,14 +130,14 @@ namespace massif {
     }
     
     std::shared_ptr<TileData> MapTilerOnlineTileDataSource::loadOnlineTile(const std::string& tileURL, const MapTile& mapTile) {
-        Log::Infof("MapTilerOnlineTileDataSource::loadOnlineTile: Loading tile %d/%d/%d", mapTile.getZoom(), mapTile.getX(), mapTile.getY());
+        LOG_INFOF("MapTilerOnlineTileDataSource::loadOnlineTile: Loading tile %d/%d/%d", mapTile.getZoom(), mapTile.getX(), mapTile.getY());
 
         std::string url = buildTileURL(tileURL, mapTile);
         if (url.empty()) {
             return std::shared_ptr<TileData>();
         }
 
-        Log::Debugf("MapTilerOnlineTileDataSource::loadOnlineTile: Loading %s", url.c_str());
+        LOG_DEBUGF("MapTilerOnlineTileDataSource::loadOnlineTile: Loading %s", url.c_str());
         std::map<std::string, std::string> requestHeaders = NetworkUtils::CreateAppRefererHeader();
         std::map<std::string, std::string> responseHeaders;
         std::shared_ptr<BinaryData> responseData;
@@ -159,11 +159,11 @@ namespace massif {
         int maxAge = NetworkUtils::GetMaxAgeHTTPHeader(responseHeaders);
         auto tileData = std::make_shared<TileData>(responseData);
         if (maxAge > 0) {
-            Log::Infof("MapTilerOnlineTileDataSource::loadOnlineTile: Setting tile %d/%d/%d maxage=%d", mapTile.getZoom(), mapTile.getX(), mapTile.getY(), maxAge);
+            LOG_INFOF("MapTilerOnlineTileDataSource::loadOnlineTile: Setting tile %d/%d/%d maxage=%d", mapTile.getZoom(), mapTile.getX(), mapTile.getY(), maxAge);
             tileData->setMaxAge(maxAge * 1000);
         }
         if (statusCode == 204) { // special case - empty tile, replace with parent tile
-            Log::Infof("MapTilerOnlineTileDataSource::loadOnlineTile: Replacing tile %d/%d/%d with parent", mapTile.getZoom(), mapTile.getX(), mapTile.getY());
+            LOG_INFOF("MapTilerOnlineTileDataSource::loadOnlineTile: Replacing tile %d/%d/%d with parent", mapTile.getZoom(), mapTile.getX(), mapTile.getY());
             tileData->setReplaceWithParent(true);
         }
         applyTileMetadata(tileData, mapTile);
@@ -1,9 +1,11 @@
 #include "MemoryCacheTileDataSource.h"
 #include "core/BinaryData.h"
 #include "core/MapTile.h"
+#include "vectortiles/NativeVectorTile.h"
 #include "utils/Log.h"
 
 #include <memory>
+#include <unordered_map>
 
 namespace massif {
     
@@ -20,33 +22,136 @@ namespace massif {
     std::shared_ptr<TileData> MemoryCacheTileDataSource::loadTile(const MapTile& mapTile) {
         std::unique_lock<std::recursive_mutex> lock(_mutex);
         
-        Log::Infof("MemoryCacheTileDataSource::loadTile: Loading %s", mapTile.toString().c_str());
+        LOG_INFOF("MemoryCacheTileDataSource::loadTile: Loading %s", mapTile.toString().c_str());
         
         std::shared_ptr<TileData> tileData;
+        std::shared_ptr<TileData> expiredTileData; // kept for revalidating it instead of loading it again
         if (_cache.read(mapTile.getTileId(), tileData)) {
             if (tileData->getMaxAge() != 0) {
                 applyCacheTileMetadata(tileData, mapTile);
                 return tileData;
             }
             _cache.remove(mapTile.getTileId());
+            expiredTileData = tileData;
         }
 
+        // Single-flight: several layers (and the elevation/contour sources) typically miss on the
+        // same tile at nearly the same time. Only the first caller loads it, the others wait for its result.
+        long long tileId = mapTile.getTileId();
+        auto it = _pendingLoads.find(tileId);
+        if (it != _pendingLoads.end()) {
+            std::shared_future<std::shared_ptr<TileData> > future = it->second;
+            lock.unlock();
+            _coalescedLoadCount++;
+            return future.get();
+        }
+        std::promise<std::shared_ptr<TileData> > promise;
+        _pendingLoads[tileId] = promise.get_future().share();
         lock.unlock();
-        tileData = _dataSource->loadTile(mapTile);
-        applyCacheTileMetadata(tileData, mapTile); // null-safe; the wrapped source may not attach any metadata itself
+
+        try {
+            tileData = expiredTileData ? _dataSource->revalidateTile(mapTile, expiredTileData) : _dataSource->loadTile(mapTile);
+            applyCacheTileMetadata(tileData, mapTile); // null-safe; the wrapped source may not attach any metadata itself
+        }
+        catch (...) {
+            lock.lock();
+            _pendingLoads.erase(tileId);
+            lock.unlock();
+            promise.set_value(std::shared_ptr<TileData>());
+            throw;
+        }
+
         lock.lock();
+        storeTile(mapTile, tileData);
+        _pendingLoads.erase(tileId);
+        lock.unlock();
+
+        promise.set_value(tileData);
+        return tileData;
+    }
+
+    std::vector<std::shared_ptr<TileData> > MemoryCacheTileDataSource::loadTiles(const std::vector<MapTile>& mapTiles) {
+        if (!_dataSource->isBatchLoadSupported()) {
+            return TileDataSource::loadTiles(mapTiles);
+        }
+
+        // Claim the tiles that are neither cached nor already being loaded, so that concurrent
+        // single tile loads of the same tiles wait for this batch instead of loading them again.
+        std::vector<MapTile> missingTiles;
+        std::vector<std::promise<std::shared_ptr<TileData> > > promises;
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            for (const MapTile& mapTile : mapTiles) {
+                long long tileId = mapTile.getTileId();
+                if (_cache.exists(tileId) || _pendingLoads.find(tileId) != _pendingLoads.end()) {
+                    continue;
+                }
+                promises.emplace_back();
+                _pendingLoads[tileId] = promises.back().get_future().share();
+                missingTiles.push_back(mapTile);
+            }
+        }
+
+        std::vector<std::shared_ptr<TileData> > loadedTiles;
+        try {
+            if (!missingTiles.empty()) {
+                loadedTiles = _dataSource->loadTiles(missingTiles);
+            }
+            loadedTiles.resize(missingTiles.size());
+            for (std::size_t i = 0; i < missingTiles.size(); i++) {
+                applyCacheTileMetadata(loadedTiles[i], missingTiles[i]);
+            }
+        }
+        catch (...) {
+            {
+                std::lock_guard<std::recursive_mutex> lock(_mutex);
+                for (const MapTile& mapTile : missingTiles) {
+                    _pendingLoads.erase(mapTile.getTileId());
+                }
+            }
+            for (std::promise<std::shared_ptr<TileData> >& promise : promises) {
+                promise.set_value(std::shared_ptr<TileData>());
+            }
+            throw;
+        }
+
+        std::unordered_map<long long, std::shared_ptr<TileData> > loadedTileMap;
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            for (std::size_t i = 0; i < missingTiles.size(); i++) {
+                storeTile(missingTiles[i], loadedTiles[i]);
+                _pendingLoads.erase(missingTiles[i].getTileId());
+                loadedTileMap[missingTiles[i].getTileId()] = loadedTiles[i];
+            }
+        }
+        for (std::size_t i = 0; i < promises.size(); i++) {
+            promises[i].set_value(loadedTiles[i]);
+        }
 
+        // Everything else is either cached or pending in another load
+        std::vector<std::shared_ptr<TileData> > tileDatas;
+        tileDatas.reserve(mapTiles.size());
+        for (const MapTile& mapTile : mapTiles) {
+            auto it = loadedTileMap.find(mapTile.getTileId());
+            tileDatas.push_back(it != loadedTileMap.end() ? it->second : loadTile(mapTile));
+        }
+        return tileDatas;
+    }
+    
+    void MemoryCacheTileDataSource::storeTile(const MapTile& mapTile, const std::shared_ptr<TileData>& tileData) {
         if (tileData) {
             if (tileData->getMaxAge() != 0 && tileData->getData() && !tileData->isReplaceWithParent()) {
-                _cache.put(mapTile.getTileId(), tileData, tileData->getData()->size() + 16);
+                std::size_t tileSize = tileData->getData()->size();
+                if (std::shared_ptr<const NativeVectorTile> nativeTile = tileData->getNativeTile()) {
+                    tileSize += nativeTile->getDataSize();
+                }
+                _cache.put(mapTile.getTileId(), tileData, tileSize + 16);
             }
         } else {
-            Log::Infof("MemoryCacheTileDataSource::loadTile: Failed to load %s.", mapTile.toString().c_str());
+            LOG_INFOF("MemoryCacheTileDataSource::loadTile: Failed to load %s.", mapTile.toString().c_str());
         }
-        
-        return tileData;
     }
-    
+
     void MemoryCacheTileDataSource::clear() {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
         _cache.clear();
@@ -9,6 +9,9 @@
 
 #include "datasources/CacheTileDataSource.h"
 
+#include <future>
+#include <map>
+
 #include <stdext/timed_lru_cache.h>
 
 namespace massif {
@@ -28,6 +31,10 @@ namespace massif {
         virtual ~MemoryCacheTileDataSource();
     
         virtual std::shared_ptr<TileData> loadTile(const MapTile& mapTile);
+
+#ifndef SWIG
+        virtual std::vector<std::shared_ptr<TileData> > loadTiles(const std::vector<MapTile>& mapTiles);
+#endif
                 
         virtual void clear();
 
@@ -38,7 +45,10 @@ namespace massif {
     protected:
         static const unsigned int DEFAULT_CAPACITY;
 
+        void storeTile(const MapTile& mapTile, const std::shared_ptr<TileData>& tileData);
+
         cache::timed_lru_cache<long long, std::shared_ptr<TileData> > _cache;
+        std::map<long long, std::shared_future<std::shared_ptr<TileData> > > _pendingLoads; // single-flight de-duplication of concurrent misses
         mutable std::recursive_mutex _mutex;
     };
     
@@ -2,7 +2,10 @@
 #include "core/BinaryData.h"
 #include "core/MapTile.h"
 #include "components/Exceptions.h"
+#include "datasources/components/TileData.h"
 #include "utils/Log.h"
+#include "vectortiles/NativeVectorTile.h"
+#include "vectortiles/utils/MVTLogger.h"
 
 #ifdef _MASSIF_OFFLINE_SUPPORT
 #include "datasources/MBTilesTileDataSource.h"
@@ -13,6 +16,38 @@
 #include <stdext/zlib.h>
 
 #include <mapnikvt/CompressionUtils.h>
+#include <mapnikvt/MBVTFeatureDecoder.h>
+#include <mapnikvt/MLTFeatureDecoder.h>
+
+namespace {
+
+    std::shared_ptr<const massif::NativeVectorTile> DecodeNativeTile(const massif::BinaryData& tileData) {
+        using namespace massif;
+
+        const std::vector<unsigned char>& rawData = *tileData.getDataPtr();
+        std::vector<unsigned char> inflatedData;
+        const std::vector<unsigned char>& data = mvt::compression::inflate_tile(rawData.empty() ? nullptr : rawData.data(), rawData.size(), inflatedData) ? inflatedData : rawData;
+
+        auto logger = std::make_shared<MVTLogger>("MergedMBVTTileDataSource");
+        std::shared_ptr<mvt::LayerFeatureDecoder> decoder;
+        if (mvt::MLTFeatureDecoder::isTileData(data.data(), data.size())) {
+            decoder = std::make_shared<mvt::MLTFeatureDecoder>(data, logger);
+        } else {
+            decoder = std::make_shared<mvt::MBVTFeatureDecoder>(data, logger);
+        }
+
+        std::vector<NativeVectorTile::Layer> layers;
+        for (const std::string& layerName : decoder->getLayerNames()) {
+            NativeVectorTile::Layer layer(layerName);
+            for (std::shared_ptr<mvt::FeatureDecoder::FeatureIterator> it = decoder->createLayerFeatureIterator(layerName, nullptr); it->valid(); it->advance()) {
+                layer.features.emplace_back(it->getFeatureId(), it->getGeometry(), it->getFeatureData(false, nullptr));
+            }
+            layers.push_back(std::move(layer));
+        }
+        return std::make_shared<NativeVectorTile>(std::move(layers));
+    }
+
+}
 
 namespace massif {
     
@@ -87,6 +122,31 @@ namespace massif {
             if (result2->isReplaceWithParent()) {
                 return result1;
             }
+
+            // In-memory tiles have no bytes to concatenate, so their layers are merged instead.
+            // If only one of the tiles is in memory, the encoded one is decoded into layers first.
+            std::shared_ptr<const NativeVectorTile> nativeTile1 = result1->getNativeTile();
+            std::shared_ptr<const NativeVectorTile> nativeTile2 = result2->getNativeTile();
+            if (nativeTile1 || nativeTile2) {
+                try {
+                    if (!nativeTile1) {
+                        nativeTile1 = DecodeNativeTile(*result1->getData());
+                    }
+                    if (!nativeTile2) {
+                        nativeTile2 = DecodeNativeTile(*result2->getData());
+                    }
+                }
+                catch (const std::exception& ex) {
+                    Log::Errorf("MergedMBVTTileDataSource::loadTile: Failed to decode tile %s: %s", mapTile.toString().c_str(), ex.what());
+                    return result1->getNativeTile() ? result1 : result2;
+                }
+                std::vector<NativeVectorTile::Layer> layers(nativeTile1->getLayers());
+                layers.insert(layers.end(), nativeTile2->getLayers().begin(), nativeTile2->getLayers().end());
+                auto tileData = std::make_shared<TileData>(std::make_shared<BinaryData>());
+                tileData->setNativeTile(std::make_shared<NativeVectorTile>(std::move(layers)));
+                mergeTileAttributes(mapTile, *result1, *result2, *tileData);
+                return tileData;
+            }
             
             // We have data for both sources, we can merge them. Note that we may need to decompress the data first.
             std::shared_ptr<std::vector<unsigned char>> data1 = result1->getData()->getDataPtr();
@@ -141,18 +201,7 @@ namespace massif {
 
             auto mergedBinaryData = std::make_shared<BinaryData>(std::move(mergedData));
             auto mergedTileData = std::make_shared<TileData>(mergedBinaryData);
-            
-            // Merge metadata from both sources. When keys conflict, source1 metadata 
-            // overwrites source2 metadata (applied last to take precedence).
-            std::map<std::string, std::shared_ptr<Variant>> metadata2 = _dataSource2->buildTileMetadata(mapTile);
-            for (const auto& entry : metadata2) {
-                mergedTileData->setMetadata(entry.first, entry.second);
-            }
-            std::map<std::string, std::shared_ptr<Variant>> metadata1 = _dataSource1->buildTileMetadata(mapTile);
-            for (const auto& entry : metadata1) {
-                mergedTileData->setMetadata(entry.first, entry.second);
-            }
-            
+            mergeTileAttributes(mapTile, *result1, *result2, *mergedTileData);
             return mergedTileData;
         }
 
@@ -160,6 +209,32 @@ namespace massif {
         return result1 ? result1 : result2;
     }
 
+    void MergedMBVTTileDataSource::mergeTileAttributes(const MapTile& mapTile, const TileData& tileData1, const TileData& tileData2, TileData& mergedTileData) const {
+        // The merged tile expires with the first of its inputs
+        long long maxAge1 = tileData1.getMaxAge();
+        long long maxAge2 = tileData2.getMaxAge();
+        if (maxAge1 >= 0 && maxAge2 >= 0) {
+            mergedTileData.setMaxAge(std::min(maxAge1, maxAge2));
+        } else {
+            mergedTileData.setMaxAge(std::max(maxAge1, maxAge2));
+        }
+
+        // Merge metadata from both sources and both tiles. When keys conflict, source1 metadata
+        // overwrites source2 metadata (applied last to take precedence).
+        for (const auto& entry : _dataSource2->buildTileMetadata(mapTile)) {
+            mergedTileData.setMetadata(entry.first, entry.second);
+        }
+        for (const auto& entry : tileData2.getMetadataMap()) {
+            mergedTileData.setMetadata(entry.first, entry.second);
+        }
+        for (const auto& entry : _dataSource1->buildTileMetadata(mapTile)) {
+            mergedTileData.setMetadata(entry.first, entry.second);
+        }
+        for (const auto& entry : tileData1.getMetadataMap()) {
+            mergedTileData.setMetadata(entry.first, entry.second);
+        }
+    }
+
     MergedMBVTTileDataSource::DataSourceListener::DataSourceListener(MergedMBVTTileDataSource& combinedDataSource) :
         _combinedDataSource(combinedDataSource)
     {
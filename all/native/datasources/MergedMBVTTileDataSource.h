@@ -49,6 +49,8 @@ namespace massif {
         const DirectorPtr<TileDataSource> _dataSource2;
 
     private:
+        void mergeTileAttributes(const MapTile& mapTile, const TileData& tileData1, const TileData& tileData2, TileData& mergedTileData) const;
+
         std::shared_ptr<DataSourceListener> _dataSourceListener;
     };
     
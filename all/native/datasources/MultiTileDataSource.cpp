@@ -79,7 +79,7 @@ namespace massif {
 
     std::shared_ptr<TileData> MultiTileDataSource::loadTile(const MapTile &mapTile)
     {
-        Log::Infof("MultiTileDataSource::loadTile: Loading %s", mapTile.toString().c_str());
+        LOG_INFOF("MultiTileDataSource::loadTile: Loading %s", mapTile.toString().c_str());
         try
         {
             MapTile mapTileFlipped = mapTile.getFlipped();
@@ -148,7 +148,7 @@ namespace massif {
 
                 if (mapTile.getZoom() > getMinZoom())
                 {
-                    Log::Infof("MultiTileDataSource::loadTile: Tile data doesn't exist in the database, redirecting to parent");
+                    LOG_INFOF("MultiTileDataSource::loadTile: Tile data doesn't exist in the database, redirecting to parent");
                     if (!tileData){
                         tileData = std::make_shared<TileData>(std::shared_ptr<BinaryData>());
                     }
@@ -158,7 +158,7 @@ namespace massif {
                 }
                 else
                 {
-                    Log::Infof("MultiTileDataSource::loadTile: Tile data doesn't exist in the database");
+                    LOG_INFOF("MultiTileDataSource::loadTile: Tile data doesn't exist in the database");
                     return std::shared_ptr<TileData>();
                 }
             }
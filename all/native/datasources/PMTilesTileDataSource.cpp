@@ -7,10 +7,10 @@
 #include "datasources/components/PMTilesUtils.h"
 #include "projections/Projection.h"
 #include "utils/Log.h"
+#include "utils/MemoryMappedFile.h"
 
 #include <cstring>
 #include <algorithm>
-#include <unordered_map>
 // For JSON parsing (simple extraction)
 #include <boost/algorithm/string.hpp>
 
@@ -19,61 +19,33 @@ namespace massif {
     PMTilesTileDataSource::PMTilesTileDataSource(const std::string& path) :
         TileDataSource(),
         _path(path),
+        _mappedFile(),
         _file(),
         _header(),
         _rootDirectory(),
         _cachedMetadata(),
         _cachedDataExtent(),
-        _leafDirectoryCache(),
+        _leafDirectoryShards(),
+        _fileMutex(),
         _mutex()
     {
-        _file = std::make_unique<std::ifstream>(path, std::ios::binary);
-        if (!_file->is_open()) {
-            throw FileException("Failed to open PMTiles file", path);
-        }
-
-        _header = ReadHeader(*_file);
-        
-        // Read and decode root directory
-        std::vector<uint8_t> rootDirData(_header.rootDirectoryLength);
-        _file->seekg(_header.rootDirectoryOffset);
-        _file->read(reinterpret_cast<char*>(rootDirData.data()), _header.rootDirectoryLength);
-        
-        std::vector<uint8_t> decompressed = pmtiles::decompressData(rootDirData, _header.internalCompression);
-        _rootDirectory = pmtiles::decodeDirectory(decompressed);
-        
-        Log::Infof("PMTilesTileDataSource: Opened %s with %llu tiles, zoom %d-%d", 
-                   path.c_str(), _header.numTileEntries, _header.minZoom, _header.maxZoom);
+        openArchive();
     }
 
     PMTilesTileDataSource::PMTilesTileDataSource(int minZoom, int maxZoom, const std::string& path) :
         TileDataSource(minZoom, maxZoom),
         _path(path),
+        _mappedFile(),
         _file(),
         _header(),
         _rootDirectory(),
         _cachedMetadata(),
         _cachedDataExtent(),
-        _leafDirectoryCache(),
+        _leafDirectoryShards(),
+        _fileMutex(),
         _mutex()
     {
-        _file = std::make_unique<std::ifstream>(path, std::ios::binary);
-        if (!_file->is_open()) {
-            throw FileException("Failed to open PMTiles file", path);
-        }
-
-        _header = ReadHeader(*_file);
-        
-        // Read and decode root directory
-        std::vector<uint8_t> rootDirData(_header.rootDirectoryLength);
-        _file->seekg(_header.rootDirectoryOffset);
-        _file->read(reinterpret_cast<char*>(rootDirData.data()), _header.rootDirectoryLength);
-        
-        std::vector<uint8_t> decompressed = pmtiles::decompressData(rootDirData, _header.internalCompression);
-        _rootDirectory = pmtiles::decodeDirectory(decompressed);
-        
-        Log::Infof("PMTilesTileDataSource: Opened %s with %llu tiles, zoom %d-%d", 
-                   path.c_str(), _header.numTileEntries, _header.minZoom, _header.maxZoom);
+        openArchive();
     }
         
     PMTilesTileDataSource::~PMTilesTileDataSource() {
@@ -89,13 +61,7 @@ namespace massif {
             }
             
             try {
-                // Read metadata
-                std::vector<uint8_t> metadataData(_header.metadataLength);
-                _file->seekg(_header.metadataOffset);
-                _file->read(reinterpret_cast<char*>(metadataData.data()), _header.metadataLength);
-                
-                // Decompress if needed
-                std::vector<uint8_t> decompressed = pmtiles::decompressData(metadataData, _header.internalCompression);
+                std::vector<uint8_t> decompressed = readData(_header.metadataOffset, _header.metadataLength, _header.internalCompression);
                 
                 _cachedMetadata = std::string(decompressed.begin(), decompressed.end());
             }
@@ -175,11 +141,11 @@ namespace massif {
     }
 
     std::shared_ptr<TileData> PMTilesTileDataSource::loadTile(const MapTile& mapTile) {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
-        
-        Log::Infof("PMTilesTileDataSource::loadTile: Loading %s", mapTile.toString().c_str());
+        // No lock here: the archive is either memory mapped (lock-free reads) or readData
+        // serializes the stream access itself, and the leaf directory cache is sharded.
+        LOG_INFOF("PMTilesTileDataSource::loadTile: Loading %s", mapTile.toString().c_str());
         
-        if (!_file || !_file->is_open()) {
+        if (!_mappedFile && !_file) {
             Log::Errorf("PMTilesTileDataSource::loadTile: File not open");
             return std::shared_ptr<TileData>();
         }
@@ -197,26 +163,23 @@ namespace massif {
             
             // Find the tile entry
             pmtiles::DirectoryEntry entry;
-            if (!FindTileEntry(tileId, entry)) {
+            if (!findTileEntry(tileId, entry)) {
                 // Tile not found, try parent tile
                 if (mapTile.getZoom() > getMinZoom()) {
-                    Log::Infof("PMTilesTileDataSource::loadTile: Tile not found, redirecting to parent");
+                    LOG_INFOF("PMTilesTileDataSource::loadTile: Tile not found, redirecting to parent");
                     std::shared_ptr<TileData> tileData = std::make_shared<TileData>(std::shared_ptr<BinaryData>());
                     tileData->setReplaceWithParent(true);
                     return tileData;
                 } else {
-                    Log::Infof("PMTilesTileDataSource::loadTile: Tile not found");
+                    LOG_INFOF("PMTilesTileDataSource::loadTile: Tile not found");
                     return std::shared_ptr<TileData>();
                 }
             }
             
-            // Read tile data
-            std::vector<uint8_t> compressedData = ReadTileData(entry.offset, entry.length);
-            
-            // Decompress if needed
-            std::vector<uint8_t> tileBytes = pmtiles::decompressData(compressedData, _header.tileCompression);
+            // Read and decompress tile data straight from the archive into the tile buffer
+            std::vector<uint8_t> tileBytes = readData(_header.tileDataOffset + entry.offset, entry.length, _header.tileCompression);
             
-            auto data = std::make_shared<BinaryData>(tileBytes.data(), tileBytes.size());
+            auto data = std::make_shared<BinaryData>(std::move(tileBytes));
             auto tileData = std::make_shared<TileData>(data);
             applyTileMetadata(tileData, mapTile);
             return tileData;
@@ -227,6 +190,12 @@ namespace massif {
         }
     }
 
+    PMTilesTileDataSource::LeafDirectoryShard::LeafDirectoryShard() :
+        cache(LEAF_DIRECTORY_CACHE_CAPACITY / LEAF_DIRECTORY_CACHE_SHARDS),
+        mutex()
+    {
+    }
+
     pmtiles::Header PMTilesTileDataSource::ReadHeader(std::ifstream& file) {
         // Read 127-byte header
         uint8_t headerBytes[127];
@@ -240,75 +209,98 @@ namespace massif {
         return pmtiles::readHeader(headerBytes);
     }
 
-    std::vector<uint8_t> PMTilesTileDataSource::ReadTileData(uint64_t offset, uint32_t length) {
-        std::vector<uint8_t> data(length);
-        _file->seekg(_header.tileDataOffset + offset);
-        _file->read(reinterpret_cast<char*>(data.data()), length);
-        
-        if (!_file) {
-            throw GenericException("Failed to read tile data");
+    void PMTilesTileDataSource::openArchive() {
+        auto mappedFile = std::make_unique<MemoryMappedFile>(_path);
+        if (mappedFile->isOpen()) {
+            const uint8_t* headerBytes = mappedFile->range(0, 127);
+            if (!headerBytes) {
+                throw GenericException("Failed to read PMTiles header");
+            }
+            _header = pmtiles::readHeader(headerBytes);
+            _mappedFile = std::move(mappedFile);
+        } else {
+            _file = std::make_unique<std::ifstream>(_path, std::ios::binary);
+            if (!_file->is_open()) {
+                throw FileException("Failed to open PMTiles file", _path);
+            }
+            _header = ReadHeader(*_file);
         }
+
+        // Read and decode root directory
+        std::vector<uint8_t> decompressed = readData(_header.rootDirectoryOffset, _header.rootDirectoryLength, _header.internalCompression);
+        _rootDirectory = pmtiles::decodeDirectory(decompressed);
         
-        return data;
+        LOG_INFOF("PMTilesTileDataSource: Opened %s with %llu tiles, zoom %d-%d%s", 
+                   _path.c_str(), _header.numTileEntries, _header.minZoom, _header.maxZoom, _mappedFile ? " (memory mapped)" : "");
     }
 
-    bool PMTilesTileDataSource::FindTileEntry(uint64_t tileId, pmtiles::DirectoryEntry& outEntry) {
-        // Search in root directory first
-        for (const auto& entry : _rootDirectory) {
-            if (entry.runLength == 0) {
-                // This is a leaf directory entry
-                if (entry.tileId <= tileId) {
-                    // Check if this leaf directory might contain our tile
-                    try {
-                        // Check cache first
-                        auto cacheIt = _leafDirectoryCache.find(entry.offset);
-                        std::vector<pmtiles::DirectoryEntry>* leafDir;
-                        
-                        if (cacheIt != _leafDirectoryCache.end()) {
-                            leafDir = &cacheIt->second;
-                        } else {
-                            // Load and cache the leaf directory
-                            std::vector<pmtiles::DirectoryEntry> loadedLeafDir = LoadLeafDirectory(entry.offset, entry.length);
-                            auto insertResult = _leafDirectoryCache.emplace(entry.offset, std::move(loadedLeafDir));
-                            leafDir = &insertResult.first->second;
-                        }
-                        
-                        // Search in the leaf directory using shared utility
-                        if (pmtiles::findTileEntry(*leafDir, tileId, outEntry)) {
-                            return true;
-                        }
-                    }
-                    catch (const std::exception& ex) {
-                        Log::Warnf("PMTilesTileDataSource: Failed to load leaf directory: %s", ex.what());
-                    }
-                }
-            } else {
-                // This is a tile entry
-                if (tileId >= entry.tileId && tileId < entry.tileId + entry.runLength) {
-                    outEntry = entry; // Copy the entry
-                    return true;
-                }
+    std::vector<uint8_t> PMTilesTileDataSource::readData(uint64_t offset, uint64_t length, uint8_t compression) const {
+        if (_mappedFile) {
+            const uint8_t* dataPtr = _mappedFile->range(offset, length);
+            if (!dataPtr) {
+                throw GenericException("Data range outside of PMTiles archive");
             }
+            return pmtiles::decompressData(dataPtr, static_cast<size_t>(length), compression);
+        }
+
+        std::vector<uint8_t> data(static_cast<size_t>(length));
+        {
+            std::lock_guard<std::mutex> lock(_fileMutex);
+            _file->seekg(offset);
+            _file->read(reinterpret_cast<char*>(data.data()), length);
+            if (!*_file) {
+                _file->clear();
+                throw GenericException("Failed to read PMTiles data");
+            }
+        }
+        if (compression == 0x01 || compression == 0x00) {
+            return data;
+        }
+        return pmtiles::decompressData(data.data(), data.size(), compression);
+    }
+
+    bool PMTilesTileDataSource::findTileEntry(uint64_t tileId, pmtiles::DirectoryEntry& outEntry) const {
+        // Binary search the root directory, then descend through the leaf directories it points to
+        const std::vector<pmtiles::DirectoryEntry>* directory = &_rootDirectory;
+        DirectoryPtr leafDirectory; // keeps the current leaf directory alive even if evicted meanwhile
+        for (int depth = 0; depth < MAX_DIRECTORY_DEPTH; depth++) {
+            const pmtiles::DirectoryEntry* entry = pmtiles::findEntry(*directory, tileId);
+            if (!entry) {
+                return false;
+            }
+            if (entry->runLength > 0) {
+                outEntry = *entry;
+                return true;
+            }
+            leafDirectory = getLeafDirectory(entry->offset, entry->length);
+            directory = leafDirectory.get();
         }
-        
         return false;
     }
 
-    std::vector<pmtiles::DirectoryEntry> PMTilesTileDataSource::LoadLeafDirectory(uint64_t offset, uint32_t length) {
-        // Read leaf directory data
-        std::vector<uint8_t> leafData(length);
-        _file->seekg(_header.leafDirectoriesOffset + offset);
-        _file->read(reinterpret_cast<char*>(leafData.data()), length);
-        
-        if (!_file) {
-            throw GenericException("Failed to read leaf directory");
+    PMTilesTileDataSource::DirectoryPtr PMTilesTileDataSource::getLeafDirectory(uint64_t offset, uint64_t length) const {
+        LeafDirectoryShard& shard = _leafDirectoryShards[(offset / 64) % LEAF_DIRECTORY_CACHE_SHARDS];
+
+        DirectoryPtr leafDirectory;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (shard.cache.read(offset, leafDirectory)) {
+                return leafDirectory;
+            }
         }
-        
-        // Decompress and decode using shared utilities
-        std::vector<uint8_t> decompressed = pmtiles::decompressData(leafData, _header.internalCompression);
-        return pmtiles::decodeDirectory(decompressed);
+
+        // Decode outside of the shard lock. Two threads may decode the same leaf, the result is identical.
+        std::vector<uint8_t> decompressed = readData(_header.leafDirectoriesOffset + offset, length, _header.internalCompression);
+        leafDirectory = std::make_shared<const std::vector<pmtiles::DirectoryEntry> >(pmtiles::decodeDirectory(decompressed));
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.cache.put(offset, leafDirectory, leafDirectory->size() * sizeof(pmtiles::DirectoryEntry) + 64);
+        }
+        return leafDirectory;
     }
 
+    const std::size_t PMTilesTileDataSource::LEAF_DIRECTORY_CACHE_CAPACITY = 16 * 1024 * 1024;
+
 }
 
 #endif
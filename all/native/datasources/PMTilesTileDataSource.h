@@ -12,19 +12,25 @@
 #include "datasources/TileDataSource.h"
 #include "datasources/components/PMTilesUtils.h"
 
+#include <array>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <vector>
 #include <fstream>
-#include <unordered_map>
+
+#include <stdext/timed_lru_cache.h>
 
 namespace massif {
+    class MemoryMappedFile;
     
     /**
      * A tile data source that loads tiles from a PMTiles v3 archive file.
      * PMTiles is a single-file archive format for pyramids of tiled data.
      * The archive format supports efficient random access and metadata storage.
+     * Where the platform supports it, the archive is memory mapped and tiles are loaded
+     * concurrently without locking; otherwise reads are serialized through a single file stream.
      */
     class PMTilesTileDataSource : public TileDataSource {
     public:
@@ -71,19 +77,35 @@ namespace massif {
         virtual std::shared_ptr<TileData> loadTile(const MapTile& mapTile);
 
     private:
+        static const std::size_t LEAF_DIRECTORY_CACHE_CAPACITY;
+        static const int LEAF_DIRECTORY_CACHE_SHARDS = 8;
+        static const int MAX_DIRECTORY_DEPTH = 4;
+
+        typedef std::shared_ptr<const std::vector<pmtiles::DirectoryEntry> > DirectoryPtr;
+
+        struct LeafDirectoryShard {
+            cache::timed_lru_cache<uint64_t, DirectoryPtr> cache;
+            std::mutex mutex;
+
+            LeafDirectoryShard();
+        };
+
         static pmtiles::Header ReadHeader(std::ifstream& file);
-        
-        std::vector<uint8_t> ReadTileData(uint64_t offset, uint32_t length);
-        bool FindTileEntry(uint64_t tileId, pmtiles::DirectoryEntry& outEntry);
-        std::vector<pmtiles::DirectoryEntry> LoadLeafDirectory(uint64_t offset, uint32_t length);
+
+        void openArchive();
+        std::vector<uint8_t> readData(uint64_t offset, uint64_t length, uint8_t compression) const;
+        bool findTileEntry(uint64_t tileId, pmtiles::DirectoryEntry& outEntry) const;
+        DirectoryPtr getLeafDirectory(uint64_t offset, uint64_t length) const;
 
         std::string _path;
-        std::unique_ptr<std::ifstream> _file;
+        std::unique_ptr<MemoryMappedFile> _mappedFile;
+        std::unique_ptr<std::ifstream> _file; // only used if the archive could not be memory mapped
         pmtiles::Header _header;
         std::vector<pmtiles::DirectoryEntry> _rootDirectory;
         mutable std::optional<std::string> _cachedMetadata;
         mutable std::optional<MapBounds> _cachedDataExtent;
-        mutable std::unordered_map<uint64_t, std::vector<pmtiles::DirectoryEntry> > _leafDirectoryCache;
+        mutable std::array<LeafDirectoryShard, LEAF_DIRECTORY_CACHE_SHARDS> _leafDirectoryShards;
+        mutable std::mutex _fileMutex;
         mutable std::recursive_mutex _mutex;
     };
     
@@ -3,10 +3,12 @@
 #include "PackageManagerTileDataSource.h"
 #include "core/MapTile.h"
 #include "components/Exceptions.h"
+#include "packagemanager/PackageTileMask.h"
 #include "packagemanager/handlers/MapPackageHandler.h"
 #include "utils/Log.h"
 #include "utils/Const.h"
 
+#include <algorithm>
 #include <memory>
 
 namespace massif {
@@ -14,7 +16,8 @@ namespace massif {
     PackageManagerTileDataSource::PackageManagerTileDataSource(const std::shared_ptr<PackageManager>& packageManager) :
         TileDataSource(0, Const::MAX_SUPPORTED_ZOOM_LEVEL),
         _packageManager(packageManager),
-        _cachedOpenPackageHandlers(),
+        _packageIndex(),
+        _packageIndexGeneration(0),
         _mutex()
     {
         if (!packageManager) {
@@ -35,17 +38,17 @@ namespace massif {
     }
 
     std::shared_ptr<TileData> PackageManagerTileDataSource::loadTile(const MapTile& mapTile) {
-        Log::Infof("PackageManagerTileDataSource::loadTile: Loading %s", mapTile.toString().c_str());
+        LOG_INFOF("PackageManagerTileDataSource::loadTile: Loading %s", mapTile.toString().c_str());
         try {
             MapTile mapTileFlipped = mapTile.getFlipped();
 
             std::shared_ptr<BinaryData> data;
             _packageManager->accessLocalPackages([this, mapTileFlipped, &data](const std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> >& packageHandlerMap) {
-                std::lock_guard<std::mutex> lock(_mutex);
+                std::shared_ptr<const PackageIndex> index = getPackageIndex(packageHandlerMap);
 
-                // Fast path: try already open packages
-                for (auto it = _cachedOpenPackageHandlers.begin(); it != _cachedOpenPackageHandlers.end(); it++) {
-                    const std::shared_ptr<PackageInfo>& packageInfo = it->first;
+                // Only the packages the index lists for the tile are tried, no lock is held while loading
+                for (int packageIndex : FindPackageIndices(*index, mapTileFlipped)) {
+                    const std::shared_ptr<PackageInfo>& packageInfo = index->packages[packageIndex].first;
                     std::shared_ptr<PackageTileMask> tileMask = packageInfo->getTileMask();
                     if (tileMask) {
                         if (tileMask->getTileStatus(mapTileFlipped) == PackageTileStatus::PACKAGE_TILE_STATUS_MISSING) {
@@ -53,43 +56,20 @@ namespace massif {
                         }
                     }
 
-                    data = it->second->loadTile(mapTileFlipped);
+                    data = index->packages[packageIndex].second->loadTile(mapTileFlipped);
                     if (data || tileMask) {
-                        std::rotate(_cachedOpenPackageHandlers.begin(), it, it + 1);
                         return;
                     }
                 }
-
-                // Slow path: try other packages
-                for (auto it = packageHandlerMap.begin(); it != packageHandlerMap.end(); it++) {
-                    if (auto mapHandler = std::dynamic_pointer_cast<MapPackageHandler>(it->second)) {
-                        const std::shared_ptr<PackageInfo>& packageInfo = it->first;
-                        std::shared_ptr<PackageTileMask> tileMask = packageInfo->getTileMask();
-                        if (tileMask) {
-                            if (tileMask->getTileStatus(mapTileFlipped) == PackageTileStatus::PACKAGE_TILE_STATUS_MISSING) {
-                                continue;
-                            }
-                        }
-
-                        data = mapHandler->loadTile(mapTileFlipped);
-                        if (data || tileMask) {
-                            _cachedOpenPackageHandlers.insert(_cachedOpenPackageHandlers.begin(), std::make_pair(packageInfo, mapHandler));
-                            if (_cachedOpenPackageHandlers.size() > MAX_OPEN_PACKAGES) {
-                                _cachedOpenPackageHandlers.pop_back();
-                            }
-                            return;
-                        }
-                    }
-                }
             });
 
             std::shared_ptr<TileData> tileData = std::make_shared<TileData>(data);
             if (!data) {
                 if (mapTileFlipped.getZoom() > getMinZoom()) {
-                    Log::Infof("PackageManagerTileDataSource::loadTile: Tile data doesn't exist in the database, redirecting to parent");
+                    LOG_INFOF("PackageManagerTileDataSource::loadTile: Tile data doesn't exist in the database, redirecting to parent");
                     tileData->setReplaceWithParent(true);
                 } else {
-                    Log::Infof("PackageManagerTileDataSource::loadTile: Tile data doesn't exist in the database");
+                    LOG_INFOF("PackageManagerTileDataSource::loadTile: Tile data doesn't exist in the database");
                     return std::shared_ptr<TileData>();
                 }
             }
@@ -101,6 +81,82 @@ namespace massif {
         return std::shared_ptr<TileData>();
     }
         
+    std::shared_ptr<const PackageManagerTileDataSource::PackageIndex> PackageManagerTileDataSource::getPackageIndex(const std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> >& packageHandlerMap) const {
+        int generation = 0;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_packageIndex) {
+                return _packageIndex;
+            }
+            generation = _packageIndexGeneration;
+        }
+
+        // Build outside of the lock. If the packages changed meanwhile, the index is used for this load only.
+        std::shared_ptr<const PackageIndex> index = BuildPackageIndex(packageHandlerMap);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (generation == _packageIndexGeneration && !_packageIndex) {
+                _packageIndex = index;
+            }
+        }
+        return index;
+    }
+
+    std::shared_ptr<const PackageManagerTileDataSource::PackageIndex> PackageManagerTileDataSource::BuildPackageIndex(const std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> >& packageHandlerMap) {
+        auto index = std::make_shared<PackageIndex>();
+        for (auto it = packageHandlerMap.begin(); it != packageHandlerMap.end(); it++) {
+            if (auto mapHandler = std::dynamic_pointer_cast<MapPackageHandler>(it->second)) {
+                index->packages.emplace_back(it->first, mapHandler);
+            }
+        }
+
+        std::vector<int> packageIndices;
+        for (int i = 0; i < static_cast<int>(index->packages.size()); i++) {
+            packageIndices.push_back(i);
+        }
+        BuildPackageIndexNode(index->rootNode, *index, packageIndices, MapTile(0, 0, 0, 0));
+        return index;
+    }
+
+    void PackageManagerTileDataSource::BuildPackageIndexNode(PackageIndexNode& node, const PackageIndex& index, const std::vector<int>& packageIndices, const MapTile& tile) {
+        // Keep the packages that may contain the tile. A tile missing from a tile mask implies its subtiles are missing too.
+        for (int packageIndex : packageIndices) {
+            std::shared_ptr<PackageTileMask> tileMask = index.packages[packageIndex].first->getTileMask();
+            if (!tileMask || tileMask->getTileStatus(tile) != PackageTileStatus::PACKAGE_TILE_STATUS_MISSING) {
+                node.packageIndices.push_back(packageIndex);
+            }
+        }
+        if (node.packageIndices.size() <= 1 || tile.getZoom() >= MAX_INDEX_ZOOM) {
+            return;
+        }
+
+        // Packages without tile masks are candidates everywhere, so subdivide only if it narrows the list down
+        bool masked = std::any_of(node.packageIndices.begin(), node.packageIndices.end(), [&index](int packageIndex) {
+            return static_cast<bool>(index.packages[packageIndex].first->getTileMask());
+        });
+        if (!masked) {
+            return;
+        }
+
+        node.subNodes = std::make_unique<std::array<PackageIndexNode, 4> >();
+        for (int idx = 0; idx < 4; idx++) {
+            int dx = idx % 2;
+            int dy = idx / 2;
+            BuildPackageIndexNode((*node.subNodes)[idx], index, node.packageIndices, MapTile(tile.getX() * 2 + dx, tile.getY() * 2 + dy, tile.getZoom() + 1, tile.getFrameNr()));
+        }
+    }
+
+    const std::vector<int>& PackageManagerTileDataSource::FindPackageIndices(const PackageIndex& index, const MapTile& tile) {
+        const PackageIndexNode* node = &index.rootNode;
+        for (int zoom = 1; zoom <= tile.getZoom() && node->subNodes; zoom++) {
+            int shift = tile.getZoom() - zoom;
+            int dx = (tile.getX() >> shift) & 1;
+            int dy = (tile.getY() >> shift) & 1;
+            node = &(*node->subNodes)[dy * 2 + dx];
+        }
+        return node->packageIndices;
+    }
+
     PackageManagerTileDataSource::PackageManagerListener::PackageManagerListener(PackageManagerTileDataSource& dataSource) :
         _dataSource(dataSource)
     {
@@ -109,7 +165,8 @@ namespace massif {
     void PackageManagerTileDataSource::PackageManagerListener::onPackagesChanged(PackageChangeType changeType) {
         {
             std::lock_guard<std::mutex> lock(_dataSource._mutex);
-            _dataSource._cachedOpenPackageHandlers.clear();
+            _dataSource._packageIndex.reset();
+            _dataSource._packageIndexGeneration++;
         }
         _dataSource.notifyTilesChanged(changeType == PACKAGES_DELETED); // we need to remove tiles only if packages were deleted
     }
@@ -118,7 +175,8 @@ namespace massif {
         // NOTE: ignore
     }
 
-    const unsigned int PackageManagerTileDataSource::MAX_OPEN_PACKAGES = 4;
+    // Deep enough to separate the packages along their borders, shallow enough to keep the index small
+    const int PackageManagerTileDataSource::MAX_INDEX_ZOOM = 10;
 
 }
 
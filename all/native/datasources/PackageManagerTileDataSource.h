@@ -13,6 +13,8 @@
 #include "datasources/TileDataSource.h"
 #include "packagemanager/PackageManager.h"
 
+#include <array>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -52,11 +54,28 @@ namespace massif {
             PackageManagerTileDataSource& _dataSource;
         };
 
-        static const unsigned int MAX_OPEN_PACKAGES;
+        struct PackageIndexNode {
+            std::vector<int> packageIndices; // candidate packages for the tiles under the node, in index package order
+            std::unique_ptr<std::array<PackageIndexNode, 4> > subNodes;
+        };
+
+        struct PackageIndex {
+            std::vector<std::pair<std::shared_ptr<PackageInfo>, std::shared_ptr<MapPackageHandler> > > packages;
+            PackageIndexNode rootNode;
+        };
+
+        std::shared_ptr<const PackageIndex> getPackageIndex(const std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> >& packageHandlerMap) const;
+
+        static std::shared_ptr<const PackageIndex> BuildPackageIndex(const std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> >& packageHandlerMap);
+        static void BuildPackageIndexNode(PackageIndexNode& node, const PackageIndex& index, const std::vector<int>& packageIndices, const MapTile& tile);
+        static const std::vector<int>& FindPackageIndices(const PackageIndex& index, const MapTile& tile);
+
+        static const int MAX_INDEX_ZOOM;
 
         const std::shared_ptr<PackageManager> _packageManager;
 
-        mutable std::vector<std::pair<std::shared_ptr<PackageInfo>, std::shared_ptr<MapPackageHandler> > > _cachedOpenPackageHandlers;
+        mutable std::shared_ptr<const PackageIndex> _packageIndex;
+        mutable int _packageIndexGeneration;
 
         mutable std::mutex _mutex;
 
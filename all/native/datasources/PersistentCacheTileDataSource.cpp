@@ -1,11 +1,20 @@
 #ifdef _MASSIF_OFFLINE_SUPPORT
 
 #include "PersistentCacheTileDataSource.h"
+#include "components/Exceptions.h"
 #include "core/BinaryData.h"
+#include "datasources/HTTPTileDataSource.h"
 #include "datasources/TileDownloadListener.h"
 #include "utils/Log.h"
 #include "utils/TileUtils.h"
 
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+
 #include <sqlite3pp.h>
 
 namespace massif {
@@ -13,11 +22,25 @@ namespace massif {
     PersistentCacheTileDataSource::PersistentCacheTileDataSource(const std::shared_ptr<TileDataSource>& dataSource, const std::string& databasePath) :
         CacheTileDataSource(dataSource),
         _database(),
+        _writeDatabase(),
         _cacheOnlyMode(false),
+        _downloadConcurrency(DEFAULT_DOWNLOAD_CONCURRENCY),
         _downloadTasks(),
         _downloadThreadPool(std::make_shared<CancelableThreadPool>()),
-        _cache(DEFAULT_CAPACITY),
-        _mutex()
+        _pendingLoads(),
+        _mutex(),
+        _capacity(DEFAULT_CAPACITY),
+        _totalSize(0),
+        _pendingWrites(),
+        _pendingWriteBytes(0),
+        _nextWriteSequence(0),
+        _pendingAccessTimes(),
+        _clearRequested(false),
+        _evictionRequested(false),
+        _writerStopped(true),
+        _writerThread(),
+        _writeMutex(),
+        _writeCondition()
     {
         _downloadThreadPool->setPoolSize(1);
         openDatabase(databasePath);
@@ -39,6 +62,20 @@ namespace massif {
         _cacheOnlyMode = enabled;
     }
 
+    int PersistentCacheTileDataSource::getDownloadConcurrency() const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        return _downloadConcurrency;
+    }
+
+    void PersistentCacheTileDataSource::setDownloadConcurrency(int concurrency) {
+        if (concurrency < 1) {
+            throw InvalidArgumentException("Download concurrency must be positive");
+        }
+
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        _downloadConcurrency = concurrency;
+    }
+
     void PersistentCacheTileDataSource::startDownloadArea(const MapBounds& mapBounds, int minZoom, int maxZoom, int fetchDelay, const std::shared_ptr<TileDownloadListener>& tileDownloadListener) {
         auto task = std::make_shared<DownloadTask>(std::static_pointer_cast<PersistentCacheTileDataSource>(shared_from_this()), mapBounds, minZoom, maxZoom, fetchDelay, tileDownloadListener);
         {
@@ -63,59 +100,145 @@ namespace massif {
     std::shared_ptr<TileData> PersistentCacheTileDataSource::loadTile(const MapTile& mapTile) {
         std::unique_lock<std::recursive_mutex> lock(_mutex);
         
-        Log::Infof("PersistentCacheTileDataSource::loadTile: Loading %s", mapTile.toString().c_str());
+        LOG_INFOF("PersistentCacheTileDataSource::loadTile: Loading %s", mapTile.toString().c_str());
         
         if (!_database) {
             Log::Error("PersistentCacheTileDataSource::loadTile: Could not connect to the database, loading tile without caching");
         }
 
-        if (_cache.empty()) {
-            loadTileInfo();
-        }
-        
-        std::shared_ptr<TileData> tileData;
-
-        std::shared_ptr<long long> tileIdPtr;
-        if (_cache.read(mapTile.getTileId(), tileIdPtr)) {
-            tileData = get(mapTile.getTileId());
-            if (tileData) {
-                if (tileData->getMaxAge() != 0) {
-                    std::map<std::string, std::shared_ptr<Variant>> metadata = _dataSource->buildTileMetadata(mapTile);
-                    for (const auto& entry : metadata) {
-                        tileData->setMetadata(entry.first, entry.second);
-                    }
-                    return tileData;
+        std::shared_ptr<TileData> tileData = get(mapTile.getTileId());
+        std::shared_ptr<TileData> expiredTileData; // kept for revalidating it instead of loading it again
+        if (tileData) {
+            if (tileData->getMaxAge() != 0) {
+                touch(mapTile.getTileId());
+                std::map<std::string, std::shared_ptr<Variant>> metadata = _dataSource->buildTileMetadata(mapTile);
+                for (const auto& entry : metadata) {
+                    tileData->setMetadata(entry.first, entry.second);
                 }
+                return tileData;
             }
-            _cache.remove(mapTile.getTileId());
+            remove(mapTile.getTileId());
+            expiredTileData = tileData;
         }
-        
-        if (!_cacheOnlyMode) {
+
+        if (_cacheOnlyMode) {
+            if (!tileData) {
+                LOG_INFOF("PersistentCacheTileDataSource::loadTile: Failed to load %s", mapTile.toString().c_str());
+            }
+            return tileData; // expired data is still better than nothing in cache only mode
+        }
+
+        // Single-flight: concurrent misses on the same tile share one download and one store.
+        // Only the first caller loads the tile, the others wait for its result.
+        long long tileId = mapTile.getTileId();
+        auto it = _pendingLoads.find(tileId);
+        if (it != _pendingLoads.end()) {
+            std::shared_future<std::shared_ptr<TileData> > future = it->second;
             lock.unlock();
-            tileData = _dataSource->loadTile(mapTile);
+            _coalescedLoadCount++;
+            return future.get();
+        }
+        std::promise<std::shared_ptr<TileData> > promise;
+        _pendingLoads[tileId] = promise.get_future().share();
+        lock.unlock();
+
+        try {
+            tileData = expiredTileData ? _dataSource->revalidateTile(mapTile, expiredTileData) : _dataSource->loadTile(mapTile);
             if (tileData) { // loading can fail (network errors), in which case there is nothing to annotate
                 std::map<std::string, std::shared_ptr<Variant>> metadata = _dataSource->buildTileMetadata(mapTile);
                 for (const auto& entry : metadata) {
                     tileData->setMetadata(entry.first, entry.second);
                 }
             }
+        }
+        catch (...) {
             lock.lock();
+            _pendingLoads.erase(tileId);
+            lock.unlock();
+            promise.set_value(std::shared_ptr<TileData>());
+            throw;
         }
-    
-        if (tileData) {
-            if (tileData->getMaxAge() != 0 && !tileData->isReplaceWithParent() && tileData->getData()) {
+
+        lock.lock();
+        storeTile(mapTile, tileData);
+        _pendingLoads.erase(tileId);
+        lock.unlock();
+
+        promise.set_value(tileData);
+        return tileData;
+    }
+
+    std::vector<std::shared_ptr<TileData> > PersistentCacheTileDataSource::loadTiles(const std::vector<MapTile>& mapTiles) {
+        if (!_dataSource->isBatchLoadSupported() || isCacheOnlyMode()) {
+            return TileDataSource::loadTiles(mapTiles);
+        }
+
+        // Claim the tiles that are neither cached nor already being loaded, so that concurrent
+        // single tile loads of the same tiles wait for this batch instead of loading them again.
+        std::vector<MapTile> missingTiles;
+        std::vector<std::promise<std::shared_ptr<TileData> > > promises;
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            for (const MapTile& mapTile : mapTiles) {
                 long long tileId = mapTile.getTileId();
-                std::size_t tileSize = tileData->getData()->size();
-                _cache.put(mapTile.getTileId(), createTileId(tileId), tileSize + EXTRA_TILE_FOOTPRINT);
-                if (_cache.exists(mapTile.getTileId())) { // make sure the tile was added
-                    store(mapTile.getTileId(), tileData);
+                if (exists(tileId) || _pendingLoads.find(tileId) != _pendingLoads.end()) {
+                    continue;
                 }
+                promises.emplace_back();
+                _pendingLoads[tileId] = promises.back().get_future().share();
+                missingTiles.push_back(mapTile);
             }
-        } else {
-            Log::Infof("PersistentCacheTileDataSource::loadTile: Failed to load %s", mapTile.toString().c_str());
         }
-        
-        return tileData;
+
+        std::vector<std::shared_ptr<TileData> > loadedTiles;
+        try {
+            if (!missingTiles.empty()) {
+                loadedTiles = _dataSource->loadTiles(missingTiles);
+            }
+            loadedTiles.resize(missingTiles.size());
+            for (std::size_t i = 0; i < missingTiles.size(); i++) {
+                if (loadedTiles[i]) {
+                    std::map<std::string, std::shared_ptr<Variant>> metadata = _dataSource->buildTileMetadata(missingTiles[i]);
+                    for (const auto& entry : metadata) {
+                        loadedTiles[i]->setMetadata(entry.first, entry.second);
+                    }
+                }
+            }
+        }
+        catch (...) {
+            {
+                std::lock_guard<std::recursive_mutex> lock(_mutex);
+                for (const MapTile& mapTile : missingTiles) {
+                    _pendingLoads.erase(mapTile.getTileId());
+                }
+            }
+            for (std::promise<std::shared_ptr<TileData> >& promise : promises) {
+                promise.set_value(std::shared_ptr<TileData>());
+            }
+            throw;
+        }
+
+        std::unordered_map<long long, std::shared_ptr<TileData> > loadedTileMap;
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            for (std::size_t i = 0; i < missingTiles.size(); i++) {
+                storeTile(missingTiles[i], loadedTiles[i]);
+                _pendingLoads.erase(missingTiles[i].getTileId());
+                loadedTileMap[missingTiles[i].getTileId()] = loadedTiles[i];
+            }
+        }
+        for (std::size_t i = 0; i < promises.size(); i++) {
+            promises[i].set_value(loadedTiles[i]);
+        }
+
+        // Everything else is either cached or pending in another load
+        std::vector<std::shared_ptr<TileData> > tileDatas;
+        tileDatas.reserve(mapTiles.size());
+        for (const MapTile& mapTile : mapTiles) {
+            auto it = loadedTileMap.find(mapTile.getTileId());
+            tileDatas.push_back(it != loadedTileMap.end() ? it->second : loadTile(mapTile));
+        }
+        return tileDatas;
     }
 
     bool PersistentCacheTileDataSource::isOpen() const {
@@ -128,26 +251,52 @@ namespace massif {
         closeDatabase();
     }
         
+        
     void PersistentCacheTileDataSource::clear() {
-        try {
-            std::lock_guard<std::recursive_mutex> lock(_mutex);
-            _cache.clear(); // forces all elements to be removed, but can be slow
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        if (!_database) {
+            return;
         }
-        catch (const std::exception& ex) {
-            Log::Errorf("PersistentCacheTileDataSource::clear: Failed to clear cache: %s", ex.what());
+
+        {
+            // Queued writes would only be deleted by the writer anyway
+            std::lock_guard<std::mutex> writeLock(_writeMutex);
+            _pendingWrites.clear();
+            _pendingWriteBytes = 0;
+            _pendingAccessTimes.clear();
+            _clearRequested = true;
         }
+        _writeCondition.notify_all();
+        flushWrites();
     }
     
     std::size_t PersistentCacheTileDataSource::getCapacity() const {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
-        return _cache.capacity();
+        std::lock_guard<std::mutex> writeLock(_writeMutex);
+        return _capacity;
     }
     
     void PersistentCacheTileDataSource::setCapacity(std::size_t capacityInBytes) {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
-        _cache.resize(capacityInBytes);
+        {
+            std::lock_guard<std::mutex> writeLock(_writeMutex);
+            _capacity = capacityInBytes;
+            _evictionRequested = true;
+        }
+        _writeCondition.notify_all();
     }
     
+    void PersistentCacheTileDataSource::storeTile(const MapTile& mapTile, const std::shared_ptr<TileData>& tileData) {
+        if (tileData) {
+            // In-memory tiles have no bytes to write: they stay with the source that generates them.
+            if (tileData->getMaxAge() != 0 && !tileData->isReplaceWithParent() && tileData->getData() && !tileData->getNativeTile()) {
+                if (tileData->getData()->size() + EXTRA_TILE_FOOTPRINT <= getCapacity()) { // a tile larger than the cache would be evicted right away
+                    store(mapTile.getTileId(), tileData);
+                }
+            }
+        } else {
+            LOG_INFOF("PersistentCacheTileDataSource::loadTile: Failed to load %s", mapTile.toString().c_str());
+        }
+    }
+
     void PersistentCacheTileDataSource::openDatabase(const std::string& databasePath) {
         try {
             _database = std::make_unique<sqlite3pp::database>(databasePath.c_str());
@@ -162,21 +311,68 @@ namespace massif {
             sqlite3pp::command command1(*_database, "PRAGMA page_size=4096");
             command1.execute();
             command1.finish();
+
+            // WAL lets the writer connection commit while tiles are read through this one,
+            // and with it NORMAL sync only loses the last commits on power loss, which is fine for a cache.
+            _database->execute("PRAGMA journal_mode=WAL");
+            _database->execute("PRAGMA synchronous=NORMAL");
             
             try {
+                // Only the columns are checked, reading rows here would make opening a large cache slow
                 sqlite3pp::query query1(*_database, "SELECT name FROM sqlite_master WHERE type='table' AND name='persistent_cache'");
                 for (auto it1 = query1.begin(); it1 != query1.end(); ++it1) {
-                    sqlite3pp::query query2(*_database, "SELECT expirationTime FROM persistent_cache");
+                    sqlite3pp::query query2(*_database, "SELECT expirationTime FROM persistent_cache LIMIT 1");
                     for (auto it2 = query2.begin(); it2 != query2.end(); ++it2);
                     query2.finish();
+
+                    try {
+                        sqlite3pp::query query3(*_database, "SELECT size, accessTime FROM persistent_cache LIMIT 1");
+                        query3.finish();
+                    }
+                    catch (const std::exception&) {
+                        // Databases from before access times were tracked are converted once
+                        Log::Info("PersistentCacheTileDataSource::openDatabase: Adding access times to database");
+                        sqlite3pp::command command1(*_database, "ALTER TABLE persistent_cache ADD COLUMN size INTEGER");
+                        command1.execute();
+                        command1.finish();
+                        sqlite3pp::command command2(*_database, "ALTER TABLE persistent_cache ADD COLUMN accessTime INTEGER");
+                        command2.execute();
+                        command2.finish();
+                        sqlite3pp::command command3(*_database, "UPDATE persistent_cache SET size=IFNULL(LENGTH(compressed), 0), accessTime=time");
+                        command3.execute();
+                        command3.finish();
+                        sqlite3pp::command command4(*_database, "DROP TABLE IF EXISTS persistent_cache_info");
+                        command4.execute();
+                        command4.finish();
+                    }
+
+                    try {
+                        sqlite3pp::query query4(*_database, "SELECT entityTag, lastModified FROM persistent_cache LIMIT 1");
+                        query4.finish();
+                    }
+                    catch (const std::exception&) {
+                        Log::Info("PersistentCacheTileDataSource::openDatabase: Adding validators to database");
+                        sqlite3pp::command command1(*_database, "ALTER TABLE persistent_cache ADD COLUMN entityTag TEXT");
+                        command1.execute();
+                        command1.finish();
+                        sqlite3pp::command command2(*_database, "ALTER TABLE persistent_cache ADD COLUMN lastModified TEXT");
+                        command2.execute();
+                        command2.finish();
+                    }
                 }
                 query1.finish();
             }
             catch (const std::exception&) {
                 Log::Info("PersistentCacheTileDataSource::openDatabase: Reinitializing database");
-                sqlite3pp::command command(*_database, "DROP TABLE IF EXISTS persistent_cache");
-                command.execute();
-                command.finish();
+                sqlite3pp::command command1(*_database, "DROP TABLE IF EXISTS persistent_cache");
+                command1.execute();
+                command1.finish();
+                sqlite3pp::command command2(*_database, "DROP TABLE IF EXISTS persistent_cache_info");
+                command2.execute();
+                command2.finish();
+                sqlite3pp::command command3(*_database, "DROP TABLE IF EXISTS persistent_cache_downloads");
+                command3.execute();
+                command3.finish();
             }
 
             sqlite3pp::command command3(*_database, R"SQL(
@@ -184,16 +380,52 @@ namespace massif {
                         tileId INTEGER NOT NULL PRIMARY KEY,
                         compressed BLOB,
                         time INTEGER,
-                        expirationTime INTEGER
+                        expirationTime INTEGER,
+                        size INTEGER,
+                        accessTime INTEGER,
+                        entityTag TEXT,
+                        lastModified TEXT
                     ))SQL");
             command3.execute();
             command3.finish();
+
+            sqlite3pp::command command4(*_database, "CREATE INDEX IF NOT EXISTS persistent_cache_accessTime ON persistent_cache(accessTime)");
+            command4.execute();
+            command4.finish();
+
+            sqlite3pp::command command5(*_database, "CREATE TABLE IF NOT EXISTS persistent_cache_info(name TEXT NOT NULL PRIMARY KEY, value INTEGER)");
+            command5.execute();
+            command5.finish();
+
+            sqlite3pp::command command6(*_database, "CREATE TABLE IF NOT EXISTS persistent_cache_downloads(area TEXT NOT NULL PRIMARY KEY, tileIndex INTEGER)");
+            command6.execute();
+            command6.finish();
         }
         catch (const std::exception& ex) {
             Log::Errorf("PersistentCacheTileDataSource::openDatabase: Failed to initialize database: %s", ex.what());
             _database.reset();
             return;
         }
+
+        if (!loadCacheInfo()) {
+            _database.reset();
+            return;
+        }
+
+        try {
+            _writeDatabase = std::make_unique<sqlite3pp::database>(databasePath.c_str());
+            _writeDatabase->execute("PRAGMA synchronous=NORMAL");
+            _writeDatabase->set_busy_timeout(BUSY_TIMEOUT);
+            _database->set_busy_timeout(BUSY_TIMEOUT);
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("PersistentCacheTileDataSource::openDatabase: Failed to open writer connection: %s", ex.what());
+            _writeDatabase.reset();
+            _database.reset();
+            return;
+        }
+
+        startWriter();
     }
 
     void PersistentCacheTileDataSource::closeDatabase() {
@@ -201,6 +433,19 @@ namespace massif {
             return;
         }
 
+        stopWriter(); // commits everything still queued
+
+        try {
+            if (_writeDatabase->disconnect() != SQLITE_OK) {
+                Log::Error("PersistentCacheTileDataSource::closeDatabase: Failed to close writer connection");
+            }
+            _writeDatabase.reset();
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("PersistentCacheTileDataSource::closeDatabase: Failed to close writer connection: %s", ex.what());
+            _writeDatabase.reset();
+        }
+
         try {
             if (_database->disconnect() != SQLITE_OK) {
                 Log::Error("PersistentCacheTileDataSource::closeDatabase: Failed to close database");
@@ -211,47 +456,61 @@ namespace massif {
             Log::Errorf("PersistentCacheTileDataSource::closeDatabase: Failed to close database: %s", ex.what());
             _database.reset();
         }
-
-        _cache.clear(); // NOTE: as the database is closed at this point, elements are not removed
     }
     
-    void PersistentCacheTileDataSource::loadTileInfo() {
-        struct TileInfo {
-            std::uint64_t tileId;
-            std::size_t tileSize;
-            std::uint64_t time;
-        };
+    bool PersistentCacheTileDataSource::loadCacheInfo() {
+        try {
+            if (ReadTotalSize(*_database, _totalSize)) {
+                return true;
+            }
 
+            // New or converted database: sum the tiles up once and keep the total from then on
+            sqlite3pp::query query(*_database, "SELECT COUNT(*), IFNULL(SUM(size), 0) FROM persistent_cache");
+            auto qit = query.begin();
+            _totalSize = (*qit).get<std::uint64_t>(0) * EXTRA_TILE_FOOTPRINT + (*qit).get<std::uint64_t>(1);
+            query.finish();
+
+            sqlite3pp::command command(*_database, "INSERT OR REPLACE INTO persistent_cache_info(name, value) VALUES ('totalSize', :value)");
+            command.bind(":value", static_cast<std::uint64_t>(_totalSize));
+            command.execute();
+            command.finish();
+            return true;
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("PersistentCacheTileDataSource::loadCacheInfo: Failed to query cache size from the database: %s", ex.what());
+            return false;
+        }
+    }
+
+    bool PersistentCacheTileDataSource::exists(long long tileId) {
         if (!_database) {
-            return;
+            return false;
         }
 
-        try {
-            // Get tile ids and sizes ordered by the timestamp from the database
-            std::vector<TileInfo> tileInfos;
-            tileInfos.reserve(_cache.capacity() / (EXTRA_TILE_FOOTPRINT + 1));
-            sqlite3pp::query query(*_database, "SELECT tileId, LENGTH(compressed), time FROM persistent_cache");
-            for (auto it = query.begin(); it != query.end(); ++it) {
-                TileInfo tileInfo;
-                tileInfo.tileId = (*it).get<std::uint64_t>(0);
-                tileInfo.tileSize = static_cast<std::size_t>((*it).get<std::uint64_t>(1));
-                tileInfo.time = (*it).get<std::uint64_t>(2);
-                tileInfos.push_back(tileInfo);
+        // Expired tiles count as missing, as they would be loaded again anyway
+        long long time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        {
+            std::lock_guard<std::mutex> writeLock(_writeMutex);
+            auto it = _pendingWrites.find(tileId);
+            if (it != _pendingWrites.end()) {
+                return it->second.data && (it->second.expirationTime == 0 || it->second.expirationTime > time);
             }
-            query.finish();
-
-            // Sort the tiles
-            std::sort(tileInfos.begin(), tileInfos.end(), [](const TileInfo& tileInfo1, const TileInfo& tileInfo2) {
-                return tileInfo1.time < tileInfo2.time;
-            });
+        }
 
-            // Now store the queried items in cache. This may result in eviction of some of the items.
-            for (const TileInfo& tileInfo : tileInfos) {
-                _cache.put(tileInfo.tileId, createTileId(tileInfo.tileId), tileInfo.tileSize + EXTRA_TILE_FOOTPRINT);
+        try {
+            sqlite3pp::query query(*_database, "SELECT expirationTime FROM persistent_cache WHERE tileId=:tileId");
+            query.bind(":tileId", static_cast<std::uint64_t>(tileId));
+            bool found = false;
+            for (auto qit = query.begin(); qit != query.end(); ++qit) {
+                long long expirationTime = (*qit).get<std::uint64_t>(0);
+                found = expirationTime == 0 || expirationTime > time;
             }
+            query.finish();
+            return found;
         }
         catch (const std::exception& ex) {
-            Log::Errorf("PersistentCacheTileDataSource::loadTileInfo: Failed to query tile set from the database: %s", ex.what());
+            Log::Errorf("PersistentCacheTileDataSource::exists: Failed to query tile from the database: %s", ex.what());
+            return false;
         }
     }
     
@@ -261,24 +520,53 @@ namespace massif {
         }
     
         try {
-            // Get the tile from the database
-            sqlite3pp::query query(*_database, "SELECT compressed, expirationTime FROM persistent_cache WHERE tileId=:tileId");
-            query.bind(":tileId", static_cast<std::uint64_t>(tileId));
-            auto qit = query.begin();
-            if (qit == query.end()) {
-                // No data exists for this tile in the database
-                Log::Error("PersistentCacheTileDataSource::get: Inconsistency, tile data does not exist in the database");
-                return std::shared_ptr<TileData>();
+            std::shared_ptr<BinaryData> data;
+            long long expirationTime = 0;
+            std::string entityTag;
+            std::string lastModified;
+            bool pending = false;
+            {
+                // Queued writes are newer than the table
+                std::lock_guard<std::mutex> writeLock(_writeMutex);
+                auto it = _pendingWrites.find(tileId);
+                if (it != _pendingWrites.end()) {
+                    if (!it->second.data) {
+                        return std::shared_ptr<TileData>();
+                    }
+                    data = it->second.data;
+                    expirationTime = it->second.expirationTime;
+                    entityTag = it->second.entityTag;
+                    lastModified = it->second.lastModified;
+                    pending = true;
+                }
+            }
+
+            if (!pending) {
+                // Get the tile from the database
+                sqlite3pp::query query(*_database, "SELECT compressed, expirationTime, entityTag, lastModified FROM persistent_cache WHERE tileId=:tileId");
+                query.bind(":tileId", static_cast<std::uint64_t>(tileId));
+                auto qit = query.begin();
+                if (qit == query.end()) {
+                    return std::shared_ptr<TileData>(); // not cached
+                }
+
+                // Construct TileData from the blob returned from the database
+                std::size_t dataSize = (*qit).column_bytes(0);
+                const unsigned char* dataPtr = static_cast<const unsigned char*>((*qit).get<const void*>(0));
+                expirationTime = (*qit).get<std::uint64_t>(1);
+                if ((*qit).column_type(2) != SQLITE_NULL) {
+                    entityTag = (*qit).get<const char*>(2);
+                }
+                if ((*qit).column_type(3) != SQLITE_NULL) {
+                    lastModified = (*qit).get<const char*>(3);
+                }
+                data = std::make_shared<BinaryData>(dataPtr, dataSize);
+                query.finish();
             }
-            
-            // Construct TileData from the blob returned from the database
-            std::size_t dataSize = (*qit).column_bytes(0);
-            const unsigned char* dataPtr = static_cast<const unsigned char*>((*qit).get<const void*>(0));
-            long long expirationTime = (*qit).get<std::uint64_t>(1);
-            auto data = std::make_shared<BinaryData>(dataPtr, dataSize);
-            query.finish();
             
             auto tileData = std::make_shared<TileData>(data);
+            tileData->setEntityTag(entityTag);
+            tileData->setLastModified(lastModified);
             if (expirationTime != 0) {
                 long long maxAge = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::time_point(std::chrono::milliseconds(expirationTime)) - std::chrono::system_clock::now()).count();
                 tileData->setMaxAge(maxAge > 0 ? maxAge : 0);
@@ -302,47 +590,330 @@ namespace massif {
             expirationTime = std::chrono::duration_cast<std::chrono::milliseconds>((std::chrono::system_clock::now() + std::chrono::milliseconds(tileData->getMaxAge())).time_since_epoch()).count();
         }
 
-        // Add tile to the database
+        // Queue the tile for the writer
+        enqueueWrite(tileId, PendingWrite { tileData->getData(), time, expirationTime, tileData->getEntityTag(), tileData->getLastModified(), 0 });
+    }
+
+    void PersistentCacheTileDataSource::remove(long long tileId) {
+        if (!_database) {
+            return;
+        }
+        
+        enqueueWrite(tileId, PendingWrite { std::shared_ptr<BinaryData>(), 0, 0, std::string(), std::string(), 0 });
+    }
+
+    void PersistentCacheTileDataSource::touch(long long tileId) {
+        if (!_database) {
+            return;
+        }
+
+        long long time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        {
+            std::lock_guard<std::mutex> writeLock(_writeMutex);
+            if (_writerStopped) {
+                return;
+            }
+            _pendingAccessTimes[tileId] = time;
+        }
+        _writeCondition.notify_all();
+    }
+
+    void PersistentCacheTileDataSource::startWriter() {
+        {
+            std::lock_guard<std::mutex> writeLock(_writeMutex);
+            _writerStopped = false;
+        }
+        _writerThread = std::thread(&PersistentCacheTileDataSource::writerLoop, this);
+    }
+
+    void PersistentCacheTileDataSource::stopWriter() {
+        {
+            std::lock_guard<std::mutex> writeLock(_writeMutex);
+            _writerStopped = true;
+        }
+        _writeCondition.notify_all();
+        if (_writerThread.joinable()) {
+            _writerThread.join();
+        }
+    }
+
+    void PersistentCacheTileDataSource::flushWrites() {
+        std::unique_lock<std::mutex> writeLock(_writeMutex);
+        _writeCondition.wait(writeLock, [this] {
+            return (_pendingWrites.empty() && _pendingAccessTimes.empty() && !_clearRequested) || _writerStopped;
+        });
+    }
+
+    void PersistentCacheTileDataSource::flushQueuedWrites() {
+        // Unlike flushWrites, writes queued meanwhile are not waited for, so concurrent stores can not hold this up
+        std::unique_lock<std::mutex> writeLock(_writeMutex);
+        std::uint64_t sequence = _nextWriteSequence;
+        _writeCondition.wait(writeLock, [this, sequence] {
+            if (_writerStopped) {
+                return true;
+            }
+            for (const std::pair<const long long, PendingWrite>& entry : _pendingWrites) {
+                if (entry.second.sequence <= sequence) {
+                    return false;
+                }
+            }
+            return true;
+        });
+    }
+
+    void PersistentCacheTileDataSource::enqueueWrite(long long tileId, PendingWrite pendingWrite) {
+        std::size_t dataSize = pendingWrite.data ? pendingWrite.data->size() : 0;
+        {
+            std::unique_lock<std::mutex> writeLock(_writeMutex);
+            if (_writerStopped) {
+                return;
+            }
+
+            // Back-pressure: wait for the writer instead of growing the queue past its budget
+            _writeCondition.wait(writeLock, [this, dataSize] {
+                return _pendingWriteBytes == 0 || _pendingWriteBytes + dataSize <= MAX_PENDING_WRITE_BYTES || _writerStopped;
+            });
+
+            pendingWrite.sequence = ++_nextWriteSequence;
+            auto it = _pendingWrites.find(tileId);
+            if (it != _pendingWrites.end()) {
+                _pendingWriteBytes -= it->second.data ? it->second.data->size() : 0;
+                it->second = std::move(pendingWrite);
+            } else {
+                _pendingWrites.emplace(tileId, std::move(pendingWrite));
+            }
+            _pendingWriteBytes += dataSize;
+        }
+        _writeCondition.notify_all();
+    }
+
+    void PersistentCacheTileDataSource::writerLoop() {
+        std::vector<std::pair<long long, PendingWrite> > batch;
+        std::unordered_map<long long, long long> accessTimes;
+        while (true) {
+            bool clearAll = false;
+            bool evict = false;
+            std::size_t capacity = 0;
+            batch.clear();
+            accessTimes.clear();
+            {
+                std::unique_lock<std::mutex> writeLock(_writeMutex);
+                _writeCondition.wait(writeLock, [this] {
+                    return !_pendingWrites.empty() || !_pendingAccessTimes.empty() || _clearRequested || _evictionRequested || _writerStopped;
+                });
+                if (_pendingWrites.empty() && _pendingAccessTimes.empty() && !_clearRequested && !_evictionRequested) {
+                    break; // stopped and fully flushed
+                }
+
+                // Entries are copied, not taken, so that readers still find them until they are committed
+                for (auto it = _pendingWrites.begin(); it != _pendingWrites.end() && batch.size() < MAX_WRITE_BATCH_SIZE; it++) {
+                    batch.push_back(*it);
+                }
+                std::swap(accessTimes, _pendingAccessTimes);
+                clearAll = _clearRequested;
+                evict = _evictionRequested || !batch.empty();
+                _evictionRequested = false;
+                capacity = _capacity;
+            }
+
+            std::size_t totalSize = _totalSize;
+            try {
+                _writeDatabase->execute("BEGIN");
+
+                if (clearAll) {
+                    sqlite3pp::command command(*_writeDatabase, "DELETE FROM persistent_cache");
+                    command.execute();
+                    command.finish();
+                    totalSize = 0;
+                }
+
+                // Replaced and removed tiles are looked up first, so that the total size stays exact
+                sqlite3pp::query sizeQuery(*_writeDatabase, "SELECT size FROM persistent_cache WHERE tileId=:tileId");
+                sqlite3pp::command storeCommand(*_writeDatabase, "INSERT OR REPLACE INTO persistent_cache(tileId, compressed, time, expirationTime, size, accessTime, entityTag, lastModified) VALUES (:tileId, :compressed, :time, :expirationTime, :size, :time, :entityTag, :lastModified)");
+                sqlite3pp::command removeCommand(*_writeDatabase, "DELETE FROM persistent_cache WHERE tileId=:tileId");
+                for (const std::pair<long long, PendingWrite>& entry : batch) {
+                    const PendingWrite& pendingWrite = entry.second;
+                    sizeQuery.bind(":tileId", static_cast<std::uint64_t>(entry.first));
+                    for (auto qit = sizeQuery.begin(); qit != sizeQuery.end(); ++qit) {
+                        totalSize -= std::min(totalSize, static_cast<std::size_t>((*qit).get<std::uint64_t>(0)) + EXTRA_TILE_FOOTPRINT);
+                    }
+                    sizeQuery.reset();
+
+                    if (pendingWrite.data) {
+                        storeCommand.bind(":tileId", static_cast<std::uint64_t>(entry.first));
+                        storeCommand.bind(":compressed", pendingWrite.data->data(), static_cast<unsigned int>(pendingWrite.data->size()));
+                        storeCommand.bind(":time", static_cast<std::uint64_t>(pendingWrite.time));
+                        storeCommand.bind(":expirationTime", static_cast<std::uint64_t>(pendingWrite.expirationTime));
+                        storeCommand.bind(":size", static_cast<std::uint64_t>(pendingWrite.data->size()));
+                        if (!pendingWrite.entityTag.empty()) {
+                            storeCommand.bind(":entityTag", pendingWrite.entityTag.c_str());
+                        } else {
+                            storeCommand.bind(":entityTag");
+                        }
+                        if (!pendingWrite.lastModified.empty()) {
+                            storeCommand.bind(":lastModified", pendingWrite.lastModified.c_str());
+                        } else {
+                            storeCommand.bind(":lastModified");
+                        }
+                        storeCommand.execute();
+                        storeCommand.reset();
+                        totalSize += pendingWrite.data->size() + EXTRA_TILE_FOOTPRINT;
+                    } else {
+                        removeCommand.bind(":tileId", static_cast<std::uint64_t>(entry.first));
+                        removeCommand.execute();
+                        removeCommand.reset();
+                    }
+                }
+                sizeQuery.finish();
+                storeCommand.finish();
+                removeCommand.finish();
+
+                sqlite3pp::command touchCommand(*_writeDatabase, "UPDATE persistent_cache SET accessTime=:accessTime WHERE tileId=:tileId");
+                for (const std::pair<const long long, long long>& entry : accessTimes) {
+                    touchCommand.bind(":accessTime", static_cast<std::uint64_t>(entry.second));
+                    touchCommand.bind(":tileId", static_cast<std::uint64_t>(entry.first));
+                    touchCommand.execute();
+                    touchCommand.reset();
+                }
+                touchCommand.finish();
+
+                // Evict the least recently accessed tiles until the cache fits its capacity again
+                while (evict && totalSize > capacity) {
+                    std::vector<std::pair<long long, std::size_t> > evictedTiles;
+                    sqlite3pp::query evictQuery(*_writeDatabase, "SELECT tileId, size FROM persistent_cache ORDER BY accessTime LIMIT :count");
+                    evictQuery.bind(":count", static_cast<std::uint64_t>(MAX_EVICTION_BATCH_SIZE));
+                    for (auto qit = evictQuery.begin(); qit != evictQuery.end() && totalSize > capacity; ++qit) {
+                        std::size_t tileSize = static_cast<std::size_t>((*qit).get<std::uint64_t>(1)) + EXTRA_TILE_FOOTPRINT;
+                        evictedTiles.emplace_back((*qit).get<std::uint64_t>(0), tileSize);
+                        totalSize -= std::min(totalSize, tileSize);
+                    }
+                    evictQuery.finish();
+                    if (evictedTiles.empty()) {
+                        totalSize = 0; // the table is empty, whatever the total said
+                        break;
+                    }
+
+                    sqlite3pp::command evictCommand(*_writeDatabase, "DELETE FROM persistent_cache WHERE tileId=:tileId");
+                    for (const std::pair<long long, std::size_t>& evictedTile : evictedTiles) {
+                        evictCommand.bind(":tileId", static_cast<std::uint64_t>(evictedTile.first));
+                        evictCommand.execute();
+                        evictCommand.reset();
+                    }
+                    evictCommand.finish();
+                }
+
+                sqlite3pp::command infoCommand(*_writeDatabase, "INSERT OR REPLACE INTO persistent_cache_info(name, value) VALUES ('totalSize', :value)");
+                infoCommand.bind(":value", static_cast<std::uint64_t>(totalSize));
+                infoCommand.execute();
+                infoCommand.finish();
+
+                if (_writeDatabase->execute("COMMIT") == SQLITE_OK) {
+                    _totalSize = totalSize;
+                } else {
+                    Log::Errorf("PersistentCacheTileDataSource::writerLoop: Failed to commit %d tiles: %s", static_cast<int>(batch.size()), _writeDatabase->error_msg());
+                    _writeDatabase->execute("ROLLBACK");
+                }
+            }
+            catch (const std::exception& ex) {
+                Log::Errorf("PersistentCacheTileDataSource::writerLoop: Failed to write tiles to the database: %s", ex.what());
+                _writeDatabase->execute("ROLLBACK");
+            }
+
+            // Failed writes are dropped too, retrying them would only stall the queue
+            {
+                std::lock_guard<std::mutex> writeLock(_writeMutex);
+                for (const std::pair<long long, PendingWrite>& entry : batch) {
+                    auto it = _pendingWrites.find(entry.first);
+                    if (it != _pendingWrites.end() && it->second.sequence == entry.second.sequence) {
+                        _pendingWriteBytes -= it->second.data ? it->second.data->size() : 0;
+                        _pendingWrites.erase(it);
+                    }
+                }
+                if (clearAll) {
+                    _clearRequested = false;
+                }
+            }
+            _writeCondition.notify_all();
+        }
+    }
+
+    std::uint64_t PersistentCacheTileDataSource::loadDownloadCursor(const std::string& area) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        if (!_database) {
+            return 0;
+        }
+
         try {
-            sqlite3pp::command command(*_database, "INSERT OR REPLACE INTO persistent_cache(tileId, compressed, time, expirationTime) VALUES (:tileId, :compressed, :time, :expirationTime)");
-            command.bind(":tileId", static_cast<std::uint64_t>(tileId));
-            command.bind(":compressed", tileData->getData()->data(), static_cast<unsigned int>(tileData->getData()->size()));
-            command.bind(":time", static_cast<std::uint64_t>(time));
-            command.bind(":expirationTime", static_cast<std::uint64_t>(expirationTime));
+            std::uint64_t tileIndex = 0;
+            sqlite3pp::query query(*_database, "SELECT tileIndex FROM persistent_cache_downloads WHERE area=:area");
+            query.bind(":area", area.c_str());
+            for (auto qit = query.begin(); qit != query.end(); ++qit) {
+                tileIndex = (*qit).get<std::uint64_t>(0);
+            }
+            query.finish();
+            return tileIndex;
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("PersistentCacheTileDataSource::loadDownloadCursor: Failed to query download progress: %s", ex.what());
+            return 0;
+        }
+    }
+
+    void PersistentCacheTileDataSource::saveDownloadCursor(const std::string& area, std::uint64_t tileIndex) {
+        // The cursor must not get ahead of the tiles it covers. They were all queued before this call.
+        flushQueuedWrites();
+
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        if (!_database) {
+            return;
+        }
+
+        try {
+            sqlite3pp::command command(*_database, "INSERT OR REPLACE INTO persistent_cache_downloads(area, tileIndex) VALUES (:area, :tileIndex)");
+            command.bind(":area", area.c_str());
+            command.bind(":tileIndex", tileIndex);
             command.execute();
             command.finish();
         }
         catch (const std::exception& ex) {
-            Log::Errorf("PersistentCacheTileDataSource::store: Failed to store tile data in the database: %s", ex.what());
+            Log::Errorf("PersistentCacheTileDataSource::saveDownloadCursor: Failed to store download progress: %s", ex.what());
         }
     }
 
-    void PersistentCacheTileDataSource::remove(long long tileId) {
+    std::string PersistentCacheTileDataSource::getSourceId() const {
+        std::shared_ptr<TileDataSource> dataSource = _dataSource.get();
+        if (auto httpDataSource = std::dynamic_pointer_cast<HTTPTileDataSource>(dataSource)) {
+            return httpDataSource->getBaseURL();
+        }
+        return typeid(*dataSource).name();
+    }
+
+    void PersistentCacheTileDataSource::deleteDownloadCursor(const std::string& area) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
         if (!_database) {
             return;
         }
-        
+
         try {
-            sqlite3pp::command command(*_database, "DELETE FROM persistent_cache WHERE tileId=:tileId");
-            command.bind(":tileId", static_cast<std::uint64_t>(tileId));
+            sqlite3pp::command command(*_database, "DELETE FROM persistent_cache_downloads WHERE area=:area");
+            command.bind(":area", area.c_str());
             command.execute();
             command.finish();
         }
         catch (const std::exception& ex) {
-            Log::Errorf("PersistentCacheTileDataSource::remove: Failed to remove tile from the database: %s", ex.what());
+            Log::Errorf("PersistentCacheTileDataSource::deleteDownloadCursor: Failed to delete download progress: %s", ex.what());
         }
     }
-    
-    std::shared_ptr<long long> PersistentCacheTileDataSource::createTileId(long long tileId) {
-        std::weak_ptr<PersistentCacheTileDataSource> cacheWeak(std::static_pointer_cast<PersistentCacheTileDataSource>(shared_from_this()));
-        auto tileIdDeleter = [cacheWeak](long long* tileIdPtr) {
-            std::unique_ptr<long long> tileId(tileIdPtr);
-            if (auto cache = cacheWeak.lock()) {
-                std::lock_guard<std::recursive_mutex> lock(cache->_mutex); // probably not needed, as this gets called from already locked state
-                cache->remove(*tileId);
-            }
-        };
-        return std::shared_ptr<long long>(new long long(tileId), tileIdDeleter);
+
+    bool PersistentCacheTileDataSource::ReadTotalSize(sqlite3pp::database& database, std::size_t& totalSize) {
+        sqlite3pp::query query(database, "SELECT value FROM persistent_cache_info WHERE name='totalSize'");
+        auto qit = query.begin();
+        if (qit == query.end()) {
+            return false;
+        }
+        totalSize = static_cast<std::size_t>((*qit).get<std::uint64_t>(0));
+        query.finish();
+        return true;
     }
 
     PersistentCacheTileDataSource::DownloadTask::DownloadTask(const std::shared_ptr<PersistentCacheTileDataSource>& dataSource, const MapBounds& mapBounds, int minZoom, int maxZoom, int fetchDelay, const std::shared_ptr<TileDownloadListener>& listener) :
@@ -350,8 +921,19 @@ namespace massif {
         _mapBounds(mapBounds),
         _minZoom(minZoom),
         _maxZoom(maxZoom),
+        _fetchDelay(fetchDelay),
         _downloadListener(listener),
-        _fetchDelay(fetchDelay)
+        _zoomRanges(),
+        _tileCount(0),
+        _area(),
+        _nextTileIndex(0),
+        _progressMutex(),
+        _completedTileCount(0),
+        _cursorTileIndex(0),
+        _savedCursorTileIndex(0),
+        _completedChunks(),
+        _cursorMutex(),
+        _storedCursorTileIndex(0)
     {
     }
     
@@ -359,6 +941,8 @@ namespace massif {
         std::shared_ptr<Projection> projection;
         int minZoom = _minZoom;
         int maxZoom = _maxZoom;
+        int concurrency = 1;
+        std::string sourceId;
         if (auto dataSource = _dataSource.lock()) {
             if (!dataSource->isOpen()) {
                 Log::Warn("PersistentCacheTileDataSource::DownloadTask: Database is not open, skipping download");
@@ -367,72 +951,79 @@ namespace massif {
             projection = dataSource->getProjection();
             minZoom = std::max(minZoom, dataSource->getMinZoom());
             maxZoom = std::min(maxZoom, dataSource->getMaxZoom());
+            concurrency = dataSource->getDownloadConcurrency();
+            sourceId = dataSource->getSourceId();
         } else {
             Log::Info("PersistentCacheTileDataSource::DownloadTask: Download cancelled due to lost datasource");
             return;
         }
 
-        std::uint64_t tileCount = 0;
+        _tileCount = 0;
         for (int zoom = minZoom; zoom <= maxZoom; zoom++) {
             MapTile mapTile1 = TileUtils::CalculateClippedMapTile(_mapBounds.getMin(), zoom, projection);
             MapTile mapTile2 = TileUtils::CalculateClippedMapTile(_mapBounds.getMax(), zoom, projection);
-            std::uint64_t dx = std::abs(mapTile1.getX() - mapTile2.getX()) + 1;
-            std::uint64_t dy = std::abs(mapTile1.getY() - mapTile2.getY()) + 1;
-            tileCount += dx * dy;
+            ZoomRange zoomRange;
+            zoomRange.zoom = zoom;
+            zoomRange.minX = std::min(mapTile1.getX(), mapTile2.getX());
+            zoomRange.maxX = std::max(mapTile1.getX(), mapTile2.getX());
+            zoomRange.minY = std::min(mapTile1.getY(), mapTile2.getY());
+            zoomRange.maxY = std::max(mapTile1.getY(), mapTile2.getY());
+            zoomRange.firstTileIndex = _tileCount;
+            _zoomRanges.push_back(zoomRange);
+            _tileCount += static_cast<std::uint64_t>(zoomRange.maxX - zoomRange.minX + 1) * static_cast<std::uint64_t>(zoomRange.maxY - zoomRange.minY + 1);
         }
 
-        Log::Infof("PersistentCacheTileDataSource::DownloadTask: Starting to download %d tiles", static_cast<int>(tileCount));
+        // The same area at the same zooms numbers its tiles the same way, so its saved cursor can be reused.
+        // The source is part of the key, as sources caching into the same database do not share their tiles.
+        std::stringstream ss;
+        ss << sourceId << ";" << std::setprecision(17) << _mapBounds.getMin().getX() << "," << _mapBounds.getMin().getY() << "," << _mapBounds.getMax().getX() << "," << _mapBounds.getMax().getY() << "," << minZoom << "," << maxZoom;
+        _area = ss.str();
 
-        if (_downloadListener) {
-            _downloadListener->onDownloadStarting(static_cast<int>(tileCount));
+        std::uint64_t firstTileIndex = 0;
+        if (auto dataSource = _dataSource.lock()) {
+            firstTileIndex = std::min(dataSource->loadDownloadCursor(_area), _tileCount);
         }
+        _nextTileIndex = firstTileIndex;
+        _completedTileCount = firstTileIndex;
+        _cursorTileIndex = firstTileIndex;
+        _savedCursorTileIndex = firstTileIndex;
+        _storedCursorTileIndex = firstTileIndex;
 
-        std::uint64_t tileIndex = 0;
-        for (int zoom = minZoom; zoom <= maxZoom; zoom++) {
-            MapTile mapTile1 = TileUtils::CalculateClippedMapTile(_mapBounds.getMin(), zoom, projection);
-            MapTile mapTile2 = TileUtils::CalculateClippedMapTile(_mapBounds.getMax(), zoom, projection);
-            for (int y = std::min(mapTile1.getY(), mapTile2.getY()); y <= std::max(mapTile1.getY(), mapTile2.getY()); y++) {
-                if (isCanceled()) {
-                    break;
-                }
-
-                for (int x = std::min(mapTile1.getX(), mapTile2.getX()); x <= std::max(mapTile1.getX(), mapTile2.getX()); x++) {
-                    if (isCanceled()) {
-                        break;
-                    }
-
-                    if (_downloadListener) {
-                        _downloadListener->onDownloadProgress(static_cast<float>(100.0 * tileIndex / tileCount));
-                    }
+        if (firstTileIndex > 0) {
+            LOG_INFOF("PersistentCacheTileDataSource::DownloadTask: Resuming download of %d tiles from tile %d", static_cast<int>(_tileCount), static_cast<int>(firstTileIndex));
+        } else {
+            LOG_INFOF("PersistentCacheTileDataSource::DownloadTask: Starting to download %d tiles", static_cast<int>(_tileCount));
+        }
 
-                    MapTile mapTile(x, y, zoom, 0);
-                    std::shared_ptr<TileData> tileData;
-                    if (auto dataSource = _dataSource.lock()) {
-                        tileData = dataSource->loadTile(mapTile.getFlipped());
-                    } else {
-                        cancel();
-                        break;
-                    }
-                    tileIndex++;
+        if (_downloadListener) {
+            _downloadListener->onDownloadStarting(static_cast<int>(_tileCount));
+        }
 
-                    if (!tileData && _downloadListener) {
-                        _downloadListener->onDownloadFailed(mapTile);
-                    }
-                    if (_fetchDelay > 0) {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(_fetchDelay));
-                    }
-                }
-            }
+        std::vector<std::thread> threads;
+        for (int i = 1; i < concurrency; i++) {
+            threads.emplace_back(&DownloadTask::downloadTiles, this);
+        }
+        downloadTiles();
+        for (std::thread& thread : threads) {
+            thread.join();
         }
 
+        bool completed = _completedTileCount == _tileCount;
         if (auto dataSource = _dataSource.lock()) {
+            if (completed) {
+                dataSource->deleteDownloadCursor(_area);
+            } else {
+                saveCursor(_cursorTileIndex);
+            }
+
+            std::lock_guard<std::recursive_mutex> lock(dataSource->_mutex);
             dataSource->_downloadTasks.erase(std::static_pointer_cast<DownloadTask>(shared_from_this()));
         } else {
             Log::Info("PersistentCacheTileDataSource::DownloadTask: Download cancelled due to lost datasource");
             return;
         }
 
-        if (tileIndex == tileCount) {
+        if (completed) {
             if (_downloadListener) {
                 _downloadListener->onDownloadProgress(100.0f);
                 _downloadListener->onDownloadCompleted();
@@ -443,8 +1034,105 @@ namespace massif {
         }
     }
 
+    MapTile PersistentCacheTileDataSource::DownloadTask::getMapTile(std::uint64_t tileIndex) const {
+        auto it = std::upper_bound(_zoomRanges.begin(), _zoomRanges.end(), tileIndex, [](std::uint64_t tileIndex, const ZoomRange& zoomRange) {
+            return tileIndex < zoomRange.firstTileIndex;
+        });
+        const ZoomRange& zoomRange = *(--it);
+        std::uint64_t width = zoomRange.maxX - zoomRange.minX + 1;
+        std::uint64_t offset = tileIndex - zoomRange.firstTileIndex;
+        return MapTile(zoomRange.minX + static_cast<int>(offset % width), zoomRange.minY + static_cast<int>(offset / width), zoomRange.zoom, 0);
+    }
+
+    void PersistentCacheTileDataSource::DownloadTask::downloadTiles() {
+        std::vector<MapTile> missingTiles;
+        std::vector<MapTile> failedTiles;
+        while (!isCanceled()) {
+            std::uint64_t firstTileIndex = _nextTileIndex.fetch_add(DOWNLOAD_CHUNK_SIZE);
+            if (firstTileIndex >= _tileCount) {
+                break;
+            }
+            std::uint64_t tileCount = std::min(static_cast<std::uint64_t>(DOWNLOAD_CHUNK_SIZE), _tileCount - firstTileIndex);
+
+            missingTiles.clear();
+            failedTiles.clear();
+            if (auto dataSource = _dataSource.lock()) {
+                {
+                    std::lock_guard<std::recursive_mutex> lock(dataSource->_mutex);
+                    for (std::uint64_t i = 0; i < tileCount; i++) {
+                        MapTile mapTile = getMapTile(firstTileIndex + i).getFlipped();
+                        if (!dataSource->exists(mapTile.getTileId())) {
+                            missingTiles.push_back(mapTile);
+                        }
+                    }
+                }
+
+                if (!missingTiles.empty()) {
+                    std::vector<std::shared_ptr<TileData> > tileDatas = dataSource->loadTiles(missingTiles);
+                    for (std::size_t i = 0; i < missingTiles.size(); i++) {
+                        if (i >= tileDatas.size() || !tileDatas[i]) {
+                            failedTiles.push_back(missingTiles[i].getFlipped());
+                        }
+                    }
+                }
+            } else {
+                cancel();
+                break;
+            }
+
+            completeTiles(firstTileIndex, tileCount, failedTiles);
+
+            if (_fetchDelay > 0 && !missingTiles.empty()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(_fetchDelay * missingTiles.size()));
+            }
+        }
+    }
+
+    void PersistentCacheTileDataSource::DownloadTask::completeTiles(std::uint64_t firstTileIndex, std::uint64_t tileCount, const std::vector<MapTile>& failedTiles) {
+        std::unique_lock<std::mutex> lock(_progressMutex);
+
+        // Chunks finish out of order, the cursor only passes chunks that are all done
+        _completedTileCount += tileCount;
+        _completedChunks[firstTileIndex] = tileCount;
+        for (auto it = _completedChunks.begin(); it != _completedChunks.end() && it->first == _cursorTileIndex; it = _completedChunks.erase(it)) {
+            _cursorTileIndex += it->second;
+        }
+
+        if (_downloadListener) {
+            for (const MapTile& mapTile : failedTiles) {
+                _downloadListener->onDownloadFailed(mapTile);
+            }
+            _downloadListener->onDownloadProgress(static_cast<float>(100.0 * _completedTileCount / _tileCount));
+        }
+
+        if (_cursorTileIndex >= _savedCursorTileIndex + DOWNLOAD_CURSOR_INTERVAL && _cursorTileIndex < _tileCount) {
+            std::uint64_t cursorTileIndex = _cursorTileIndex;
+            _savedCursorTileIndex = cursorTileIndex;
+            lock.unlock(); // saving waits for the tile writes, the other workers keep going meanwhile
+            saveCursor(cursorTileIndex);
+        }
+    }
+
+    void PersistentCacheTileDataSource::DownloadTask::saveCursor(std::uint64_t tileIndex) {
+        std::lock_guard<std::mutex> lock(_cursorMutex);
+        if (tileIndex <= _storedCursorTileIndex) {
+            return; // a later cursor was saved meanwhile
+        }
+        if (auto dataSource = _dataSource.lock()) {
+            dataSource->saveDownloadCursor(_area, tileIndex);
+            _storedCursorTileIndex = tileIndex;
+        }
+    }
+
     const unsigned int PersistentCacheTileDataSource::DEFAULT_CAPACITY = 50 * 1024 * 1024;
     const unsigned int PersistentCacheTileDataSource::EXTRA_TILE_FOOTPRINT = 1024;
+    const std::size_t PersistentCacheTileDataSource::MAX_PENDING_WRITE_BYTES = 8 * 1024 * 1024;
+    const std::size_t PersistentCacheTileDataSource::MAX_WRITE_BATCH_SIZE = 256;
+    const std::size_t PersistentCacheTileDataSource::MAX_EVICTION_BATCH_SIZE = 256;
+    const int PersistentCacheTileDataSource::BUSY_TIMEOUT = 5000;
+    const int PersistentCacheTileDataSource::DEFAULT_DOWNLOAD_CONCURRENCY = 4;
+    const std::size_t PersistentCacheTileDataSource::DOWNLOAD_CHUNK_SIZE = 16;
+    const std::size_t PersistentCacheTileDataSource::DOWNLOAD_CURSOR_INTERVAL = 1024;
 
 }
 
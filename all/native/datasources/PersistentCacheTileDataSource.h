@@ -14,18 +14,25 @@
 #include "components/DirectorPtr.h"
 #include "datasources/CacheTileDataSource.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <map>
 #include <mutex>
 #include <memory>
 #include <string>
 #include <set>
-
-#include <stdext/timed_lru_cache.h>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace sqlite3pp {
     class database;
 }
 
 namespace massif {
+    class BinaryData;
     class TileDownloadListener;
 
     /**
@@ -34,8 +41,17 @@ namespace massif {
      * even after the application is closed.
      * The database contains table "persistent_cache" with the following fields:
      * "tileId" (tile id), "compressed" (compressed tile image),
-     * "time" (the time the tile was cached in milliseconds from epoch).
+     * "time" (the time the tile was cached in milliseconds from epoch),
+     * "size" (the size of the compressed tile), "accessTime" (the time the tile was last read),
+     * "entityTag" and "lastModified" (the validators the tile was served with, for revalidating it once expired).
+     * The total size of the tiles is kept in table "persistent_cache_info", so opening
+     * the database does not depend on the number of cached tiles.
      * Default cache capacity is 50MB.
+     * Writes to the database are queued and committed in batches by a background writer,
+     * which also evicts the least recently read tiles once the capacity is exceeded.
+     * The queue is flushed when the database is closed.
+     * Area downloads record their progress in table "persistent_cache_downloads", so that
+     * an interrupted download of the same area resumes where it stopped.
      */
     class PersistentCacheTileDataSource : public CacheTileDataSource {
     public:
@@ -62,8 +78,22 @@ namespace massif {
          */
         void setCacheOnlyMode(bool enabled);
 
+        /**
+         * Returns the number of tile requests an area download keeps in flight.
+         * @return The number of concurrent tile requests of area downloads.
+         */
+        int getDownloadConcurrency() const;
+        /**
+         * Sets the number of tile requests an area download keeps in flight.
+         * The change applies to downloads started afterwards. The default is 4.
+         * @param concurrency The number of concurrent tile requests, must be positive.
+         */
+        void setDownloadConcurrency(int concurrency);
+
         /**
          * Starts downloading the specified area. The area will be stored in the cache.
+         * Tiles that are already cached and not expired are skipped. If a download of the same area
+         * was interrupted earlier, it resumes from where it stopped.
          * Note that is the area is too big or cache is already filled, subsequent downloaded tiles
          * may push existing tile out of the cache.
          * @param mapBounds The bounds of the area to download. The coordinate system of the bounds must be the same as specified in the data source projection.
@@ -91,6 +121,10 @@ namespace massif {
         void close();
 
         virtual std::shared_ptr<TileData> loadTile(const MapTile& mapTile);
+
+#ifndef SWIG
+        virtual std::vector<std::shared_ptr<TileData> > loadTiles(const std::vector<MapTile>& mapTiles);
+#endif
         
         virtual void clear();
         
@@ -106,38 +140,121 @@ namespace massif {
             virtual void run();
     
         private:
+            struct ZoomRange {
+                int zoom;
+                int minX;
+                int maxX;
+                int minY;
+                int maxY;
+                std::uint64_t firstTileIndex;
+            };
+
+            MapTile getMapTile(std::uint64_t tileIndex) const;
+            void downloadTiles();
+            void completeTiles(std::uint64_t firstTileIndex, std::uint64_t tileCount, const std::vector<MapTile>& failedTiles);
+            void saveCursor(std::uint64_t tileIndex);
+
             std::weak_ptr<PersistentCacheTileDataSource> _dataSource;
             MapBounds _mapBounds;
             int _minZoom;
             int _maxZoom;
             int _fetchDelay;
             DirectorPtr<TileDownloadListener> _downloadListener;
+
+            // Tiles are numbered by zoom, row and column; workers claim them in chunks of consecutive indices.
+            std::vector<ZoomRange> _zoomRanges;
+            std::uint64_t _tileCount;
+            std::string _area;
+            std::atomic<std::uint64_t> _nextTileIndex;
+
+            std::mutex _progressMutex;
+            std::uint64_t _completedTileCount;
+            std::uint64_t _cursorTileIndex; // all tiles before this are done
+            std::uint64_t _savedCursorTileIndex; // last cursor handed to saveCursor
+            std::map<std::uint64_t, std::uint64_t> _completedChunks; // done chunks past the cursor, by first index
+
+            // Saving waits for the tile writes, so it is serialized separately from the progress
+            std::mutex _cursorMutex;
+            std::uint64_t _storedCursorTileIndex;
+        };
+
+        struct PendingWrite {
+            std::shared_ptr<BinaryData> data; // null for a removal
+            long long time;
+            long long expirationTime;
+            std::string entityTag;
+            std::string lastModified;
+            std::uint64_t sequence; // tells the writer whether the entry was replaced while it was being written
         };
 
         static const unsigned int DEFAULT_CAPACITY;
         static const unsigned int EXTRA_TILE_FOOTPRINT;
+        // Tile bytes the write queue may hold before stores wait for the writer.
+        static const std::size_t MAX_PENDING_WRITE_BYTES;
+        // Queued writes committed in a single transaction.
+        static const std::size_t MAX_WRITE_BATCH_SIZE;
+        // Tiles selected for eviction per query.
+        static const std::size_t MAX_EVICTION_BATCH_SIZE;
+        // Milliseconds a connection waits for the other one to release its lock.
+        static const int BUSY_TIMEOUT;
+        static const int DEFAULT_DOWNLOAD_CONCURRENCY;
+        // Tiles a download worker claims (and loads as a batch) at a time.
+        static const std::size_t DOWNLOAD_CHUNK_SIZE;
+        // Completed tiles between saves of the download progress.
+        static const std::size_t DOWNLOAD_CURSOR_INTERVAL;
 
         void openDatabase(const std::string& databasePath);
         void closeDatabase();
-        void loadTileInfo();
+        bool loadCacheInfo();
 
-        void downloadArea(const MapBounds& mapBounds, int minZoom, int maxZoom, const std::shared_ptr<TileDownloadListener>& listener);
+        void startWriter();
+        void stopWriter();
+        void flushWrites();
+        void flushQueuedWrites();
+        void enqueueWrite(long long tileId, PendingWrite pendingWrite);
+        void writerLoop();
+
+        std::uint64_t loadDownloadCursor(const std::string& area);
+        void saveDownloadCursor(const std::string& area, std::uint64_t tileIndex);
+        void deleteDownloadCursor(const std::string& area);
+        std::string getSourceId() const;
         
+        void storeTile(const MapTile& mapTile, const std::shared_ptr<TileData>& tileData);
+
+        bool exists(long long tileId);
         std::shared_ptr<TileData> get(long long tileId);
         void store(long long tileId, const std::shared_ptr<TileData>& tileData);
         void remove(long long tileId);
+        void touch(long long tileId);
 
-        std::shared_ptr<long long> createTileId(long long tileId);
+        static bool ReadTotalSize(sqlite3pp::database& database, std::size_t& totalSize);
         
         std::unique_ptr<sqlite3pp::database> _database;
+        std::unique_ptr<sqlite3pp::database> _writeDatabase; // used only by the writer thread
         
         bool _cacheOnlyMode;
+        int _downloadConcurrency;
 
         std::set<std::shared_ptr<DownloadTask> > _downloadTasks;
         std::shared_ptr<CancelableThreadPool> _downloadThreadPool;
         
-        cache::timed_lru_cache<long long, std::shared_ptr<long long> > _cache;
+        std::map<long long, std::shared_future<std::shared_ptr<TileData> > > _pendingLoads; // single-flight de-duplication of concurrent misses
         mutable std::recursive_mutex _mutex;
+
+        std::size_t _capacity;
+        std::size_t _totalSize; // tile sizes plus footprints, as committed; owned by the writer once it runs
+
+        // Write-behind queue, latest write per tile. Entries stay queued until committed, so reads see them.
+        std::unordered_map<long long, PendingWrite> _pendingWrites;
+        std::size_t _pendingWriteBytes;
+        std::uint64_t _nextWriteSequence;
+        std::unordered_map<long long, long long> _pendingAccessTimes;
+        bool _clearRequested;
+        bool _evictionRequested;
+        bool _writerStopped;
+        std::thread _writerThread;
+        mutable std::mutex _writeMutex;
+        std::condition_variable _writeCondition;
     };
 
 }
@@ -133,6 +133,23 @@ namespace massif {
         return metadata;
     }
     
+    bool TileDataSource::isBatchLoadSupported() const {
+        return false;
+    }
+
+    std::vector<std::shared_ptr<TileData> > TileDataSource::loadTiles(const std::vector<MapTile>& tiles) {
+        std::vector<std::shared_ptr<TileData> > tileDatas;
+        tileDatas.reserve(tiles.size());
+        for (const MapTile& tile : tiles) {
+            tileDatas.push_back(loadTile(tile));
+        }
+        return tileDatas;
+    }
+
+    std::shared_ptr<TileData> TileDataSource::revalidateTile(const MapTile& tile, const std::shared_ptr<TileData>& expiredTileData) {
+        return loadTile(tile);
+    }
+
     void TileDataSource::applyTileMetadata(const std::shared_ptr<TileData>& tileData, const MapTile& tile) const {
         if (!tileData) {
             return;
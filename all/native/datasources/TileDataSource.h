@@ -119,6 +119,35 @@ namespace massif {
          * @return The tile data. If the tile is not available, null may be returned.
          */
         virtual std::shared_ptr<TileData> loadTile(const MapTile& tile) = 0;
+
+#ifndef SWIG
+        /**
+         * Returns true if the data source loads a batch of tiles more efficiently than the same tiles
+         * one by one (for example by coalescing network requests). The default is false.
+         * Internal method.
+         * @return True if loadTiles should be preferred for multiple tiles.
+         */
+        virtual bool isBatchLoadSupported() const;
+
+        /**
+         * Loads a batch of tiles. The default implementation simply loads the tiles one by one.
+         * Internal method.
+         * @param tiles The tiles to load, using the same coordinate system as loadTile.
+         * @return The tile data for every requested tile, in the same order. Entries may be null.
+         */
+        virtual std::vector<std::shared_ptr<TileData> > loadTiles(const std::vector<MapTile>& tiles);
+
+        /**
+         * Loads a tile again after its cached copy has expired. Data sources that can check whether
+         * the cached copy is still current (for example with a conditional HTTP request) return a new tile data
+         * sharing the cached bytes when it is. The default implementation simply loads the tile.
+         * Internal method.
+         * @param tile The tile to load, using the same coordinate system as loadTile.
+         * @param expiredTileData The expired cached copy of the tile.
+         * @return The tile data. If the tile is not available, null may be returned.
+         */
+        virtual std::shared_ptr<TileData> revalidateTile(const MapTile& tile, const std::shared_ptr<TileData>& expiredTileData);
+#endif
     
         /**
          * Notifies listeners that the tiles have changed. Action taken depends on the implementation of the
@@ -0,0 +1,899 @@
+#include "GeoJSONTileIndex.h"
+#include "utils/Const.h"
+#include "vectortiles/NativeVectorTile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <limits>
+#include <set>
+
+#include <mapnikvt/Geometry.h>
+#include <mapnikvt/FeatureData.h>
+
+namespace {
+
+    struct Vertex {
+        double x;
+        double y;
+        double importance; // squared distance below which simplification drops the vertex
+
+        Vertex(double x, double y, double importance) : x(x), y(y), importance(importance) { }
+    };
+
+    typedef std::vector<Vertex> VertexList;
+    typedef std::vector<VertexList> VertexLists;
+
+    // Spherical mercator normalized to [0, 1], with the origin at the north-west corner.
+    Vertex projectPosition(const massif::MapPos& pos) {
+        double sinLat = std::sin(pos.getY() * massif::Const::DEG_TO_RAD);
+        double y = 0.5 - 0.25 * std::log((1 + sinLat) / (1 - sinLat)) / massif::Const::PI;
+        return Vertex(pos.getX() / 360.0 + 0.5, std::min(1.0, std::max(0.0, y)), 1);
+    }
+
+    double getSqSegmentDistance(const Vertex& p, const Vertex& a, const Vertex& b) {
+        double x = a.x;
+        double y = a.y;
+        double dx = b.x - x;
+        double dy = b.y - y;
+        if (dx != 0 || dy != 0) {
+            double t = ((p.x - x) * dx + (p.y - y) * dy) / (dx * dx + dy * dy);
+            if (t > 1) {
+                x = b.x;
+                y = b.y;
+            } else if (t > 0) {
+                x += dx * t;
+                y += dy * t;
+            }
+        }
+        dx = p.x - x;
+        dy = p.y - y;
+        return dx * dx + dy * dy;
+    }
+
+    // Ranks the vertices for Douglas-Peucker once, so that simplifying for a zoom level is only a
+    // comparison against its tolerance. The end points are always kept.
+    void rankVertices(VertexList& vertices) {
+        for (Vertex& vertex : vertices) {
+            vertex.importance = 0;
+        }
+        vertices.front().importance = 1;
+        vertices.back().importance = 1;
+
+        std::vector<std::pair<std::size_t, std::size_t> > ranges;
+        ranges.emplace_back(0, vertices.size() - 1);
+        while (!ranges.empty()) {
+            std::size_t first = ranges.back().first;
+            std::size_t last = ranges.back().second;
+            ranges.pop_back();
+
+            double maxSqDist = 0;
+            std::size_t index = first;
+            for (std::size_t i = first + 1; i < last; i++) {
+                double sqDist = getSqSegmentDistance(vertices[i], vertices[first], vertices[last]);
+                if (sqDist > maxSqDist) {
+                    index = i;
+                    maxSqDist = sqDist;
+                }
+            }
+            if (index != first) {
+                vertices[index].importance = maxSqDist;
+                if (index - first > 1) {
+                    ranges.emplace_back(first, index);
+                }
+                if (last - index > 1) {
+                    ranges.emplace_back(index, last);
+                }
+            }
+        }
+    }
+
+    double getAxisValue(const Vertex& vertex, int axis) {
+        return axis == 0 ? vertex.x : vertex.y;
+    }
+
+    // Vertices created on the clip edges are always kept by simplification.
+    Vertex intersect(const Vertex& a, const Vertex& b, int axis, double k) {
+        double t = (k - getAxisValue(a, axis)) / (getAxisValue(b, axis) - getAxisValue(a, axis));
+        if (axis == 0) {
+            return Vertex(k, a.y + (b.y - a.y) * t, 1);
+        }
+        return Vertex(a.x + (b.x - a.x) * t, k, 1);
+    }
+
+    void clipPoints(const VertexList& points, int axis, double k1, double k2, VertexList& result) {
+        for (const Vertex& point : points) {
+            double k = getAxisValue(point, axis);
+            if (k >= k1 && k <= k2) {
+                result.push_back(point);
+            }
+        }
+    }
+
+    // Clips a line to the slab k1 <= axis <= k2, appending the pieces inside it.
+    void clipLine(const VertexList& line, int axis, double k1, double k2, VertexLists& result) {
+        VertexList slice;
+        auto flush = [&slice, &result]() {
+            if (slice.size() >= 2) {
+                slice.front().importance = 1;
+                slice.back().importance = 1;
+                result.push_back(std::move(slice));
+            }
+            slice.clear();
+        };
+
+        for (std::size_t i = 0; i < line.size(); i++) {
+            const Vertex& a = line[i];
+            double ak = getAxisValue(a, axis);
+            if (ak >= k1 && ak <= k2) {
+                slice.push_back(a);
+            }
+            if (i + 1 == line.size()) {
+                break;
+            }
+
+            const Vertex& b = line[i + 1];
+            double bk = getAxisValue(b, axis);
+            if (ak < k1) {
+                if (bk > k1) {
+                    slice.push_back(intersect(a, b, axis, k1));
+                    if (bk > k2) {
+                        slice.push_back(intersect(a, b, axis, k2));
+                        flush();
+                    }
+                }
+            } else if (ak > k2) {
+                if (bk < k2) {
+                    slice.push_back(intersect(a, b, axis, k2));
+                    if (bk < k1) {
+                        slice.push_back(intersect(a, b, axis, k1));
+                        flush();
+                    }
+                }
+            } else if (bk < k1) {
+                if (ak > k1) {
+                    slice.push_back(intersect(a, b, axis, k1));
+                }
+                flush();
+            } else if (bk > k2) {
+                if (ak < k2) {
+                    slice.push_back(intersect(a, b, axis, k2));
+                }
+                flush();
+            }
+        }
+        flush();
+    }
+
+    // Clips a closed ring to the slab, keeping it a single closed ring (Sutherland-Hodgman).
+    // Returns an empty list if less than a triangle is left.
+    VertexList clipRing(const VertexList& ring, int axis, double k1, double k2) {
+        VertexList result;
+        for (std::size_t i = 0; i + 1 < ring.size(); i++) {
+            const Vertex& a = ring[i];
+            const Vertex& b = ring[i + 1];
+            double ak = getAxisValue(a, axis);
+            double bk = getAxisValue(b, axis);
+            if (ak >= k1 && ak <= k2) {
+                result.push_back(a);
+            }
+            // A segment may cross both edges, in the order of its direction
+            double edges[2] = { ak < bk ? k1 : k2, ak < bk ? k2 : k1 };
+            for (double k : edges) {
+                if ((ak < k && bk > k) || (ak > k && bk < k)) {
+                    result.push_back(intersect(a, b, axis, k));
+                }
+            }
+        }
+        if (!result.empty() && (result.front().x != result.back().x || result.front().y != result.back().y)) {
+            result.push_back(result.front());
+        }
+        if (result.size() < 4) {
+            result.clear();
+        }
+        return result;
+    }
+
+    // Parts of a geometry: a single list of points, a list of lines, or a list of polygons as rings (outer ring first).
+    std::vector<VertexLists> clipParts(massif::mvt::FeatureData::GeometryType type, const std::vector<VertexLists>& parts, int axis, double k1, double k2) {
+        std::vector<VertexLists> result;
+        switch (type) {
+        case massif::mvt::FeatureData::GeometryType::POINT_GEOMETRY: {
+                VertexList points;
+                for (const VertexLists& part : parts) {
+                    for (const VertexList& vertices : part) {
+                        clipPoints(vertices, axis, k1, k2, points);
+                    }
+                }
+                if (!points.empty()) {
+                    result.emplace_back(1, std::move(points));
+                }
+                break;
+            }
+        case massif::mvt::FeatureData::GeometryType::LINE_GEOMETRY: {
+                VertexLists lines;
+                for (const VertexLists& part : parts) {
+                    for (const VertexList& line : part) {
+                        clipLine(line, axis, k1, k2, lines);
+                    }
+                }
+                if (!lines.empty()) {
+                    result.push_back(std::move(lines));
+                }
+                break;
+            }
+        case massif::mvt::FeatureData::GeometryType::POLYGON_GEOMETRY:
+            for (const VertexLists& polygon : parts) {
+                VertexLists rings;
+                for (std::size_t i = 0; i < polygon.size(); i++) {
+                    VertexList ring = clipRing(polygon[i], axis, k1, k2);
+                    if (ring.empty()) {
+                        if (i == 0) {
+                            break; // the outer ring is gone, and with it the holes
+                        }
+                        continue;
+                    }
+                    rings.push_back(std::move(ring));
+                }
+                if (!rings.empty()) {
+                    result.push_back(std::move(rings));
+                }
+            }
+            break;
+        default:
+            break;
+        }
+        return result;
+    }
+
+    std::vector<cglib::vec2<float> > convertVertices(const VertexList& vertices, std::size_t count, double scale, int x, int y, double sqTolerance) {
+        std::vector<cglib::vec2<float> > result;
+        result.reserve(count);
+        for (std::size_t i = 0; i < count; i++) {
+            const Vertex& vertex = vertices[i];
+            if (sqTolerance > 0 && vertex.importance <= sqTolerance) {
+                continue;
+            }
+            result.emplace_back(static_cast<float>(vertex.x * scale - x), static_cast<float>(vertex.y * scale - y));
+        }
+        return result;
+    }
+
+    // Converts to tile coordinates, simplified for the tile's zoom.
+    std::shared_ptr<const massif::mvt::Geometry> convertGeometry(massif::mvt::FeatureData::GeometryType type, const std::vector<VertexLists>& parts, double scale, int x, int y, double sqTolerance) {
+        switch (type) {
+        case massif::mvt::FeatureData::GeometryType::POINT_GEOMETRY: {
+                std::vector<cglib::vec2<float> > points;
+                for (const VertexLists& part : parts) {
+                    for (const VertexList& vertices : part) {
+                        std::vector<cglib::vec2<float> > converted = convertVertices(vertices, vertices.size(), scale, x, y, 0);
+                        points.insert(points.end(), converted.begin(), converted.end());
+                    }
+                }
+                if (points.empty()) {
+                    return std::shared_ptr<const massif::mvt::Geometry>();
+                }
+                return std::make_shared<const massif::mvt::Geometry>(massif::mvt::PointGeometry(std::move(points)));
+            }
+        case massif::mvt::FeatureData::GeometryType::LINE_GEOMETRY: {
+                std::vector<std::vector<cglib::vec2<float> > > lines;
+                for (const VertexLists& part : parts) {
+                    for (const VertexList& line : part) {
+                        std::vector<cglib::vec2<float> > converted = convertVertices(line, line.size(), scale, x, y, sqTolerance);
+                        if (converted.size() >= 2) {
+                            lines.push_back(std::move(converted));
+                        }
+                    }
+                }
+                if (lines.empty()) {
+                    return std::shared_ptr<const massif::mvt::Geometry>();
+                }
+                return std::make_shared<const massif::mvt::Geometry>(massif::mvt::LineGeometry(std::move(lines)));
+            }
+        case massif::mvt::FeatureData::GeometryType::POLYGON_GEOMETRY: {
+                std::vector<std::vector<std::vector<cglib::vec2<float> > > > polygons;
+                for (const VertexLists& polygon : parts) {
+                    std::vector<std::vector<cglib::vec2<float> > > rings;
+                    for (std::size_t i = 0; i < polygon.size(); i++) {
+                        // The closing vertex is left out, as the MVT decoder leaves it out
+                        std::vector<cglib::vec2<float> > converted = convertVertices(polygon[i], polygon[i].size() - 1, scale, x, y, sqTolerance);
+                        if (converted.size() < 3) {
+                            if (i == 0) {
+                                break;
+                            }
+                            continue;
+                        }
+                        rings.push_back(std::move(converted));
+                    }
+                    if (!rings.empty()) {
+                        polygons.push_back(std::move(rings));
+                    }
+                }
+                if (polygons.empty()) {
+                    return std::shared_ptr<const massif::mvt::Geometry>();
+                }
+                return std::make_shared<const massif::mvt::Geometry>(massif::mvt::PolygonGeometry(std::move(polygons)));
+            }
+        default:
+            return std::shared_ptr<const massif::mvt::Geometry>();
+        }
+    }
+
+}
+
+namespace massif {
+
+    struct GeoJSONTileIndex::Geometry {
+        std::vector<VertexLists> parts;
+        double minX;
+        double minY;
+        double maxX;
+        double maxY;
+        std::size_t vertexCount;
+
+        explicit Geometry(std::vector<VertexLists> geometryParts) :
+            parts(std::move(geometryParts)),
+            minX(std::numeric_limits<double>::infinity()),
+            minY(std::numeric_limits<double>::infinity()),
+            maxX(-std::numeric_limits<double>::infinity()),
+            maxY(-std::numeric_limits<double>::infinity()),
+            vertexCount(0)
+        {
+            for (const VertexLists& part : parts) {
+                for (const VertexList& vertices : part) {
+                    for (const Vertex& vertex : vertices) {
+                        minX = std::min(minX, vertex.x);
+                        minY = std::min(minY, vertex.y);
+                        maxX = std::max(maxX, vertex.x);
+                        maxY = std::max(maxY, vertex.y);
+                    }
+                    vertexCount += vertices.size();
+                }
+            }
+        }
+    };
+
+    class GeoJSONTileIndex::Feature {
+    public:
+        Feature(mvt::FeatureData::GeometryType type, const std::optional<std::uint64_t>& id, std::shared_ptr<const Geometry> geometry, std::shared_ptr<const mvt::FeatureData> featureData) :
+            type(type), id(id), geometry(std::move(geometry)), featureData(std::move(featureData)) { }
+
+        const mvt::FeatureData::GeometryType type;
+        const std::optional<std::uint64_t> id;
+        const std::shared_ptr<const Geometry> geometry; // projected, not clipped
+        const std::shared_ptr<const mvt::FeatureData> featureData;
+    };
+
+    struct GeoJSONTileIndex::TileFeature {
+        int layerIndex;
+        std::uint64_t key;
+        double buffer;
+        std::shared_ptr<const Feature> feature;
+        std::shared_ptr<const Geometry> geometry; // clipped to the node, including the layer buffer
+    };
+
+    struct GeoJSONTileIndex::Node {
+        const int zoom;
+        const int x;
+        const int y;
+        std::vector<TileFeature> features; // by feature key
+        std::size_t vertexCount;
+        // Built eagerly for the top levels and lazily down to LAZY_INDEX_MAX_DEPTH, then never replaced. Accessed atomically.
+        mutable std::shared_ptr<const Node> children[4];
+
+        Node(int zoom, int x, int y) : zoom(zoom), x(x), y(y), features(), vertexCount(0), children() { }
+    };
+
+    GeoJSONTileIndex::GeoJSONTileIndex(int maxZoom) :
+        _maxZoom(maxZoom),
+        _layers(),
+        _nextLayerIndex(0),
+        _nextFeatureKey(0),
+        _snapshot()
+    {
+        rebuild();
+    }
+
+    GeoJSONTileIndex::~GeoJSONTileIndex() {
+    }
+
+    std::vector<int> GeoJSONTileIndex::getLayerIndices() const {
+        std::vector<int> layerIndices;
+        for (auto it = _layers.begin(); it != _layers.end(); it++) {
+            layerIndices.push_back(it->first);
+        }
+        return layerIndices;
+    }
+
+    int GeoJSONTileIndex::createLayer(const std::string& name, float buffer) {
+        int layerIndex = _nextLayerIndex;
+        getOrCreateLayer(layerIndex, buffer).name = name;
+        publish(_snapshot->_root);
+        return layerIndex;
+    }
+
+    void GeoJSONTileIndex::deleteLayer(int layerIndex) {
+        auto it = _layers.find(layerIndex);
+        if (it == _layers.end()) {
+            return;
+        }
+        bool empty = it->second.features.empty();
+        _layers.erase(it);
+        if (empty) {
+            publish(_snapshot->_root);
+        } else {
+            rebuild();
+        }
+    }
+
+    void GeoJSONTileIndex::setLayerFeatures(int layerIndex, float buffer, const std::vector<std::shared_ptr<const Feature> >& features) {
+        Layer& layer = getOrCreateLayer(layerIndex, buffer);
+        layer.features.clear();
+        for (const std::shared_ptr<const Feature>& feature : features) {
+            if (feature) {
+                layer.features.emplace(_nextFeatureKey++, feature);
+            }
+        }
+        rebuild();
+    }
+
+    void GeoJSONTileIndex::addFeatures(int layerIndex, float buffer, const std::vector<std::shared_ptr<const Feature> >& features, bool update) {
+        Layer& layer = getOrCreateLayer(layerIndex, buffer);
+
+        // Replaced features hand their keys to the new features with the same id, in order.
+        std::vector<std::uint64_t> removedKeys;
+        std::map<std::uint64_t, std::vector<std::uint64_t> > reusableKeys;
+        if (update) {
+            std::set<std::uint64_t> ids;
+            for (const std::shared_ptr<const Feature>& feature : features) {
+                if (feature && feature->id) {
+                    ids.insert(*feature->id);
+                }
+            }
+            for (auto it = layer.features.begin(); it != layer.features.end(); ) {
+                const std::optional<std::uint64_t>& id = it->second->id;
+                if (id && ids.count(*id) > 0) {
+                    removedKeys.push_back(it->first);
+                    reusableKeys[*id].push_back(it->first);
+                    it = layer.features.erase(it);
+                } else {
+                    it++;
+                }
+            }
+        }
+
+        std::vector<TileFeature> addedFeatures;
+        for (const std::shared_ptr<const Feature>& feature : features) {
+            if (!feature) {
+                continue;
+            }
+            std::uint64_t key = 0;
+            auto it = feature->id ? reusableKeys.find(*feature->id) : reusableKeys.end();
+            if (it != reusableKeys.end() && !it->second.empty()) {
+                key = it->second.front();
+                it->second.erase(it->second.begin());
+            } else {
+                key = _nextFeatureKey++;
+            }
+            layer.features.emplace(key, feature);
+            addedFeatures.push_back(TileFeature { layerIndex, key, layer.buffer, feature, feature->geometry });
+        }
+
+        if (removedKeys.empty() && addedFeatures.empty()) {
+            return;
+        }
+        if (removedKeys.size() + addedFeatures.size() > MAX_EDIT_FEATURES) {
+            rebuild();
+            return;
+        }
+
+        // A feature outside the root tile moves the root up, which only a rebuild does
+        const std::shared_ptr<const Node>& root = _snapshot->_root;
+        std::vector<TileFeature> rootFeatures;
+        for (const TileFeature& tileFeature : addedFeatures) {
+            if (root->zoom > 0 && !IsInsideNode(*tileFeature.geometry, *root)) {
+                rebuild();
+                return;
+            }
+            TileFeature clipped;
+            if (ClipTileFeature(tileFeature, root->zoom, root->x, root->y, clipped)) {
+                rootFeatures.push_back(std::move(clipped));
+            }
+        }
+        publish(EditNode(root, removedKeys, std::move(rootFeatures)));
+    }
+
+    void GeoJSONTileIndex::removeFeatures(int layerIndex, std::uint64_t id) {
+        auto layerIt = _layers.find(layerIndex);
+        if (layerIt == _layers.end()) {
+            return;
+        }
+
+        std::vector<std::uint64_t> removedKeys;
+        Layer& layer = layerIt->second;
+        for (auto it = layer.features.begin(); it != layer.features.end(); ) {
+            if (it->second->id && *it->second->id == id) {
+                removedKeys.push_back(it->first);
+                it = layer.features.erase(it);
+            } else {
+                it++;
+            }
+        }
+
+        if (removedKeys.empty()) {
+            return;
+        }
+        if (removedKeys.size() > MAX_EDIT_FEATURES) {
+            rebuild();
+            return;
+        }
+        publish(EditNode(_snapshot->_root, removedKeys, std::vector<TileFeature>()));
+    }
+
+    std::shared_ptr<const GeoJSONTileIndex::Snapshot> GeoJSONTileIndex::getSnapshot() const {
+        return std::atomic_load(&_snapshot);
+    }
+
+    std::shared_ptr<const GeoJSONTileIndex::Feature> GeoJSONTileIndex::CreatePointFeature(const std::optional<std::uint64_t>& id, const std::vector<MapPos>& points, const std::vector<std::pair<std::string, mvt::Value> >& properties) {
+        VertexList vertices;
+        vertices.reserve(points.size());
+        for (const MapPos& pos : points) {
+            vertices.push_back(projectPosition(pos));
+        }
+        if (vertices.empty()) {
+            return std::shared_ptr<const Feature>();
+        }
+
+        std::vector<VertexLists> parts;
+        parts.emplace_back(1, std::move(vertices));
+        auto geometry = std::make_shared<const Geometry>(std::move(parts));
+        auto featureData = std::make_shared<const mvt::FeatureData>(mvt::FeatureData::GeometryType::POINT_GEOMETRY, properties);
+        return std::make_shared<const Feature>(mvt::FeatureData::GeometryType::POINT_GEOMETRY, id, geometry, featureData);
+    }
+
+    std::shared_ptr<const GeoJSONTileIndex::Feature> GeoJSONTileIndex::CreateLineFeature(const std::optional<std::uint64_t>& id, const std::vector<std::vector<MapPos> >& lines, const std::vector<std::pair<std::string, mvt::Value> >& properties) {
+        VertexLists vertexLists;
+        for (const std::vector<MapPos>& line : lines) {
+            if (line.size() < 2) {
+                continue;
+            }
+            VertexList vertices;
+            vertices.reserve(line.size());
+            for (const MapPos& pos : line) {
+                vertices.push_back(projectPosition(pos));
+            }
+            rankVertices(vertices);
+            vertexLists.push_back(std::move(vertices));
+        }
+        if (vertexLists.empty()) {
+            return std::shared_ptr<const Feature>();
+        }
+
+        std::vector<VertexLists> parts;
+        parts.push_back(std::move(vertexLists));
+        auto geometry = std::make_shared<const Geometry>(std::move(parts));
+        auto featureData = std::make_shared<const mvt::FeatureData>(mvt::FeatureData::GeometryType::LINE_GEOMETRY, properties);
+        return std::make_shared<const Feature>(mvt::FeatureData::GeometryType::LINE_GEOMETRY, id, geometry, featureData);
+    }
+
+    std::shared_ptr<const GeoJSONTileIndex::Feature> GeoJSONTileIndex::CreatePolygonFeature(const std::optional<std::uint64_t>& id, const std::vector<std::vector<std::vector<MapPos> > >& polygons, const std::vector<std::pair<std::string, mvt::Value> >& properties) {
+        std::vector<VertexLists> parts;
+        for (const std::vector<std::vector<MapPos> >& polygon : polygons) {
+            VertexLists rings;
+            for (std::size_t i = 0; i < polygon.size(); i++) {
+                VertexList vertices;
+                vertices.reserve(polygon[i].size() + 1);
+                for (const MapPos& pos : polygon[i]) {
+                    vertices.push_back(projectPosition(pos));
+                }
+                if (!vertices.empty() && (vertices.front().x != vertices.back().x || vertices.front().y != vertices.back().y)) {
+                    vertices.push_back(vertices.front());
+                }
+                if (vertices.size() < 4) {
+                    if (i == 0) {
+                        break;
+                    }
+                    continue;
+                }
+                rankVertices(vertices);
+                rings.push_back(std::move(vertices));
+            }
+            if (!rings.empty()) {
+                parts.push_back(std::move(rings));
+            }
+        }
+        if (parts.empty()) {
+            return std::shared_ptr<const Feature>();
+        }
+
+        auto geometry = std::make_shared<const Geometry>(std::move(parts));
+        auto featureData = std::make_shared<const mvt::FeatureData>(mvt::FeatureData::GeometryType::POLYGON_GEOMETRY, properties);
+        return std::make_shared<const Feature>(mvt::FeatureData::GeometryType::POLYGON_GEOMETRY, id, geometry, featureData);
+    }
+
+    GeoJSONTileIndex::Layer& GeoJSONTileIndex::getOrCreateLayer(int layerIndex, float buffer) {
+        auto it = _layers.find(layerIndex);
+        if (it == _layers.end()) {
+            it = _layers.emplace(layerIndex, Layer { std::string(), buffer / TILE_SIZE, {} }).first;
+            _nextLayerIndex = std::max(_nextLayerIndex, layerIndex + 1);
+        }
+        return it->second;
+    }
+
+    void GeoJSONTileIndex::rebuild() {
+        double minX = std::numeric_limits<double>::infinity(), minY = minX;
+        double maxX = -std::numeric_limits<double>::infinity(), maxY = maxX;
+        for (auto layerIt = _layers.begin(); layerIt != _layers.end(); layerIt++) {
+            for (auto it = layerIt->second.features.begin(); it != layerIt->second.features.end(); it++) {
+                const Geometry& geometry = *it->second->geometry;
+                minX = std::min(minX, geometry.minX);
+                minY = std::min(minY, geometry.minY);
+                maxX = std::max(maxX, geometry.maxX);
+                maxY = std::max(maxY, geometry.maxY);
+            }
+        }
+
+        // Root the tree at the deepest tile holding everything: a city-sized layer would otherwise
+        // be copied whole through a dozen levels before the first real cut.
+        int rootZoom = 0, rootX = 0, rootY = 0;
+        while (minX <= maxX && rootZoom < _maxZoom) {
+            double scale = std::ldexp(1.0, rootZoom + 1);
+            double x0 = std::floor(minX * scale), x1 = std::floor(maxX * scale);
+            double y0 = std::floor(minY * scale), y1 = std::floor(maxY * scale);
+            if (x0 != x1 || y0 != y1 || x0 < 0 || y0 < 0 || x1 >= scale || y1 >= scale) {
+                break;
+            }
+            rootZoom++;
+            rootX = static_cast<int>(x0);
+            rootY = static_cast<int>(y0);
+        }
+
+        auto root = std::make_shared<Node>(rootZoom, rootX, rootY);
+        for (auto layerIt = _layers.begin(); layerIt != _layers.end(); layerIt++) {
+            for (auto it = layerIt->second.features.begin(); it != layerIt->second.features.end(); it++) {
+                TileFeature clipped;
+                if (ClipTileFeature(TileFeature { layerIt->first, it->first, layerIt->second.buffer, it->second, it->second->geometry }, rootZoom, rootX, rootY, clipped)) {
+                    root->vertexCount += clipped.geometry->vertexCount;
+                    root->features.push_back(std::move(clipped));
+                }
+            }
+        }
+        std::sort(root->features.begin(), root->features.end(), [](const TileFeature& feature1, const TileFeature& feature2) {
+            return feature1.key < feature2.key;
+        });
+
+        BuildChildNodes(*root, std::min(rootZoom + INDEX_MAX_DEPTH, _maxZoom), rootZoom + PARALLEL_BUILD_MAX_DEPTH);
+        publish(root);
+    }
+
+    void GeoJSONTileIndex::publish(const std::shared_ptr<const Node>& root) {
+        std::map<int, std::string> layerNames;
+        double minX = std::numeric_limits<double>::infinity(), minY = minX;
+        double maxX = -std::numeric_limits<double>::infinity(), maxY = maxX;
+        for (auto layerIt = _layers.begin(); layerIt != _layers.end(); layerIt++) {
+            layerNames[layerIt->first] = layerIt->second.name;
+            for (auto it = layerIt->second.features.begin(); it != layerIt->second.features.end(); it++) {
+                const Geometry& geometry = *it->second->geometry;
+                minX = std::min(minX, geometry.minX);
+                minY = std::min(minY, geometry.minY);
+                maxX = std::max(maxX, geometry.maxX);
+                maxY = std::max(maxY, geometry.maxY);
+            }
+        }
+
+        MapBounds bounds;
+        if (minX <= maxX) {
+            double worldSize = 2 * Const::PI * Const::EARTH_RADIUS;
+            bounds = MapBounds(MapPos((minX - 0.5) * worldSize, (0.5 - maxY) * worldSize), MapPos((maxX - 0.5) * worldSize, (0.5 - minY) * worldSize));
+        }
+        std::atomic_store(&_snapshot, std::shared_ptr<const Snapshot>(new Snapshot(std::move(layerNames), root, bounds)));
+    }
+
+    std::shared_ptr<const GeoJSONTileIndex::Geometry> GeoJSONTileIndex::ClipGeometry(const Feature& feature, const std::shared_ptr<const Geometry>& geometry, double minX, double minY, double maxX, double maxY) {
+        if (geometry->maxX < minX || geometry->minX > maxX || geometry->maxY < minY || geometry->minY > maxY) {
+            return std::shared_ptr<const Geometry>();
+        }
+        // Fully inside: share the geometry with the parent
+        if (geometry->minX >= minX && geometry->maxX <= maxX && geometry->minY >= minY && geometry->maxY <= maxY) {
+            return geometry;
+        }
+
+        std::vector<VertexLists> parts = geometry->parts;
+        if (geometry->minX < minX || geometry->maxX > maxX) {
+            parts = clipParts(feature.type, parts, 0, minX, maxX);
+        }
+        if (!parts.empty() && (geometry->minY < minY || geometry->maxY > maxY)) {
+            parts = clipParts(feature.type, parts, 1, minY, maxY);
+        }
+        if (parts.empty()) {
+            return std::shared_ptr<const Geometry>();
+        }
+        return std::make_shared<const Geometry>(std::move(parts));
+    }
+
+    bool GeoJSONTileIndex::ClipTileFeature(const TileFeature& tileFeature, int zoom, int x, int y, TileFeature& clipped) {
+        double scale = std::ldexp(1.0, -zoom);
+        std::shared_ptr<const Geometry> geometry = ClipGeometry(*tileFeature.feature, tileFeature.geometry,
+            (x - tileFeature.buffer) * scale, (y - tileFeature.buffer) * scale, (x + 1 + tileFeature.buffer) * scale, (y + 1 + tileFeature.buffer) * scale);
+        if (!geometry) {
+            return false;
+        }
+        clipped = tileFeature;
+        clipped.geometry = std::move(geometry);
+        return true;
+    }
+
+    bool GeoJSONTileIndex::IsInsideNode(const Geometry& geometry, const Node& node) {
+        double scale = std::ldexp(1.0, -node.zoom);
+        return geometry.minX >= node.x * scale && geometry.maxX <= (node.x + 1) * scale && geometry.minY >= node.y * scale && geometry.maxY <= (node.y + 1) * scale;
+    }
+
+    std::shared_ptr<GeoJSONTileIndex::Node> GeoJSONTileIndex::CreateNode(const Node& source, int zoom, int x, int y) {
+        auto node = std::make_shared<Node>(zoom, x, y);
+        for (const TileFeature& tileFeature : source.features) {
+            TileFeature clipped;
+            if (ClipTileFeature(tileFeature, zoom, x, y, clipped)) {
+                node->vertexCount += clipped.geometry->vertexCount;
+                node->features.push_back(std::move(clipped));
+            }
+        }
+        return node;
+    }
+
+    void GeoJSONTileIndex::BuildChildNodes(Node& node, int maxBuildZoom, int maxParallelZoom) {
+        if (node.zoom >= maxBuildZoom || node.vertexCount <= INDEX_MAX_VERTICES) {
+            return;
+        }
+
+        std::shared_ptr<Node> children[4];
+        if (node.zoom < maxParallelZoom) {
+            std::vector<std::future<std::shared_ptr<Node> > > futures;
+            for (int quadrant = 0; quadrant < 4; quadrant++) {
+                futures.push_back(std::async(std::launch::async, [&node, quadrant, maxBuildZoom, maxParallelZoom]() {
+                    std::shared_ptr<Node> child = CreateNode(node, node.zoom + 1, node.x * 2 + (quadrant & 1), node.y * 2 + (quadrant >> 1));
+                    BuildChildNodes(*child, maxBuildZoom, maxParallelZoom);
+                    return child;
+                }));
+            }
+            for (int quadrant = 0; quadrant < 4; quadrant++) {
+                children[quadrant] = futures[quadrant].get();
+            }
+        } else {
+            for (int quadrant = 0; quadrant < 4; quadrant++) {
+                children[quadrant] = CreateNode(node, node.zoom + 1, node.x * 2 + (quadrant & 1), node.y * 2 + (quadrant >> 1));
+                BuildChildNodes(*children[quadrant], maxBuildZoom, maxParallelZoom);
+            }
+        }
+
+        // Not published yet, so no atomics needed
+        for (int quadrant = 0; quadrant < 4; quadrant++) {
+            node.children[quadrant] = children[quadrant];
+        }
+    }
+
+    std::shared_ptr<const GeoJSONTileIndex::Node> GeoJSONTileIndex::EditNode(const std::shared_ptr<const Node>& node, const std::vector<std::uint64_t>& removedKeys, std::vector<TileFeature> addedFeatures) {
+        auto compareKeys = [](const TileFeature& feature1, const TileFeature& feature2) {
+            return feature1.key < feature2.key;
+        };
+        std::sort(addedFeatures.begin(), addedFeatures.end(), compareKeys);
+
+        // Merge in key order, so replaced features keep their place
+        auto newNode = std::make_shared<Node>(node->zoom, node->x, node->y);
+        newNode->features.reserve(node->features.size() + addedFeatures.size());
+        auto addedIt = addedFeatures.begin();
+        for (const TileFeature& tileFeature : node->features) {
+            for (; addedIt != addedFeatures.end() && addedIt->key < tileFeature.key; addedIt++) {
+                newNode->features.push_back(*addedIt);
+            }
+            if (!std::binary_search(removedKeys.begin(), removedKeys.end(), tileFeature.key)) {
+                newNode->features.push_back(tileFeature);
+            }
+        }
+        newNode->features.insert(newNode->features.end(), addedIt, addedFeatures.end());
+        for (const TileFeature& tileFeature : newNode->features) {
+            newNode->vertexCount += tileFeature.geometry->vertexCount;
+        }
+
+        // Children the edit does not reach are shared. Children not built yet stay so, they are split off the new node when needed.
+        for (int quadrant = 0; quadrant < 4; quadrant++) {
+            std::shared_ptr<const Node> child = std::atomic_load(&node->children[quadrant]);
+            if (!child) {
+                continue;
+            }
+
+            std::vector<std::uint64_t> childRemovedKeys;
+            for (std::uint64_t key : removedKeys) {
+                TileFeature keyFeature;
+                keyFeature.key = key;
+                if (std::binary_search(child->features.begin(), child->features.end(), keyFeature, compareKeys)) {
+                    childRemovedKeys.push_back(key);
+                }
+            }
+            std::vector<TileFeature> childAddedFeatures;
+            for (const TileFeature& tileFeature : addedFeatures) {
+                TileFeature clipped;
+                if (ClipTileFeature(tileFeature, child->zoom, child->x, child->y, clipped)) {
+                    childAddedFeatures.push_back(std::move(clipped));
+                }
+            }
+
+            if (childRemovedKeys.empty() && childAddedFeatures.empty()) {
+                newNode->children[quadrant] = child;
+            } else {
+                newNode->children[quadrant] = EditNode(child, childRemovedKeys, std::move(childAddedFeatures));
+            }
+        }
+        return newNode;
+    }
+
+    const int GeoJSONTileIndex::INDEX_MAX_DEPTH = 5;
+    const std::size_t GeoJSONTileIndex::INDEX_MAX_VERTICES = 100000;
+    const int GeoJSONTileIndex::LAZY_INDEX_MAX_DEPTH = 8;
+    const int GeoJSONTileIndex::PARALLEL_BUILD_MAX_DEPTH = 2;
+    const std::size_t GeoJSONTileIndex::MAX_EDIT_FEATURES = 1000;
+    const double GeoJSONTileIndex::TILE_SIZE = 256.0;
+
+    GeoJSONTileIndex::Snapshot::Snapshot(std::map<int, std::string> layerNames, std::shared_ptr<const Node> root, const MapBounds& bounds) :
+        _layerNames(std::move(layerNames)),
+        _root(std::move(root)),
+        _bounds(bounds)
+    {
+    }
+
+    GeoJSONTileIndex::Snapshot::~Snapshot() {
+    }
+
+    std::shared_ptr<const NativeVectorTile> GeoJSONTileIndex::Snapshot::buildTile(int zoom, int x, int y, float simplifyTolerance) const {
+        std::shared_ptr<const Node> node = _root;
+        if (zoom < node->zoom || (x >> (zoom - node->zoom)) != node->x || (y >> (zoom - node->zoom)) != node->y) {
+            // Above the root, or beside it where only the buffer reaches the features: cut directly
+            node = CreateNode(*node, zoom, x, y);
+        } else {
+            // Walk down, splitting off the nodes that are not built yet. Concurrent walks may split the
+            // same node, the first one to finish is kept. The tile's own node and nodes deeper than
+            // LAZY_INDEX_MAX_DEPTH are not kept unless already there - the tile caches above hold the built tile.
+            int maxKeptZoom = _root->zoom + LAZY_INDEX_MAX_DEPTH;
+            while (node->zoom < zoom && !node->features.empty()) {
+                int shift = zoom - node->zoom - 1;
+                int childX = x >> shift;
+                int childY = y >> shift;
+                int quadrant = (childX & 1) | ((childY & 1) << 1);
+                std::shared_ptr<const Node> child = std::atomic_load(&node->children[quadrant]);
+                if (!child) {
+                    std::shared_ptr<const Node> newChild = CreateNode(*node, node->zoom + 1, childX, childY);
+                    if (shift == 0 || node->zoom + 1 > maxKeptZoom || std::atomic_compare_exchange_strong(&node->children[quadrant], &child, newChild)) {
+                        child = newChild;
+                    }
+                }
+                node = child;
+            }
+        }
+
+        std::map<int, std::vector<NativeVectorTile::Feature> > layerFeatures;
+        if (!node->features.empty()) {
+            double scale = std::ldexp(1.0, zoom);
+            double tolerance = simplifyTolerance / (TILE_SIZE * scale);
+            for (const TileFeature& tileFeature : node->features) {
+                std::shared_ptr<const mvt::Geometry> geometry = convertGeometry(tileFeature.feature->type, tileFeature.geometry->parts, scale, x, y, tolerance * tolerance);
+                if (geometry) {
+                    long long id = static_cast<long long>(tileFeature.feature->id ? *tileFeature.feature->id : tileFeature.key);
+                    layerFeatures[tileFeature.layerIndex].emplace_back(id, geometry, tileFeature.feature->featureData);
+                }
+            }
+        }
+
+        std::vector<NativeVectorTile::Layer> layers;
+        for (auto it = layerFeatures.begin(); it != layerFeatures.end(); it++) {
+            auto nameIt = _layerNames.find(it->first);
+            layers.emplace_back(nameIt != _layerNames.end() ? nameIt->second : std::string());
+            layers.back().features = std::move(it->second);
+        }
+        return std::make_shared<const NativeVectorTile>(std::move(layers));
+    }
+
+    const MapBounds& GeoJSONTileIndex::Snapshot::getBounds() const {
+        return _bounds;
+    }
+
+}
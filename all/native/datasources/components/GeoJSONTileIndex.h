@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _MASSIF_GEOJSONTILEINDEX_H_
+#define _MASSIF_GEOJSONTILEINDEX_H_
+
+#include "core/MapBounds.h"
+#include "core/MapPos.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <mapnikvt/Value.h>
+
+namespace massif {
+    class NativeVectorTile;
+
+    /**
+     * A geojson-vt style tile index over GeoJSON features. Features are projected and ranked for
+     * simplification once, when added, and then clipped into a quadtree of tiles rooted at the deepest
+     * tile that holds all of them: the top levels are built eagerly (in parallel for large inputs),
+     * deeper nodes are split off their parent when first walked through. A tile is built from its node
+     * by dropping the vertices below the tolerance of its zoom.
+     *
+     * The index itself is not thread safe and is meant to be edited under the owner's lock. Every edit
+     * publishes a new immutable snapshot: nodes the edit does not touch are shared with the previous
+     * snapshot, touched nodes are copied. Snapshots can be read from any number of threads without locking.
+     */
+    class GeoJSONTileIndex {
+    public:
+        class Feature;
+        class Snapshot;
+
+        /**
+         * Constructs an empty index.
+         * @param maxZoom The deepest zoom level tiles are built for.
+         */
+        explicit GeoJSONTileIndex(int maxZoom);
+        virtual ~GeoJSONTileIndex();
+
+        /**
+         * Returns the indices of the existing layers, in ascending order.
+         * @return The layer indices.
+         */
+        std::vector<int> getLayerIndices() const;
+        /**
+         * Creates a new empty layer.
+         * @param name The name of the layer.
+         * @param buffer The clipping buffer of the layer, in tile pixels.
+         * @return The index of the new layer.
+         */
+        int createLayer(const std::string& name, float buffer);
+        /**
+         * Deletes a layer and its features. Does nothing if the layer does not exist.
+         * @param layerIndex The index of the layer.
+         */
+        void deleteLayer(int layerIndex);
+
+        /**
+         * Replaces all features of a layer. The layer is created with an empty name if it does not exist.
+         * @param layerIndex The index of the layer.
+         * @param buffer The clipping buffer in tile pixels, used only if the layer is created.
+         * @param features The new features of the layer.
+         */
+        void setLayerFeatures(int layerIndex, float buffer, const std::vector<std::shared_ptr<const Feature> >& features);
+        /**
+         * Adds features to a layer. The layer is created with an empty name if it does not exist.
+         * @param layerIndex The index of the layer.
+         * @param buffer The clipping buffer in tile pixels, used only if the layer is created.
+         * @param features The features to add.
+         * @param update If true, existing features with the same ids are replaced and keep their draw order.
+         */
+        void addFeatures(int layerIndex, float buffer, const std::vector<std::shared_ptr<const Feature> >& features, bool update);
+        /**
+         * Removes the features with the given id from a layer.
+         * @param layerIndex The index of the layer.
+         * @param id The id of the features.
+         */
+        void removeFeatures(int layerIndex, std::uint64_t id);
+
+        /**
+         * Returns the current snapshot of the index. Safe to call from any thread.
+         * @return The current snapshot.
+         */
+        std::shared_ptr<const Snapshot> getSnapshot() const;
+
+        /**
+         * Creates a point feature.
+         * @param id The id of the feature, if it has one.
+         * @param points The points in WGS84 coordinates.
+         * @param properties The properties of the feature.
+         * @return The feature, or null if it has no points.
+         */
+        static std::shared_ptr<const Feature> CreatePointFeature(const std::optional<std::uint64_t>& id, const std::vector<MapPos>& points, const std::vector<std::pair<std::string, mvt::Value> >& properties);
+        /**
+         * Creates a line feature.
+         * @param id The id of the feature, if it has one.
+         * @param lines The lines in WGS84 coordinates.
+         * @param properties The properties of the feature.
+         * @return The feature, or null if it has no lines of at least two points.
+         */
+        static std::shared_ptr<const Feature> CreateLineFeature(const std::optional<std::uint64_t>& id, const std::vector<std::vector<MapPos> >& lines, const std::vector<std::pair<std::string, mvt::Value> >& properties);
+        /**
+         * Creates a polygon feature. Rings are closed if needed, the first ring of each polygon is the outer ring.
+         * @param id The id of the feature, if it has one.
+         * @param polygons The polygons in WGS84 coordinates.
+         * @param properties The properties of the feature.
+         * @return The feature, or null if it has no polygons with a valid outer ring.
+         */
+        static std::shared_ptr<const Feature> CreatePolygonFeature(const std::optional<std::uint64_t>& id, const std::vector<std::vector<std::vector<MapPos> > >& polygons, const std::vector<std::pair<std::string, mvt::Value> >& properties);
+
+    private:
+        struct Geometry;
+        struct TileFeature;
+        struct Node;
+
+        struct Layer {
+            std::string name;
+            double buffer; // in tile units
+            std::map<std::uint64_t, std::shared_ptr<const Feature> > features; // by feature key, which is the draw order
+        };
+
+        Layer& getOrCreateLayer(int layerIndex, float buffer);
+        void rebuild();
+        void publish(const std::shared_ptr<const Node>& root);
+
+        static std::shared_ptr<const Geometry> ClipGeometry(const Feature& feature, const std::shared_ptr<const Geometry>& geometry, double minX, double minY, double maxX, double maxY);
+        static bool ClipTileFeature(const TileFeature& tileFeature, int zoom, int x, int y, TileFeature& clipped);
+        static bool IsInsideNode(const Geometry& geometry, const Node& node);
+        static std::shared_ptr<Node> CreateNode(const Node& source, int zoom, int x, int y);
+        static void BuildChildNodes(Node& node, int maxBuildZoom, int maxParallelZoom);
+        static std::shared_ptr<const Node> EditNode(const std::shared_ptr<const Node>& node, const std::vector<std::uint64_t>& removedKeys, std::vector<TileFeature> addedFeatures);
+
+        // Levels below the root and vertex counts up to which the quadtree is split eagerly, as in geojson-vt.
+        static const int INDEX_MAX_DEPTH;
+        static const std::size_t INDEX_MAX_VERTICES;
+        // Levels below the root down to which nodes split on demand are kept in the snapshot. Deeper tiles are cut
+        // from their deepest kept ancestor each time, so the memory held by a snapshot stays bounded however far it is zoomed into.
+        static const int LAZY_INDEX_MAX_DEPTH;
+        // Nodes this close to the root build their children on separate threads.
+        static const int PARALLEL_BUILD_MAX_DEPTH;
+        // Edits changing more features than this rebuild the index instead of copying the touched nodes.
+        static const std::size_t MAX_EDIT_FEATURES;
+        // Tile size in pixels, for converting the buffer and the simplification tolerance.
+        static const double TILE_SIZE;
+
+        const int _maxZoom;
+        std::map<int, Layer> _layers;
+        int _nextLayerIndex;
+        std::uint64_t _nextFeatureKey;
+        std::shared_ptr<const Snapshot> _snapshot;
+    };
+
+    /**
+     * An immutable state of the index. Tiles are built from it without locking.
+     */
+    class GeoJSONTileIndex::Snapshot {
+    public:
+        virtual ~Snapshot();
+
+        /**
+         * Builds a tile from the snapshot.
+         * @param zoom The zoom level of the tile.
+         * @param x The x coordinate of the tile.
+         * @param y The y coordinate of the tile, counted from the north.
+         * @param simplifyTolerance The simplification tolerance in tile pixels.
+         * @return The tile with the features of all layers, layers without features are left out.
+         */
+        std::shared_ptr<const NativeVectorTile> buildTile(int zoom, int x, int y, float simplifyTolerance) const;
+
+        /**
+         * Returns the bounds of all features, in EPSG3857 coordinates.
+         * @return The bounds of all features.
+         */
+        const MapBounds& getBounds() const;
+
+    private:
+        friend class GeoJSONTileIndex;
+
+        Snapshot(std::map<int, std::string> layerNames, std::shared_ptr<const Node> root, const MapBounds& bounds);
+
+        const std::map<int, std::string> _layerNames;
+        const std::shared_ptr<const Node> _root;
+        const MapBounds _bounds;
+    };
+
+}
+
+#endif
@@ -105,11 +105,18 @@ namespace pmtiles {
     }
 
     std::vector<uint8_t> decompressData(const std::vector<uint8_t>& data, uint8_t compression) {
+        if (compression == 0x01 || compression == 0x00) {
+            return data;
+        }
+        return decompressData(data.data(), data.size(), compression);
+    }
+
+    std::vector<uint8_t> decompressData(const uint8_t* data, size_t size, uint8_t compression) {
         // Compression: 0x00=Unknown, 0x01=None, 0x02=gzip, 0x03=brotli, 0x04=zstd
         
         if (compression == 0x01 || compression == 0x00) {
             // No compression or unknown (treat as uncompressed)
-            return data;
+            return std::vector<uint8_t>(data, data + size);
         }
         else if (compression == 0x02) {
             // gzip decompression using streaming API
@@ -122,11 +129,11 @@ namespace pmtiles {
                 throw GenericException("Failed to initialize gzip decompression");
             }
             
-            stream.avail_in = data.size();
-            stream.next_in = const_cast<uint8_t*>(data.data());
+            stream.avail_in = size;
+            stream.next_in = const_cast<uint8_t*>(data);
             
             std::vector<uint8_t> result;
-            result.reserve(data.size() * 4); // Initial estimate: 4x compression ratio
+            result.reserve(size * 4); // Initial estimate: 4x compression ratio
             
             uint8_t buffer[32768];
             int ret;
@@ -153,13 +160,13 @@ namespace pmtiles {
         else if (compression == 0x03) {
             // Brotli decompression
             // Initial buffer size: estimate 10x compression ratio (typical for map tiles)
-            size_t maxOutputSize = data.size() * 10;
+            size_t maxOutputSize = size * 10;
             std::vector<uint8_t> result(maxOutputSize);
             size_t decodedSize = maxOutputSize;
             
             BrotliDecoderResult status = BrotliDecoderDecompress(
-                data.size(),
-                data.data(),
+                size,
+                data,
                 &decodedSize,
                 result.data()
             );
@@ -167,13 +174,13 @@ namespace pmtiles {
             // If buffer was too small, retry with larger buffer
             // Fallback buffer size: 50x for edge cases with high compression ratios
             if (status == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT) {
-                maxOutputSize = data.size() * 50;
+                maxOutputSize = size * 50;
                 result.resize(maxOutputSize);
                 decodedSize = maxOutputSize;
                 
                 status = BrotliDecoderDecompress(
-                    data.size(),
-                    data.data(),
+                    size,
+                    data,
                     &decodedSize,
                     result.data()
                 );
@@ -190,7 +197,7 @@ namespace pmtiles {
 #ifdef HAVE_ZSTD
         else if (compression == 0x04) {
             // Zstandard decompression
-            unsigned long long const decompressedSize = ZSTD_getFrameContentSize(data.data(), data.size());
+            unsigned long long const decompressedSize = ZSTD_getFrameContentSize(data, size);
             
             if (decompressedSize == ZSTD_CONTENTSIZE_ERROR) {
                 Log::Error("PMTiles: Invalid zstd compressed data");
@@ -199,17 +206,17 @@ namespace pmtiles {
             else if (decompressedSize == ZSTD_CONTENTSIZE_UNKNOWN) {
                 // Size unknown, use heuristic
                 // Initial buffer size: estimate 10x compression ratio (typical for map tiles)
-                size_t maxOutputSize = data.size() * 10;
+                size_t maxOutputSize = size * 10;
                 std::vector<uint8_t> result(maxOutputSize);
                 
-                size_t actualSize = ZSTD_decompress(result.data(), maxOutputSize, data.data(), data.size());
+                size_t actualSize = ZSTD_decompress(result.data(), maxOutputSize, data, size);
                 
                 if (ZSTD_isError(actualSize)) {
                     // Try with larger buffer
                     // Fallback buffer size: 50x for edge cases with high compression ratios
-                    maxOutputSize = data.size() * 50;
+                    maxOutputSize = size * 50;
                     result.resize(maxOutputSize);
-                    actualSize = ZSTD_decompress(result.data(), maxOutputSize, data.data(), data.size());
+                    actualSize = ZSTD_decompress(result.data(), maxOutputSize, data, size);
                     
                     if (ZSTD_isError(actualSize)) {
                         Log::Errorf("PMTiles: Zstandard decompression failed: %s", ZSTD_getErrorName(actualSize));
@@ -224,7 +231,7 @@ namespace pmtiles {
                 // Size is known
                 std::vector<uint8_t> result(decompressedSize);
                 
-                size_t actualSize = ZSTD_decompress(result.data(), decompressedSize, data.data(), data.size());
+                size_t actualSize = ZSTD_decompress(result.data(), decompressedSize, data, size);
                 
                 if (ZSTD_isError(actualSize)) {
                     Log::Errorf("PMTiles: Zstandard decompression failed: %s", ZSTD_getErrorName(actualSize));
@@ -334,18 +341,31 @@ namespace pmtiles {
     }
 
     bool findTileEntry(const std::vector<DirectoryEntry>& directory, uint64_t tileId, DirectoryEntry& outEntry) {
-        for (const auto& entry : directory) {
-            if (entry.runLength == 0) {
-                // This is a pointer to a leaf directory, not a tile
-                continue;
-            }
-            
-            if (tileId >= entry.tileId && tileId < entry.tileId + entry.runLength) {
-                outEntry = entry;
-                return true;
-            }
+        const DirectoryEntry* entry = findEntry(directory, tileId);
+        if (!entry || entry->runLength == 0) {
+            // Not covered, or a pointer to a leaf directory, not a tile
+            return false;
+        }
+        outEntry = *entry;
+        return true;
+    }
+
+    const DirectoryEntry* findEntry(const std::vector<DirectoryEntry>& directory, uint64_t tileId) {
+        // The last entry starting at or before the tile id is the only candidate
+        auto it = std::upper_bound(directory.begin(), directory.end(), tileId, [](uint64_t id, const DirectoryEntry& entry) {
+            return id < entry.tileId;
+        });
+        if (it == directory.begin()) {
+            return nullptr;
+        }
+        --it;
+        if (it->runLength == 0) {
+            return &*it;
+        }
+        if (tileId - it->tileId < it->runLength) {
+            return &*it;
         }
-        return false;
+        return nullptr;
     }
 
 } // namespace pmtiles
@@ -2,6 +2,7 @@
 #ifndef _MASSIF_PMTILESUTILS_H_
 #define _MASSIF_PMTILESUTILS_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -68,6 +69,16 @@ namespace pmtiles {
      */
     std::vector<uint8_t> decompressData(const std::vector<uint8_t>& data, uint8_t compression);
 
+    /**
+     * Decompress PMTiles data directly from a memory range (for example a memory mapped archive).
+     * @param data Pointer to the compressed data
+     * @param size Size of the compressed data in bytes
+     * @param compression Compression type (see above)
+     * @return Decompressed data
+     * @throws GenericException if decompression fails
+     */
+    std::vector<uint8_t> decompressData(const uint8_t* data, size_t size, uint8_t compression);
+
     /**
      * Decode a PMTiles directory from decompressed data.
      * @param data Decompressed directory data
@@ -93,14 +104,23 @@ namespace pmtiles {
     uint64_t zxyToTileId(int z, int x, int y);
 
     /**
-     * Find a tile entry in a directory.
-     * @param directory Directory entries to search
+     * Find a tile entry in a directory (binary search, leaf directory pointers are not returned).
+     * @param directory Directory entries to search, sorted by TileID
      * @param tileId TileID to find
      * @param outEntry Output entry if found
      * @return true if found, false otherwise
      */
     bool findTileEntry(const std::vector<DirectoryEntry>& directory, uint64_t tileId, DirectoryEntry& outEntry);
 
+    /**
+     * Find the entry covering a TileID in a directory (binary search): either the tile run
+     * containing the tile, or the leaf directory pointer (runLength 0) that may contain it.
+     * @param directory Directory entries to search, sorted by TileID
+     * @param tileId TileID to find
+     * @return Pointer to the entry, or nullptr if the directory does not cover the tile
+     */
+    const DirectoryEntry* findEntry(const std::vector<DirectoryEntry>& directory, uint64_t tileId);
+
 } // namespace pmtiles
 } // namespace massif
 
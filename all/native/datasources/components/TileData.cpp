@@ -5,7 +5,7 @@
 namespace massif {
     
     TileData::TileData(const std::shared_ptr<BinaryData>& data) :
-        _data(data), _expirationTime(), _replaceWithParent(false), _overzoom(false), _metadata(), _mutex()
+        _data(data), _nativeTile(), _expirationTime(), _entityTag(), _lastModified(), _replaceWithParent(false), _overzoom(false), _metadata(), _mutex()
     {
     }
 
@@ -57,6 +57,36 @@ namespace massif {
         return _data;
     }
     
+    std::shared_ptr<const NativeVectorTile> TileData::getNativeTile() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _nativeTile;
+    }
+
+    void TileData::setNativeTile(const std::shared_ptr<const NativeVectorTile>& nativeTile) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _nativeTile = nativeTile;
+    }
+
+    std::string TileData::getEntityTag() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _entityTag;
+    }
+
+    void TileData::setEntityTag(const std::string& entityTag) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entityTag = entityTag;
+    }
+
+    std::string TileData::getLastModified() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _lastModified;
+    }
+
+    void TileData::setLastModified(const std::string& lastModified) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _lastModified = lastModified;
+    }
+    
     std::shared_ptr<Variant> TileData::getMetadata(const std::string& key) const {
         std::lock_guard<std::mutex> lock(_mutex);
         auto it = _metadata.find(key);
@@ -71,4 +101,9 @@ namespace massif {
         _metadata[key] = value;
     }
 
+    std::map<std::string, std::shared_ptr<Variant> > TileData::getMetadataMap() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _metadata;
+    }
+
 }
@@ -16,6 +16,7 @@
 
 namespace massif {
     class BinaryData;
+    class NativeVectorTile;
     class Variant;
     
     /**
@@ -68,6 +69,41 @@ namespace massif {
          * @return Tile data as binary data.
          */
         const std::shared_ptr<BinaryData>& getData() const;
+
+        /**
+         * Returns the in-memory vector tile, if the data source generated its features directly.
+         * The binary data of such a tile is empty.
+         * @return The in-memory vector tile, or null if the tile is only available as binary data.
+         */
+        std::shared_ptr<const NativeVectorTile> getNativeTile() const;
+        /**
+         * Sets the in-memory vector tile. Vector tile layers decode it instead of the binary data.
+         * @param nativeTile The in-memory vector tile.
+         */
+        void setNativeTile(const std::shared_ptr<const NativeVectorTile>& nativeTile);
+
+        /**
+         * Returns the entity tag (the ETag HTTP header) the tile data was served with.
+         * Used for revalidating the tile once it has expired.
+         * @return The entity tag, or an empty string if the tile data has none.
+         */
+        std::string getEntityTag() const;
+        /**
+         * Sets the entity tag of the tile data.
+         * @param entityTag The entity tag, or an empty string if the tile data has none.
+         */
+        void setEntityTag(const std::string& entityTag);
+        /**
+         * Returns the modification time (the Last-Modified HTTP header) the tile data was served with.
+         * Used for revalidating the tile once it has expired.
+         * @return The modification time as sent by the server, or an empty string if the tile data has none.
+         */
+        std::string getLastModified() const;
+        /**
+         * Sets the modification time of the tile data.
+         * @param lastModified The modification time as sent by the server, or an empty string if the tile data has none.
+         */
+        void setLastModified(const std::string& lastModified);
         
         /**
          * Returns metadata associated with this tile.
@@ -81,10 +117,18 @@ namespace massif {
          * @param value The metadata value.
          */
         void setMetadata(const std::string& key, const std::shared_ptr<Variant>& value);
+        /**
+         * Returns all metadata associated with this tile.
+         * @return The metadata values by key.
+         */
+        std::map<std::string, std::shared_ptr<Variant> > getMetadataMap() const;
         
     private:
         const std::shared_ptr<BinaryData> _data;
+        std::shared_ptr<const NativeVectorTile> _nativeTile;
         std::shared_ptr<std::chrono::steady_clock::time_point> _expirationTime;
+        std::string _entityTag;
+        std::string _lastModified;
         bool _replaceWithParent;
         bool _overzoom;
         // using > > without the space breaks swig
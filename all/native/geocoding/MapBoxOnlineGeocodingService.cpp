@@ -118,7 +118,7 @@ namespace massif {
         }
 
         std::string url = NetworkUtils::BuildURLFromParameters(baseURL, params);
-        Log::Debugf("MapBoxOnlineGeocodingService::calculateAddresses: Loading %s", url.c_str());
+        LOG_DEBUGF("MapBoxOnlineGeocodingService::calculateAddresses: Loading %s", url.c_str());
 
         std::string responseString;
         if (!NetworkUtils::GetHTTP(url, responseString, Log::IsShowDebug())) {
@@ -69,7 +69,7 @@ namespace massif {
         }
 
         std::string url = NetworkUtils::BuildURLFromParameters(baseURL, params);
-        Log::Debugf("MapBoxOnlineReverseGeocodingService::calculateAddresses: Loading %s", url.c_str());
+        LOG_DEBUGF("MapBoxOnlineReverseGeocodingService::calculateAddresses: Loading %s", url.c_str());
 
         std::string responseString;
         if (!NetworkUtils::GetHTTP(url, responseString, Log::IsShowDebug())) {
@@ -5,6 +5,9 @@
 #include "geocoding/utils/MassifGeocodingProxy.h"
 #include "packagemanager/handlers/GeocodingPackageHandler.h"
 
+#include <algorithm>
+#include <thread>
+
 #include <geocoding/Geocoder.h>
 
 #include <sqlite3pp.h>
@@ -15,9 +18,10 @@ namespace massif {
         _autocomplete(false),
         _language(),
         _maxResults(10),
-        _cachedPackageDatabaseMap(),
-        _cachedGeocoder(),
-        _mutex()
+        _geocoderPool(),
+        _mutex(),
+        _packageHandlerCache(),
+        _localDbs()
     {
     }
 
@@ -33,7 +37,7 @@ namespace massif {
         std::lock_guard<std::mutex> lock(_mutex);
         if (autocomplete != _autocomplete) {
             _autocomplete = autocomplete;
-            _cachedGeocoder.reset();
+            _geocoderPool.reset();
         }
     }
 
@@ -46,7 +50,7 @@ namespace massif {
         std::lock_guard<std::mutex> lock(_mutex);
         if (lang != _language) {
             _language = lang;
-            _cachedGeocoder.reset();
+            _geocoderPool.reset();
         }
     }
 
@@ -59,34 +63,8 @@ namespace massif {
         std::lock_guard<std::mutex> lock(_mutex);
         if (maxResults != _maxResults) {
             _maxResults = maxResults;
-            _cachedGeocoder.reset();
-        }
-    }
-
-    void MultiOSMOfflineGeocodingService::accessLocalPackages(const std::function<void(const std::map<std::string, std::shared_ptr<GeocodingPackageHandler> >&)>& callback) const {
-        // NOTE: should use shared_lock here, but iOS 9 does not support it
-        std::unique_lock<std::mutex> packageLock(_packageFileMutex);
-
-        // Find all package handlers
-        std::map<std::string, std::shared_ptr<GeocodingPackageHandler> > packageHandlerMap;
-        {
-            std::lock_guard<std::mutex> lock(_mutex);
-
-            for (const std::string& localDb : _localDbs) {
-                auto it = _packageHandlerCache.find(localDb);
-                if (it == _packageHandlerCache.end()) {
-                    auto handler = std::make_shared<GeocodingPackageHandler>(localDb);
-                    if (!handler) {
-                        continue;
-                    }
-                    it = _packageHandlerCache.insert(std::make_pair(localDb, handler)).first;
-                }
-                packageHandlerMap[localDb] = it->second;
-            }
+            _geocoderPool.reset();
         }
-
-        // Use the callback
-        callback(packageHandlerMap);
     }
 
     std::vector<std::shared_ptr<GeocodingResult> > MultiOSMOfflineGeocodingService::calculateAddresses(const std::shared_ptr<GeocodingRequest>& request) const {
@@ -94,44 +72,12 @@ namespace massif {
             throw NullArgumentException("Null request");
         }
 
-        // Do routing via package manager, so that all packages are locked during routing
-        std::vector<std::shared_ptr<GeocodingResult> > results;
-        accessLocalPackages([this, &results, &request](const std::map<std::string, std::shared_ptr<GeocodingPackageHandler> >& packageHandlerMap) {
-            // Build map of geocoding databases
-            std::map<std::string, std::shared_ptr<sqlite3pp::database> > packageDatabaseMap;
-            for (auto it = packageHandlerMap.begin(); it != packageHandlerMap.end(); it++) {
-                if (auto geocodingHandler = std::dynamic_pointer_cast<GeocodingPackageHandler>(it->second)) {
-                    if (auto packageDatabase = geocodingHandler->getDatabase()) {
-                        packageDatabaseMap[it->first] = packageDatabase;
-                    }
-                }
-            }
-
-            // Now check if we have to reinitialize the geocoder
-            std::lock_guard<std::mutex> lock(_mutex);
-            if (!_cachedGeocoder || packageDatabaseMap != _cachedPackageDatabaseMap) {
-                auto geocoder = std::make_shared<geocoding::Geocoder>();
-                geocoder->setAutocomplete(_autocomplete);
-                geocoder->setLanguage(_language);
-                geocoder->setMaxResults(_maxResults);
-                for (auto it = packageDatabaseMap.begin(); it != packageDatabaseMap.end(); it++) {
-                    try {
-                        if (!geocoder->import(it->second)) {
-                            throw FileException("Failed to import geocoding database " + it->first, "");
-                        }
-                    }
-                    catch (const std::exception& ex) {
-                        throw GenericException("Exception while importing geocoding database " + it->first, ex.what());
-                    }
-                }
-                _cachedPackageDatabaseMap = packageDatabaseMap;
-                _cachedGeocoder = geocoder;
-            }
-
-            results = MassifGeocodingProxy::CalculateAddresses(_cachedGeocoder, request);
+        std::shared_ptr<GeocoderPool<geocoding::Geocoder> > geocoderPool = getGeocoderPool();
+        return geocoderPool->use([&request](const std::shared_ptr<geocoding::Geocoder>& geocoder) {
+            return MassifGeocodingProxy::CalculateAddresses(geocoder, request);
         });
-        return results;
     }
+
     void MultiOSMOfflineGeocodingService::add(const std::string &database)
     {
         {
@@ -142,6 +88,7 @@ namespace massif {
                 return;
             }
             _localDbs.emplace_back(database);
+            _geocoderPool.reset();
         }
     }
 
@@ -156,9 +103,41 @@ namespace massif {
                 return false;
             }
             _localDbs.erase(it);
+            _geocoderPool.reset();
         }
         return true;
     }
+
+    std::shared_ptr<GeocoderPool<geocoding::Geocoder> > MultiOSMOfflineGeocodingService::getGeocoderPool() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_geocoderPool) {
+            std::vector<std::pair<std::string, std::shared_ptr<GeocodingPackageHandler> > > packageHandlers;
+            for (const std::string& localDb : _localDbs) {
+                auto it = _packageHandlerCache.find(localDb);
+                if (it == _packageHandlerCache.end()) {
+                    it = _packageHandlerCache.insert(std::make_pair(localDb, std::make_shared<GeocodingPackageHandler>(localDb))).first;
+                }
+                packageHandlers.emplace_back(localDb, it->second);
+            }
+
+            bool autocomplete = _autocomplete;
+            std::string language = _language;
+            int maxResults = _maxResults;
+            auto factory = [packageHandlers, autocomplete, language, maxResults]() {
+                auto geocoder = std::make_shared<geocoding::Geocoder>();
+                geocoder->setAutocomplete(autocomplete);
+                geocoder->setLanguage(language);
+                geocoder->setMaxResults(maxResults);
+                ImportGeocodingPackages(*geocoder, packageHandlers);
+                return geocoder;
+            };
+            _geocoderPool = std::make_shared<GeocoderPool<geocoding::Geocoder> >(factory, std::min(std::max(1u, std::thread::hardware_concurrency()), MAX_IDLE_GEOCODERS));
+        }
+        return _geocoderPool;
+    }
+
+    const unsigned int MultiOSMOfflineGeocodingService::MAX_IDLE_GEOCODERS = 4;
+
 }
 
 #endif
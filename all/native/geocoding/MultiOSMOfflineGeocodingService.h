@@ -10,6 +10,7 @@
 #if defined(_MASSIF_GEOCODING_SUPPORT) && defined(_MASSIF_OFFLINE_SUPPORT)
 
 #include "geocoding/GeocodingService.h"
+#include "geocoding/utils/GeocoderPool.h"
 #include "packagemanager/handlers/GeocodingPackageHandler.h"
 
 namespace sqlite3pp {
@@ -58,20 +59,21 @@ namespace massif {
         bool remove(const std::string&  database);
         
     protected:
+        static const unsigned int MAX_IDLE_GEOCODERS;
+
         bool _autocomplete;
         std::string _language;
         int _maxResults;
 
-        mutable std::map<std::string, std::shared_ptr<sqlite3pp::database> > _cachedPackageDatabaseMap;
-        mutable std::shared_ptr<geocoding::Geocoder> _cachedGeocoder;
+        mutable std::shared_ptr<GeocoderPool<geocoding::Geocoder> > _geocoderPool; // replaced when the databases or options change
 
         mutable std::mutex _mutex;
 
     private:
-        void accessLocalPackages(const std::function<void(const std::map<std::string, std::shared_ptr<GeocodingPackageHandler> >&)>& callback) const;
+        std::shared_ptr<GeocoderPool<geocoding::Geocoder> > getGeocoderPool() const;
+
         mutable std::map<std::string, std::shared_ptr<GeocodingPackageHandler> > _packageHandlerCache;
         std::vector<std::string > _localDbs;
-        mutable std::mutex _packageFileMutex; // guards all package file accesses
     };
     
 }
@@ -5,6 +5,11 @@
 #include "geocoding/utils/MassifGeocodingProxy.h"
 #include "packagemanager/handlers/GeocodingPackageHandler.h"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
 #include <geocoding/RevGeocoder.h>
 
 #include <sqlite3pp.h>
@@ -13,9 +18,10 @@ namespace massif {
 
     MultiOSMOfflineReverseGeocodingService::MultiOSMOfflineReverseGeocodingService() :
         _language(),
-        _cachedPackageDatabaseMap(),
-        _cachedRevGeocoder(),
-        _mutex()
+        _revGeocoderPool(),
+        _mutex(),
+        _packageHandlerCache(),
+        _localDbs()
     {
     }
 
@@ -31,77 +37,69 @@ namespace massif {
         std::lock_guard<std::mutex> lock(_mutex);
         if (lang != _language) {
             _language = lang;
-            _cachedRevGeocoder.reset();
+            _revGeocoderPool.reset();
         }
     }
 
-    void MultiOSMOfflineReverseGeocodingService::accessLocalPackages(const std::function<void(const std::map<std::string, std::shared_ptr<GeocodingPackageHandler> >&)>& callback) const {
-        // NOTE: should use shared_lock here, but iOS 9 does not support it
-        std::unique_lock<std::mutex> packageLock(_packageFileMutex);
-
-        // Find all package handlers
-        std::map<std::string, std::shared_ptr<GeocodingPackageHandler> > packageHandlerMap;
-        {
-            std::lock_guard<std::mutex> lock(_mutex);
-
-            for (const std::string& localDb : _localDbs) {
-                auto it = _packageHandlerCache.find(localDb);
-                if (it == _packageHandlerCache.end()) {
-                    auto handler = std::make_shared<GeocodingPackageHandler>(localDb);
-                    if (!handler) {
-                        continue;
-                    }
-                    it = _packageHandlerCache.insert(std::make_pair(localDb, handler)).first;
-                }
-                packageHandlerMap[localDb] = it->second;
-            }
+    std::vector<std::shared_ptr<GeocodingResult> > MultiOSMOfflineReverseGeocodingService::calculateAddresses(const std::shared_ptr<ReverseGeocodingRequest>& request) const {
+        if (!request) {
+            throw NullArgumentException("Null request");
         }
 
-        // Use the callback
-        callback(packageHandlerMap);
+        std::shared_ptr<GeocoderPool<geocoding::RevGeocoder> > revGeocoderPool = getRevGeocoderPool();
+        return revGeocoderPool->use([&request](const std::shared_ptr<geocoding::RevGeocoder>& revGeocoder) {
+            return MassifGeocodingProxy::CalculateAddresses(revGeocoder, request);
+        });
     }
 
-    std::vector<std::shared_ptr<GeocodingResult> > MultiOSMOfflineReverseGeocodingService::calculateAddresses(const std::shared_ptr<ReverseGeocodingRequest>& request) const {
-        if (!request) {
-            throw NullArgumentException("Null request");
+    std::vector<std::vector<std::shared_ptr<GeocodingResult> > > MultiOSMOfflineReverseGeocodingService::calculateAddressesBatch(const std::shared_ptr<Projection>& projection, const std::vector<MapPos>& locations, float searchRadius) const {
+        if (!projection) {
+            throw NullArgumentException("Null projection");
         }
 
-        // Do routing via package manager, so that all packages are locked during routing
-        std::vector<std::shared_ptr<GeocodingResult> > results;
-        accessLocalPackages([this, &results, &request](const std::map<std::string, std::shared_ptr<GeocodingPackageHandler> >& packageHandlerMap) {
-            // Build map of geocoding databases
-            std::map<std::string, std::shared_ptr<sqlite3pp::database> > packageDatabaseMap;
-            for (auto it = packageHandlerMap.begin(); it != packageHandlerMap.end(); it++) {
-                if (auto geocodingHandler = std::dynamic_pointer_cast<GeocodingPackageHandler>(it->second)) {
-                    if (auto packageDatabase = geocodingHandler->getDatabase()) {
-                        packageDatabaseMap[it->first] = packageDatabase;
+        std::shared_ptr<GeocoderPool<geocoding::RevGeocoder> > revGeocoderPool = getRevGeocoderPool();
+
+        // Each worker keeps one geocoder for all the locations it claims
+        std::vector<std::vector<std::shared_ptr<GeocodingResult> > > results(locations.size());
+        std::atomic<std::size_t> nextLocationIndex(0);
+        std::exception_ptr firstException;
+        std::mutex exceptionMutex;
+        auto geocodeLocations = [&]() {
+            try {
+                revGeocoderPool->use([&](const std::shared_ptr<geocoding::RevGeocoder>& revGeocoder) {
+                    for (std::size_t index = nextLocationIndex++; index < locations.size(); index = nextLocationIndex++) {
+                        auto request = std::make_shared<ReverseGeocodingRequest>(projection, locations[index]);
+                        request->setSearchRadius(searchRadius);
+                        results[index] = MassifGeocodingProxy::CalculateAddresses(revGeocoder, request);
                     }
-                }
+                    return true;
+                });
             }
-
-            // Now check if we have to reinitialize the geocoder
-            std::lock_guard<std::mutex> lock(_mutex);
-            if (!_cachedRevGeocoder || packageDatabaseMap != _cachedPackageDatabaseMap) {
-                auto revGeocoder = std::make_shared<geocoding::RevGeocoder>();
-                revGeocoder->setLanguage(_language);
-                for (auto it = packageDatabaseMap.begin(); it != packageDatabaseMap.end(); it++) {
-                    try {
-                        if (!revGeocoder->import(it->second)) {
-                            throw FileException("Failed to import geocoding database " + it->first, "");
-                        }
-                    }
-                    catch (const std::exception& ex) {
-                        throw GenericException("Exception while importing geocoding database " + it->first, ex.what());
-                    }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(exceptionMutex);
+                if (!firstException) {
+                    firstException = std::current_exception();
                 }
-                _cachedPackageDatabaseMap = packageDatabaseMap;
-                _cachedRevGeocoder = revGeocoder;
+                nextLocationIndex.store(locations.size());
             }
+        };
 
-            results = MassifGeocodingProxy::CalculateAddresses(_cachedRevGeocoder, request);
-        });
+        std::size_t threadCount = std::min(std::min(static_cast<std::size_t>(std::max(1u, std::thread::hardware_concurrency())), static_cast<std::size_t>(MAX_BATCH_THREADS)), locations.size());
+        std::vector<std::thread> threads;
+        for (std::size_t i = 1; i < threadCount; i++) {
+            threads.emplace_back(geocodeLocations);
+        }
+        geocodeLocations();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        if (firstException) {
+            std::rethrow_exception(firstException);
+        }
         return results;
     }
+
     void MultiOSMOfflineReverseGeocodingService::add(const std::string &database)
     {
         {
@@ -112,6 +110,7 @@ namespace massif {
                 return;
             }
             _localDbs.emplace_back(database);
+            _revGeocoderPool.reset();
         }
     }
 
@@ -126,10 +125,38 @@ namespace massif {
                 return false;
             }
             _localDbs.erase(it);
+            _revGeocoderPool.reset();
         }
         return true;
     }
 
+    std::shared_ptr<GeocoderPool<geocoding::RevGeocoder> > MultiOSMOfflineReverseGeocodingService::getRevGeocoderPool() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_revGeocoderPool) {
+            std::vector<std::pair<std::string, std::shared_ptr<GeocodingPackageHandler> > > packageHandlers;
+            for (const std::string& localDb : _localDbs) {
+                auto it = _packageHandlerCache.find(localDb);
+                if (it == _packageHandlerCache.end()) {
+                    it = _packageHandlerCache.insert(std::make_pair(localDb, std::make_shared<GeocodingPackageHandler>(localDb))).first;
+                }
+                packageHandlers.emplace_back(localDb, it->second);
+            }
+
+            std::string language = _language;
+            auto factory = [packageHandlers, language]() {
+                auto revGeocoder = std::make_shared<geocoding::RevGeocoder>();
+                revGeocoder->setLanguage(language);
+                ImportGeocodingPackages(*revGeocoder, packageHandlers);
+                return revGeocoder;
+            };
+            _revGeocoderPool = std::make_shared<GeocoderPool<geocoding::RevGeocoder> >(factory, std::min(std::max(1u, std::thread::hardware_concurrency()), MAX_IDLE_GEOCODERS));
+        }
+        return _revGeocoderPool;
+    }
+
+    const unsigned int MultiOSMOfflineReverseGeocodingService::MAX_IDLE_GEOCODERS = 4;
+    const unsigned int MultiOSMOfflineReverseGeocodingService::MAX_BATCH_THREADS = 4;
+
 }
 
 #endif
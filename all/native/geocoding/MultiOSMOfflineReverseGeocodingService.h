@@ -9,7 +9,9 @@
 
 #if defined(_MASSIF_GEOCODING_SUPPORT) && defined(_MASSIF_OFFLINE_SUPPORT)
 
+#include "core/MapPos.h"
 #include "geocoding/ReverseGeocodingService.h"
+#include "geocoding/utils/GeocoderPool.h"
 #include "packagemanager/handlers/GeocodingPackageHandler.h"
 
 namespace sqlite3pp {
@@ -38,6 +40,17 @@ namespace massif {
 
         virtual std::vector<std::shared_ptr<GeocodingResult> > calculateAddresses(const std::shared_ptr<ReverseGeocodingRequest>& request) const;
 
+        /**
+         * Calculates matching addresses for a list of locations, for example the points of a track.
+         * The locations are divided between several threads, each using a geocoder of its own.
+         * @param projection The projection of the locations and the results.
+         * @param locations The locations to reverse geocode.
+         * @param searchRadius The search radius in meters.
+         * @result The list of geocoding results for each location, in the order of the locations.
+         * @throws std::runtime_error If IO error occured during the calculation.
+         */
+        std::vector<std::vector<std::shared_ptr<GeocodingResult> > > calculateAddressesBatch(const std::shared_ptr<Projection>& projection, const std::vector<MapPos>& locations, float searchRadius) const;
+
         /**
          * Adds a new database.
          * @param database The database file patht to be added.
@@ -52,18 +65,20 @@ namespace massif {
         bool remove(const std::string&  database);
         
     protected:
+        static const unsigned int MAX_IDLE_GEOCODERS;
+        static const unsigned int MAX_BATCH_THREADS;
+
         std::string _language;
 
-        mutable std::map<std::string, std::shared_ptr<sqlite3pp::database> > _cachedPackageDatabaseMap;
-        mutable std::shared_ptr<geocoding::RevGeocoder> _cachedRevGeocoder;
+        mutable std::shared_ptr<GeocoderPool<geocoding::RevGeocoder> > _revGeocoderPool; // replaced when the databases or options change
 
         mutable std::mutex _mutex;
 
     private:
-        void accessLocalPackages(const std::function<void(const std::map<std::string, std::shared_ptr<GeocodingPackageHandler> >&)>& callback) const;
+        std::shared_ptr<GeocoderPool<geocoding::RevGeocoder> > getRevGeocoderPool() const;
+
         mutable std::map<std::string, std::shared_ptr<GeocodingPackageHandler> > _packageHandlerCache;
         std::vector<std::string > _localDbs;
-        mutable std::mutex _packageFileMutex; // guards all package file accesses
     };
     
 }
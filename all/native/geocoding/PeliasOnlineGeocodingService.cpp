@@ -112,7 +112,7 @@ namespace massif {
         }
 
         std::string url = NetworkUtils::BuildURLFromParameters(baseURL, params);
-        Log::Debugf("PeliasOnlineGeocodingService::calculateAddresses: Loading %s", url.c_str());
+        LOG_DEBUGF("PeliasOnlineGeocodingService::calculateAddresses: Loading %s", url.c_str());
 
         std::string responseString;
         if (!NetworkUtils::GetHTTP(url, responseString, Log::IsShowDebug())) {
@@ -74,7 +74,7 @@ namespace massif {
         }
 
         std::string url = NetworkUtils::BuildURLFromParameters(baseURL, params);
-        Log::Debugf("PeliasOnlineReverseGeocodingService::calculateAddresses: Loading %s", url.c_str());
+        LOG_DEBUGF("PeliasOnlineReverseGeocodingService::calculateAddresses: Loading %s", url.c_str());
 
         std::string responseString;
         if (!NetworkUtils::GetHTTP(url, responseString, Log::IsShowDebug())) {
@@ -107,7 +107,7 @@ namespace massif {
         }
 
         std::string url = NetworkUtils::BuildURLFromParameters(baseURL, params);
-        Log::Debugf("TomTomOnlineGeocodingService::calculateAddresses: Loading %s", url.c_str());
+        LOG_DEBUGF("TomTomOnlineGeocodingService::calculateAddresses: Loading %s", url.c_str());
 
         std::string responseString;
         if (!NetworkUtils::GetHTTP(url, responseString, Log::IsShowDebug())) {
@@ -70,7 +70,7 @@ namespace massif {
         }
 
         std::string url = NetworkUtils::BuildURLFromParameters(baseURL, params);
-        Log::Debugf("TomTomOnlineReverseGeocodingService::calculateAddresses: Loading %s", url.c_str());
+        LOG_DEBUGF("TomTomOnlineReverseGeocodingService::calculateAddresses: Loading %s", url.c_str());
 
         std::string responseString;
         if (!NetworkUtils::GetHTTP(url, responseString, Log::IsShowDebug())) {
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _MASSIF_GEOCODERPOOL_H_
+#define _MASSIF_GEOCODERPOOL_H_
+
+#ifdef _MASSIF_GEOCODING_SUPPORT
+
+#include "components/Exceptions.h"
+#ifdef _MASSIF_PACKAGEMANAGER_SUPPORT
+#include "packagemanager/handlers/GeocodingPackageHandler.h"
+#endif
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace massif {
+
+    /**
+     * A pool of identically configured geocoders for one package set and one set of options.
+     * Each geocoder is used by a single thread at a time, so queries on different threads do not wait for each other.
+     * Services publish a new pool when the packages or options change; queries already running keep using the old one.
+     * The service lock is only held while looking up the pool, the queries themselves run on geocoders of their own.
+     */
+    template <typename Geocoder>
+    class GeocoderPool {
+    public:
+        typedef std::function<std::shared_ptr<Geocoder>()> Factory;
+
+        GeocoderPool(const Factory& factory, std::size_t maxIdleCount) :
+            _factory(factory),
+            _maxIdleCount(maxIdleCount),
+            _idleGeocoders(),
+            _mutex()
+        {
+        }
+
+        /**
+         * Runs the function with a geocoder that no other thread is using.
+         * The geocoder is created when no idle one is left, and returned to the pool afterwards
+         * unless the function throws.
+         * @param func The function to run.
+         * @return The value returned by the function.
+         */
+        template <typename Func>
+        auto use(Func func) -> decltype(func(std::shared_ptr<Geocoder>())) {
+            std::shared_ptr<Geocoder> geocoder;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (!_idleGeocoders.empty()) {
+                    geocoder = std::move(_idleGeocoders.back());
+                    _idleGeocoders.pop_back();
+                }
+            }
+            if (!geocoder) {
+                geocoder = _factory();
+            }
+
+            auto result = func(geocoder);
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_idleGeocoders.size() < _maxIdleCount) {
+                _idleGeocoders.push_back(std::move(geocoder));
+            }
+            return result;
+        }
+
+    private:
+        const Factory _factory;
+        const std::size_t _maxIdleCount;
+        std::vector<std::shared_ptr<Geocoder> > _idleGeocoders;
+        std::mutex _mutex;
+    };
+
+#ifdef _MASSIF_PACKAGEMANAGER_SUPPORT
+    /**
+     * Imports the geocoding packages into a geocoder of a pool.
+     * Each package is imported through a connection of its own, as the shared package connection serializes all queries.
+     * @param geocoder The geocoder to import the packages into.
+     * @param packageHandlers The package names and their handlers.
+     * @throws GenericException If a package could not be imported.
+     */
+    template <typename Geocoder>
+    void ImportGeocodingPackages(Geocoder& geocoder, const std::vector<std::pair<std::string, std::shared_ptr<GeocodingPackageHandler> > >& packageHandlers) {
+        for (const std::pair<std::string, std::shared_ptr<GeocodingPackageHandler> >& packageHandler : packageHandlers) {
+            std::shared_ptr<sqlite3pp::database> packageDatabase = packageHandler.second->openConnection();
+            if (!packageDatabase) {
+                continue;
+            }
+            try {
+                if (!geocoder.import(packageDatabase)) {
+                    throw FileException("Failed to import geocoding database " + packageHandler.first, "");
+                }
+            }
+            catch (const std::exception& ex) {
+                throw GenericException("Exception while importing geocoding database " + packageHandler.first, ex.what());
+            }
+        }
+    }
+#endif
+    
+}
+
+#endif
+
+#endif
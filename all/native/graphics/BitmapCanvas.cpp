@@ -10,6 +10,9 @@
 #elif defined(__ANDROID__)
 #define MASSIF_BITMAP_CANVAS_IMPL AndroidImpl
 #include "graphics/BitmapCanvasAndroidImpl.h"
+#elif defined(__linux__)
+#define MASSIF_BITMAP_CANVAS_IMPL LinuxImpl
+#include "graphics/BitmapCanvasLinuxImpl.h"
 #else
 #error "Unsupported platform"
 #endif
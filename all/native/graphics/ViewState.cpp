@@ -158,7 +158,7 @@ namespace massif {
             MapVec upVecInternal = _projectionSurface->calculateMapVec(_focusPos, _upVec);
             float rotation = static_cast<float>(-std::atan2(upVecInternal.getX(), upVecInternal.getY()) * Const::RAD_TO_DEG);
             if (!std::isfinite(rotation)) {
-                Log::Infof("ViewState::setUpVec: Failed to calculate rotation %g (old %g)", rotation, _rotation);
+                LOG_INFOF("ViewState::setUpVec: Failed to calculate rotation %g (old %g)", rotation, _rotation);
             } else {
                 _rotation = rotation;
             }
@@ -18,16 +18,119 @@
 #include "utils/Const.h"
 #include "utils/Log.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
-#include <list>
-#include <stack>
 #include <memory>
 #include <utility>
 #include <numeric>
 
 #include <cglib/vec.h>
 
+namespace {
+
+    // Static 2D KD-tree, laid out like kdbush: the points are ordered in place so that every range
+    // is split at its median on alternating axes. No nodes are allocated, queries walk the ranges.
+    class PointKDIndex {
+    public:
+        PointKDIndex(const std::vector<cglib::vec2<double> >& points, const std::vector<std::size_t>& ids) : _entries() {
+            _entries.reserve(ids.size());
+            for (std::size_t id : ids) {
+                _entries.push_back(Entry { points[id], id });
+            }
+            if (!_entries.empty()) {
+                sortRange(0, _entries.size() - 1, 0);
+            }
+        }
+
+        // Ids in the index order, which keeps neighbours close to each other
+        std::size_t size() const {
+            return _entries.size();
+        }
+
+        std::size_t getId(std::size_t index) const {
+            return _entries[index].id;
+        }
+
+        // Calls the visitor with the id and the squared distance of every point within the radius.
+        // The visitor may shrink the radius for the rest of the walk, for nearest neighbour searches.
+        template <typename Visitor>
+        void findWithin(const cglib::vec2<double>& pos, double radius, Visitor visitor) const {
+            if (_entries.empty()) {
+                return;
+            }
+            Range stack[64];
+            int stackSize = 0;
+            stack[stackSize++] = Range { 0, _entries.size() - 1, 0, 0 };
+            while (stackSize > 0) {
+                Range range = stack[--stackSize];
+                if (range.splitDistance > radius) {
+                    continue;
+                }
+                if (range.right - range.left <= NODE_SIZE) {
+                    for (std::size_t i = range.left; i <= range.right; i++) {
+                        double distanceSqr = cglib::norm(_entries[i].point - pos);
+                        if (distanceSqr <= radius * radius) {
+                            visitor(_entries[i].id, distanceSqr, radius);
+                        }
+                    }
+                    continue;
+                }
+
+                std::size_t mid = (range.left + range.right) / 2;
+                const cglib::vec2<double>& midPoint = _entries[mid].point;
+                double distanceSqr = cglib::norm(midPoint - pos);
+                if (distanceSqr <= radius * radius) {
+                    visitor(_entries[mid].id, distanceSqr, radius);
+                }
+                // Push the far side first, so that the near side is walked first. The far side is skipped when
+                // popped if the radius has shrunk below its distance by then.
+                double splitDistance = pos(range.axis) - midPoint(range.axis);
+                if (splitDistance < 0) {
+                    stack[stackSize++] = Range { mid + 1, range.right, 1 - range.axis, -splitDistance };
+                    stack[stackSize++] = Range { range.left, mid - 1, 1 - range.axis, 0 };
+                } else {
+                    stack[stackSize++] = Range { range.left, mid - 1, 1 - range.axis, splitDistance };
+                    stack[stackSize++] = Range { mid + 1, range.right, 1 - range.axis, 0 };
+                }
+            }
+        }
+
+    private:
+        struct Entry {
+            cglib::vec2<double> point;
+            std::size_t id;
+        };
+
+        struct Range {
+            std::size_t left;
+            std::size_t right;
+            int axis;
+            double splitDistance;
+        };
+
+        void sortRange(std::size_t left, std::size_t right, int axis) {
+            if (right - left <= NODE_SIZE) {
+                return;
+            }
+            std::size_t mid = (left + right) / 2;
+            std::nth_element(_entries.begin() + left, _entries.begin() + mid, _entries.begin() + right + 1, [axis](const Entry& entry1, const Entry& entry2) {
+                return entry1.point(axis) < entry2.point(axis);
+            });
+            sortRange(left, mid - 1, 1 - axis);
+            sortRange(mid + 1, right, 1 - axis);
+        }
+
+        static const std::size_t NODE_SIZE = 64;
+
+        std::vector<Entry> _entries;
+    };
+
+}
+
 namespace massif {
 
     ClusteredVectorLayer::ClusteredVectorLayer(const std::shared_ptr<LocalVectorDataSource>& dataSource, const std::shared_ptr<ClusterElementBuilder>& clusterElementBuilder) :
@@ -40,11 +143,14 @@ namespace massif {
         _dpiScale(1.0f),
         _clusters(std::make_shared<std::vector<Cluster> >()),
         _projectionSurface(),
-        _singletonClusterCount(0),
+        _elementClusterIdxMap(),
+        _removedClusterCount(0),
         _rootClusterIdx(-1),
         _renderClusterIdxs(),
         _refreshRootCluster(true),
-        _clusterMutex()
+        _pendingElementEdits(),
+        _clusterMutex(),
+        _clusterUpdateMutex()
     {
         if (!clusterElementBuilder) {
             throw NullArgumentException("Null clusterElementBuilder");
@@ -99,23 +205,19 @@ namespace massif {
     bool ClusteredVectorLayer::expandCluster(const std::shared_ptr<VectorElement>& clusterElement, float px) {
         bool updated = false;
         {
-            std::lock_guard<std::recursive_mutex> lock(_mutex);
-            std::stack<int> clusterIdxs;
-            clusterIdxs.push(_rootClusterIdx);
-            while (!clusterIdxs.empty()) {
-                int clusterIdx = clusterIdxs.top();
-                clusterIdxs.pop();
-                if (clusterIdx == -1) {
-                    continue;
-                }
-                Cluster& cluster = (*_clusters)[clusterIdx];
-                if (cluster.clusterElement == clusterElement) {
-                    cluster.expandPx = px;
-                    updated = true;
-                    break;
+            std::lock_guard<std::mutex> lock(_clusterMutex);
+            // Cluster elements exist only for rendered clusters and, once expanded, their ancestors in the tree
+            std::unordered_set<int> visitedClusterIdxs;
+            for (auto it = _renderClusterIdxs.begin(); it != _renderClusterIdxs.end() && !updated; it++) {
+                for (int clusterIdx = *it; clusterIdx != -1 && visitedClusterIdxs.insert(clusterIdx).second; ) {
+                    Cluster& cluster = (*_clusters)[clusterIdx];
+                    if (cluster.clusterElement == clusterElement) {
+                        cluster.expandPx = px;
+                        updated = true;
+                        break;
+                    }
+                    clusterIdx = cluster.parentClusterIdx;
                 }
-                clusterIdxs.push(cluster.childClusterIdx[0]);
-                clusterIdxs.push(cluster.childClusterIdx[1]);
             }
         }
         redraw();
@@ -147,7 +249,11 @@ namespace massif {
                 syncRendererElement(element, lastCullState->getViewState(), remove);
             }
         }
-        refresh();
+        {
+            std::lock_guard<std::mutex> lock(_clusterMutex);
+            _pendingElementEdits.emplace_back(element, remove);
+        }
+        VectorLayer::refresh();
     }
 
     std::shared_ptr<VectorLayer::FetchTask> ClusteredVectorLayer::createFetchTask(const std::shared_ptr<CullState>& cullState) {
@@ -166,13 +272,19 @@ namespace massif {
             layer->_dpiScale = options->getDPI() / Const::UNSCALED_DPI;
         }
 
-        std::vector<std::shared_ptr<VectorElement> > vectorElements = std::static_pointer_cast<LocalVectorDataSource>(layer->_dataSource.get())->getAll();
+        std::lock_guard<std::mutex> updateLock(layer->_clusterUpdateMutex);
         bool refresh = false;
+        std::vector<ElementEdit> elementEdits;
         {
             std::lock_guard<std::mutex> lock(layer->_clusterMutex);
             std::swap(refresh, layer->_refreshRootCluster);
+            std::swap(elementEdits, layer->_pendingElementEdits);
+        }
+        if (!refresh && !elementEdits.empty()) {
+            refresh = !layer->updateClusters(elementEdits);
         }
         if (refresh) {
+            std::vector<std::shared_ptr<VectorElement> > vectorElements = std::static_pointer_cast<LocalVectorDataSource>(layer->_dataSource.get())->getAll();
             layer->rebuildClusters(vectorElements);
         }
         return false;
@@ -192,24 +304,25 @@ namespace massif {
         clusters->reserve(vectorElements.size() * 2);
         std::vector<int> clusterIdxs;
         clusterIdxs.reserve(vectorElements.size());
+        std::unordered_map<std::shared_ptr<VectorElement>, int> elementClusterIdxMap;
+        elementClusterIdxMap.reserve(vectorElements.size());
         for (const std::shared_ptr<VectorElement>& element : vectorElements) {
             int clusterIdx = createSingletonCluster(element, *clusters, *projectionSurface);
             if (clusterIdx != -1) {
                 clusterIdxs.push_back(clusterIdx);
+                elementClusterIdxMap[element] = clusterIdx;
             }
         }
 
         // Check if we must recalculate clustering
-        int singletonClusterCount = static_cast<int>(clusters->size());
         {
             std::lock_guard<std::mutex> lock(_clusterMutex);
 
-            if (_singletonClusterCount == singletonClusterCount) {
+            if (_projectionSurface == projectionSurface && _elementClusterIdxMap.size() == elementClusterIdxMap.size()) {
                 bool changed = false;
-                for (int i = 0; i < singletonClusterCount; i++) {
-                    if ((*_clusters)[i].vectorElement != (*clusters)[i].vectorElement ||
-                        (*_clusters)[i].staticPos != (*clusters)[i].staticPos)
-                    {
+                for (auto it = elementClusterIdxMap.begin(); it != elementClusterIdxMap.end(); it++) {
+                    auto it2 = _elementClusterIdxMap.find(it->first);
+                    if (it2 == _elementClusterIdxMap.end() || (*_clusters)[it2->second].staticPos != (*clusters)[it->second].staticPos) {
                         changed = true;
                         break;
                     }
@@ -224,27 +337,64 @@ namespace massif {
             }
         }
 
-        // Rebuild clusters, by doing bottom-up merging into a single cluster
-        int rootClusterIdx = -1;
-        if (!clusters->empty()) {
-            rootClusterIdx = mergeClusters(clusterIdxs.begin(), clusterIdxs.end(), *clusters, *projectionSurface, 1).front();
-        }
+        // Rebuild the cluster tree over all levels
+        int rootClusterIdx = BuildClusterTree(clusterIdxs, *clusters);
 
         // Synchronize cluster data
         std::lock_guard<std::mutex> lock(_clusterMutex);
         std::swap(clusters, _clusters);
         std::swap(projectionSurface, _projectionSurface);
-        std::swap(singletonClusterCount, _singletonClusterCount);
+        std::swap(elementClusterIdxMap, _elementClusterIdxMap);
         std::swap(rootClusterIdx, _rootClusterIdx);
+        _removedClusterCount = 0;
         _renderClusterIdxs.clear();
     }
 
+    bool ClusteredVectorLayer::updateClusters(const std::vector<ElementEdit>& elementEdits) {
+        std::shared_ptr<ProjectionSurface> projectionSurface;
+        if (auto mapRenderer = getMapRenderer()) {
+            projectionSurface = mapRenderer->getProjectionSurface();
+        }
+
+        std::lock_guard<std::mutex> lock(_clusterMutex);
+        if (!projectionSurface || projectionSurface != _projectionSurface) {
+            return false;
+        }
+        if (_removedClusterCount > _clusters->size() * MAX_REMOVED_CLUSTER_RATIO) {
+            return false;
+        }
+
+        // Edited elements are always removed and added back in their current state, so repeated edits are harmless
+        std::vector<Cluster>& clusters = *_clusters;
+        for (const ElementEdit& elementEdit : elementEdits) {
+            auto it = _elementClusterIdxMap.find(elementEdit.first);
+            if (it != _elementClusterIdxMap.end()) {
+                _rootClusterIdx = RemoveCluster(_rootClusterIdx, it->second, clusters, _removedClusterCount);
+                _elementClusterIdxMap.erase(it);
+            }
+            if (!elementEdit.second) {
+                int clusterIdx = createSingletonCluster(elementEdit.first, clusters, *projectionSurface);
+                if (clusterIdx != -1) {
+                    _rootClusterIdx = InsertCluster(_rootClusterIdx, clusterIdx, clusters);
+                    _elementClusterIdxMap[elementEdit.first] = clusterIdx;
+                }
+            }
+        }
+
+        // Removed clusters drop out of the rendering list, the rest keep their transitions
+        _renderClusterIdxs.erase(std::remove_if(_renderClusterIdxs.begin(), _renderClusterIdxs.end(), [&clusters](int clusterIdx) {
+            return clusters[clusterIdx].elementCount == 0;
+        }), _renderClusterIdxs.end());
+        return true;
+    }
+
     int ClusteredVectorLayer::createSingletonCluster(const std::shared_ptr<VectorElement>& element, std::vector<Cluster>& clusters, const ProjectionSurface& projectionSurface) const {
         MapPos mapPos;
         if (!element->isVisible() || !GetVectorElementPos(element, mapPos)) {
             return -1;
         }
-        cglib::vec3<double> pos = projectionSurface.calculatePosition(_dataSource->getProjection()->toInternal(mapPos));
+        MapPos internalPos = _dataSource->getProjection()->toInternal(mapPos);
+        cglib::vec3<double> pos = projectionSurface.calculatePosition(internalPos);
 
         int clusterIdx = static_cast<int>(clusters.size());
         clusters.emplace_back();
@@ -252,190 +402,307 @@ namespace massif {
         cluster.maxDistance = 0;
         cluster.expandPx = 0;
         cluster.staticPos = cluster.transitionPos = mapPos;
+        cluster.internalPos = MapPos(internalPos.getX(), internalPos.getY());
         cluster.bounds = cglib::bbox3<double>(pos, pos);
         cluster.elementCount = 1;
-        cluster.childClusterIdx[0] = -1;
-        cluster.childClusterIdx[1] = -1;
+        cluster.level = MAX_CLUSTER_LEVEL + 1;
         cluster.parentClusterIdx = -1;
+        cluster.firstChildClusterIdx = -1;
+        cluster.nextSiblingClusterIdx = -1;
         cluster.vectorElement = element;
         return clusterIdx;
     }
 
-    int ClusteredVectorLayer::createMergedCluster(int clusterIdx1, int clusterIdx2, std::vector<Cluster>& clusters, const ProjectionSurface& projectionSurface) const {
-        int n1 = clusters[clusterIdx1].elementCount;
-        int n2 = clusters[clusterIdx2].elementCount;
-        const MapPos& clusterPos1 = clusters[clusterIdx1].staticPos;
-        const MapPos& clusterPos2 = clusters[clusterIdx2].staticPos;
-        MapPos internalPos1 = _dataSource->getProjection()->toInternal(clusterPos1);
-        MapPos internalPos2 = _dataSource->getProjection()->toInternal(clusterPos2);
-        double dist = projectionSurface.calculateDistance(projectionSurface.calculatePosition(internalPos1), projectionSurface.calculatePosition(internalPos2));
-        MapPos mapPos((clusterPos1.getX() * n1 + clusterPos2.getX() * n2) / (n1 + n2), (clusterPos1.getY() * n1 + clusterPos2.getY() * n2) / (n1 + n2));
-
-        int clusterIdx = static_cast<int>(clusters.size());
-        clusters.emplace_back();
-        Cluster& cluster = clusters.back();
-        cluster.maxDistance = dist;
-        cluster.expandPx = 0;
-        cluster.staticPos = cluster.transitionPos = mapPos;
-        cluster.bounds = clusters[clusterIdx1].bounds;
-        cluster.bounds.add(clusters[clusterIdx2].bounds);
-        cluster.elementCount = n1 + n2;
-        cluster.childClusterIdx[0] = clusterIdx1;
-        cluster.childClusterIdx[1] = clusterIdx2;
-        cluster.parentClusterIdx = -1;
-        clusters[clusterIdx1].parentClusterIdx = clusterIdx;
-        clusters[clusterIdx2].parentClusterIdx = clusterIdx;
-        return clusterIdx;
-    }
-
-    std::vector<int> ClusteredVectorLayer::mergeClusters(std::vector<int>::iterator clustersBegin, std::vector<int>::iterator clustersEnd, std::vector<Cluster>& clusters, const ProjectionSurface& projectionSurface, std::size_t maxClusters) const {
-        struct ClusterInfo {
-            int clusterIdx;
-            double closestClusterDistance;
-            std::list<ClusterInfo>::iterator closestClusterInfoIt;
-        };
-        
-        std::size_t initialClusters = clustersEnd - clustersBegin;
-
-        // Find axis of bigger variance, use this axis for sorting
-        double meanFactor = 1.0 / initialClusters;
-        cglib::vec2<double> mean = std::accumulate(clustersBegin, clustersEnd, cglib::vec2<double>::zero(), [meanFactor, &clusters](const cglib::vec2<double>& result, int clusterIdx) {
-            const MapPos& pos = clusters[clusterIdx].staticPos;
-            return result + cglib::vec2<double>(pos.getX(), pos.getY()) * meanFactor;
-        });
-        cglib::vec2<double> variance = std::accumulate(clustersBegin, clustersEnd, cglib::vec2<double>::zero(), [mean, &clusters](const cglib::vec2<double>& result, int clusterIdx) {
-            const MapPos& pos = clusters[clusterIdx].staticPos;
-            cglib::vec2<double> delta = cglib::vec2<double>(pos.getX(), pos.getY()) - mean;
-            return result + cglib::vec2<double>(delta(0) * delta(0), delta(1) * delta(1));
-        });
-
-        int axis = (variance(0) > variance(1) ? 0 : 1);
-        auto clusterComparator = [axis, &clusters](int clusterIdx1, int clusterIdx2) {
-            return clusters[clusterIdx1].staticPos[axis] < clusters[clusterIdx2].staticPos[axis];
+    int ClusteredVectorLayer::BuildClusterTree(const std::vector<int>& clusterIdxs, std::vector<Cluster>& clusters) {
+        // The clusters of the current level live in slots. Slots from the last full build are kept in the main index,
+        // clusters merged since then in an extra index that is rebuilt every level, the main one only once the extra
+        // one grows large. Each slot knows the distance to its nearest neighbour, so that only the slots that can merge
+        // at a level are queried.
+        std::vector<int> slotClusterIdxs(clusterIdxs);
+        std::vector<cglib::vec2<double> > slotPoints;
+        slotPoints.reserve(clusterIdxs.size() * 2);
+        for (int clusterIdx : clusterIdxs) {
+            slotPoints.emplace_back(clusters[clusterIdx].internalPos.getX(), clusters[clusterIdx].internalPos.getY());
+        }
+        std::vector<double> slotNearestDistances(clusterIdxs.size(), std::numeric_limits<double>::infinity());
+        std::vector<char> slotsMerged(clusterIdxs.size(), 0);
+        std::size_t clusterCount = clusterIdxs.size();
+
+        std::vector<std::size_t> mainSlotIds;
+        std::vector<std::size_t> extraSlotIds;
+        std::shared_ptr<PointKDIndex> mainIndex;
+        std::shared_ptr<PointKDIndex> extraIndex;
+        std::size_t firstNewSlotId = 0;
+        std::vector<int> mergedClusterIdxs;
+
+        // The neighbours of a point in the index order are close to it, they give the search a tight initial radius
+        auto findNearestDistance = [&](const PointKDIndex& index, std::size_t i) {
+            std::size_t slotId = index.getId(i);
+            double nearestDistance = std::numeric_limits<double>::infinity();
+            for (std::size_t j = (i > 0 ? i - 1 : i + 1); j <= i + 1 && j < index.size(); j += 2) {
+                if (!slotsMerged[index.getId(j)]) {
+                    nearestDistance = std::min(nearestDistance, cglib::length(slotPoints[index.getId(j)] - slotPoints[slotId]));
+                }
+            }
+            auto visitor = [&](std::size_t otherSlotId, double distanceSqr, double& radius) {
+                if (otherSlotId != slotId && !slotsMerged[otherSlotId] && distanceSqr < nearestDistance * nearestDistance) {
+                    nearestDistance = radius = std::sqrt(distanceSqr);
+                }
+            };
+            mainIndex->findWithin(slotPoints[slotId], nearestDistance, visitor);
+            extraIndex->findWithin(slotPoints[slotId], nearestDistance, visitor);
+            return nearestDistance;
         };
 
-        // Use hierarchical clustering, if size above threshold
-        std::list<ClusterInfo> clusterInfos;
-        if (initialClusters > 2 * HIERARCHICAL_MODE_THRESHOLD) {
-            std::vector<int> childClusterIdxs1;
-            childClusterIdxs1.reserve(initialClusters);
-            std::vector<int> childClusterIdxs2;
-            childClusterIdxs2.reserve(initialClusters);
-            for (auto it = clustersBegin; it != clustersEnd; it++) {
-                const Cluster& cluster = clusters[*it];
-                if (cluster.staticPos[axis] < mean(axis)) {
-                    childClusterIdxs1.push_back(*it);
-                } else {
-                    childClusterIdxs2.push_back(*it);
+        // Going from the finest level to the coarsest, merge each cluster with all unmerged clusters within the level radius
+        for (int level = MAX_CLUSTER_LEVEL; level >= 0 && clusterCount > 1; level--) {
+            std::size_t newSlotCount = slotClusterIdxs.size() - firstNewSlotId;
+            if (!mainIndex || (extraSlotIds.size() + newSlotCount) * 4 > clusterCount) {
+                mainSlotIds.clear();
+                for (std::size_t slotId = 0; slotId < slotClusterIdxs.size(); slotId++) {
+                    if (!slotsMerged[slotId]) {
+                        mainSlotIds.push_back(slotId);
+                    }
                 }
-            }
-            if (!childClusterIdxs1.empty() && !childClusterIdxs2.empty()) {
-                childClusterIdxs1 = mergeClusters(childClusterIdxs1.begin(), childClusterIdxs1.end(), clusters, projectionSurface, HIERARCHICAL_MODE_THRESHOLD);
-                childClusterIdxs2 = mergeClusters(childClusterIdxs2.begin(), childClusterIdxs2.end(), clusters, projectionSurface, HIERARCHICAL_MODE_THRESHOLD);
-                std::sort(childClusterIdxs1.begin(), childClusterIdxs1.end(), clusterComparator);
-                std::sort(childClusterIdxs2.begin(), childClusterIdxs2.end(), clusterComparator);
-                for (int clusterIdx : childClusterIdxs1) {
-                    ClusterInfo clusterInfo;
-                    clusterInfo.clusterIdx = clusterIdx;
-                    clusterInfos.push_back(clusterInfo);
+                extraSlotIds.clear();
+                mainIndex = std::make_shared<PointKDIndex>(slotPoints, mainSlotIds);
+                extraIndex = std::make_shared<PointKDIndex>(slotPoints, extraSlotIds);
+                for (std::size_t i = 0; i < mainIndex->size(); i++) {
+                    slotNearestDistances[mainIndex->getId(i)] = findNearestDistance(*mainIndex, i);
                 }
-                for (int clusterIdx : childClusterIdxs2) {
-                    ClusterInfo clusterInfo;
-                    clusterInfo.clusterIdx = clusterIdx;
-                    clusterInfos.push_back(clusterInfo);
+            } else if (newSlotCount > 0) {
+                extraSlotIds.erase(std::remove_if(extraSlotIds.begin(), extraSlotIds.end(), [&slotsMerged](std::size_t slotId) {
+                    return slotsMerged[slotId] != 0;
+                }), extraSlotIds.end());
+                for (std::size_t slotId = firstNewSlotId; slotId < slotClusterIdxs.size(); slotId++) {
+                    extraSlotIds.push_back(slotId);
+                }
+                extraIndex = std::make_shared<PointKDIndex>(slotPoints, extraSlotIds);
+                for (std::size_t i = 0; i < extraIndex->size(); i++) {
+                    if (extraIndex->getId(i) >= firstNewSlotId) {
+                        slotNearestDistances[extraIndex->getId(i)] = findNearestDistance(*extraIndex, i);
+                    }
                 }
             }
-        }
-        
-        // If hierarchical clustering was not needed/did not succeed, use normal sorting/create full clustering
-        if (clusterInfos.empty()) {
-            std::sort(clustersBegin, clustersEnd, clusterComparator);
-            for (auto it = clustersBegin; it != clustersEnd; it++) {
-                ClusterInfo clusterInfo;
-                clusterInfo.clusterIdx = *it;
-                clusterInfos.push_back(clusterInfo);
-            }
-        }
-
-        // Find closest clusters. n*sqrt(n) steps avg, n^2 worst
-        for (auto it = clusterInfos.begin(); it != clusterInfos.end(); it++) {
-            it->closestClusterDistance = std::numeric_limits<double>::infinity();
-            it->closestClusterInfoIt = clusterInfos.end();
-            for (auto testIt = it; ++testIt != clusterInfos.end(); ) {
-                if (clusters[testIt->clusterIdx].staticPos[axis] - clusters[it->clusterIdx].staticPos[axis] >= it->closestClusterDistance) {
-                    break;
+            firstNewSlotId = slotClusterIdxs.size();
+
+            // Levels without a single merge are skipped by going straight to the level of the closest pair
+            double minDistance = std::numeric_limits<double>::infinity();
+            for (std::size_t slotId = 0; slotId < slotClusterIdxs.size(); slotId++) {
+                if (!slotsMerged[slotId]) {
+                    minDistance = std::min(minDistance, slotNearestDistances[slotId]);
                 }
-                double distanceSqr = MapVec(clusters[testIt->clusterIdx].staticPos - clusters[it->clusterIdx].staticPos).lengthSqr();
-                if (distanceSqr < it->closestClusterDistance * it->closestClusterDistance) {
-                    it->closestClusterDistance = std::sqrt(distanceSqr);
-                    it->closestClusterInfoIt = testIt;
+            }
+            level = std::min(level, GetMergeLevel(minDistance));
+            if (level < 0) {
+                break;
+            }
+
+            // Slots are visited in the index order, so that consecutive queries walk the same ranges. Clusters merged
+            // at this level are not in the indices, so they wait for the next level.
+            double radius = GetLevelRadius(level);
+            for (const std::shared_ptr<PointKDIndex>& index : { mainIndex, extraIndex }) {
+                for (std::size_t i = 0; i < index->size(); i++) {
+                    std::size_t slotId = index->getId(i);
+                    if (slotsMerged[slotId] || slotNearestDistances[slotId] > radius) {
+                        continue;
+                    }
+                    mergedClusterIdxs.clear();
+                    mergedClusterIdxs.push_back(slotClusterIdxs[slotId]);
+                    auto visitor = [&](std::size_t otherSlotId, double distanceSqr, double& radius) {
+                        if (otherSlotId != slotId && !slotsMerged[otherSlotId]) {
+                            slotsMerged[otherSlotId] = 1;
+                            mergedClusterIdxs.push_back(slotClusterIdxs[otherSlotId]);
+                        }
+                    };
+                    mainIndex->findWithin(slotPoints[slotId], radius, visitor);
+                    extraIndex->findWithin(slotPoints[slotId], radius, visitor);
+                    if (mergedClusterIdxs.size() < 2) {
+                        continue;
+                    }
+                    slotsMerged[slotId] = 1;
+                    clusterCount -= mergedClusterIdxs.size() - 1;
+
+                    int clusterIdx = CreateMergedCluster(mergedClusterIdxs, level, clusters);
+                    slotClusterIdxs.push_back(clusterIdx);
+                    slotPoints.emplace_back(clusters[clusterIdx].internalPos.getX(), clusters[clusterIdx].internalPos.getY());
+                    slotNearestDistances.push_back(std::numeric_limits<double>::infinity());
+                    slotsMerged.push_back(0);
                 }
             }
         }
 
-        // Merge clusters one-by-one (n steps)
-        while (clusterInfos.size() > maxClusters) {
-            // Find closest pair. n steps
-            std::list<ClusterInfo>::iterator it1 = clusterInfos.begin();
-            for (auto it = clusterInfos.begin(); ++it != clusterInfos.end(); ) {
-                if (it->closestClusterDistance < it1->closestClusterDistance) {
-                    it1 = it;
-                }
+        // Whatever is left is farther apart than the world size, the root takes all of it
+        std::vector<int> rootClusterIdxs;
+        for (std::size_t slotId = 0; slotId < slotClusterIdxs.size(); slotId++) {
+            if (!slotsMerged[slotId]) {
+                rootClusterIdxs.push_back(slotClusterIdxs[slotId]);
             }
-            std::list<ClusterInfo>::iterator it2 = it1->closestClusterInfoIt;
-
-            // Merge cluster pair
-            ClusterInfo mergedClusterInfo;
-            mergedClusterInfo.clusterIdx = createMergedCluster(it1->clusterIdx, it2->clusterIdx, clusters, projectionSurface);
-            mergedClusterInfo.closestClusterDistance = std::numeric_limits<double>::infinity();
-            mergedClusterInfo.closestClusterInfoIt = it2; // to force recalculation
-
-            // Insert cluster to sorted cluster info list. 1 steps avg, n steps worst
-            std::list<ClusterInfo>::iterator lastIt = clusterInfos.erase(it2);
-            std::list<ClusterInfo>::iterator firstIt = clusterInfos.erase(it1);
-            std::list<ClusterInfo>::iterator mergeIt;
-            for (mergeIt = firstIt; mergeIt != lastIt; mergeIt++) {
-                if (clusters[mergedClusterInfo.clusterIdx].staticPos[axis] > clusters[mergeIt->clusterIdx].staticPos[axis]) {
-                    break;
+        }
+        if (rootClusterIdxs.empty()) {
+            return -1;
+        }
+        if (rootClusterIdxs.size() == 1) {
+            return rootClusterIdxs.front();
+        }
+        return CreateMergedCluster(rootClusterIdxs, -1, clusters);
+    }
+
+    int ClusteredVectorLayer::InsertCluster(int rootClusterIdx, int clusterIdx, std::vector<Cluster>& clusters) {
+        if (rootClusterIdx == -1) {
+            return clusterIdx;
+        }
+
+        // Walk down while the new cluster would have joined the candidate at the candidate's own level
+        MapPos pos = clusters[clusterIdx].internalPos;
+        int parentClusterIdx = -1;
+        int candidateClusterIdx = rootClusterIdx;
+        while (true) {
+            const Cluster& candidateCluster = clusters[candidateClusterIdx];
+            int level = GetMergeLevel(MapVec(candidateCluster.internalPos - pos).length());
+            if (candidateCluster.firstChildClusterIdx == -1 || level < candidateCluster.level) {
+                // Merge with the candidate at the finest level both fit in
+                if (parentClusterIdx != -1) {
+                    DetachChildCluster(parentClusterIdx, candidateClusterIdx, clusters);
+                }
+                int mergedClusterIdx = CreateMergedCluster(std::vector<int> { candidateClusterIdx, clusterIdx }, level, clusters);
+                if (parentClusterIdx != -1) {
+                    AttachChildCluster(parentClusterIdx, mergedClusterIdx, clusters);
+                } else {
+                    rootClusterIdx = mergedClusterIdx;
                 }
+                break;
             }
-            mergeIt = clusterInfos.insert(mergeIt, mergedClusterInfo);
 
-            // For all clusters, if closest cluster is one of the merged clusters, recalculate closest cluster. n/2 steps avg
-            for (auto it = clusterInfos.begin(); it != lastIt; it++) {
-                if (it->closestClusterInfoIt == it1 || it->closestClusterInfoIt == it2) {
-                    it->closestClusterDistance = std::numeric_limits<double>::infinity();
-                    it->closestClusterInfoIt = clusterInfos.end();
-                    for (auto testIt = it; ++testIt != clusterInfos.end(); ) {
-                        if (clusters[testIt->clusterIdx].staticPos[axis] - clusters[it->clusterIdx].staticPos[axis] >= it->closestClusterDistance) {
-                            break;
-                        }
-                        double distanceSqr = MapVec(clusters[testIt->clusterIdx].staticPos - clusters[it->clusterIdx].staticPos).lengthSqr();
-                        if (distanceSqr < it->closestClusterDistance * it->closestClusterDistance) {
-                            it->closestClusterDistance = std::sqrt(distanceSqr);
-                            it->closestClusterInfoIt = testIt;
-                        }
-                    }
+            // Continue with the closest child, or become a child of the candidate if none is within the radius of the level below
+            parentClusterIdx = candidateClusterIdx;
+            double closestDistance = std::numeric_limits<double>::infinity();
+            for (int childClusterIdx = candidateCluster.firstChildClusterIdx; childClusterIdx != -1; childClusterIdx = clusters[childClusterIdx].nextSiblingClusterIdx) {
+                double distance = MapVec(clusters[childClusterIdx].internalPos - pos).length();
+                if (distance < closestDistance) {
+                    closestDistance = distance;
+                    candidateClusterIdx = childClusterIdx;
                 }
             }
+            if (candidateCluster.level >= MAX_CLUSTER_LEVEL || closestDistance > GetLevelRadius(candidateCluster.level + 1)) {
+                AttachChildCluster(parentClusterIdx, clusterIdx, clusters);
+                break;
+            }
+        }
+
+        // Update the ancestors of the new cluster
+        for (int ancestorClusterIdx = parentClusterIdx; ancestorClusterIdx != -1; ancestorClusterIdx = clusters[ancestorClusterIdx].parentClusterIdx) {
+            UpdateMergedCluster(ancestorClusterIdx, clusters);
+        }
+        return rootClusterIdx;
+    }
 
-            // Update clusters, check if merged cluster is closer than previously closest cluster. n/2 steps avg
-            for (auto it = clusterInfos.begin(); it != mergeIt; it++) {
-                double distanceSqr = MapVec(clusters[mergeIt->clusterIdx].staticPos - clusters[it->clusterIdx].staticPos).lengthSqr();
-                if (distanceSqr < it->closestClusterDistance * it->closestClusterDistance) {
-                    it->closestClusterDistance = std::sqrt(distanceSqr);
-                    it->closestClusterInfoIt = mergeIt;
+    int ClusteredVectorLayer::RemoveCluster(int rootClusterIdx, int clusterIdx, std::vector<Cluster>& clusters, int& removedClusterCount) {
+        int parentClusterIdx = clusters[clusterIdx].parentClusterIdx;
+        if (parentClusterIdx != -1) {
+            DetachChildCluster(parentClusterIdx, clusterIdx, clusters);
+        } else {
+            rootClusterIdx = -1;
+        }
+        clusters[clusterIdx].elementCount = 0;
+        clusters[clusterIdx].clusterElement.reset();
+        clusters[clusterIdx].vectorElement.reset();
+        removedClusterCount++;
+
+        // Update the ancestors, a cluster left with a single child is replaced by the child
+        for (int ancestorClusterIdx = parentClusterIdx; ancestorClusterIdx != -1; ) {
+            Cluster& ancestorCluster = clusters[ancestorClusterIdx];
+            int nextAncestorClusterIdx = ancestorCluster.parentClusterIdx;
+            int childClusterIdx = ancestorCluster.firstChildClusterIdx;
+            if (clusters[childClusterIdx].nextSiblingClusterIdx == -1) {
+                DetachChildCluster(ancestorClusterIdx, childClusterIdx, clusters);
+                if (nextAncestorClusterIdx != -1) {
+                    DetachChildCluster(nextAncestorClusterIdx, ancestorClusterIdx, clusters);
+                    AttachChildCluster(nextAncestorClusterIdx, childClusterIdx, clusters);
+                } else {
+                    rootClusterIdx = childClusterIdx;
                 }
+                ancestorCluster.elementCount = 0;
+                ancestorCluster.clusterElement.reset();
+                removedClusterCount++;
+            } else {
+                UpdateMergedCluster(ancestorClusterIdx, clusters);
             }
+            ancestorClusterIdx = nextAncestorClusterIdx;
         }
+        return rootClusterIdx;
+    }
 
-        // Return the remaining clusters
-        std::vector<int> clusterIdxs;
-        clusterIdxs.reserve(maxClusters);
-        for (const ClusterInfo& clusterInfo : clusterInfos) {
-            clusterIdxs.push_back(clusterInfo.clusterIdx);
+    int ClusteredVectorLayer::CreateMergedCluster(const std::vector<int>& childClusterIdxs, int level, std::vector<Cluster>& clusters) {
+        int clusterIdx = static_cast<int>(clusters.size());
+        clusters.emplace_back();
+        Cluster& cluster = clusters.back();
+        cluster.maxDistance = GetLevelRadius(level);
+        cluster.expandPx = 0;
+        cluster.level = level;
+        cluster.parentClusterIdx = -1;
+        cluster.firstChildClusterIdx = -1;
+        cluster.nextSiblingClusterIdx = -1;
+        for (int childClusterIdx : childClusterIdxs) {
+            AttachChildCluster(clusterIdx, childClusterIdx, clusters);
         }
-        return clusterIdxs;
+        UpdateMergedCluster(clusterIdx, clusters);
+        cluster.transitionPos = cluster.staticPos;
+        return clusterIdx;
+    }
+
+    void ClusteredVectorLayer::UpdateMergedCluster(int clusterIdx, std::vector<Cluster>& clusters) {
+        Cluster& cluster = clusters[clusterIdx];
+        int elementCount = 0;
+        double staticX = 0, staticY = 0;
+        double internalX = 0, internalY = 0;
+        for (int childClusterIdx = cluster.firstChildClusterIdx; childClusterIdx != -1; childClusterIdx = clusters[childClusterIdx].nextSiblingClusterIdx) {
+            const Cluster& childCluster = clusters[childClusterIdx];
+            if (elementCount == 0) {
+                cluster.bounds = childCluster.bounds;
+            } else {
+                cluster.bounds.add(childCluster.bounds);
+            }
+            int n = childCluster.elementCount;
+            elementCount += n;
+            staticX += childCluster.staticPos.getX() * n;
+            staticY += childCluster.staticPos.getY() * n;
+            internalX += childCluster.internalPos.getX() * n;
+            internalY += childCluster.internalPos.getY() * n;
+        }
+        cluster.elementCount = elementCount;
+        cluster.staticPos = MapPos(staticX / elementCount, staticY / elementCount);
+        cluster.internalPos = MapPos(internalX / elementCount, internalY / elementCount);
+        cluster.clusterElement.reset(); // the element count changed, so must the element
+    }
+
+    void ClusteredVectorLayer::AttachChildCluster(int clusterIdx, int childClusterIdx, std::vector<Cluster>& clusters) {
+        clusters[childClusterIdx].parentClusterIdx = clusterIdx;
+        clusters[childClusterIdx].nextSiblingClusterIdx = clusters[clusterIdx].firstChildClusterIdx;
+        clusters[clusterIdx].firstChildClusterIdx = childClusterIdx;
+    }
+
+    void ClusteredVectorLayer::DetachChildCluster(int clusterIdx, int childClusterIdx, std::vector<Cluster>& clusters) {
+        int* linkIdx = &clusters[clusterIdx].firstChildClusterIdx;
+        while (*linkIdx != childClusterIdx) {
+            linkIdx = &clusters[*linkIdx].nextSiblingClusterIdx;
+        }
+        *linkIdx = clusters[childClusterIdx].nextSiblingClusterIdx;
+        clusters[childClusterIdx].parentClusterIdx = -1;
+        clusters[childClusterIdx].nextSiblingClusterIdx = -1;
+    }
+
+    double ClusteredVectorLayer::GetLevelRadius(int level) {
+        return std::ldexp(static_cast<double>(Const::WORLD_SIZE), -level);
+    }
+
+    int ClusteredVectorLayer::GetMergeLevel(double distance) {
+        // The finest level with a radius of at least the distance
+        if (distance <= 0) {
+            return MAX_CLUSTER_LEVEL;
+        }
+        double level = std::floor(std::log2(Const::WORLD_SIZE / distance));
+        return static_cast<int>(std::max(-1.0, std::min(static_cast<double>(MAX_CLUSTER_LEVEL), level)));
     }
 
     bool ClusteredVectorLayer::renderClusters(const ViewState& viewState, float deltaSeconds) {
@@ -527,7 +794,11 @@ namespace massif {
                 renderState.expandedClusterIdx = clusterIdx;
                 renderState.totalExpanded = 0;
             } else {
-                stop = cluster.maxDistance < _minClusterDistance * renderState.pixelMeasure;
+                // The merge radius is in internal units, the pixel measure in surface units. On a spherical
+                // surface an internal unit covers a distance that depends on the latitude, so it is measured here.
+                const MapPos& pos = cluster.internalPos;
+                double surfaceScale = cglib::length(renderState.projectionSurface->calculatePosition(MapPos(pos.getX() + 1, pos.getY())) - renderState.projectionSurface->calculatePosition(pos));
+                stop = cluster.maxDistance * surfaceScale < _minClusterDistance * renderState.pixelMeasure;
             }
         }
         if (cluster.elementCount == 1 || stop) {
@@ -536,11 +807,10 @@ namespace massif {
 
         // Draw subclusters recursively
         bool refresh = false;
-        if (renderCluster(cluster.childClusterIdx[0], viewState, renderState, deltaSeconds)) {
-            refresh = true;
-        }
-        if (renderCluster(cluster.childClusterIdx[1], viewState, renderState, deltaSeconds)) {
-            refresh = true;
+        for (int childClusterIdx = cluster.firstChildClusterIdx; childClusterIdx != -1; childClusterIdx = (*renderState.clusters)[childClusterIdx].nextSiblingClusterIdx) {
+            if (renderCluster(childClusterIdx, viewState, renderState, deltaSeconds)) {
+                refresh = true;
+            }
         }
 
         // Undo expanded state
@@ -647,8 +917,9 @@ namespace massif {
         if (cluster.vectorElement) {
             elements.push_back(cluster.vectorElement);
         }
-        StoreVectorElements(cluster.childClusterIdx[0], clusters, elements);
-        StoreVectorElements(cluster.childClusterIdx[1], clusters, elements);
+        for (int childClusterIdx = cluster.firstChildClusterIdx; childClusterIdx != -1; childClusterIdx = clusters[childClusterIdx].nextSiblingClusterIdx) {
+            StoreVectorElements(childClusterIdx, clusters, elements);
+        }
     }
 
     bool ClusteredVectorLayer::GetVectorElementPos(const std::shared_ptr<VectorElement>& vectorElement, MapPos& pos) {
@@ -674,6 +945,7 @@ namespace massif {
         return false;
     }
 
-    const unsigned int ClusteredVectorLayer::HIERARCHICAL_MODE_THRESHOLD = 100;
+    const int ClusteredVectorLayer::MAX_CLUSTER_LEVEL = 32;
+    const float ClusteredVectorLayer::MAX_REMOVED_CLUSTER_RATIO = 0.5f;
 
 }
@@ -16,7 +16,6 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
-#include <list>
 #include <memory>
 #include <utility>
 #include <mutex>
@@ -30,7 +29,9 @@ namespace massif {
 
     /**
      * A vector layer that supports clustering point-type features.
-     * A Pairwise centroid hierarchical clustering algorithm is used internally.
+     * Clusters are kept in a tree over all zoom levels, built like supercluster: from the finest level
+     * to the coarsest, each cluster is greedily merged with its neighbours within the level radius.
+     * Frames only walk the tree down to the visible clusters, element changes update it in place.
      */
     class ClusteredVectorLayer : public VectorLayer {
     public:
@@ -50,6 +51,8 @@ namespace massif {
 
         /**
          * Returns the current minimum distance between clusters (in device-independent pixels).
+         * Clusters merge at fixed radii that halve from zoom to zoom, so a cluster splits once its merge radius
+         * reaches this distance on screen, when its parts are between half and all of this distance apart.
          * @return The current minimum clustering distance.
          */
         float getMinimumClusterDistance() const;
@@ -96,18 +99,23 @@ namespace massif {
 
     private:
         struct Cluster {
-            double maxDistance;
+            double maxDistance; // merge radius of the cluster level in internal units, 0 for singletons
             float expandPx;
             MapPos staticPos;
             MapPos transitionPos;
+            MapPos internalPos;
             cglib::bbox3<double> bounds;
-            int elementCount;
+            int elementCount; // 0 for removed clusters
+            int level;
             std::shared_ptr<VectorElement> clusterElement;
             std::shared_ptr<VectorElement> vectorElement;
             int parentClusterIdx;
-            int childClusterIdx[2];
+            int firstChildClusterIdx;
+            int nextSiblingClusterIdx;
         };
 
+        typedef std::pair<std::shared_ptr<VectorElement>, bool> ElementEdit; // element and the removal flag
+
         struct RenderState {
             double pixelMeasure;
             int totalExpanded;
@@ -126,7 +134,10 @@ namespace massif {
             virtual bool loadElements(const std::shared_ptr<VectorLayer>& vectorLayer, const std::shared_ptr<CullState>& cullState);
         };
 
-        static const unsigned int HIERARCHICAL_MODE_THRESHOLD;
+        // Finest cluster level. Level radii halve from the world size at level 0, this is well below a pixel at the deepest zoom.
+        static const int MAX_CLUSTER_LEVEL;
+        // Clusters are rebuilt instead of edited once removed clusters exceed this share of the cluster list.
+        static const float MAX_REMOVED_CLUSTER_RATIO;
 
         const DirectorPtr<ClusterElementBuilder> _clusterElementBuilder;
         ClusterBuilderMode::ClusterBuilderMode _clusterBuilderMode;
@@ -137,11 +148,14 @@ namespace massif {
         float _dpiScale;
         std::shared_ptr<std::vector<Cluster> > _clusters;
         std::shared_ptr<ProjectionSurface> _projectionSurface;
-        int _singletonClusterCount;
+        std::unordered_map<std::shared_ptr<VectorElement>, int> _elementClusterIdxMap;
+        int _removedClusterCount;
         int _rootClusterIdx;
         std::vector<int> _renderClusterIdxs;
         bool _refreshRootCluster;
-        mutable std::mutex _clusterMutex; // for _minClusterDistance, _maxClusterZoom, _dpiScale, _rootClusterIdx, _refreshRootCluster, _renderClusters, _renderClusterIdxs
+        std::vector<ElementEdit> _pendingElementEdits;
+        mutable std::mutex _clusterMutex; // for _minClusterDistance, _maxClusterZoom, _dpiScale, _clusters, _elementClusterIdxMap, _removedClusterCount, _rootClusterIdx, _renderClusterIdxs, _refreshRootCluster, _pendingElementEdits
+        std::mutex _clusterUpdateMutex; // serializes rebuilds and edits, so that edits are never applied to a tree that is about to be replaced
 
         virtual bool onDrawFrame(float deltaSeconds, BillboardSorter& billboardSorter, const ViewState& viewState);
 
@@ -150,9 +164,8 @@ namespace massif {
         virtual std::shared_ptr<FetchTask> createFetchTask(const std::shared_ptr<CullState>& cullState);
 
         void rebuildClusters(const std::vector<std::shared_ptr<VectorElement> >& vectorElements);
+        bool updateClusters(const std::vector<ElementEdit>& elementEdits);
         int createSingletonCluster(const std::shared_ptr<VectorElement>& element, std::vector<Cluster>& clusters, const ProjectionSurface& projectionSurface) const;
-        int createMergedCluster(int clusterIdx1, int clusterIdx2, std::vector<Cluster>& clusters, const ProjectionSurface& projectionSurface) const;
-        std::vector<int> mergeClusters(std::vector<int>::iterator clustersBegin, std::vector<int>::iterator clustersEnd, std::vector<Cluster>& clusters, const ProjectionSurface& projectionSurface, std::size_t maxClusters) const;
 
         bool renderClusters(const ViewState& viewState, float deltaSeconds);
         bool renderCluster(int clusterIdx, const ViewState& viewState, RenderState& renderState, float deltaSeconds);
@@ -160,6 +173,16 @@ namespace massif {
         bool moveCluster(int clusterIdx, const MapPos& targetPos, const RenderState& renderState, float deltaSeconds);
         MapPos createExpandedElementPos(RenderState& renderState) const;
 
+        static int BuildClusterTree(const std::vector<int>& clusterIdxs, std::vector<Cluster>& clusters);
+        static int InsertCluster(int rootClusterIdx, int clusterIdx, std::vector<Cluster>& clusters);
+        static int RemoveCluster(int rootClusterIdx, int clusterIdx, std::vector<Cluster>& clusters, int& removedClusterCount);
+        static int CreateMergedCluster(const std::vector<int>& childClusterIdxs, int level, std::vector<Cluster>& clusters);
+        static void UpdateMergedCluster(int clusterIdx, std::vector<Cluster>& clusters);
+        static void AttachChildCluster(int clusterIdx, int childClusterIdx, std::vector<Cluster>& clusters);
+        static void DetachChildCluster(int clusterIdx, int childClusterIdx, std::vector<Cluster>& clusters);
+        static double GetLevelRadius(int level);
+        static int GetMergeLevel(double distance);
+
         static void StoreVectorElements(int clusterIdx, const std::vector<Cluster>& clusters, std::vector<std::shared_ptr<VectorElement> >& elements);
         static bool GetVectorElementPos(const std::shared_ptr<VectorElement>& vectorElement, MapPos& pos);
         static bool SetVectorElementPos(const std::shared_ptr<VectorElement>& vectorElement, const MapPos& pos);
@@ -14,6 +14,7 @@
 #include "ui/RasterTileClickInfo.h"
 #include "utils/Log.h"
 #include "utils/Const.h"
+#include "utils/TraceProfiler.h"
 
 #include <array>
 #include <algorithm>
@@ -168,7 +169,7 @@ namespace massif {
         return false;
     }
     
-    void RasterTileLayer::fetchTile(long long tileId, const MapTile& tile, bool preloadingTile, int priorityDelta) {
+    std::shared_ptr<TileLayer::FetchTaskBase> RasterTileLayer::fetchTile(long long tileId, const MapTile& tile, bool preloadingTile, int priorityDelta) {
         std::shared_ptr<CancelableThreadPool> tileThreadPool;
         {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
@@ -178,7 +179,9 @@ namespace massif {
             auto task = std::make_shared<FetchTask>(std::static_pointer_cast<RasterTileLayer>(shared_from_this()), tileId, tile, preloadingTile);
             _fetchingTileTasks.insert(tileId, task);
             tileThreadPool->execute(task, getUpdatePriority() + priorityDelta);
+            return task;
         }
+        return std::shared_ptr<FetchTaskBase>();
     }
     
     void RasterTileLayer::clearTiles(bool preloadingTiles) {
@@ -442,7 +445,11 @@ namespace massif {
             if (isCanceled()) {
                 break;
             }
-            std::shared_ptr<TileData> tileData = layer->_dataSource->loadTile(dataSourceTile);
+            std::shared_ptr<TileData> tileData;
+            {
+                TRACE_SCOPE("RasterTileLayer::loadTileData");
+                tileData = loadDataSourceTile(layer, dataSourceTile);
+            }
             if (!tileData) {
                 break;
             }
@@ -463,6 +470,7 @@ namespace massif {
             vt::TileId vtDataSourceTile(dataSourceTile.getZoom(), dataSourceTile.getX(), dataSourceTile.getY());
             std::shared_ptr<Bitmap> bitmap;
             if (std::shared_ptr<BinaryData> data = tileData->getData()) {
+                TRACE_SCOPE("RasterTileLayer::decodeTile");
                 bitmap = Bitmap::CreateFromCompressed(data);
                 if (!bitmap && !data->empty()) {
                     Log::Error("RasterTileLayer::FetchTask: Failed to decode tile");
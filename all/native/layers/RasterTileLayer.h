@@ -115,7 +115,7 @@ namespace massif {
         virtual bool tileExists(long long tileId, bool preloadingCache) const;
         virtual bool tileValid(long long tileId, bool preloadingCache) const;
         virtual bool prefetchTile(long long tileId, bool preloadingTile);
-        virtual void fetchTile(long long tileId, const MapTile& mapTile, bool preloadingTile, int priorityDelta);
+        virtual std::shared_ptr<FetchTaskBase> fetchTile(long long tileId, const MapTile& mapTile, bool preloadingTile, int priorityDelta);
         virtual void clearTiles(bool preloadingTiles);
         virtual void invalidateTiles(bool preloadingTiles);
 
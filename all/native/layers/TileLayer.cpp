@@ -2,6 +2,7 @@
 #include "core/BinaryData.h"
 #include "components/Exceptions.h"
 #include "components/CancelableTask.h"
+#include "components/CancelableThreadPool.h"
 #include "datasources/components/TileData.h"
 #include "layers/TileLoadListener.h"
 #include "layers/UTFGridEventListener.h"
@@ -20,6 +21,7 @@
 #include "utils/Const.h"
 #include "utils/TileUtils.h"
 #include "utils/Log.h"
+#include "utils/TraceProfiler.h"
 
 #ifdef __ANDROID__
 #include <sys/system_properties.h>
@@ -425,6 +427,9 @@ namespace massif {
 
         // Fetch the tiles
         std::unordered_set<long long> fetchedTiles;
+        std::vector<MapTile> batchTiles;
+        std::unordered_set<long long> batchTileIds;
+        std::vector<std::shared_ptr<FetchTaskBase> > batchFetchTasks;
         for (const FetchTileInfo& fetchTileInfo : fetchTileList) {
             long long tileId = getTileId(fetchTileInfo.tile);
             if (fetchedTiles.find(tileId) != fetchedTiles.end()) {
@@ -444,8 +449,42 @@ namespace massif {
                 }
             }
             if (!found) {
-                fetchTile(getTileId(fetchTileInfo.tile), fetchTileInfo.tile, fetchTileInfo.preloading, fetchTileInfo.priorityDelta);
+                bool batchTile = false;
+                if (_dataSource->isBatchLoadSupported()) {
+                    for (MapTile dataSourceTile = fetchTileInfo.tile; true; dataSourceTile = dataSourceTile.getParent()) {
+                        int zoom = dataSourceTile.getZoom();
+                        if (zoom >= _dataSource->getMinZoom() && zoom <= _dataSource->getMaxZoom()) {
+                            if (batchTileIds.insert(dataSourceTile.getTileId()).second) {
+                                batchTiles.push_back(dataSourceTile);
+                            }
+                            batchTile = true;
+                            break;
+                        }
+                        if (zoom <= 0) {
+                            break;
+                        }
+                    }
+                }
+                std::shared_ptr<FetchTaskBase> task = fetchTile(getTileId(fetchTileInfo.tile), fetchTileInfo.tile, fetchTileInfo.preloading, fetchTileInfo.priorityDelta);
+                if (task && batchTile) {
+                    batchFetchTasks.push_back(task);
+                }
+            }
+        }
+
+        // Hand the new tiles to the data source as a single batch. The batch runs ahead of the individual fetch tasks,
+        // which take their tiles from the batch result instead of loading them one by one. The new tasks cannot have
+        // started yet, as they need the layer mutex held here.
+        if (_batchFetchTask) {
+            _batchFetchTask->cancel();
+            _batchFetchTask.reset();
+        }
+        if (batchTiles.size() > 1 && _tileThreadPool) {
+            _batchFetchTask = std::make_shared<BatchFetchTask>(std::static_pointer_cast<TileLayer>(shared_from_this()), batchTiles);
+            for (const std::shared_ptr<FetchTaskBase>& task : batchFetchTasks) {
+                task->setBatchFetchTask(_batchFetchTask);
             }
+            _tileThreadPool->execute(_batchFetchTask, getUpdatePriority() + BATCH_PRIORITY_OFFSET);
         }
 
         // Cancel old tasks
@@ -647,7 +686,7 @@ namespace massif {
             int budgetMinTileZoom = static_cast<int>(std::floor(maxTileZoom));
             if (budgetMinTileZoom < _terrainMinTileZoom) {
                 if (_terrainMinTileZoom - budgetMinTileZoom > 1) {
-                    Log::Infof("TileLayer::calculateVisibleTiles: the view distance needs %d more levels of terrain tile coarsening than allowed; coarsening to zoom %d to stay inside %d tiles",
+                    LOG_INFOF("TileLayer::calculateVisibleTiles: the view distance needs %d more levels of terrain tile coarsening than allowed; coarsening to zoom %d to stay inside %d tiles",
                                _terrainMinTileZoom - budgetMinTileZoom, budgetMinTileZoom, TERRAIN_COVER_TILE_BUDGET);
                 }
                 _terrainMinTileZoom = std::max(0, budgetMinTileZoom);
@@ -1163,7 +1202,8 @@ namespace massif {
         _preloadingTile(preloadingTile),
         _dataSourceTiles(),
         _started(false),
-        _invalidated(false)
+        _invalidated(false),
+        _batchFetchTask()
     {
         for (MapTile dataSourceTile = tile; true; ) {
             int zoom = dataSourceTile.getZoom();
@@ -1177,6 +1217,81 @@ namespace massif {
         }
     }
 
+    TileLayer::BatchFetchTask::BatchFetchTask(const std::shared_ptr<TileLayer>& layer, const std::vector<MapTile>& dataSourceTiles) :
+        _layer(layer),
+        _dataSourceTiles(dataSourceTiles),
+        _tileDatas(),
+        _started(false),
+        _finished(false),
+        _mutex(),
+        _condition()
+    {
+        for (const MapTile& dataSourceTile : dataSourceTiles) {
+            _tileDatas[dataSourceTile.getTileId()] = std::shared_ptr<TileData>();
+        }
+    }
+
+    std::shared_ptr<TileData> TileLayer::BatchFetchTask::getTileData(const MapTile& dataSourceTile) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_tileDatas.find(dataSourceTile.getTileId()) == _tileDatas.end()) {
+            return std::shared_ptr<TileData>();
+        }
+
+        // If no pool thread has picked up the batch yet, run it here. Waiting for it could block every pool thread.
+        if (!_started) {
+            lock.unlock();
+            run();
+            lock.lock();
+        }
+        _condition.wait(lock, [this]() { return _finished; });
+        return _tileDatas[dataSourceTile.getTileId()];
+    }
+
+    void TileLayer::BatchFetchTask::cancel() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            CancelableTask::cancel();
+            // A batch canceled before it started never runs, the fetch tasks load their tiles themselves
+            if (!_started) {
+                _started = true;
+                _finished = true;
+            }
+        }
+        _condition.notify_all();
+    }
+
+    void TileLayer::BatchFetchTask::run() {
+        TRACE_SCOPE("TileLayer::BatchFetchTask");
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_started) {
+                return;
+            }
+            _started = true;
+        }
+
+        std::vector<std::shared_ptr<TileData> > tileDatas;
+        if (std::shared_ptr<TileLayer> layer = _layer.lock()) {
+            try {
+                tileDatas = layer->_dataSource->loadTiles(_dataSourceTiles);
+            }
+            catch (const std::exception& ex) {
+                Log::Errorf("TileLayer::BatchFetchTask: Exception while loading tiles: %s", ex.what());
+            }
+        } else {
+            Log::Info("TileLayer::BatchFetchTask: Lost connection to layer");
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (std::size_t i = 0; i < tileDatas.size() && i < _dataSourceTiles.size(); i++) {
+                _tileDatas[_dataSourceTiles[i].getTileId()] = tileDatas[i];
+            }
+            _finished = true;
+        }
+        _condition.notify_all();
+    }
+
     long long TileLayer::FetchTaskBase::getTileId() const {
         return _tileId;
     }
@@ -1196,6 +1311,19 @@ namespace massif {
     void TileLayer::FetchTaskBase::invalidate() {
         _invalidated.store(true);
     }
+
+    void TileLayer::FetchTaskBase::setBatchFetchTask(const std::shared_ptr<BatchFetchTask>& batchFetchTask) {
+        _batchFetchTask = batchFetchTask;
+    }
+
+    std::shared_ptr<TileData> TileLayer::FetchTaskBase::loadDataSourceTile(const std::shared_ptr<TileLayer>& layer, const MapTile& dataSourceTile) {
+        if (_batchFetchTask) {
+            if (std::shared_ptr<TileData> tileData = _batchFetchTask->getTileData(dataSourceTile)) {
+                return tileData;
+            }
+        }
+        return layer->_dataSource->loadTile(dataSourceTile);
+    }
         
     void TileLayer::FetchTaskBase::cancel() {
         std::shared_ptr<TileLayer> layer = _layer.lock();
@@ -1219,6 +1347,7 @@ namespace massif {
     }
 
     void TileLayer::FetchTaskBase::run() {
+        TRACE_SCOPE("TileLayer::FetchTask");
         std::shared_ptr<TileLayer> layer = _layer.lock();
         if (!layer) {
             Log::Info("TileLayer::FetchTaskBase: Lost connection to layer");
@@ -1326,6 +1455,8 @@ namespace massif {
     // actually wanted. It used to be +1, so a coarse stand-in was requested first and the map showed
     // it even when the real tile would have arrived just as fast - and for a source that generates
     // its tiles (traced contours) that preview is a full pass whose result is thrown away.
+    // Above the individual fetch tasks, so that they find the batched tiles already loaded (or pending) when they run.
+    const int TileLayer::BATCH_PRIORITY_OFFSET = 1;
     const int TileLayer::PARENT_PRIORITY_OFFSET = -1;
     const int TileLayer::PRELOADING_PRIORITY_OFFSET = -2;
     const double TileLayer::PRELOADING_TILE_SCALE = 1.5;
@@ -18,6 +18,7 @@
 #include <vt/TileId.h>
 
 #include <atomic>
+#include <condition_variable>
 #include <map>
 #include <mutex>
 #include <unordered_map>
@@ -259,6 +260,8 @@ namespace massif {
             std::weak_ptr<TileLayer> _layer;
         };
         
+        class BatchFetchTask;
+
         class FetchTaskBase : public CancelableTask {
         public:
             FetchTaskBase(const std::shared_ptr<TileLayer>& layer, long long tileId, const MapTile& tile, bool preloadingTile);
@@ -270,11 +273,16 @@ namespace massif {
             bool isInvalidated() const;
             void invalidate();
 
+            void setBatchFetchTask(const std::shared_ptr<BatchFetchTask>& batchFetchTask);
+
             virtual void cancel();
             virtual void run();
             
         protected:
             virtual bool loadTile(const std::shared_ptr<TileLayer>& layer) = 0;
+
+            // Takes the tile from the batch this task belongs to, or loads it from the data source if the batch did not load it
+            std::shared_ptr<TileData> loadDataSourceTile(const std::shared_ptr<TileLayer>& layer, const MapTile& dataSourceTile);
             
             std::weak_ptr<TileLayer> _layer;
             long long _tileId;
@@ -287,8 +295,30 @@ namespace massif {
 
             bool _started;
             std::atomic<bool> _invalidated;
+            std::shared_ptr<BatchFetchTask> _batchFetchTask; // set before the task starts, guarded by layer mutex
         };
         
+        class BatchFetchTask : public CancelableTask {
+        public:
+            BatchFetchTask(const std::shared_ptr<TileLayer>& layer, const std::vector<MapTile>& dataSourceTiles);
+
+            // Waits for the batch and returns its result for the tile. Returns null if the tile is not part of the batch,
+            // failed to load, or the batch was canceled before it started. Runs the batch on the calling thread if it has not started yet.
+            std::shared_ptr<TileData> getTileData(const MapTile& dataSourceTile);
+
+            virtual void cancel();
+            virtual void run();
+
+        private:
+            std::weak_ptr<TileLayer> _layer;
+            std::vector<MapTile> _dataSourceTiles;
+            std::unordered_map<long long, std::shared_ptr<TileData> > _tileDatas;
+            bool _started;
+            bool _finished;
+            std::mutex _mutex;
+            std::condition_variable _condition;
+        };
+
         class FetchingTileTasks {
         public:
             FetchingTileTasks() : _fetchingTiles(), _mutex() { }
@@ -379,7 +409,7 @@ namespace massif {
         virtual bool tileExists(long long tileId, bool preloadingCache) const = 0;
         virtual bool tileValid(long long tileId, bool preloadingCache) const = 0;
         virtual bool prefetchTile(long long tileId, bool preloadingTile) = 0;
-        virtual void fetchTile(long long tileId, const MapTile& mapTile, bool preloadingTile, int priorityDelta) = 0;
+        virtual std::shared_ptr<FetchTaskBase> fetchTile(long long tileId, const MapTile& mapTile, bool preloadingTile, int priorityDelta) = 0;
         virtual void clearTiles(bool preloadingTiles) = 0;
         virtual void invalidateTiles(bool preloadingTiles) = 0;
 
@@ -468,6 +498,7 @@ namespace massif {
         std::shared_ptr<TileRenderer> _tileRenderer;
     
         FetchingTileTasks _fetchingTileTasks;
+        std::shared_ptr<BatchFetchTask> _batchFetchTask;
         
     private:
         struct FetchTileInfo {
@@ -495,6 +526,7 @@ namespace massif {
         static const int MAX_STAND_IN_DEPTH;
         static const int MAX_CHILD_SEARCH_DEPTH;
 
+        static const int BATCH_PRIORITY_OFFSET;
         static const int PARENT_PRIORITY_OFFSET;
         static const int PRELOADING_PRIORITY_OFFSET;
         static const double PRELOADING_TILE_SCALE;
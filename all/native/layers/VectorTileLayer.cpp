@@ -17,6 +17,8 @@
 #include "ui/VectorTileClickInfo.h"
 #include "utils/Log.h"
 #include "utils/Const.h"
+#include "utils/TraceProfiler.h"
+#include "vectortiles/NativeVectorTile.h"
 #include "vectortiles/VectorTileDecoder.h"
 #include "vectortiles/MBVectorTileDecoder.h"
 
@@ -268,7 +270,7 @@ namespace massif {
         return false;
     }
     
-    void VectorTileLayer::fetchTile(long long tileId, const MapTile& tile, bool preloadingTile, int priorityDelta) {
+    std::shared_ptr<TileLayer::FetchTaskBase> VectorTileLayer::fetchTile(long long tileId, const MapTile& tile, bool preloadingTile, int priorityDelta) {
         std::shared_ptr<CancelableThreadPool> tileThreadPool;
         {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
@@ -278,7 +280,9 @@ namespace massif {
             auto task = std::make_shared<FetchTask>(std::static_pointer_cast<VectorTileLayer>(shared_from_this()), tileId, MapTile(tile.getX(), tile.getY(), tile.getZoom(), 0), preloadingTile);
             _fetchingTileTasks.insert(tileId, task);
             tileThreadPool->execute(task, getUpdatePriority() + priorityDelta);
+            return task;
         }
+        return std::shared_ptr<FetchTaskBase>();
     }
 
     void VectorTileLayer::clearTiles(bool preloadingTiles) {
@@ -454,8 +458,14 @@ namespace massif {
                     if (!tileInfo.getTileMap()) {
                         _preloadingCache.peek(tileId, tileInfo);
                     }
-                    if (std::shared_ptr<BinaryData> data = tileInfo.getTileData()) {
-                        if (std::shared_ptr<VectorTileFeature> tileFeature = _tileDecoder->decodeFeature(hitResult.featureId, hitResult.tileId, data, tileInfo.getTileBounds())) {
+                    if (tileInfo.getTileData() || tileInfo.getNativeTile()) {
+                        std::shared_ptr<VectorTileFeature> tileFeature;
+                        if (std::shared_ptr<const NativeVectorTile> nativeTile = tileInfo.getNativeTile()) {
+                            tileFeature = _tileDecoder->decodeFeature(hitResult.featureId, hitResult.tileId, nativeTile, tileInfo.getTileBounds());
+                        } else {
+                            tileFeature = _tileDecoder->decodeFeature(hitResult.featureId, hitResult.tileId, tileInfo.getTileData(), tileInfo.getTileBounds());
+                        }
+                        if (tileFeature) {
                             std::shared_ptr<Layer> thisLayer = std::const_pointer_cast<Layer>(shared_from_this());
                             results.push_back(RayIntersectedElement(tileFeature, thisLayer, ray(hitResult.rayT), ray(hitResult.rayT), pass > 0, hitResult.geoPointIndex));
                         } else {
@@ -728,7 +738,11 @@ namespace massif {
             if (isCanceled()) {
                 break;
             }
-            std::shared_ptr<TileData> tileData = layer->_dataSource->loadTile(dataSourceTile);
+            std::shared_ptr<TileData> tileData;
+            {
+                TRACE_SCOPE("VectorTileLayer::loadTileData");
+                tileData = loadDataSourceTile(layer, dataSourceTile);
+            }
             if (!tileData) {
                 break;
             }
@@ -750,7 +764,16 @@ namespace massif {
             vt::TileId vtDataSourceTile(dataSourceTile.getZoom(), dataSourceTile.getX(), dataSourceTile.getY());
             std::shared_ptr<vt::TileTransformer> tileTransformer = layer->getTileTransformer();
             std::shared_ptr<VectorTileDecoder::TileMap> tileMap;
-            if (std::shared_ptr<BinaryData> data = tileData->getData()) {
+            std::shared_ptr<const NativeVectorTile> nativeTile = tileData->getNativeTile();
+            if (nativeTile) {
+                // Generated features go straight to the layer reader, without a protobuf encode and parse in between
+                TRACE_SCOPE("VectorTileLayer::decodeTile");
+                tileMap = layer->_tileDecoder->decodeTile(vtDataSourceTile, vtTile, tileTransformer, nativeTile);
+                if (!tileMap && !nativeTile->getLayers().empty()) {
+                    Log::Error("VectorTileLayer::FetchTask: Failed to decode native tile");
+                }
+            } else if (std::shared_ptr<BinaryData> data = tileData->getData()) {
+                TRACE_SCOPE("VectorTileLayer::decodeTile");
                 tileMap = layer->_tileDecoder->decodeTile(vtDataSourceTile, vtTile, tileTransformer, data);
                 if (!tileMap && !data->empty()) {
                     Log::Error("VectorTileLayer::FetchTask: Failed to decode tile");
@@ -758,7 +781,8 @@ namespace massif {
             }
 
             // Construct tile info - keep original data if interactivity is required
-            VectorTileLayer::TileInfo tileInfo(layer->calculateMapTileBounds(dataSourceTile.getFlipped()), layer->_vectorTileEventListener.get() ? tileData->getData() : std::shared_ptr<BinaryData>(), tileMap);
+            bool interactive = static_cast<bool>(layer->_vectorTileEventListener.get());
+            VectorTileLayer::TileInfo tileInfo(layer->calculateMapTileBounds(dataSourceTile.getFlipped()), interactive && !nativeTile ? tileData->getData() : std::shared_ptr<BinaryData>(), interactive ? nativeTile : std::shared_ptr<const NativeVectorTile>(), tileMap);
             {
                 std::lock_guard<std::recursive_mutex> lock(layer->_mutex);
 
@@ -783,7 +807,7 @@ namespace massif {
             // Debug tile performance issues
             if (Log::IsShowDebug()) {
                 if (tileInfo.getMaxDrawCallCount() >= 20) {
-                    Log::Debugf("VectorTileLayer::FetchTask: Tile requires %d draw calls", tileInfo.getMaxDrawCallCount());
+                    LOG_DEBUGF("VectorTileLayer::FetchTask: Tile requires %d draw calls", tileInfo.getMaxDrawCallCount());
                 }
             }
                 
@@ -813,6 +837,9 @@ namespace massif {
         if (_tileData) {
             size += _tileData->size();
         }
+        if (_nativeTile) {
+            size += _nativeTile->getDataSize();
+        }
         if (_tileMap) {
             for (auto it = _tileMap->begin(); it != _tileMap->end(); it++) {
                 size += it->second->getResidentSize();
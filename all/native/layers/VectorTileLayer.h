@@ -25,6 +25,7 @@
 #include <mapnikvt/Properties.h>
 
 namespace massif {
+    class NativeVectorTile;
     class TileDrawData;
     class VectorTileEventListener;
     class VTLabelPlacementWorker;
@@ -187,7 +188,7 @@ namespace massif {
         virtual bool tileExists(long long tileId, bool preloadingCache) const;
         virtual bool tileValid(long long tileId, bool preloadingCache) const;
         virtual bool prefetchTile(long long tileId, bool preloadingTile);
-        virtual void fetchTile(long long tileId, const MapTile& mapTile, bool preloadingTile, int priorityDelta);
+        virtual std::shared_ptr<FetchTaskBase> fetchTile(long long tileId, const MapTile& mapTile, bool preloadingTile, int priorityDelta);
         virtual void clearTiles(bool preloadingTiles);
         virtual void invalidateTiles(bool preloadingTiles);
 
@@ -253,11 +254,12 @@ namespace massif {
         
         class TileInfo {
         public:
-            TileInfo() : _tileBounds(), _tileData(), _tileMap() { }
-            TileInfo(const MapBounds& tileBounds, const std::shared_ptr<BinaryData>& tileData, const std::shared_ptr<VectorTileDecoder::TileMap>& tileMap) : _tileBounds(tileBounds), _tileData(tileData), _tileMap(tileMap) { }
+            TileInfo() : _tileBounds(), _tileData(), _nativeTile(), _tileMap() { }
+            TileInfo(const MapBounds& tileBounds, const std::shared_ptr<BinaryData>& tileData, const std::shared_ptr<const NativeVectorTile>& nativeTile, const std::shared_ptr<VectorTileDecoder::TileMap>& tileMap) : _tileBounds(tileBounds), _tileData(tileData), _nativeTile(nativeTile), _tileMap(tileMap) { }
 
             const MapBounds& getTileBounds() const { return _tileBounds; }
             const std::shared_ptr<BinaryData>& getTileData() const { return _tileData; }
+            const std::shared_ptr<const NativeVectorTile>& getNativeTile() const { return _nativeTile; }
             const std::shared_ptr<VectorTileDecoder::TileMap>& getTileMap() const { return _tileMap; }
 
             int getMaxDrawCallCount() const;
@@ -266,6 +268,7 @@ namespace massif {
         private:
             MapBounds _tileBounds;
             std::shared_ptr<BinaryData> _tileData;
+            std::shared_ptr<const NativeVectorTile> _nativeTile;
             std::shared_ptr<VectorTileDecoder::TileMap> _tileMap;
         };
 
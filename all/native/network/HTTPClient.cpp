@@ -4,6 +4,7 @@
 #include "utils/Log.h"
 
 #include <chrono>
+#include <future>
 #include <limits>
 #include <regex>
 
@@ -36,6 +37,10 @@ namespace massif {
         _impl->setTimeout(milliseconds);
     }
 
+    bool HTTPClient::isAsyncSupported() const {
+        return _impl->isAsyncSupported();
+    }
+
     int HTTPClient::get(const std::string& url, const std::map<std::string, std::string>& requestHeaders, std::map<std::string, std::string>& responseHeaders, std::shared_ptr<BinaryData>& responseData, int* statusCode) const {
         Request request("GET", url);
         request.headers.insert(requestHeaders.begin(), requestHeaders.end());
@@ -63,6 +68,43 @@ namespace massif {
         return code;
     }
 
+    void HTTPClient::getAsync(const std::string& url, const std::map<std::string, std::string>& requestHeaders, ResponseFunc responseFn) const {
+        Request request("GET", url);
+        request.headers.insert(requestHeaders.begin(), requestHeaders.end());
+        if (request.headers.count("Accept") == 0) {
+            request.headers["Accept"] = "*/*";
+        }
+
+        auto content = std::make_shared<std::vector<unsigned char> >();
+        content->reserve(65536);
+        auto handlerFn = [content](std::uint64_t offset, std::uint64_t length, const unsigned char* buf, std::size_t size) -> bool {
+            if (content->size() != offset) {
+                content->resize(static_cast<std::size_t>(offset));
+            }
+            content->insert(content->end(), buf, buf + size);
+            return true;
+        };
+
+        auto response = std::make_shared<Response>();
+        makeRequestAsync(request, response, handlerFn, 0, [this, url, response, content, responseFn](int code, std::exception_ptr exception) {
+            if (exception) {
+                try {
+                    std::rethrow_exception(exception);
+                }
+                catch (const std::exception& ex) {
+                    if (_log) {
+                        Log::Errorf("HTTPClient::getAsync: Exception while loading URL %s: %s", url.c_str(), ex.what());
+                    }
+                }
+                catch (...) {
+                }
+                code = -1;
+            }
+            std::map<std::string, std::string> responseHeaders(response->headers.begin(), response->headers.end());
+            responseFn(code, response->statusCode, responseHeaders, std::make_shared<BinaryData>(std::move(*content)));
+        });
+    }
+
     int HTTPClient::post(const std::string& url, const std::string& contentType, const std::shared_ptr<BinaryData>& requestData, const std::map<std::string, std::string>& requestHeaders, std::map<std::string, std::string>& responseHeaders, std::shared_ptr<BinaryData>& responseData) {
         Request request("POST", url);
         request.contentType = contentType;
@@ -107,72 +149,130 @@ namespace massif {
     }
 
     int HTTPClient::makeRequest(Request request, Response& response, HandlerFunc handlerFn, std::uint64_t offset) const {
-        std::uint64_t contentOffset = 0;
-        std::uint64_t contentLength = std::numeric_limits<std::uint64_t>::max();
+        auto promise = std::make_shared<std::promise<int> >();
+        std::future<int> future = promise->get_future();
+        auto asyncResponse = std::make_shared<Response>();
+        makeRequestAsync(request, asyncResponse, handlerFn, offset, [promise](int code, std::exception_ptr exception) {
+            if (exception) {
+                promise->set_exception(exception);
+            } else {
+                promise->set_value(code);
+            }
+        });
+        future.wait();
+        response = *asyncResponse;
+        return future.get();
+    }
 
-        auto headersFn = [&](int statusCode, const std::map<std::string, std::string>& headers) {
-            response.statusCode = statusCode;
-            response.headers.insert(headers.begin(), headers.end());
+    void HTTPClient::makeRequestAsync(const Request& request, const std::shared_ptr<Response>& response, HandlerFunc handlerFn, std::uint64_t offset, CompletionFunc completionFn) const {
+        struct ContentState {
+            std::uint64_t offset = 0;
+            std::uint64_t contentOffset = 0;
+            std::uint64_t contentLength = std::numeric_limits<std::uint64_t>::max();
+        };
+        auto content = std::make_shared<ContentState>();
+        content->offset = offset;
+
+        auto headersFn = [this, url = request.url, response, content, offset](int statusCode, const std::map<std::string, std::string>& headers) {
+            response->statusCode = statusCode;
+            response->headers.insert(headers.begin(), headers.end());
 
             // Read Content-Range
             if (statusCode == 206) {
-                auto it = response.headers.find("Content-Range");
-                if (it != response.headers.end()) {
+                auto it = response->headers.find("Content-Range");
+                if (it != response->headers.end()) {
                     std::cmatch what;
                     if (std::regex_match(it->second.c_str(), what, std::regex("bytes ([0-9]+)-.*"))) {
-                        contentOffset = boost::lexical_cast<std::uint64_t>(what[1]);
+                        content->contentOffset = boost::lexical_cast<std::uint64_t>(what[1]);
                     }
                 }
-                if (contentOffset != offset) {
+                if (content->contentOffset != offset) {
                     if (_log) {
-                        Log::Errorf("HTTPClient::makeRequest: Content range mismatch: %d/%d, URL: %s", static_cast<int>(contentOffset), static_cast<int>(offset), request.url.c_str());
+                        Log::Errorf("HTTPClient::makeRequest: Content range mismatch: %d/%d, URL: %s", static_cast<int>(content->contentOffset), static_cast<int>(offset), url.c_str());
                     }
                     return false;
                 }
             }
 
             // Read Content-Length
-            auto it = response.headers.find("Content-Length");
-            if (it != response.headers.end()) {
-                contentLength = boost::lexical_cast<std::uint64_t>(it->second);
+            auto it = response->headers.find("Content-Length");
+            if (it != response->headers.end()) {
+                content->contentLength = boost::lexical_cast<std::uint64_t>(it->second);
             }
 
             return true;
         };
 
-        std::uint64_t originalOffset = offset;
-        auto dataFn = [&](const unsigned char* data, std::size_t size) {
-            bool result = handlerFn(offset, contentOffset + contentLength, data, size);
-            offset += size;
+        auto dataFn = [handlerFn, content](const unsigned char* data, std::size_t size) {
+            bool result = handlerFn(content->offset, content->contentOffset + content->contentLength, data, size);
+            content->offset += size;
             return result;
         };
 
-        if (!_impl->makeRequest(request, headersFn, dataFn)) {
-            return -1; // request was cancelled
-        }
+        _impl->makeRequestAsync(request, headersFn, dataFn, [this, request, response, handlerFn, offset, completionFn](bool result, std::exception_ptr exception) {
+            if (exception) {
+                completionFn(-1, exception);
+                return;
+            }
+            if (!result) {
+                completionFn(-1, std::exception_ptr()); // request was cancelled
+                return;
+            }
 
-        if (response.statusCode >= 300 && response.statusCode < 400) {
-            auto it = response.headers.find("Location");
-            if (it != response.headers.end()) {
-                std::string location = it->second;
+            if (response->statusCode == 304) {
+                // Not modified is a valid answer only to a conditional request, the caller then keeps its own copy
+                if (request.headers.count("If-None-Match") > 0 || request.headers.count("If-Modified-Since") > 0) {
+                    completionFn(0, std::exception_ptr());
+                    return;
+                }
                 if (_log) {
-                    Log::Infof("HTTPClient::makeRequest: Redirection from URL: %s to URL: %s", request.url.c_str(), location.c_str());
+                    Log::Errorf("HTTPClient::makeRequest: Not modified response to unconditional request, URL: %s", request.url.c_str());
                 }
-                Request redirectedRequest(request);
-                redirectedRequest.url = location;
-                response = Response();
-                return makeRequest(redirectedRequest, response, handlerFn, originalOffset);
+                completionFn(response->statusCode, std::exception_ptr());
+                return;
             }
-        }
 
-        if (response.statusCode < 200 || response.statusCode >= 300) {
-            if (_log) {
-                Log::Errorf("HTTPClient::makeRequest: Bad status code: %d, URL: %s", response.statusCode, request.url.c_str());
+            if (response->statusCode >= 300 && response->statusCode < 400) {
+                auto it = response->headers.find("Location");
+                if (it != response->headers.end()) {
+                    std::string location = it->second;
+                    if (_log) {
+                        LOG_INFOF("HTTPClient::makeRequest: Redirection from URL: %s to URL: %s", request.url.c_str(), location.c_str());
+                    }
+                    Request redirectedRequest(request);
+                    redirectedRequest.url = location;
+                    *response = Response();
+                    makeRequestAsync(redirectedRequest, response, handlerFn, offset, completionFn);
+                    return;
+                }
             }
-            return response.statusCode;
-        }
 
-        return 0;
+            if (response->statusCode < 200 || response->statusCode >= 300) {
+                if (_log) {
+                    Log::Errorf("HTTPClient::makeRequest: Bad status code: %d, URL: %s", response->statusCode, request.url.c_str());
+                }
+                completionFn(response->statusCode, std::exception_ptr());
+                return;
+            }
+
+            completionFn(0, std::exception_ptr());
+        });
+    }
+
+    bool HTTPClient::Impl::isAsyncSupported() const {
+        return false;
+    }
+
+    void HTTPClient::Impl::makeRequestAsync(const HTTPClient::Request& request, HeadersFunc headersFn, DataFunc dataFn, CompletionFunc completionFn) const {
+        bool result = false;
+        try {
+            result = makeRequest(request, headersFn, dataFn);
+        }
+        catch (...) {
+            completionFn(false, std::current_exception());
+            return;
+        }
+        completionFn(result, std::exception_ptr());
     }
 
     HTTPClient::Impl::~Impl() {
@@ -13,6 +13,7 @@
 #include <vector>
 #include <mutex>
 #include <cstdint>
+#include <exception>
 #include <functional>
 
 namespace massif {
@@ -21,13 +22,22 @@ namespace massif {
     class HTTPClient {
     public:
         typedef std::function<bool(std::uint64_t, std::uint64_t, const unsigned char*, std::size_t)> HandlerFunc;
+        typedef std::function<void(int, int, const std::map<std::string, std::string>&, const std::shared_ptr<BinaryData>&)> ResponseFunc;
 
         explicit HTTPClient(bool log);
 
         void setTimeout(int milliseconds);
 
+        // Returns true if asynchronous requests run concurrently. Otherwise getAsync runs the request on the calling thread
+        // before returning, so issuing several requests in a row downloads them one after another.
+        bool isAsyncSupported() const;
+
         int get(const std::string& url, const std::map<std::string, std::string>& requestHeaders, std::map<std::string, std::string>& responseHeaders, std::shared_ptr<BinaryData>& responseData, int* statusCode = 0) const;
         int post(const std::string& url, const std::string& contentType, const std::shared_ptr<BinaryData>& requestData, const std::map<std::string, std::string>& requestHeaders, std::map<std::string, std::string>& responseHeaders, std::shared_ptr<BinaryData>& responseData);
+        // Starts a GET request and returns immediately. The response function receives the same error code, status code,
+        // headers and data as get() once the request finishes. It may be called on a thread shared with other requests,
+        // so it should only hand the result over; the client must outlive its asynchronous requests.
+        void getAsync(const std::string& url, const std::map<std::string, std::string>& requestHeaders, ResponseFunc responseFn) const;
         int streamResponse(const std::string& method, const std::string& url, const std::map<std::string, std::string>& requestHeaders, std::map<std::string, std::string>& responseHeaders, HandlerFunc handlerFn, std::uint64_t offset) const;
 
     private:
@@ -67,11 +77,16 @@ namespace massif {
         public:
             typedef std::function<bool(int, const std::map<std::string, std::string>&)> HeadersFunc;
             typedef std::function<bool(const unsigned char*, std::size_t)> DataFunc;
+            typedef std::function<void(bool, std::exception_ptr)> CompletionFunc;
 
             virtual ~Impl();
 
             virtual void setTimeout(int milliseconds) = 0;
             virtual bool makeRequest(const HTTPClient::Request& request, HeadersFunc headersFn, DataFunc dataFn) const = 0;
+            // Default implementation returns false, as the default makeRequestAsync is synchronous.
+            virtual bool isAsyncSupported() const;
+            // Default implementation runs the request synchronously on the calling thread.
+            virtual void makeRequestAsync(const HTTPClient::Request& request, HeadersFunc headersFn, DataFunc dataFn, CompletionFunc completionFn) const;
         };
 
         class PionImpl;
@@ -79,7 +94,10 @@ namespace massif {
         class IOSImpl;
         class WinSockImpl;
 
+        typedef std::function<void(int, std::exception_ptr)> CompletionFunc;
+
         int makeRequest(Request request, Response& response, HandlerFunc handlerFn, std::uint64_t offset) const;
+        void makeRequestAsync(const Request& request, const std::shared_ptr<Response>& response, HandlerFunc handlerFn, std::uint64_t offset, CompletionFunc completionFn) const;
 
         bool _log;
         std::unique_ptr<Impl> _impl;
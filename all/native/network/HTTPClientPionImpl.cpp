@@ -3,6 +3,7 @@
 #include "utils/Log.h"
 
 #include <chrono>
+#include <future>
 #include <limits>
 #include <regex>
 
@@ -13,205 +14,455 @@ namespace massif {
 
     HTTPClient::PionImpl::PionImpl(bool log) :
         _log(log),
-        _connectionMap(),
-        _mutex()
+        _timeout(-1)
     {
+        GetEngine();
+    }
+
+    HTTPClient::PionImpl::~PionImpl() {
+    }
+
+    void HTTPClient::PionImpl::setTimeout(int milliseconds) {
+        _timeout = milliseconds;
     }
 
     bool HTTPClient::PionImpl::makeRequest(const HTTPClient::Request& request, HeadersFunc headersFn, DataFunc dataFn) const {
+        auto promise = std::make_shared<std::promise<bool> >();
+        std::future<bool> future = promise->get_future();
+        makeRequestAsync(request, headersFn, dataFn, [promise](bool result, std::exception_ptr exception) {
+            if (exception) {
+                promise->set_exception(exception);
+            } else {
+                promise->set_value(result);
+            }
+        });
+        return future.get();
+    }
+
+    bool HTTPClient::PionImpl::isAsyncSupported() const {
+        return true;
+    }
+
+    void HTTPClient::PionImpl::makeRequestAsync(const HTTPClient::Request& request, HeadersFunc headersFn, DataFunc dataFn, CompletionFunc completionFn) const {
         // Parse request URL
         std::string proto, host, path, query;
         std::uint16_t port;
         if (!pion::http::parser::parse_uri(request.url, proto, host, port, path, query)) {
-            throw NetworkException("Invalid URL", request.url);
+            completionFn(false, std::make_exception_ptr(NetworkException("Invalid URL", request.url)));
+            return;
         }
         if (proto == "https") {
-            throw NetworkException("HTTPS protocol not supported", request.url);
+            completionFn(false, std::make_exception_ptr(NetworkException("HTTPS protocol not supported", request.url)));
+            return;
         }
-        auto connectionKey = std::make_pair(host, port);
 
-        // Try to reuse existing connection from the pool for GET methods
-        bool result = false;
-        while (true) {
-            std::shared_ptr<Connection> connection;
-            {
-                std::lock_guard<std::mutex> lock(_mutex);
-                auto it = _connectionMap.find(connectionKey);
-                if (it != _connectionMap.end()) {
-                    connection = it->second;
-                    _connectionMap.erase(it);
-                }
+        Engine& engine = GetEngine();
+        auto transfer = std::make_shared<Transfer>(engine.ioService, request, headersFn, dataFn, completionFn);
+        transfer->log = _log;
+        transfer->timeout = _timeout;
+        transfer->hostKey = std::make_pair(host, static_cast<int>(port));
+
+        // Form the request
+        std::string& requestData = transfer->requestData;
+        requestData = request.method + " " + path + (query.empty() ? std::string() : "?" + query) + " HTTP/1.1\r\n";
+        requestData += "Host: " + host + (port != 80 ? ":" + boost::lexical_cast<std::string>(port) : std::string()) + "\r\n";
+        for (auto it = request.headers.begin(); it != request.headers.end(); it++) {
+            requestData += it->first + ": " + it->second + "\r\n";
+        }
+        if (!request.contentType.empty()) {
+            requestData += "Content-Length: " + boost::lexical_cast<std::string>(request.body.size()) + "\r\n";
+        }
+        requestData += "\r\n";
+        if (!request.contentType.empty()) {
+            requestData.append(reinterpret_cast<const char*>(request.body.data()), request.body.size());
+        }
+
+        engine.ioService.post([transfer]() {
+            StartTransfer(transfer);
+        });
+    }
+
+    HTTPClient::PionImpl::Engine& HTTPClient::PionImpl::GetEngine() {
+        // The engine lives until the process exits, so handlers never outlive the io_service
+        static Engine* engine = new Engine();
+        return *engine;
+    }
+
+    void HTTPClient::PionImpl::StartTransfer(const std::shared_ptr<Transfer>& transfer) {
+        Host& host = GetEngine().hosts[transfer->hostKey];
+        if (!host.waitingTransfers.empty() || !AssignConnection(host, transfer)) {
+            host.waitingTransfers.push_back(transfer);
+        }
+    }
+
+    bool HTTPClient::PionImpl::AssignConnection(Host& host, const std::shared_ptr<Transfer>& transfer) {
+        // Prefer the most recently used idle connection, it is the least likely to be closed by the server
+        while (!host.idleConnections.empty()) {
+            std::shared_ptr<Connection> connection = host.idleConnections.back();
+            host.idleConnections.pop_back();
+            if (connection->isValid()) {
+                transfer->connection = connection;
+                transfer->reused = true;
+                SendRequest(transfer);
+                return true;
             }
-            if (!connection) {
-                break;
+            asio::error_code error;
+            connection->socket.close(error);
+            host.connectionCount--;
+        }
+
+        if (host.connectionCount < MAX_HOST_CONNECTIONS) {
+            host.connectionCount++;
+            transfer->connection = std::make_shared<Connection>(GetEngine().ioService);
+            transfer->reused = false;
+            Connect(transfer);
+            return true;
+        }
+        return false;
+    }
+
+    void HTTPClient::PionImpl::Connect(const std::shared_ptr<Transfer>& transfer) {
+        ArmTimer(transfer);
+        asio::ip::tcp::resolver::query query(transfer->hostKey.first, boost::lexical_cast<std::string>(transfer->hostKey.second));
+        transfer->resolver.async_resolve(query, [transfer](const asio::error_code& error, asio::ip::tcp::resolver::iterator endpoints) {
+            if (error) {
+                HandleError(transfer, error);
+                return;
             }
-            if (!connection->isValid()) {
-                continue;
+            asio::async_connect(transfer->connection->socket, endpoints, [transfer](const asio::error_code& error, asio::ip::tcp::resolver::iterator) {
+                if (error) {
+                    HandleError(transfer, error);
+                    return;
+                }
+                SendRequest(transfer);
+            });
+        });
+    }
+
+    void HTTPClient::PionImpl::SendRequest(const std::shared_ptr<Transfer>& transfer) {
+        transfer->requestTime = std::chrono::steady_clock::now();
+        transfer->bytesReceived = 0;
+        transfer->response = pion::http::response();
+        transfer->parser.reset(new pion::http::parser(false, 0));
+        Transfer* transferPtr = transfer.get();
+        transfer->parser->set_payload_handler([transferPtr](const char* buf, std::size_t size) {
+            std::shared_ptr<Transfer> transfer = transferPtr->shared_from_this();
+            if (!DeliverHeaders(transfer)) {
+                return;
             }
+            auto data = std::make_shared<std::vector<unsigned char> >(buf, buf + size);
+            Deliver(transfer, Delivery { size, [data](Transfer& transfer) {
+                return transfer.dataFn(data->data(), data->size());
+            } });
+        });
 
-            result = makeRequest(*connection, request, headersFn, dataFn);
+        ArmTimer(transfer);
+        asio::async_write(transfer->connection->socket, asio::buffer(transfer->requestData), [transfer](const asio::error_code& error, std::size_t) {
+            if (error) {
+                HandleError(transfer, error);
+                return;
+            }
+            ReadResponse(transfer);
+        });
+    }
+
+    void HTTPClient::PionImpl::ReadResponse(const std::shared_ptr<Transfer>& transfer) {
+        ArmTimer(transfer);
+        transfer->connection->socket.async_read_some(asio::buffer(transfer->buffer), [transfer](const asio::error_code& error, std::size_t bytesRead) {
+            if (error) {
+                // If Content-Length was not explicitly defined, the content ends at EOF
+                if (error == asio::error::eof && transfer->bytesReceived > 0 && !transfer->parser->check_premature_eof(transfer->response)) {
+                    CompleteResponse(transfer, false);
+                    return;
+                }
+                HandleError(transfer, error);
+                return;
+            }
+            transfer->bytesReceived += bytesRead;
 
+            // Feed read data to HTTP parser, content is passed to the payload handler
+            asio::error_code parserError;
+            transfer->parser->set_read_buffer(transfer->buffer.data(), bytesRead);
+            boost::tribool result = transfer->parser->parse(transfer->response, parserError);
+            if (parserError) {
+                FinishTransfer(transfer, false, false, std::make_exception_ptr(NetworkException(parserError.message(), transfer->request.url)));
+                return;
+            }
+            if (transfer->cancel) {
+                FinishTransfer(transfer, false, false, std::exception_ptr());
+                return;
+            }
             if (result) {
-                std::lock_guard<std::mutex> lock(_mutex);
-                if (request.method == "GET") {
-                    _connectionMap.insert(std::make_pair(connectionKey, connection));
+                CompleteResponse(transfer, true);
+                return;
+            }
+
+            // Stop reading while the callbacks lag behind, RunCallbacks resumes once they catch up
+            {
+                std::lock_guard<std::mutex> lock(transfer->deliveryMutex);
+                if (transfer->deliveryBytes > MAX_BUFFERED_BYTES) {
+                    transfer->readPaused = true;
+                    asio::error_code timerError;
+                    transfer->timer.cancel(timerError);
+                    return;
                 }
-                return result;
             }
-        }
+            ReadResponse(transfer);
+        });
+    }
 
-        // Create new connection
-        auto connection = std::make_shared<Connection>(host, port);
-        if (!connection->isValid()) {
-            return false;
-        }
+    bool HTTPClient::PionImpl::DeliverHeaders(const std::shared_ptr<Transfer>& transfer) {
+        if (!transfer->headersDelivered) {
+            transfer->headersDelivered = true;
 
-        result = makeRequest(*connection, request, headersFn, dataFn);
+            int statusCode = transfer->response.get_status_code();
+            auto headers = std::make_shared<std::map<std::string, std::string> >(transfer->response.get_headers().begin(), transfer->response.get_headers().end());
+            Deliver(transfer, Delivery { 0, [statusCode, headers](Transfer& transfer) {
+                return transfer.headersFn(statusCode, *headers);
+            } });
+        }
+        return !transfer->cancel;
+    }
 
-        if (result) {
-            std::lock_guard<std::mutex> lock(_mutex);
-            if (request.method == "GET") {
-                _connectionMap.insert(std::make_pair(connectionKey, connection));
+    void HTTPClient::PionImpl::Deliver(const std::shared_ptr<Transfer>& transfer, Delivery delivery) {
+        {
+            std::lock_guard<std::mutex> lock(transfer->deliveryMutex);
+            transfer->deliveryBytes += delivery.size;
+            transfer->deliveries.push_back(std::move(delivery));
+            if (transfer->deliveryScheduled) {
+                return;
             }
+            transfer->deliveryScheduled = true;
         }
-        return result;
+        ScheduleCallbacks(transfer);
     }
 
-    bool HTTPClient::PionImpl::makeRequest(Connection& connection, const HTTPClient::Request& request, HeadersFunc headersFn, DataFunc dataFn) const {
-        std::string url = request.url;
-        std::string proto, host, path, query;
-        std::uint16_t port;
-        if (!pion::http::parser::parse_uri(request.url, proto, host, port, path, query)) {
-            throw NetworkException("Invalid URL", request.url);
+    void HTTPClient::PionImpl::ScheduleCallbacks(const std::shared_ptr<Transfer>& transfer) {
+        Engine& engine = GetEngine();
+        {
+            std::lock_guard<std::mutex> lock(engine.callbackMutex);
+            engine.callbackTransfers.push_back(transfer);
         }
+        engine.callbackCondition.notify_one();
+    }
 
-        // Form and send request
-        asio::error_code socketError;
-        std::chrono::steady_clock::time_point requestTime = std::chrono::steady_clock::now();
-        pion::http::request pionRequest(path);
-        pionRequest.set_method(request.method);
-        pionRequest.set_query_string(query);
-        if (!request.contentType.empty()) {
-            pionRequest.set_content(reinterpret_cast<const char*>(request.body.data()), request.body.size());
-        } else {
-            pionRequest.set_do_not_send_content_length();
-        }
-        pionRequest.add_header("Host", request.url);
-        for (auto it = request.headers.begin(); it != request.headers.end(); it++) {
-            pionRequest.add_header(it->first, it->second);
-        }
-        pionRequest.send(*connection.connection, socketError);
-        if (socketError) {
-            throw NetworkException(socketError.message(), request.url);
-        }
+    void HTTPClient::PionImpl::RunCallbacks(const std::shared_ptr<Transfer>& transfer) {
+        std::unique_lock<std::mutex> lock(transfer->deliveryMutex);
+        if (transfer->deliveries.empty()) {
+            transfer->deliveryScheduled = false;
+            if (!transfer->finished) {
+                return;
+            }
+            transfer->finished = false;
+            bool result = transfer->result && !transfer->cancel;
+            std::exception_ptr exception = transfer->callbackException ? transfer->callbackException : transfer->exception;
+            lock.unlock();
 
-        // Send the request
-        bool cancel = false;
-        asio::error_code parserError;
-        pion::http::parser parser(false, 0);
-        parser.set_payload_handler([&dataFn, &cancel](const char* buf, std::size_t size) {
-            if (!dataFn(reinterpret_cast<const unsigned char*>(buf), size)) {
-                cancel = true;
+            try {
+                transfer->completionFn(result, exception);
             }
-        });
+            catch (const std::exception& ex) {
+                if (transfer->log) {
+                    Log::Errorf("HTTPClient::PionImpl: Exception in completion handler, URL: %s: %s", transfer->request.url.c_str(), ex.what());
+                }
+            }
+            return;
+        }
+
+        // Run a single callback and requeue the transfer, so that concurrent transfers share the callback threads
+        Delivery delivery = std::move(transfer->deliveries.front());
+        transfer->deliveries.pop_front();
+        lock.unlock();
 
-        // Read headers
-        asio::streambuf buffer;
-        std::size_t bytesRead = asio::read_until(*connection.connection, buffer, "\r\n\r\n", socketError);
-        if (socketError) {
-            throw NetworkException(socketError.message(), request.url);
+        if (!transfer->cancel) {
+            try {
+                if (!delivery.callbackFn(*transfer)) {
+                    transfer->cancel = true;
+                }
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> exceptionLock(transfer->deliveryMutex);
+                transfer->callbackException = std::current_exception();
+                transfer->cancel = true;
+            }
         }
 
-        // Feed read data to HTTP parser
-        pion::http::response pionResponse;
-        std::vector<char> bufferData(asio::buffers_begin(buffer.data()), asio::buffers_end(buffer.data()));
-        parser.set_read_buffer(bufferData.data(), bufferData.size());
-        parser.parse(pionResponse, parserError);
-        buffer.consume(bufferData.size());
-        if (parserError) {
-            throw NetworkException(parserError.message(), request.url);
+        lock.lock();
+        transfer->deliveryBytes -= delivery.size;
+        if (transfer->readPaused && (transfer->deliveryBytes <= MAX_BUFFERED_BYTES || transfer->cancel)) {
+            transfer->readPaused = false;
+            GetEngine().ioService.post([transfer]() {
+                if (transfer->cancel) {
+                    FinishTransfer(transfer, false, false, std::exception_ptr());
+                    return;
+                }
+                ReadResponse(transfer);
+            });
         }
+        lock.unlock();
+        ScheduleCallbacks(transfer);
+    }
 
-        // Call headers callback
-        std::map<std::string, std::string> headers;
-        headers.insert(pionResponse.get_headers().begin(), pionResponse.get_headers().end());
-        if (!headersFn(pionResponse.get_status_code(), headers)) {
-            cancel = true;
+    void HTTPClient::PionImpl::CompleteResponse(const std::shared_ptr<Transfer>& transfer, bool keepAlive) {
+        if (!DeliverHeaders(transfer)) {
+            FinishTransfer(transfer, false, false, std::exception_ptr());
+            return;
         }
 
         // Check Keep-Alive directive
+        Connection& connection = *transfer->connection;
         connection.maxRequests--;
-        it = pionResponse.get_headers().find("Keep-Alive");
-        if (it != pionResponse.get_headers().end()) {
+        auto it = transfer->response.get_headers().find("Keep-Alive");
+        if (it != transfer->response.get_headers().end()) {
             std::cmatch what;
-            if (std::regex_match(it->second.c_str(), what, std::regex(".*[^a-zA-Z0-9]timeout=([0-9]*).*"))) {
+            if (std::regex_match(it->second.c_str(), what, std::regex(".*[^a-zA-Z0-9]?timeout=([0-9]*).*"))) {
                 long long timeout = boost::lexical_cast<long long>(what[1]);
-                connection.keepAliveTime = requestTime + std::chrono::seconds(timeout);
+                connection.keepAliveTime = transfer->requestTime + std::chrono::seconds(timeout);
             }
-            if (std::regex_match(it->second.c_str(), what, std::regex(".*[^a-zA-Z0-9]max=([0-9]*).*"))) {
+            if (std::regex_match(it->second.c_str(), what, std::regex(".*[^a-zA-Z0-9]?max=([0-9]*).*"))) {
                 int maxRequests = boost::lexical_cast<int>(what[1]);
                 connection.maxRequests = std::min(connection.maxRequests, maxRequests);
             }
         } else {
-            connection.keepAliveTime = requestTime + std::chrono::seconds(5); // Apache servers have this limitation typically
+            connection.keepAliveTime = transfer->requestTime + std::chrono::seconds(5); // Apache servers have this limitation typically
         }
 
-        // Read Content-Length
-        std::uint64_t contentLength = std::numeric_limits<std::uint64_t>::max();
-        auto it = pionResponse.get_headers().find("Content-Length");
-        if (it != pionResponse.get_headers().end()) {
-            contentLength = boost::lexical_cast<std::uint64_t>(it->second);
-        } else {
-            connection.maxRequests = 0; // force new connection next time
-        }
+        FinishTransfer(transfer, keepAlive && transfer->response.check_keep_alive(), true, std::exception_ptr());
+    }
 
-        // Read response
-        for (std::uint64_t offset = 0; offset < contentLength && !cancel; ) {
-            bytesRead = asio::read(*connection.connection, buffer, asio::transfer_at_least(1), socketError);
-            if (socketError) {
-                // If Content-Length was not explicitly defined, break at EOF
-                if (socketError == asio::error::eof && contentLength == std::numeric_limits<std::uint64_t>::max()) {
-                    break;
-                }
-                throw NetworkException(socketError.message(), request.url);
+    void HTTPClient::PionImpl::HandleError(const std::shared_ptr<Transfer>& transfer, const asio::error_code& error) {
+        // A pooled connection may have been closed by the server meanwhile, retry with another one
+        if (transfer->reused && transfer->bytesReceived == 0 && !transfer->timedOut) {
+            Host& host = GetEngine().hosts[transfer->hostKey];
+            asio::error_code closeError;
+            transfer->connection->socket.close(closeError);
+            transfer->connection.reset();
+            host.connectionCount--;
+            if (!AssignConnection(host, transfer)) {
+                host.waitingTransfers.push_front(transfer);
             }
+            return;
+        }
 
-            // Parse read data
-            bufferData.assign(asio::buffers_begin(buffer.data()), asio::buffers_end(buffer.data()));
-            parser.set_read_buffer(bufferData.data(), bufferData.size());
-            parser.parse(pionResponse, parserError);
-            buffer.consume(bufferData.size());
-            if (parserError) {
-                throw NetworkException(parserError.message(), request.url);
+        std::string message = transfer->timedOut ? std::string("Request timed out") : error.message();
+        FinishTransfer(transfer, false, false, std::make_exception_ptr(NetworkException(message, transfer->request.url)));
+    }
+
+    void HTTPClient::PionImpl::FinishTransfer(const std::shared_ptr<Transfer>& transfer, bool reusable, bool result, std::exception_ptr exception) {
+        asio::error_code error;
+        transfer->timer.cancel(error);
+
+        // Hand the connection over to a waiting request of the same host, keep it idle or close it
+        Host& host = GetEngine().hosts[transfer->hostKey];
+        if (std::shared_ptr<Connection> connection = std::move(transfer->connection)) {
+            if (reusable && connection->isValid()) {
+                host.idleConnections.push_back(connection);
+            } else {
+                connection->socket.close(error);
+                host.connectionCount--;
             }
+        }
+        while (!host.waitingTransfers.empty()) {
+            std::shared_ptr<Transfer> waitingTransfer = host.waitingTransfers.front();
+            if (!AssignConnection(host, waitingTransfer)) {
+                break;
+            }
+            host.waitingTransfers.pop_front();
+        }
 
-            offset += bytesRead;
+        // The completion callback runs after the pending data callbacks
+        {
+            std::lock_guard<std::mutex> lock(transfer->deliveryMutex);
+            transfer->finished = true;
+            transfer->result = result;
+            transfer->exception = exception;
+            if (transfer->deliveryScheduled) {
+                return;
+            }
+            transfer->deliveryScheduled = true;
         }
+        ScheduleCallbacks(transfer);
+    }
 
-        return !cancel;
+    void HTTPClient::PionImpl::ArmTimer(const std::shared_ptr<Transfer>& transfer) {
+        if (transfer->timeout < 0) {
+            return;
+        }
+        transfer->timer.expires_from_now(std::chrono::milliseconds(transfer->timeout));
+        std::weak_ptr<Transfer> weakTransfer = transfer;
+        transfer->timer.async_wait([weakTransfer](const asio::error_code& error) {
+            std::shared_ptr<Transfer> transfer = weakTransfer.lock();
+            if (error || !transfer || !transfer->connection) {
+                return;
+            }
+            if (transfer->timer.expires_at() > std::chrono::steady_clock::now()) {
+                return; // rearmed after this wait was scheduled
+            }
+            // Closing the socket aborts the pending operation, which then reports the timeout
+            transfer->timedOut = true;
+            asio::error_code closeError;
+            transfer->resolver.cancel();
+            transfer->connection->socket.close(closeError);
+        });
     }
 
-    HTTPClient::PionImpl::Connection::Connection(const std::string& host, std::uint16_t port) :
-        maxRequests(std::numeric_limits<int>::max()), keepAliveTime(), ioService(), connection()
+    HTTPClient::PionImpl::Connection::Connection(asio::io_service& ioService) :
+        maxRequests(std::numeric_limits<int>::max()), keepAliveTime(), socket(ioService)
     {
-        // Connect to server
-        connection = std::make_shared<pion::tcp::connection>(ioService);
-        connection->set_lifecycle(pion::tcp::connection::LIFECYCLE_KEEPALIVE);
-        asio::error_code socketError = connection->connect(host, port);
-        if (socketError) {
-            connection.reset();
-        }
     }
 
     bool HTTPClient::PionImpl::Connection::isValid() const {
-        if (!connection) {
-            return false;
-        }
-        if (connection->get_lifecycle() == pion::tcp::connection::LIFECYCLE_CLOSE) {
+        if (!socket.is_open()) {
             return false;
         }
         std::chrono::steady_clock::time_point nullTime;
         return maxRequests > 0 && (keepAliveTime == nullTime || keepAliveTime > std::chrono::steady_clock::now());
     }
 
+    HTTPClient::PionImpl::Transfer::Transfer(asio::io_service& ioService, const HTTPClient::Request& request, HeadersFunc headersFn, DataFunc dataFn, CompletionFunc completionFn) :
+        request(request), headersFn(std::move(headersFn)), dataFn(std::move(dataFn)), completionFn(std::move(completionFn)), log(false), timeout(-1), hostKey(), requestData(),
+        connection(), reused(false), timedOut(false), headersDelivered(false), cancel(false), bytesReceived(0), requestTime(),
+        parser(), response(), buffer(), resolver(ioService), timer(ioService),
+        deliveryMutex(), deliveries(), deliveryBytes(0), deliveryScheduled(false), readPaused(false), finished(false), result(false), exception(), callbackException()
+    {
+    }
+
+    HTTPClient::PionImpl::Engine::Engine() :
+        ioService(), work(new asio::io_service::work(ioService)), thread(), hosts(),
+        callbackMutex(), callbackCondition(), callbackTransfers(), callbackThreads()
+    {
+        for (int i = 0; i < CALLBACK_THREAD_COUNT; i++) {
+            callbackThreads.emplace_back([this]() {
+                while (true) {
+                    std::shared_ptr<Transfer> transfer;
+                    {
+                        std::unique_lock<std::mutex> lock(callbackMutex);
+                        callbackCondition.wait(lock, [this]() { return !callbackTransfers.empty(); });
+                        transfer = std::move(callbackTransfers.front());
+                        callbackTransfers.pop_front();
+                    }
+                    RunCallbacks(transfer);
+                }
+            });
+        }
+
+        thread = std::thread([this]() {
+            while (true) {
+                try {
+                    ioService.run();
+                    break;
+                }
+                catch (const std::exception& ex) {
+                    Log::Errorf("HTTPClient::PionImpl: Exception on I/O thread: %s", ex.what());
+                }
+            }
+        });
+    }
+
+    const int HTTPClient::PionImpl::MAX_HOST_CONNECTIONS = 6;
+
+    const int HTTPClient::PionImpl::CALLBACK_THREAD_COUNT = 4;
+
+    const std::size_t HTTPClient::PionImpl::MAX_BUFFERED_BYTES = 1024 * 1024;
+
 }
@@ -10,35 +10,134 @@
 #include <asio.hpp>
 #include <pion/http/parser.hpp>
 #include <pion/http/response.hpp>
-#include <pion/tcp/connection.hpp>
 
 #include "network/HTTPClient.h"
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace massif {
 
+    // Requests of all clients run on a single I/O thread shared by the process. Connections are pooled per host,
+    // at most MAX_HOST_CONNECTIONS per host; requests beyond that wait for a connection of the host to become free.
+    // Request callbacks never run on the I/O thread: they are queued per request and run in order on a small pool of
+    // callback threads. Reading a response pauses while more than MAX_BUFFERED_BYTES of its data wait for callbacks.
     class HTTPClient::PionImpl : public HTTPClient::Impl {
     public:
         explicit PionImpl(bool log);
+        virtual ~PionImpl();
 
+        virtual void setTimeout(int milliseconds);
         virtual bool makeRequest(const HTTPClient::Request& request, HeadersFunc headersFn, DataFunc dataFn) const;
+        virtual bool isAsyncSupported() const;
+        virtual void makeRequestAsync(const HTTPClient::Request& request, HeadersFunc headersFn, DataFunc dataFn, CompletionFunc completionFn) const;
 
     private:
         struct Connection {
             int maxRequests;
             std::chrono::steady_clock::time_point keepAliveTime;
-            asio::io_service ioService;
-            std::shared_ptr<pion::tcp::connection> connection;
+            asio::ip::tcp::socket socket;
 
-            Connection(const std::string& host, std::uint16_t port);
+            explicit Connection(asio::io_service& ioService);
 
             bool isValid() const;
         };
 
-        bool makeRequest(Connection& connection, const HTTPClient::Request& request, HeadersFunc headersFn, DataFunc dataFn) const;
+        struct Transfer;
+
+        struct Delivery {
+            std::size_t size;
+            std::function<bool(Transfer&)> callbackFn; // returns false to cancel the request
+        };
+
+        struct Transfer : public std::enable_shared_from_this<Transfer> {
+            HTTPClient::Request request;
+            HeadersFunc headersFn;
+            DataFunc dataFn;
+            CompletionFunc completionFn;
+            bool log;
+            int timeout;
+            std::pair<std::string, int> hostKey;
+            std::string requestData;
+
+            std::shared_ptr<Connection> connection;
+            bool reused;
+            bool timedOut;
+            bool headersDelivered;
+            std::atomic<bool> cancel;
+            std::uint64_t bytesReceived;
+            std::chrono::steady_clock::time_point requestTime;
+            std::unique_ptr<pion::http::parser> parser;
+            pion::http::response response;
+            std::array<char, 16384> buffer;
+            asio::ip::tcp::resolver resolver;
+            asio::steady_timer timer;
+
+            // Callback state, shared between the I/O thread and the callback threads. Guarded by deliveryMutex.
+            std::mutex deliveryMutex;
+            std::deque<Delivery> deliveries;
+            std::size_t deliveryBytes;
+            bool deliveryScheduled;
+            bool readPaused;
+            bool finished;
+            bool result;
+            std::exception_ptr exception;
+            std::exception_ptr callbackException;
+
+            Transfer(asio::io_service& ioService, const HTTPClient::Request& request, HeadersFunc headersFn, DataFunc dataFn, CompletionFunc completionFn);
+        };
+
+        struct Host {
+            int connectionCount = 0; // open or connecting, idle ones included
+            std::vector<std::shared_ptr<Connection> > idleConnections;
+            std::deque<std::shared_ptr<Transfer> > waitingTransfers;
+        };
+
+        // State of the I/O thread. Everything except the io_service and the callback queue is touched only on that thread.
+        struct Engine {
+            asio::io_service ioService;
+            std::unique_ptr<asio::io_service::work> work;
+            std::thread thread;
+            std::map<std::pair<std::string, int>, Host> hosts;
+
+            std::mutex callbackMutex;
+            std::condition_variable callbackCondition;
+            std::deque<std::shared_ptr<Transfer> > callbackTransfers;
+            std::vector<std::thread> callbackThreads;
+
+            Engine();
+        };
+
+        static const int MAX_HOST_CONNECTIONS;
+        static const int CALLBACK_THREAD_COUNT;
+        static const std::size_t MAX_BUFFERED_BYTES;
+
+        static Engine& GetEngine();
+
+        static void StartTransfer(const std::shared_ptr<Transfer>& transfer);
+        static bool AssignConnection(Host& host, const std::shared_ptr<Transfer>& transfer);
+        static void Connect(const std::shared_ptr<Transfer>& transfer);
+        static void SendRequest(const std::shared_ptr<Transfer>& transfer);
+        static void ReadResponse(const std::shared_ptr<Transfer>& transfer);
+        static bool DeliverHeaders(const std::shared_ptr<Transfer>& transfer);
+        static void Deliver(const std::shared_ptr<Transfer>& transfer, Delivery delivery);
+        static void ScheduleCallbacks(const std::shared_ptr<Transfer>& transfer);
+        static void RunCallbacks(const std::shared_ptr<Transfer>& transfer);
+        static void CompleteResponse(const std::shared_ptr<Transfer>& transfer, bool keepAlive);
+        static void HandleError(const std::shared_ptr<Transfer>& transfer, const asio::error_code& error);
+        static void FinishTransfer(const std::shared_ptr<Transfer>& transfer, bool reusable, bool result, std::exception_ptr exception);
+        static void ArmTimer(const std::shared_ptr<Transfer>& transfer);
 
         bool _log;
-        mutable std::multimap<std::pair<std::string, int>, std::shared_ptr<Connection> > _connectionMap;
-        mutable std::mutex _mutex;
+        std::atomic<int> _timeout;
     };
 
 }
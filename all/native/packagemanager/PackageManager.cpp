@@ -342,8 +342,8 @@ namespace massif {
     }
 
     void PackageManager::accessLocalPackages(const std::function<void(const std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> >&)>& callback) const {
-        // NOTE: should use shared_lock here, but iOS 9 does not support it
-        std::unique_lock<std::mutex> packageLock(_packageFileMutex);
+        // Readers share the lock, only deleting a package needs exclusive access to the files
+        std::shared_lock<std::shared_mutex> packageLock(_packageFileMutex);
 
         // Find all package handlers
         std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> > packageHandlerMap;
@@ -810,7 +810,7 @@ namespace massif {
             query.bind(":package_id", task.packageId.c_str());
             query.bind(":version", task.packageVersion);
             for (auto qit = query.begin(); qit != query.end(); qit++) {
-                Log::Infof("PackageManager: Package %s already imported", task.packageId.c_str());
+                LOG_INFOF("PackageManager: Package %s already imported", task.packageId.c_str());
                 return true;
             }
         }
@@ -896,7 +896,7 @@ namespace massif {
             throw;
         }
 
-        Log::Infof("PackageManager: Package %s imported", task.packageId.c_str());
+        LOG_INFOF("PackageManager: Package %s imported", task.packageId.c_str());
         return true;
     }
 
@@ -927,7 +927,7 @@ namespace massif {
             query.bind(":package_id", task.packageId.c_str());
             for (auto qit = query.begin(); qit != query.end(); qit++) {
                 if (qit->get<int>(0) == task.packageVersion && task.packageVersion != -1) {
-                    Log::Infof("PackageManager: Package %s already downloaded", task.packageId.c_str());
+                    LOG_INFOF("PackageManager: Package %s already downloaded", task.packageId.c_str());
                     return true;
                 }
                 downloaded = true;
@@ -942,7 +942,7 @@ namespace massif {
             for (int retry = 0; true; retry++) {
                 if (retry > 0) {
                     utf8_filesystem::unlink(packageFileName.c_str());
-                    Log::Infof("PackageManager: Retrying package %s download", task.packageId.c_str());
+                    LOG_INFOF("PackageManager: Retrying package %s download", task.packageId.c_str());
                 }
                 FILE* fpRaw = utf8_filesystem::fopen(packageFileName.c_str(), "ab");
                 if (!fpRaw) {
@@ -972,7 +972,7 @@ namespace massif {
                     }
 
                     if (offset != fileOffset) {
-                        Log::Infof("PackageManager: Truncating file");
+                        LOG_INFOF("PackageManager: Truncating file");
                         utf8_filesystem::fseek64(fp.get(), offset, SEEK_SET);
                         utf8_filesystem::ftruncate64(fp.get(), offset);
                     }
@@ -1080,7 +1080,7 @@ namespace massif {
             throw;
         }
 
-        Log::Infof("PackageManager: Package %s downloaded", task.packageId.c_str());
+        LOG_INFOF("PackageManager: Package %s downloaded", task.packageId.c_str());
         return true;
     }
 
@@ -1112,7 +1112,7 @@ namespace massif {
         deleteLocalPackage(id);
         updateTaskStatus(taskId, PackageAction::PACKAGE_ACTION_REMOVING, 100);
 
-        Log::Infof("PackageManager: Package %s removed", task.packageId.c_str());
+        LOG_INFOF("PackageManager: Package %s removed", task.packageId.c_str());
         return true;
     }
 
@@ -1205,7 +1205,7 @@ namespace massif {
     }
 
     void PackageManager::deleteLocalPackage(int id) {
-        std::unique_lock<std::mutex> packageLock(_packageFileMutex);
+        std::unique_lock<std::shared_mutex> packageLock(_packageFileMutex);
 
         // Find package info and if successful, remove the package
         std::string packageFileName;
@@ -1570,7 +1570,7 @@ namespace massif {
     }
 
     int PackageManager::DownloadFile(const std::string& url, NetworkUtils::HandlerFunc handler, std::uint64_t offset) {
-        Log::Debugf("PackageManager::DownloadFile: %s", url.c_str());
+        LOG_DEBUGF("PackageManager::DownloadFile: %s", url.c_str());
         std::map<std::string, std::string> requestHeaders = NetworkUtils::CreateAppRefererHeader();
         std::map<std::string, std::string> responseHeaders;
         return NetworkUtils::StreamHTTPResponse("GET", url, requestHeaders, responseHeaders, handler, offset, Log::IsShowDebug());
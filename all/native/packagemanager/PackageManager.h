@@ -377,7 +377,7 @@ namespace massif {
         mutable std::shared_ptr<std::vector<std::shared_ptr<PackageInfo> > > _serverPackageCache;
         mutable std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> > _packageHandlerCache;
 
-        mutable std::mutex _packageFileMutex; // guards all package file accesses
+        mutable std::shared_mutex _packageFileMutex; // guards all package file accesses
 
         mutable std::recursive_mutex _mutex; // guards all state
     };
@@ -25,28 +25,15 @@ namespace massif {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
 
         if (!_packageDb) {
-            try {
-                // Open package database
-                _packageDb = std::make_shared<sqlite3pp::database>();
-                if (_packageDb->connect_v2(_uncompressedFileName.c_str(), SQLITE_OPEN_READONLY | SQLITE_OPEN_FULLMUTEX) != SQLITE_OK) { // try locally uncompressed package first
-                    if (_packageDb->connect_v2(_fileName.c_str(), SQLITE_OPEN_READONLY | SQLITE_OPEN_FULLMUTEX) != SQLITE_OK) { // assume that the package was not gzipped, so use original file
-                        Log::Errorf("GeocodingPackageHandler::getDatabase: Can not connect to database %s", _fileName.c_str());
-                        _packageDb.reset();
-                    }
-                }
-                if (_packageDb) {
-                    _packageDb->execute("PRAGMA temp_store=MEMORY");
-                    _packageDb->execute("PRAGMA cache_size=256");
-                }
-            }
-            catch (const std::exception& ex) {
-                Log::Errorf("GeocodingPackageHandler::getDatabase: Exception %s", ex.what());
-                _packageDb.reset();
-            }
+            _packageDb = connect(SQLITE_OPEN_READONLY | SQLITE_OPEN_FULLMUTEX);
         }
         return _packageDb;
     }
 
+    std::shared_ptr<sqlite3pp::database> GeocodingPackageHandler::openConnection() const {
+        return connect(SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX);
+    }
+
     void GeocodingPackageHandler::onImportPackage() {
         std::shared_ptr<FILE> fpIn(utf8_filesystem::fopen(_fileName.c_str(), "rb"), fclose);
         std::shared_ptr<FILE> fpOut(utf8_filesystem::fopen(_uncompressedFileName.c_str(), "wb"), fclose);
@@ -64,6 +51,29 @@ namespace massif {
         return std::shared_ptr<PackageTileMask>();
     }
 
+    std::shared_ptr<sqlite3pp::database> GeocodingPackageHandler::connect(int flags) const {
+        std::shared_ptr<sqlite3pp::database> packageDb;
+        try {
+            // Open package database
+            packageDb = std::make_shared<sqlite3pp::database>();
+            if (packageDb->connect_v2(_uncompressedFileName.c_str(), flags) != SQLITE_OK) { // try locally uncompressed package first
+                if (packageDb->connect_v2(_fileName.c_str(), flags) != SQLITE_OK) { // assume that the package was not gzipped, so use original file
+                    Log::Errorf("GeocodingPackageHandler::connect: Can not connect to database %s", _fileName.c_str());
+                    packageDb.reset();
+                }
+            }
+            if (packageDb) {
+                packageDb->execute("PRAGMA temp_store=MEMORY");
+                packageDb->execute("PRAGMA cache_size=256");
+            }
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("GeocodingPackageHandler::connect: Exception %s", ex.what());
+            packageDb.reset();
+        }
+        return packageDb;
+    }
+
 }
 
 #endif
@@ -24,12 +24,21 @@ namespace massif {
 
         std::shared_ptr<sqlite3pp::database> getDatabase();
 
+        /**
+         * Opens a new read-only connection to the package database, without the serialization of the shared connection.
+         * The connection must only be used by one thread at a time.
+         * @return The new connection, or null if the database could not be opened.
+         */
+        std::shared_ptr<sqlite3pp::database> openConnection() const;
+
         virtual void onImportPackage();
         virtual void onDeletePackage();
 
         virtual std::shared_ptr<PackageTileMask> calculateTileMask() const;
 
     private:
+        std::shared_ptr<sqlite3pp::database> connect(int flags) const;
+
         const std::string _uncompressedFileName;
         std::shared_ptr<sqlite3pp::database> _packageDb;
     };
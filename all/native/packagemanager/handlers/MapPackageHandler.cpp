@@ -19,48 +19,66 @@ namespace massif {
         PackageHandler(fileName),
         _serverEncKey(serverEncKey),
         _localEncKey(localEncKey),
-        _packageDb(),
-        _decryptFunc(),
-        _sharedDictionary()
+        _idleConnections(),
+        _sharedDictionary(),
+        _sharedDictionaryLoaded(false)
     {
     }
 
     MapPackageHandler::~MapPackageHandler() {
-        closeDatabase();
+        closeConnections();
     }
 
     std::shared_ptr<BinaryData> MapPackageHandler::loadTile(const MapTile& mapTile) {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
-
+        // The query runs on a connection of its own, so that tiles of the same package can be loaded concurrently
+        std::unique_ptr<TileConnection> connection;
         try {
-            if (!openDatabase()) {
+            connection = acquireConnection();
+            if (!connection) {
                 return std::shared_ptr<BinaryData>();
             }
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("MapPackageHandler::loadTile: Exception %s", ex.what());
+            return std::shared_ptr<BinaryData>();
+        }
 
+        std::vector<unsigned char> data;
+        bool found = false;
+        try {
             // Try to load the tile (this could fail, as tile masks may not be complete to the last zoom level)
-            sqlite3pp::query query(*_packageDb, "SELECT tile_decrypt(tile_data, zoom_level, tile_column, tile_row) FROM tiles WHERE zoom_level=:zoom AND tile_column=:x AND tile_row=:y");
+            sqlite3pp::query& query = *connection->tileQuery;
+            query.reset();
             query.bind(":zoom", mapTile.getZoom());
             query.bind(":x", mapTile.getX());
             query.bind(":y", mapTile.getY());
             for (auto qit = query.begin(); qit != query.end(); qit++) {
                 const unsigned char* dataPtr = reinterpret_cast<const unsigned char*>(qit->get<const void*>(0));
                 std::size_t dataSize = qit->column_bytes(0);
-                std::vector<unsigned char> data(dataPtr, dataPtr + dataSize);
-                if (_sharedDictionary) {
-                    std::vector<unsigned char> uncompressedData;
-                    if (!zlib::inflate_raw(data.data(), data.size(), _sharedDictionary->data(), _sharedDictionary->size(), uncompressedData)) {
-                        Log::Warnf("MapPackageHandler::loadTile: Failed to decompress tile with shared dictionary");
-                        return std::shared_ptr<BinaryData>();
-                    }
-                    std::swap(data, uncompressedData);
-                }
-                return std::make_shared<BinaryData>(std::move(data));
+                data.assign(dataPtr, dataPtr + dataSize);
+                found = true;
+                break;
             }
+            query.reset();
         }
         catch (const std::exception& ex) {
             Log::Errorf("MapPackageHandler::loadTile: Exception %s", ex.what());
+            return std::shared_ptr<BinaryData>(); // the connection is dropped, as its state is unknown
+        }
+        releaseConnection(std::move(connection));
+
+        if (!found) {
+            return std::shared_ptr<BinaryData>();
         }
-        return std::shared_ptr<BinaryData>();
+        if (_sharedDictionary) { // NOTE: set before the first connection is handed out and never changed afterwards
+            std::vector<unsigned char> uncompressedData;
+            if (!zlib::inflate_raw(data.data(), data.size(), _sharedDictionary->data(), _sharedDictionary->size(), uncompressedData)) {
+                Log::Warnf("MapPackageHandler::loadTile: Failed to decompress tile with shared dictionary");
+                return std::shared_ptr<BinaryData>();
+            }
+            std::swap(data, uncompressedData);
+        }
+        return std::make_shared<BinaryData>(std::move(data));
     }
 
     void MapPackageHandler::onImportPackage() {
@@ -100,29 +118,44 @@ namespace massif {
         return std::make_shared<PackageTileMask>(tiles, maxZoomLevel);
     }
 
-    bool MapPackageHandler::openDatabase() {
+    std::unique_ptr<MapPackageHandler::TileConnection> MapPackageHandler::acquireConnection() {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
 
-        if (_packageDb) {
-            return true;
+        if (!_idleConnections.empty()) {
+            std::unique_ptr<TileConnection> connection = std::move(_idleConnections.back());
+            _idleConnections.pop_back();
+            return connection;
         }
+        return openConnection();
+    }
+
+    void MapPackageHandler::releaseConnection(std::unique_ptr<TileConnection> connection) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+        if (static_cast<int>(_idleConnections.size()) < MAX_IDLE_CONNECTIONS) {
+            _idleConnections.push_back(std::move(connection));
+        }
+    }
+
+    std::unique_ptr<MapPackageHandler::TileConnection> MapPackageHandler::openConnection() {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
 
         try {
-            // Open package database
-            _packageDb = std::make_unique<sqlite3pp::database>();
-            if (_packageDb->connect_v2(_fileName.c_str(), SQLITE_OPEN_READONLY) != SQLITE_OK) {
-                Log::Errorf("MapPackageHandler::openDatabase: Failed to open database %s", _fileName.c_str());
-                _packageDb.reset();
-                return false;
+            // Open package database. The connection is used by a single thread at a time, so SQLite's own locking is not needed.
+            auto connection = std::make_unique<TileConnection>();
+            connection->database = std::make_unique<sqlite3pp::database>();
+            if (connection->database->connect_v2(_fileName.c_str(), SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX) != SQLITE_OK) {
+                Log::Errorf("MapPackageHandler::openConnection: Failed to open database %s", _fileName.c_str());
+                return std::unique_ptr<TileConnection>();
             }
-            _packageDb->execute("PRAGMA temp_store=MEMORY");
-            _packageDb->execute("PRAGMA cache_size=256");
+            connection->database->execute("PRAGMA temp_store=MEMORY");
+            connection->database->execute("PRAGMA cache_size=256");
 
             // Create new sqlite decryption function. First check if the database is crypted.
             std::string encKey = _serverEncKey;
-            bool encrypted = CheckDbEncryption(*_packageDb, _serverEncKey + _localEncKey); // NOTE: this is a hack - though tiles are actually encrypted with server key only, with check that local key is included in the hash also
-            _decryptFunc = std::make_unique<sqlite3pp::ext::function>(*_packageDb);
-            _decryptFunc->create("tile_decrypt", [encrypted, encKey](sqlite3pp::ext::context& ctx) {
+            bool encrypted = CheckDbEncryption(*connection->database, _serverEncKey + _localEncKey); // NOTE: this is a hack - though tiles are actually encrypted with server key only, with check that local key is included in the hash also
+            connection->decryptFunc = std::make_unique<sqlite3pp::ext::function>(*connection->database);
+            connection->decryptFunc->create("tile_decrypt", [encrypted, encKey](sqlite3pp::ext::context& ctx) {
                 const unsigned char* encData = reinterpret_cast<const unsigned char*>(ctx.get<const void*>(0));
                 std::size_t encSize = ctx.args_bytes(0);
                 int zoom = ctx.get<int>(1);
@@ -134,30 +167,30 @@ namespace massif {
                 }
                 ctx.result(encVector.empty() ? nullptr : &encVector[0], static_cast<int>(encVector.size()), false);
             }, 4);
+            connection->tileQuery = std::make_unique<sqlite3pp::query>(*connection->database, "SELECT tile_decrypt(tile_data, zoom_level, tile_column, tile_row) FROM tiles WHERE zoom_level=:zoom AND tile_column=:x AND tile_row=:y");
 
-            // Try to load shared dictionary
-            _sharedDictionary.reset();
-            sqlite3pp::query query(*_packageDb, "SELECT value FROM metadata WHERE name='shared_zlib_dict'");
-            for (auto qit = query.begin(); qit != query.end(); qit++) {
-                const unsigned char* dataPtr = reinterpret_cast<const unsigned char*>(qit->get<const void*>(0));
-                std::size_t dataSize = qit->column_bytes(0);
-                _sharedDictionary = std::make_unique<BinaryData>(dataPtr, dataSize);
+            // Try to load shared dictionary, once per package
+            if (!_sharedDictionaryLoaded) {
+                sqlite3pp::query query(*connection->database, "SELECT value FROM metadata WHERE name='shared_zlib_dict'");
+                for (auto qit = query.begin(); qit != query.end(); qit++) {
+                    const unsigned char* dataPtr = reinterpret_cast<const unsigned char*>(qit->get<const void*>(0));
+                    std::size_t dataSize = qit->column_bytes(0);
+                    _sharedDictionary = std::make_shared<BinaryData>(dataPtr, dataSize);
+                }
+                _sharedDictionaryLoaded = true;
             }
-            return true;
+            return connection;
         }
         catch (const std::exception& ex) {
-            Log::Errorf("MapPackageHandler::openDatabase: Exception %s", ex.what());
-            _packageDb.reset();
-            return false;
+            Log::Errorf("MapPackageHandler::openConnection: Exception %s", ex.what());
+            return std::unique_ptr<TileConnection>();
         }
     }
 
-    void MapPackageHandler::closeDatabase() {
+    void MapPackageHandler::closeConnections() {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
 
-        _packageDb.reset();
-        _decryptFunc.reset();
-        _sharedDictionary.reset();
+        _idleConnections.clear();
     }
 
     bool MapPackageHandler::CheckDbEncryption(sqlite3pp::database& db, const std::string& encKey) {
@@ -226,6 +259,8 @@ namespace massif {
         cipher->finish(secureData);
         data.assign(secureData.begin(), secureData.end());
     }
+
+    const int MapPackageHandler::MAX_IDLE_CONNECTIONS = 4;
     
 }
 
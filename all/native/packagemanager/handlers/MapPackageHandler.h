@@ -12,10 +12,12 @@
 #include "core/MapTile.h"
 #include "packagemanager/handlers/PackageHandler.h"
 
+#include <memory>
 #include <vector>
 
 namespace sqlite3pp {
     class database;
+    class query;
     namespace ext {
         class function;
     }
@@ -37,8 +39,17 @@ namespace massif {
         virtual std::shared_ptr<PackageTileMask> calculateTileMask() const;
 
     private:
-        bool openDatabase();
-        void closeDatabase();
+        struct TileConnection {
+            std::unique_ptr<sqlite3pp::database> database;
+            std::unique_ptr<sqlite3pp::ext::function> decryptFunc;
+            std::unique_ptr<sqlite3pp::query> tileQuery;
+        };
+
+        std::unique_ptr<TileConnection> acquireConnection();
+        void releaseConnection(std::unique_ptr<TileConnection> connection);
+
+        std::unique_ptr<TileConnection> openConnection();
+        void closeConnections();
 
         static bool CheckDbEncryption(sqlite3pp::database& db, const std::string& encKey);
         static void UpdateDbEncryption(sqlite3pp::database& db, const std::string& encKey);
@@ -46,12 +57,14 @@ namespace massif {
         static std::string CalculateKeyHash(const std::string& encKey);
         static void EncryptDecryptTile(std::vector<unsigned char>& data, int zoom, int x, int y, const std::string& encKey, bool encrypt);
 
+        static const int MAX_IDLE_CONNECTIONS;
+
         const std::string _serverEncKey;
         const std::string _localEncKey;
 
-        std::unique_ptr<sqlite3pp::database> _packageDb;
-        std::unique_ptr<sqlite3pp::ext::function> _decryptFunc;
-        std::unique_ptr<BinaryData> _sharedDictionary;
+        std::vector<std::unique_ptr<TileConnection> > _idleConnections; // read-only connections, checked out per loadTile call
+        std::shared_ptr<BinaryData> _sharedDictionary;
+        bool _sharedDictionaryLoaded;
     };
     
 }
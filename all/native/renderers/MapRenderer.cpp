@@ -122,7 +122,7 @@ namespace massif {
             lastFlips = flips;
             lastCullerNs = cullerNs;
 
-            Log::Infof("RenderStats: cullUpd=%lld tileRecalc=%lld tileSkip=%lld tileSets=%lld labelMaps=%lld | surfBuilt=%lld surfInval=%lld | labelsAlloc=%lld reused=%lld live=%lld elevReanchor=%lld | placeUpd=%lld reNull=%lld reHidden=%lld reVisible=%lld search=%lld | snap=%lld snapMoved=%lld | cullPasses=%lld visFlips=%lld cullMs=%.2f",
+            LOG_INFOF("RenderStats: cullUpd=%lld tileRecalc=%lld tileSkip=%lld tileSets=%lld labelMaps=%lld | surfBuilt=%lld surfInval=%lld | labelsAlloc=%lld reused=%lld live=%lld elevReanchor=%lld | placeUpd=%lld reNull=%lld reHidden=%lld reVisible=%lld search=%lld | snap=%lld snapMoved=%lld | cullPasses=%lld visFlips=%lld cullMs=%.2f",
                        deltas[13], deltas[14], deltas[15], deltas[0], deltas[11],
                        deltas[1], deltas[2],
                        deltas[3], deltas[12], RenderStats::labelsLive.load(), deltas[4],
@@ -140,7 +140,7 @@ namespace massif {
             static long long lastSurfaceDraws = 0, lastSurfaceIndices = 0;
             long long surfaceDraws = RenderStats::surfaceDraws.load();
             long long surfaceIndices = RenderStats::surfaceIndices.load();
-            Log::Infof("RenderStats: geomDraws=%lld geomIndices=%lld labelDraws=%lld renderTiles=%lld styleLayers=%lld surfDraws=%lld surfIndices=%lld (per interval)",
+            LOG_INFOF("RenderStats: geomDraws=%lld geomIndices=%lld labelDraws=%lld renderTiles=%lld styleLayers=%lld surfDraws=%lld surfIndices=%lld (per interval)",
                        draws - lastDraws, indices - lastIndices, labelDraws - lastLabelDraws,
                        tiles - lastTiles, styleLayers - lastStyleLayers,
                        surfaceDraws - lastSurfaceDraws, surfaceIndices - lastSurfaceIndices);
@@ -153,7 +153,7 @@ namespace massif {
                 RenderStats::surfDrapeDraws.load(), RenderStats::surfBackgroundDraws.load(),
                 RenderStats::surfBitmapDraws.load()
             };
-            Log::Infof("RenderStats: surfaces shadow=%lld mask=%lld fill=%lld blit=%lld drape=%lld background=%lld bitmap=%lld (per interval)",
+            LOG_INFOF("RenderStats: surfaces shadow=%lld mask=%lld fill=%lld blit=%lld drape=%lld background=%lld bitmap=%lld (per interval)",
                        surfSplit[0] - lastSurfSplit[0], surfSplit[1] - lastSurfSplit[1],
                        surfSplit[2] - lastSurfSplit[2], surfSplit[3] - lastSurfSplit[3],
                        surfSplit[4] - lastSurfSplit[4], surfSplit[5] - lastSurfSplit[5],
@@ -164,7 +164,7 @@ namespace massif {
             static long long lastMaskNs = 0, lastDrapeNs = 0;
             long long maskNs = RenderStats::surfMaskNs.load();
             long long drapeNs = RenderStats::surfDrapeNs.load();
-            Log::Infof("RenderStats: surfaces maskMs=%.1f drapeMs=%.1f (per interval)",
+            LOG_INFOF("RenderStats: surfaces maskMs=%.1f drapeMs=%.1f (per interval)",
                        (maskNs - lastMaskNs) / 1.0e6, (drapeNs - lastDrapeNs) / 1.0e6);
             lastMaskNs = maskNs; lastDrapeNs = drapeNs;
 
@@ -173,7 +173,7 @@ namespace massif {
             long long labelBatch = RenderStats::labelBatchNs.load();
             long long labelVerts = RenderStats::labelsDrawnVertices.load();
             long long lineLayouts = RenderStats::lineLayoutBuilds.load();
-            Log::Infof("RenderStats: labels built=%lld lineLayouts=%lld buildMs=%.1f batchMs=%.1f (per interval)",
+            LOG_INFOF("RenderStats: labels built=%lld lineLayouts=%lld buildMs=%.1f batchMs=%.1f (per interval)",
                        labelVerts - lastLabelVerts, lineLayouts - lastLineLayouts,
                        (labelBuild - lastLabelBuild) / 1.0e6,
                        (labelBatch - lastLabelBatch) / 1.0e6);
@@ -188,7 +188,7 @@ namespace massif {
             const long long labelSplit[2] = {
                 RenderStats::labelPlacementNs.load(), RenderStats::labelLineBuildNs.load()
             };
-            Log::Infof("RenderStats: prepare tileBlendMs=%.1f elevDirtyMs=%.1f elevUpdMs=%.1f labelBlendMs=%.1f | labelBuild placementMs=%.1f lineMs=%.1f transformMs=%.1f attribMs=%.1f (per interval)",
+            LOG_INFOF("RenderStats: prepare tileBlendMs=%.1f elevDirtyMs=%.1f elevUpdMs=%.1f labelBlendMs=%.1f | labelBuild placementMs=%.1f lineMs=%.1f transformMs=%.1f attribMs=%.1f (per interval)",
                        (prep[0] - lastPrep[0]) / 1.0e6, (prep[1] - lastPrep[1]) / 1.0e6,
                        (prep[2] - lastPrep[2]) / 1.0e6, (prep[3] - lastPrep[3]) / 1.0e6,
                        (labelSplit[0] - lastLabelSplit[0]) / 1.0e6, (labelSplit[1] - lastLabelSplit[1]) / 1.0e6,
@@ -204,7 +204,7 @@ namespace massif {
                 RenderStats::pass3DLabels2DNs.load(), RenderStats::pass3DGeometryNs.load(),
                 RenderStats::pass3DLabels3DNs.load()
             };
-            Log::Infof("RenderStats: pass3D labels2DMs=%.1f geometryMs=%.1f labels3DMs=%.1f (per interval)",
+            LOG_INFOF("RenderStats: pass3D labels2DMs=%.1f geometryMs=%.1f labels3DMs=%.1f (per interval)",
                        (pass3D[0] - lastPass3D[0]) / 1.0e6, (pass3D[1] - lastPass3D[1]) / 1.0e6,
                        (pass3D[2] - lastPass3D[2]) / 1.0e6);
             for (int i = 0; i < 3; i++) { lastPass3D[i] = pass3D[i]; }
@@ -218,7 +218,7 @@ namespace massif {
             long long bakes = RenderStats::drapeBakes.load();
             long long bakeNs = RenderStats::drapeBakeNs.load();
             long long queued = RenderStats::drapeBakeQueued.load();
-            Log::Infof("RenderStats: drape bakes=%lld queued=%lld totalMs=%.1f msPerBake=%.1f (per interval)",
+            LOG_INFOF("RenderStats: drape bakes=%lld queued=%lld totalMs=%.1f msPerBake=%.1f (per interval)",
                        bakes - lastBakes, queued - lastQueued, (bakeNs - lastBakeNs) / 1.0e6,
                        (bakeNs - lastBakeNs) / 1.0e6 / std::max(1LL, bakes - lastBakes));
             lastBakes = bakes; lastBakeNs = bakeNs; lastQueued = queued;
@@ -229,13 +229,13 @@ namespace massif {
                 RenderStats::demEncodeNs.load(), RenderStats::demUploads.load(),
                 RenderStats::demUploadNs.load(), RenderStats::demPatchNs.load()
             };
-            Log::Infof("RenderStats: dem encodes=%lld patches=%lld encodeMs=%.1f | uploads=%lld uploadMs=%.1f patchMs=%.1f | live=%lld resolved=%lld zoomGap=%lld (per interval)",
+            LOG_INFOF("RenderStats: dem encodes=%lld patches=%lld encodeMs=%.1f | uploads=%lld uploadMs=%.1f patchMs=%.1f | live=%lld resolved=%lld zoomGap=%lld (per interval)",
                        dem[0] - lastDem[0], dem[1] - lastDem[1], (dem[2] - lastDem[2]) / 1.0e6,
                        dem[3] - lastDem[3], (dem[4] - lastDem[4]) / 1.0e6, (dem[5] - lastDem[5]) / 1.0e6,
                        RenderStats::demTexturesLive.load(), RenderStats::demTexturesResolved.load(), RenderStats::demTileZoomGap.load());
             for (int i = 0; i < 6; i++) { lastDem[i] = dem[i]; }
 
-            Log::Infof("RenderStats: endFrame ms=%.1f swept=%lld labelLockWaitMs=%.1f (per interval)",
+            LOG_INFOF("RenderStats: endFrame ms=%.1f swept=%lld labelLockWaitMs=%.1f (per interval)",
                        (endFrameNs - lastEndFrame) / 1.0e6, swept - lastSwept,
                        (mutexWait - lastMutexWait) / 1.0e6);
             lastMutexWait = mutexWait;
@@ -256,14 +256,14 @@ namespace massif {
             static long long lastProbe = 0;
             long long probe = RenderStats::geomProbeNs.load();
             long long deltaCalls = std::max(1LL, (draws - lastDraws) + (skips - lastSkips));
-            Log::Infof("RenderStats: perDraw us probe=%.2f program=%.1f terrain=%.1f styleEval=%.1f styleUpload=%.1f compile=%.1f bind=%.1f draw=%.1f (calls=%lld skips=%lld vboMisses=%lld)",
+            LOG_INFOF("RenderStats: perDraw us probe=%.2f program=%.1f terrain=%.1f styleEval=%.1f styleUpload=%.1f compile=%.1f bind=%.1f draw=%.1f (calls=%lld skips=%lld vboMisses=%lld)",
                        (probe - lastProbe) / 1000.0 / deltaCalls,
                        (program - lastProgram) / 1000.0 / deltaCalls, (terrain - lastTerrain) / 1000.0 / deltaCalls,
                        (styleEval - lastStyleEval) / 1000.0 / deltaCalls, (style - lastStyle) / 1000.0 / deltaCalls,
                        (compile - lastCompile) / 1000.0 / deltaCalls,
                        (bind - lastBind) / 1000.0 / deltaCalls, (draw - lastDraw) / 1000.0 / deltaCalls,
                        deltaCalls, skips - lastSkips, misses - lastMisses);
-            Log::Infof("RenderStats: geomCompileStale=%lld (cumulative)", RenderStats::geomCompileStale.load());
+            LOG_INFOF("RenderStats: geomCompileStale=%lld (cumulative)", RenderStats::geomCompileStale.load());
             lastProgram = program; lastTerrain = terrain; lastStyle = style;
             lastStyleEval = styleEval; lastCompile = compile; lastBind = bind; lastDraw = draw;
             lastSkips = skips; lastMisses = misses; lastProbe = probe;
@@ -277,7 +277,7 @@ namespace massif {
             long long funcEval = RenderStats::styleFuncEvalNs.load();
             static long long lastViewStates = 0;
             long long viewStates = RenderStats::viewStateChanges.load();
-            Log::Infof("RenderStats: styleFuncs lookups=%lld misses=%lld constants=%lld | params/draw=%.1f evalUsPerDraw=%.1f evalUsPerMiss=%.2f viewStates=%lld",
+            LOG_INFOF("RenderStats: styleFuncs lookups=%lld misses=%lld constants=%lld | params/draw=%.1f evalUsPerDraw=%.1f evalUsPerMiss=%.2f viewStates=%lld",
                        lookups - lastLookups, funcMisses - lastFuncMisses, constants - lastConstants,
                        (params - lastParams) / (double) deltaCalls,
                        (funcEval - lastFuncEval) / 1000.0 / deltaCalls,
@@ -422,7 +422,7 @@ namespace massif {
             const char* name = std::strrchr(file, '/');
             summary += (summary.empty() ? "" : ", ") + std::string(name ? name + 1 : file) + ":" + std::to_string(sorted[i].second.second) + " x" + std::to_string(sorted[i].first);
         }
-        Log::Infof("MapRenderer: redraw requests by source - %s", summary.empty() ? "none" : summary.c_str());
+        LOG_INFOF("MapRenderer: redraw requests by source - %s", summary.empty() ? "none" : summary.c_str());
     }
 
     void MapRenderer::requestRedraw(const char* callerFile, int callerLine) const {
@@ -796,7 +796,7 @@ namespace massif {
             glGetIntegerv(GL_STENCIL_BITS, &stencilBits);
             glGetIntegerv(GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS, &maxVertexTextureUnits);
             const GLubyte* renderer = glGetString(GL_RENDERER);
-            Log::Infof("MapRenderer::onSurfaceCreated: renderer '%s', depth bits %d, stencil bits %d, vertex texture units %d",
+            LOG_INFOF("MapRenderer::onSurfaceCreated: renderer '%s', depth bits %d, stencil bits %d, vertex texture units %d",
                 renderer ? reinterpret_cast<const char*>(renderer) : "?", depthBits, stencilBits, maxVertexTextureUnits);
         }
 
@@ -1784,7 +1784,7 @@ namespace massif {
                         static int lastFitFailure = 0;
                         if (static_cast<int>(texelMeters) != lastFitFailure) {
                             lastFitFailure = static_cast<int>(texelMeters);
-                            Log::Infof("MapRenderer: shadow light box could not be fitted, reason %d (1 no tiles, 2 tile bbox empty, 3 no elevation texture, 4 empty cascade slice, 5 slice misses the tiles, 6 sun below horizon)", lastFitFailure);
+                            LOG_INFOF("MapRenderer: shadow light box could not be fitted, reason %d (1 no tiles, 2 tile bbox empty, 3 no elevation texture, 4 empty cascade slice, 5 slice misses the tiles, 6 sun below horizon)", lastFitFailure);
                         }
                         break;
                     }
@@ -1918,7 +1918,7 @@ namespace massif {
             static int lastShadowState = -1;
             if (shadowState != lastShadowState) {
                 lastShadowState = shadowState;
-                Log::Infof("MapRenderer: shadows %s (strength %.2f, requested map %d x %d cascades, terrain lighting %d, cover tiles %d)",
+                LOG_INFOF("MapRenderer: shadows %s (strength %.2f, requested map %d x %d cascades, terrain lighting %d, cover tiles %d)",
                     shadowState == 2 ? "ACTIVE" : shadowState == 1 ? "WANTED BUT UNAVAILABLE - no light box could be fitted, or the atlas failed to allocate" : "off",
                     lighting.shadowStrength, lighting.shadowMapSize, lighting.shadowCascades,
                     lighting.terrainLightingEnabled ? 1 : 0, static_cast<int>(coverTileIds.size()));
@@ -1956,7 +1956,7 @@ namespace massif {
                 {
                     static int probe = 0;
                     if ((probe++ % 121) == 120) {
-                        Log::Infof("PROBE mask: texture %u, %d x %d, draws %d, cover %d", maskTexture, _terrainShadowMaskBuffer->getWidth(), _terrainShadowMaskBuffer->getHeight(), maskDraws, static_cast<int>(coverTileIds.size()));
+                        LOG_INFOF("PROBE mask: texture %u, %d x %d, draws %d, cover %d", maskTexture, _terrainShadowMaskBuffer->getWidth(), _terrainShadowMaskBuffer->getHeight(), maskDraws, static_cast<int>(coverTileIds.size()));
                     }
                 }
                 // Screen pixels -> mask uv. The scale is the SCREEN size, not the mask's, because
@@ -2484,7 +2484,7 @@ namespace massif {
                         bool firstCover = !groundCoverLogged && !groundTileIds.empty();
                         groundCoverLogged = groundCoverLogged || firstCover;
                         if ((groundStateFrame++ % 600) == 1 || firstCover) {
-                            Log::Infof("MapRenderer: shared terrain ground - %d layers, %d cover tiles (split level %d, collected up to %d, camera zoom %.2f), %d ground draws",
+                            LOG_INFOF("MapRenderer: shared terrain ground - %d layers, %d cover tiles (split level %d, collected up to %d, camera zoom %.2f), %d ground draws",
                                 static_cast<int>(groundLayers.size()), static_cast<int>(groundTileIds.size()),
                                 groundZoom, groundMaxCollectedZoom, viewState.getZoom(), groundDraws);
                         }
@@ -3112,7 +3112,7 @@ namespace massif {
                         emptyGroundFrame++;
                         if (emptyGroundFrame - lastEmptyGroundLog > 30) {
                             lastEmptyGroundLog = emptyGroundFrame;
-                            Log::Infof("MapRenderer: RTT drape EMPTY GROUND - %d flat fills, %d tiles skipped for missing elevation, of %d drawn (%d leaves, split level %d, camera zoom %.2f); seeded %d, blank %d, stand-in %d, partial %d, stale %d",
+                            LOG_INFOF("MapRenderer: RTT drape EMPTY GROUND - %d flat fills, %d tiles skipped for missing elevation, of %d drawn (%d leaves, split level %d, camera zoom %.2f); seeded %d, blank %d, stand-in %d, partial %d, stale %d",
                                 filledSurfaces, skippedSurfaces, static_cast<int>(drapedTiles.size()),
                                 static_cast<int>(drapeTiles.size()), drapeZoom, viewState.getZoom(), seededTiles,
                                 static_cast<int>(blankTiles.size()), static_cast<int>(standInTiles.size()),
@@ -3133,7 +3133,7 @@ namespace massif {
                     drapeMsCount++;
                     static int drapeStateFrame = 0;
                     if ((drapeStateFrame++ % 60) == 0 && drapedTiles.size() > 0) {
-                        Log::Infof("MapRenderer: RTT drape cost avg %.1f ms, max %.1f ms over %d frames", drapeMsSum / std::max(1, drapeMsCount), drapeMsMax, drapeMsCount);
+                        LOG_INFOF("MapRenderer: RTT drape cost avg %.1f ms, max %.1f ms over %d frames", drapeMsSum / std::max(1, drapeMsCount), drapeMsMax, drapeMsCount);
                         drapeMsSum = 0; drapeMsMax = 0; drapeMsCount = 0;
                     }
                     if ((drapeStateFrame % 600) == 1 && drapedTiles.size() > 0) {
@@ -3142,21 +3142,21 @@ namespace massif {
                             minZoom = std::min(minZoom, it2->tileId.zoom);
                             maxZoom = std::max(maxZoom, it2->tileId.zoom);
                         }
-                        Log::Infof("MapRenderer: RTT drape tiles zoom %d..%d, count %d", minZoom, maxZoom, static_cast<int>(drapedTiles.size()));
+                        LOG_INFOF("MapRenderer: RTT drape tiles zoom %d..%d, count %d", minZoom, maxZoom, static_cast<int>(drapedTiles.size()));
                         // Queue sizes say which of the four states the cover is actually in - a
                         // standing 'partial' backlog means the bake never catches up with the
                         // layers, which looks like the whole map stuck on bare hillshade.
-                        Log::Infof("MapRenderer: RTT drape cover - split level %d (collected up to %d, camera zoom %.2f), leaves %d",
+                        LOG_INFOF("MapRenderer: RTT drape cover - split level %d (collected up to %d, camera zoom %.2f), leaves %d",
                             drapeZoom, maxCollectedZoom, viewState.getZoom(), static_cast<int>(drapeTiles.size()));
-                        Log::Infof("MapRenderer: RTT drape seeded %d tiles from cache this frame", seededTiles);
-                        Log::Infof("MapRenderer: RTT drape queues - blank %d, stand-in %d, partial %d, stale %d, tiles without elevation %d of %d",
+                        LOG_INFOF("MapRenderer: RTT drape seeded %d tiles from cache this frame", seededTiles);
+                        LOG_INFOF("MapRenderer: RTT drape queues - blank %d, stand-in %d, partial %d, stale %d, tiles without elevation %d of %d",
                             static_cast<int>(blankTiles.size()), static_cast<int>(standInTiles.size()),
                             static_cast<int>(partialTiles.size()), static_cast<int>(staleTiles.size()),
                             static_cast<int>(drapeTiles.size()) - displacedLeaves, static_cast<int>(drapeTiles.size()));
-                        Log::Infof("MapRenderer: RTT drape ACTIVE - layers %d, collected tiles %d, drawn tiles %d, resolution %d, baked %d tiles / %d primitives, surface draws %d (%d unbaked fills)",
+                        LOG_INFOF("MapRenderer: RTT drape ACTIVE - layers %d, collected tiles %d, drawn tiles %d, resolution %d, baked %d tiles / %d primitives, surface draws %d (%d unbaked fills)",
                             static_cast<int>(drapeLayers.size()), static_cast<int>(collectedTiles.size()),
                             static_cast<int>(drapedTiles.size()), resolution, bakedTiles, bakedPrimitives, surfaceDraws, filledSurfaces);
-                        Log::Infof("MapRenderer: shadow caster passes %d over %d frames, %d cascades, %d caster tiles per pass, %.1f ms per pass, %d extrusion draws per pass, %d casters skipped for missing elevation per pass, texels per cascade %.1f/%.1f/%.1f/%.1f m (camera zoom %.2f tilt %.1f)", shadowPasses, drapeStateFrame, _shadowMapCascades, shadowCasterDraws / std::max(1, shadowPasses), shadowMsSum / std::max(1, shadowPasses), shadowExtrusionDraws / std::max(1, shadowPasses), shadowCastersNoElevation / std::max(1, shadowPasses), shadowTexelMeters[0], shadowTexelMeters[1], shadowTexelMeters[2], shadowTexelMeters[3], viewState.getZoom(), viewState.getTilt());
+                        LOG_INFOF("MapRenderer: shadow caster passes %d over %d frames, %d cascades, %d caster tiles per pass, %.1f ms per pass, %d extrusion draws per pass, %d casters skipped for missing elevation per pass, texels per cascade %.1f/%.1f/%.1f/%.1f m (camera zoom %.2f tilt %.1f)", shadowPasses, drapeStateFrame, _shadowMapCascades, shadowCasterDraws / std::max(1, shadowPasses), shadowMsSum / std::max(1, shadowPasses), shadowExtrusionDraws / std::max(1, shadowPasses), shadowCastersNoElevation / std::max(1, shadowPasses), shadowTexelMeters[0], shadowTexelMeters[1], shadowTexelMeters[2], shadowTexelMeters[3], viewState.getZoom(), viewState.getTilt());
                     }
                     }
                     catch (const std::exception& ex) {
@@ -3373,7 +3373,7 @@ namespace massif {
                 redrawMaskSum |= redrawMask;
             }
             if (frames >= 300) {
-                Log::Infof("MapRenderer: %d frames drawn, %d asked for by a layer, layer mask 0x%08x (low 16 bits base pass, high 16 bits 3D pass)", frames, layerRedrawFrames, redrawMaskSum);
+                LOG_INFOF("MapRenderer: %d frames drawn, %d asked for by a layer, layer mask 0x%08x (low 16 bits base pass, high 16 bits 3D pass)", frames, layerRedrawFrames, redrawMaskSum);
                 logRedrawSources();
                 frames = 0;
                 layerRedrawFrames = 0;
@@ -418,7 +418,7 @@ namespace massif {
             static bool firstResultLogged = false;
             if (!firstResultLogged) {
                 firstResultLogged = true;
-                Log::Infof("TerrainRenderer: terrain occlusion depth read back off the render thread (%d x %d)", result->width, result->height);
+                LOG_INFOF("TerrainRenderer: terrain occlusion depth read back off the render thread (%d x %d)", result->width, result->height);
             }
             std::lock_guard<std::mutex> lock(_depthMutex);
             _depthDataSnapshot = std::move(result);
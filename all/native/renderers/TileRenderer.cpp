@@ -770,7 +770,7 @@ namespace massif {
                                 // battery.
                                 static int pendingRebuildFrames = 0;
                                 if ((++pendingRebuildFrames % 300) == 0) {
-                                    Log::Infof("TileRenderer: %d frames spent waiting on an elevation rebuild, version %u", pendingRebuildFrames, elevationVersion);
+                                    LOG_INFOF("TileRenderer: %d frames spent waiting on an elevation rebuild, version %u", pendingRebuildFrames, elevationVersion);
                                 }
                             }
                         }
@@ -8,6 +8,7 @@
 #include "terrain/ElevationTileGrid.h"
 #include "utils/Const.h"
 #include "utils/Log.h"
+#include "utils/TraceProfiler.h"
 
 #include <vt/RenderStats.h>
 
@@ -268,6 +269,7 @@ namespace massif {
     }
 
     void ElevationTextureCache::runEncodeWorker() {
+        TRACE_THREAD_NAME("ElevationTextureEncoder");
         while (true) {
             EncodeJob job;
             {
@@ -280,6 +282,7 @@ namespace massif {
                 _encodeQueue.pop_back();
             }
 
+            TRACE_SCOPE(job.bordersOnly ? "ElevationTextureCache::encodeBorders" : "ElevationTextureCache::encode");
             if (job.bordersOnly) {
                 // Only the ring: ~1.5% of the texels of a full encode, and no megabyte to copy
                 // into a Bitmap afterwards.
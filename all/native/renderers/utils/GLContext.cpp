@@ -40,7 +40,7 @@ namespace massif {
                 break;
             }
         }
-        Log::Infof("GLContext::LoadExtensions: %s (version %d), anisotropic filtering %d", version ? version : "?", VERSION, TEXTURE_FILTER_ANISOTROPIC ? 1 : 0);
+        LOG_INFOF("GLContext::LoadExtensions: %s (version %d), anisotropic filtering %d", version ? version : "?", VERSION, TEXTURE_FILTER_ANISOTROPIC ? 1 : 0);
         if (VERSION < 300) {
             // Not fatal here - the context was already created, and failing to draw is worse than
             // drawing wrongly. It tells a bug report why everything after this looks broken.
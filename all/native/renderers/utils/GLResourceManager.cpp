@@ -19,7 +19,7 @@ namespace massif {
             _deleteQueue.clear();
         }
         if (!_deleteQueue.empty()) {
-            Log::Debugf("GLResourceManager::~GLResourceManager: Delete queue size: %d", static_cast<int>(_deleteQueue.size()));
+            LOG_DEBUGF("GLResourceManager::~GLResourceManager: Delete queue size: %d", static_cast<int>(_deleteQueue.size()));
         }
     }
 
@@ -8,6 +8,7 @@
 #include "utils/Log.h"
 #include "utils/GeomUtils.h"
 #include "utils/ThreadUtils.h"
+#include "utils/TraceProfiler.h"
 #include "vectorelements/Billboard.h"
 
 #include <algorithm>
@@ -62,6 +63,7 @@ namespace massif {
     
     void BillboardPlacementWorker::run() {
         ThreadUtils::SetThreadPriority(ThreadPriority::LOW);
+        TRACE_THREAD_NAME("BillboardPlacementWorker");
     
         while (true) {
             bool run = false;
@@ -87,6 +89,7 @@ namespace massif {
             }
 
             if (run) {
+                TRACE_SCOPE("BillboardPlacementWorker::calculateBillboardPlacement");
                 calculateBillboardPlacement();
             }
         }
@@ -9,6 +9,7 @@
 #include "utils/GeomUtils.h"
 #include "utils/Log.h"
 #include "utils/ThreadUtils.h"
+#include "utils/TraceProfiler.h"
 
 #include <vt/RenderStats.h>
 
@@ -72,6 +73,7 @@ namespace massif {
         
     void CullWorker::run() {
         ThreadUtils::SetThreadPriority(ThreadPriority::LOW);
+        TRACE_THREAD_NAME("CullWorker");
         while (true) {
             std::vector<std::shared_ptr<Layer> > layers;
             {
@@ -101,6 +103,7 @@ namespace massif {
             }
 
             if (!layers.empty()) {
+                TRACE_SCOPE("CullWorker::cull");
                 const std::shared_ptr<MapRenderer>& mapRenderer = _mapRenderer.lock();
                 if (!mapRenderer) {
                     return;
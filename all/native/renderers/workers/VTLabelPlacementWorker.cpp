@@ -6,6 +6,7 @@
 #include "utils/Const.h"
 #include "utils/Log.h"
 #include "utils/ThreadUtils.h"
+#include "utils/TraceProfiler.h"
 
 #include <vt/LabelCuller.h>
 
@@ -80,6 +81,7 @@ namespace massif {
     
     void VTLabelPlacementWorker::run() {
         ThreadUtils::SetThreadPriority(ThreadPriority::LOW);
+        TRACE_THREAD_NAME("VTLabelPlacementWorker");
     
         while (true) {
             bool run = false;
@@ -16,6 +16,7 @@ namespace massif {
         _profile("pedestrian"),
         _localDbs(),
         _configuration(ValhallaRoutingProxy::GetDefaultConfiguration()),
+        _routingContext(),
         _mutex()
     {
     }
@@ -78,6 +79,7 @@ namespace massif {
         }
         *subValue = value.toPicoJSON();
         _configuration = Variant::FromPicoJSON(config);
+        _routingContext.reset();
     }
 
     void MultiValhallaOfflineRoutingService::add(const std::string &database)
@@ -90,6 +92,7 @@ namespace massif {
                 return;
             }
             _localDbs.emplace_back(database);
+            _routingContext.reset();
         }
     }
 
@@ -104,6 +107,8 @@ namespace massif {
                 return false;
             }
             _localDbs.erase(it);
+            _packageHandlerCache.erase(database); // closes the database once no request uses it
+            _routingContext.reset();
         }
         return true;
     }
@@ -127,26 +132,10 @@ namespace massif {
         // Do routing via package manager, so that all packages are locked during routing
         std::shared_ptr<RouteMatchingResult> result;
         accessLocalPackages([this, &result, &request](const std::map<std::string, std::shared_ptr<ValhallaRoutingPackageHandler> >& packageHandlerMap) {
-            // Build map of routing packages and graph files
-            std::vector<std::shared_ptr<sqlite3pp::database> > packageDatabases;
-            for (auto it = packageHandlerMap.begin(); it != packageHandlerMap.end(); it++) {
-                if (auto valhallaRoutingHandler = std::dynamic_pointer_cast<ValhallaRoutingPackageHandler>(it->second)) {
-                    if (std::shared_ptr<sqlite3pp::database> database = valhallaRoutingHandler->getDatabase()) {
-                        packageDatabases.push_back(database);
-                    }
-                }
-            }
-
-            // Copy routing parameters
             std::string profile;
-            Variant configuration;
-            {
-                std::lock_guard<std::recursive_mutex> lock(_mutex);
-                profile = _profile;
-                configuration = _configuration;
-            }
+            std::shared_ptr<ValhallaRoutingProxy::RoutingContext> routingContext = getRoutingContext(packageHandlerMap, profile);
 
-            result = ValhallaRoutingProxy::MatchRoute(packageDatabases, profile, configuration, request);
+            result = ValhallaRoutingProxy::MatchRoute(*routingContext, profile, request);
         });
 
         return result;
@@ -160,31 +149,52 @@ namespace massif {
         // Do routing via package manager, so that all packages are locked during routing
         std::shared_ptr<RoutingResult> result;
         accessLocalPackages([this, &result, &request](const std::map<std::string, std::shared_ptr<ValhallaRoutingPackageHandler> >& packageHandlerMap) {
-            // Build map of routing packages and graph files
-            std::vector<std::shared_ptr<sqlite3pp::database> > packageDatabases;
-            for (auto it = packageHandlerMap.begin(); it != packageHandlerMap.end(); it++) {
-                if (auto valhallaRoutingHandler = std::dynamic_pointer_cast<ValhallaRoutingPackageHandler>(it->second)) {
-                    if (std::shared_ptr<sqlite3pp::database> database = valhallaRoutingHandler->getDatabase()) {
-                        packageDatabases.push_back(database);
-                    }
-                }
-            }
+            std::string profile;
+            std::shared_ptr<ValhallaRoutingProxy::RoutingContext> routingContext = getRoutingContext(packageHandlerMap, profile);
+
+            result = ValhallaRoutingProxy::CalculateRoute(*routingContext, profile, request);
+        });
+
+        return result;
+    }
 
-            // Copy routing parameters
+    std::shared_ptr<RoutingMatrixResult> MultiValhallaOfflineRoutingService::calculateMatrix(const std::shared_ptr<RoutingMatrixRequest>& request) const {
+        if (!request) {
+            throw NullArgumentException("Null request");
+        }
+
+        // Calculate the matrix via package manager, so that all packages are locked during routing
+        std::shared_ptr<RoutingMatrixResult> result;
+        accessLocalPackages([this, &result, &request](const std::map<std::string, std::shared_ptr<ValhallaRoutingPackageHandler> >& packageHandlerMap) {
             std::string profile;
-            Variant configuration;
-            {
-                std::lock_guard<std::recursive_mutex> lock(_mutex);
-                profile = _profile;
-                configuration = _configuration;
-            }
+            std::shared_ptr<ValhallaRoutingProxy::RoutingContext> routingContext = getRoutingContext(packageHandlerMap, profile);
 
-            result = ValhallaRoutingProxy::CalculateRoute(packageDatabases, profile, configuration, request);
+            result = ValhallaRoutingProxy::CalculateMatrix(*routingContext, profile, request);
         });
 
         return result;
     }
 
+    std::shared_ptr<ValhallaRoutingProxy::RoutingContext> MultiValhallaOfflineRoutingService::getRoutingContext(const std::map<std::string, std::shared_ptr<ValhallaRoutingPackageHandler> >& packageHandlerMap, std::string& profile) const {
+        // Collect the graph databases of the routing packages
+        std::vector<std::shared_ptr<sqlite3pp::database> > databases;
+        for (auto it = packageHandlerMap.begin(); it != packageHandlerMap.end(); it++) {
+            if (auto valhallaRoutingHandler = std::dynamic_pointer_cast<ValhallaRoutingPackageHandler>(it->second)) {
+                if (std::shared_ptr<sqlite3pp::database> database = valhallaRoutingHandler->getDatabase()) {
+                    databases.push_back(database);
+                }
+            }
+        }
+
+        // Copy routing parameters, reuse the context while the packages stay the same
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        profile = _profile;
+        if (!_routingContext || !_routingContext->isForDatabases(databases)) {
+            _routingContext = std::make_shared<ValhallaRoutingProxy::RoutingContext>(databases, _configuration);
+        }
+        return _routingContext;
+    }
+
     void MultiValhallaOfflineRoutingService::addLocale(const std::string& key, const std::string& json) const {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
         ValhallaRoutingProxy::AddLocale(key, json);
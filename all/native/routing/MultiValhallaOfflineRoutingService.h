@@ -11,6 +11,7 @@
 
 #include "core/Variant.h"
 #include "routing/RoutingService.h"
+#include "routing/utils/ValhallaRoutingProxy.h"
 #include "packagemanager/handlers/ValhallaRoutingPackageHandler.h"
 
 #include <memory>
@@ -54,6 +55,8 @@ namespace massif {
 
         virtual std::shared_ptr<RoutingResult> calculateRoute(const std::shared_ptr<RoutingRequest>& request) const;
 
+        virtual std::shared_ptr<RoutingMatrixResult> calculateMatrix(const std::shared_ptr<RoutingMatrixRequest>& request) const;
+
         /**
          * Adds a new database.
          * @param database The database file patht to be added.
@@ -70,9 +73,11 @@ namespace massif {
         void addLocale(const std::string& key, const std::string& json) const;
     private:
         void accessLocalPackages(const std::function<void(const std::map<std::string, std::shared_ptr<ValhallaRoutingPackageHandler> >&)>& callback) const;
+        std::shared_ptr<ValhallaRoutingProxy::RoutingContext> getRoutingContext(const std::map<std::string, std::shared_ptr<ValhallaRoutingPackageHandler> >& packageHandlerMap, std::string& profile) const;
 
         std::string _profile;
         Variant _configuration;
+        mutable std::shared_ptr<ValhallaRoutingProxy::RoutingContext> _routingContext; // for the packages of the last request
         mutable std::map<std::string, std::shared_ptr<ValhallaRoutingPackageHandler> > _packageHandlerCache;
         std::vector<std::string > _localDbs;
         mutable std::mutex _packageFileMutex; // guards all package file accesses
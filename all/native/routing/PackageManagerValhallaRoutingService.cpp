@@ -18,14 +18,20 @@ namespace massif {
         _packageManager(packageManager),
         _profile("pedestrian"),
         _configuration(ValhallaRoutingProxy::GetDefaultConfiguration()),
+        _routingContext(),
         _mutex()
     {
         if (!packageManager) {
             throw NullArgumentException("Null packageManager");
         }
+
+        _packageManagerListener = std::make_shared<PackageManagerListener>(*this);
+        _packageManager->registerOnChangeListener(_packageManagerListener);
     }
 
     PackageManagerValhallaRoutingService::~PackageManagerValhallaRoutingService() {
+        _packageManager->unregisterOnChangeListener(_packageManagerListener);
+        _packageManagerListener.reset();
     }
 
     Variant PackageManagerValhallaRoutingService::getConfigurationParameter(const std::string& param) const {
@@ -56,6 +62,7 @@ namespace massif {
         }
         *subValue = value.toPicoJSON();
         _configuration = Variant::FromPicoJSON(config);
+        _routingContext.reset();
     }
 
     std::string PackageManagerValhallaRoutingService::getProfile() const {
@@ -76,26 +83,10 @@ namespace massif {
         // Do routing via package manager, so that all packages are locked during routing
         std::shared_ptr<RouteMatchingResult> result;
         _packageManager->accessLocalPackages([this, &result, &request](const std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> >& packageHandlerMap) {
-            // Build map of routing packages and graph files
-            std::vector<std::shared_ptr<sqlite3pp::database> > packageDatabases;
-            for (auto it = packageHandlerMap.begin(); it != packageHandlerMap.end(); it++) {
-                if (auto valhallaRoutingHandler = std::dynamic_pointer_cast<ValhallaRoutingPackageHandler>(it->second)) {
-                    if (std::shared_ptr<sqlite3pp::database> database = valhallaRoutingHandler->getDatabase()) {
-                        packageDatabases.push_back(database);
-                    }
-                }
-            }
-
-            // Copy routing parameters
             std::string profile;
-            Variant configuration;
-            {
-                std::lock_guard<std::mutex> lock(_mutex);
-                profile = _profile;
-                configuration = _configuration;
-            }
+            std::shared_ptr<ValhallaRoutingProxy::RoutingContext> routingContext = getRoutingContext(packageHandlerMap, profile);
 
-            result = ValhallaRoutingProxy::MatchRoute(packageDatabases, profile, configuration, request);
+            result = ValhallaRoutingProxy::MatchRoute(*routingContext, profile, request);
         });
 
         return result;
@@ -109,35 +100,72 @@ namespace massif {
         // Do routing via package manager, so that all packages are locked during routing
         std::shared_ptr<RoutingResult> result;
         _packageManager->accessLocalPackages([this, &result, &request](const std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> >& packageHandlerMap) {
-            // Build map of routing packages and graph files
-            std::vector<std::shared_ptr<sqlite3pp::database> > packageDatabases;
-            for (auto it = packageHandlerMap.begin(); it != packageHandlerMap.end(); it++) {
-                if (auto valhallaRoutingHandler = std::dynamic_pointer_cast<ValhallaRoutingPackageHandler>(it->second)) {
-                    if (std::shared_ptr<sqlite3pp::database> database = valhallaRoutingHandler->getDatabase()) {
-                        packageDatabases.push_back(database);
-                    }
-                }
-            }
+            std::string profile;
+            std::shared_ptr<ValhallaRoutingProxy::RoutingContext> routingContext = getRoutingContext(packageHandlerMap, profile);
+
+            result = ValhallaRoutingProxy::CalculateRoute(*routingContext, profile, request);
+        });
 
-            // Copy routing parameters
+        return result;
+    }
+
+    std::shared_ptr<RoutingMatrixResult> PackageManagerValhallaRoutingService::calculateMatrix(const std::shared_ptr<RoutingMatrixRequest>& request) const {
+        if (!request) {
+            throw NullArgumentException("Null request");
+        }
+
+        // Calculate the matrix via package manager, so that all packages are locked during routing
+        std::shared_ptr<RoutingMatrixResult> result;
+        _packageManager->accessLocalPackages([this, &result, &request](const std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> >& packageHandlerMap) {
             std::string profile;
-            Variant configuration;
-            {
-                std::lock_guard<std::mutex> lock(_mutex);
-                profile = _profile;
-                configuration = _configuration;
-            }
+            std::shared_ptr<ValhallaRoutingProxy::RoutingContext> routingContext = getRoutingContext(packageHandlerMap, profile);
 
-            result = ValhallaRoutingProxy::CalculateRoute(packageDatabases, profile, configuration, request);
+            result = ValhallaRoutingProxy::CalculateMatrix(*routingContext, profile, request);
         });
 
         return result;
     }
 
+    std::shared_ptr<ValhallaRoutingProxy::RoutingContext> PackageManagerValhallaRoutingService::getRoutingContext(const std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> >& packageHandlerMap, std::string& profile) const {
+        // Collect the graph databases of the routing packages
+        std::vector<std::shared_ptr<sqlite3pp::database> > databases;
+        for (auto it = packageHandlerMap.begin(); it != packageHandlerMap.end(); it++) {
+            if (auto valhallaRoutingHandler = std::dynamic_pointer_cast<ValhallaRoutingPackageHandler>(it->second)) {
+                if (std::shared_ptr<sqlite3pp::database> database = valhallaRoutingHandler->getDatabase()) {
+                    databases.push_back(database);
+                }
+            }
+        }
+
+        // Copy routing parameters, reuse the context while the packages stay the same
+        std::lock_guard<std::mutex> lock(_mutex);
+        profile = _profile;
+        if (!_routingContext || !_routingContext->isForDatabases(databases)) {
+            _routingContext = std::make_shared<ValhallaRoutingProxy::RoutingContext>(databases, _configuration);
+        }
+        return _routingContext;
+    }
+
     void PackageManagerValhallaRoutingService::addLocale(const std::string& key, const std::string& json) const {
         std::lock_guard<std::mutex> lock(_mutex);
         ValhallaRoutingProxy::AddLocale(key, json);
     }
+
+    PackageManagerValhallaRoutingService::PackageManagerListener::PackageManagerListener(PackageManagerValhallaRoutingService& service) :
+        _service(service)
+    {
+    }
+
+    void PackageManagerValhallaRoutingService::PackageManagerListener::onPackagesChanged(PackageChangeType changeType) {
+        // Release the graph reader and the databases of the old packages now, not on the next request
+        std::lock_guard<std::mutex> lock(_service._mutex);
+        _service._routingContext.reset();
+    }
+
+    void PackageManagerValhallaRoutingService::PackageManagerListener::onStylesChanged() {
+        // Impossible
+    }
+
 }
 
 #endif
@@ -12,6 +12,7 @@
 #include "core/Variant.h"
 #include "packagemanager/PackageManager.h"
 #include "routing/RoutingService.h"
+#include "routing/utils/ValhallaRoutingProxy.h"
 
 #include <memory>
 #include <string>
@@ -56,14 +57,33 @@ namespace massif {
 
         virtual std::shared_ptr<RoutingResult> calculateRoute(const std::shared_ptr<RoutingRequest>& request) const;
 
+        virtual std::shared_ptr<RoutingMatrixResult> calculateMatrix(const std::shared_ptr<RoutingMatrixRequest>& request) const;
+
         void addLocale(const std::string& key, const std::string& json) const;
 
     protected:
+        class PackageManagerListener : public PackageManager::OnChangeListener {
+        public:
+            explicit PackageManagerListener(PackageManagerValhallaRoutingService& service);
+
+            virtual void onPackagesChanged(PackageChangeType changeType);
+            virtual void onStylesChanged();
+
+        private:
+            PackageManagerValhallaRoutingService& _service;
+        };
+
         const std::shared_ptr<PackageManager> _packageManager;
         std::string _profile;
         Variant _configuration;
+        mutable std::shared_ptr<ValhallaRoutingProxy::RoutingContext> _routingContext; // for the packages of the last request
 
         mutable std::mutex _mutex;
+
+    private:
+        std::shared_ptr<ValhallaRoutingProxy::RoutingContext> getRoutingContext(const std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> >& packageHandlerMap, std::string& profile) const;
+
+        std::shared_ptr<PackageManagerListener> _packageManagerListener;
     };
     
 }
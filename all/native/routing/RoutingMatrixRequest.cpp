@@ -0,0 +1,103 @@
+#ifdef _MASSIF_ROUTING_SUPPORT
+
+#include "RoutingMatrixRequest.h"
+#include "components/Exceptions.h"
+
+#include <iomanip>
+#include <sstream>
+
+#include <boost/algorithm/string.hpp>
+
+namespace massif {
+
+    RoutingMatrixRequest::RoutingMatrixRequest(const std::shared_ptr<Projection>& projection, const std::vector<MapPos>& sources, const std::vector<MapPos>& targets) :
+        _projection(projection),
+        _sources(sources),
+        _targets(targets),
+        _customParams(),
+        _mutex()
+    {
+        if (!projection) {
+            throw NullArgumentException("Null projection");
+        }
+        if (sources.empty()) {
+            throw InvalidArgumentException("Empty source list");
+        }
+        if (targets.empty()) {
+            throw InvalidArgumentException("Empty target list");
+        }
+    }
+
+    RoutingMatrixRequest::~RoutingMatrixRequest() {
+    }
+
+    const std::shared_ptr<Projection>& RoutingMatrixRequest::getProjection() const {
+        return _projection;
+    }
+
+    const std::vector<MapPos>& RoutingMatrixRequest::getSources() const {
+        return _sources;
+    }
+
+    const std::vector<MapPos>& RoutingMatrixRequest::getTargets() const {
+        return _targets;
+    }
+
+    Variant RoutingMatrixRequest::getCustomParameters() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _customParams;
+    }
+
+    Variant RoutingMatrixRequest::getCustomParameter(const std::string& param) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<std::string> keys;
+        boost::split(keys, param, boost::is_any_of("."));
+        picojson::value subValue = _customParams.toPicoJSON();
+        for (const std::string& key : keys) {
+            if (!subValue.is<picojson::object>()) {
+                return Variant();
+            }
+            subValue = subValue.get(key);
+        }
+        return Variant::FromPicoJSON(subValue);
+    }
+
+    void RoutingMatrixRequest::setCustomParameter(const std::string& param, const Variant& value) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<std::string> keys;
+        boost::split(keys, param, boost::is_any_of("."));
+        picojson::value rootValue = _customParams.toPicoJSON();
+        picojson::value* subValue = &rootValue;
+        for (const std::string& key : keys) {
+            if (!subValue->is<picojson::object>()) {
+                subValue->set(picojson::object());
+            }
+            subValue = &subValue->get<picojson::object>()[key];
+        }
+        *subValue = value.toPicoJSON();
+        _customParams = Variant::FromPicoJSON(rootValue);
+    }
+
+    std::string RoutingMatrixRequest::toString() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::stringstream ss;
+        ss << std::setiosflags(std::ios::fixed);
+        ss << "RoutingMatrixRequest [sources=[";
+        for (auto it = _sources.begin(); it != _sources.end(); ++it) {
+            ss << (it == _sources.begin() ? "" : ", ") << it->toString();
+        }
+        ss << "], targets=[";
+        for (auto it = _targets.begin(); it != _targets.end(); ++it) {
+            ss << (it == _targets.begin() ? "" : ", ") << it->toString();
+        }
+        ss << "]";
+        if (_customParams.getType() != VariantType::VARIANT_TYPE_NULL) {
+            ss << ", customParams=" << _customParams.toString();
+        }
+        ss << "]";
+        return ss.str();
+    }
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _MASSIF_ROUTINGMATRIXREQUEST_H_
+#define _MASSIF_ROUTINGMATRIXREQUEST_H_
+
+#ifdef _MASSIF_ROUTING_SUPPORT
+
+#include "core/MapPos.h"
+#include "core/Variant.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace massif {
+    class Projection;
+
+    /**
+     * A class that defines the source and target points of a travel time and distance matrix.
+     */
+    class RoutingMatrixRequest {
+    public:
+        /**
+         * Constructs a new RoutingMatrixRequest instance from projection, source and target points.
+         * @param projection The projection of the points.
+         * @param sources The list of source points. Must contain at least 1 element.
+         * @param targets The list of target points. Must contain at least 1 element.
+         */
+        RoutingMatrixRequest(const std::shared_ptr<Projection>& projection, const std::vector<MapPos>& sources, const std::vector<MapPos>& targets);
+        virtual ~RoutingMatrixRequest();
+
+        /**
+         * Returns the projection of the points in the request.
+         * @return The projection of the request.
+         */
+        const std::shared_ptr<Projection>& getProjection() const;
+        /**
+         * Returns the source point list of the request.
+         * @return The source point list of the request.
+         */
+        const std::vector<MapPos>& getSources() const;
+        /**
+         * Returns the target point list of the request.
+         * @return The target point list of the request.
+         */
+        const std::vector<MapPos>& getTargets() const;
+
+        /**
+         * Returns the set of custom parameters of the request as a variant.
+         * @return The set of custom parameters as a variant. Can be empty.
+         */
+        Variant getCustomParameters() const;
+        /**
+         * Returns the custom parameter value of the request.
+         * @param param The name of the parameter to return.
+         * @return The value of the parameter. If the parameter does not exist, empty variant is returned.
+         */
+        Variant getCustomParameter(const std::string& param) const;
+        /**
+         * Sets a custom parameter value for the the request.
+         * @param param The name of the parameter. For example, "costing_options.auto.use_tolls".
+         * @param value The new value for the parameter.
+         */
+        void setCustomParameter(const std::string& param, const Variant& value);
+
+        /**
+         * Creates a string representation of this request object, useful for logging.
+         * @return The string representation of this request object.
+         */
+        std::string toString() const;
+        
+    private:
+        const std::shared_ptr<Projection> _projection;
+        const std::vector<MapPos> _sources;
+        const std::vector<MapPos> _targets;
+        Variant _customParams;
+
+        mutable std::mutex _mutex;
+    };
+    
+}
+
+#endif
+
+#endif
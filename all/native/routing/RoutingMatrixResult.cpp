@@ -0,0 +1,78 @@
+#ifdef _MASSIF_ROUTING_SUPPORT
+
+#include "RoutingMatrixResult.h"
+#include "components/Exceptions.h"
+
+#include <sstream>
+
+namespace massif {
+
+    RoutingMatrixResult::RoutingMatrixResult(int sourceCount, int targetCount, std::vector<double> times, std::vector<double> distances) :
+        _sourceCount(sourceCount),
+        _targetCount(targetCount),
+        _times(std::move(times)),
+        _distances(std::move(distances))
+    {
+        if (sourceCount < 0 || targetCount < 0) {
+            throw InvalidArgumentException("Negative source or target count");
+        }
+        std::size_t size = static_cast<std::size_t>(sourceCount) * static_cast<std::size_t>(targetCount);
+        if (_times.size() != size || _distances.size() != size) {
+            throw InvalidArgumentException("Time and distance lists do not match the source and target counts");
+        }
+    }
+
+    RoutingMatrixResult::~RoutingMatrixResult() {
+    }
+
+    int RoutingMatrixResult::getSourceCount() const {
+        return _sourceCount;
+    }
+
+    int RoutingMatrixResult::getTargetCount() const {
+        return _targetCount;
+    }
+
+    double RoutingMatrixResult::getTime(int sourceIndex, int targetIndex) const {
+        return _times[getIndex(sourceIndex, targetIndex)];
+    }
+
+    double RoutingMatrixResult::getDistance(int sourceIndex, int targetIndex) const {
+        return _distances[getIndex(sourceIndex, targetIndex)];
+    }
+
+    const std::vector<double>& RoutingMatrixResult::getTimes() const {
+        return _times;
+    }
+
+    const std::vector<double>& RoutingMatrixResult::getDistances() const {
+        return _distances;
+    }
+
+    std::string RoutingMatrixResult::toString() const {
+        std::stringstream ss;
+        ss << "RoutingMatrixResult [sourceCount=" << _sourceCount << ", targetCount=" << _targetCount << ", times=[";
+        for (auto it = _times.begin(); it != _times.end(); ++it) {
+            ss << (it == _times.begin() ? "" : ", ") << *it;
+        }
+        ss << "], distances=[";
+        for (auto it = _distances.begin(); it != _distances.end(); ++it) {
+            ss << (it == _distances.begin() ? "" : ", ") << *it;
+        }
+        ss << "]]";
+        return ss.str();
+    }
+
+    std::size_t RoutingMatrixResult::getIndex(int sourceIndex, int targetIndex) const {
+        if (sourceIndex < 0 || sourceIndex >= _sourceCount) {
+            throw OutOfRangeException("Source index out of range");
+        }
+        if (targetIndex < 0 || targetIndex >= _targetCount) {
+            throw OutOfRangeException("Target index out of range");
+        }
+        return static_cast<std::size_t>(sourceIndex) * _targetCount + targetIndex;
+    }
+
+}
+
+#endif
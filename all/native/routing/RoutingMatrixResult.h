@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _MASSIF_ROUTINGMATRIXRESULT_H_
+#define _MASSIF_ROUTINGMATRIXRESULT_H_
+
+#ifdef _MASSIF_ROUTING_SUPPORT
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace massif {
+
+    /**
+     * A class that contains the travel times and distances between all sources and targets of a matrix request.
+     * Only the totals are calculated, the result contains no paths or instructions.
+     */
+    class RoutingMatrixResult {
+    public:
+        /**
+         * Constructs a new RoutingMatrixResult instance from source and target counts and row-major time and distance lists.
+         * @param sourceCount The number of sources (rows).
+         * @param targetCount The number of targets (columns).
+         * @param times The travel times in seconds, sourceCount * targetCount elements.
+         * @param distances The travel distances in meters, sourceCount * targetCount elements.
+         */
+        RoutingMatrixResult(int sourceCount, int targetCount, std::vector<double> times, std::vector<double> distances);
+        virtual ~RoutingMatrixResult();
+
+        /**
+         * Returns the number of sources in the result.
+         * @return The number of sources.
+         */
+        int getSourceCount() const;
+        /**
+         * Returns the number of targets in the result.
+         * @return The number of targets.
+         */
+        int getTargetCount() const;
+
+        /**
+         * Returns the travel time from the specified source to the specified target.
+         * @param sourceIndex The index of the source.
+         * @param targetIndex The index of the target.
+         * @return The travel time in seconds. If the target can not be reached, NaN is returned.
+         * @throws std::out_of_range If either index is out of range.
+         */
+        double getTime(int sourceIndex, int targetIndex) const;
+        /**
+         * Returns the travel distance from the specified source to the specified target.
+         * @param sourceIndex The index of the source.
+         * @param targetIndex The index of the target.
+         * @return The travel distance in meters. If the target can not be reached, NaN is returned.
+         * @throws std::out_of_range If either index is out of range.
+         */
+        double getDistance(int sourceIndex, int targetIndex) const;
+
+        /**
+         * Returns all travel times, the times from the first source first.
+         * @return The travel times in seconds.
+         */
+        const std::vector<double>& getTimes() const;
+        /**
+         * Returns all travel distances, the distances from the first source first.
+         * @return The travel distances in meters.
+         */
+        const std::vector<double>& getDistances() const;
+
+        /**
+         * Creates a string representation of this result object, useful for logging.
+         * @return The string representation of this result object.
+         */
+        std::string toString() const;
+        
+    private:
+        std::size_t getIndex(int sourceIndex, int targetIndex) const;
+
+        int _sourceCount;
+        int _targetCount;
+        std::vector<double> _times;
+        std::vector<double> _distances;
+    };
+    
+}
+
+#endif
+
+#endif
@@ -59,7 +59,8 @@ namespace massif {
          */
         double getTotalTime() const;
         /**
-         * Returns raw result 
+         * Returns raw result. Offline Valhalla services include the raw result only if
+         * the boolean custom parameter "raw_result" of the request is set to true.
          */
         const std::string& getRawResult() const;
 
@@ -1,6 +1,9 @@
 #ifdef _MASSIF_ROUTING_SUPPORT
 
 #include "RoutingService.h"
+#include "components/Exceptions.h"
+
+#include <limits>
 
 namespace massif {
 
@@ -10,6 +13,43 @@ namespace massif {
     RoutingService::~RoutingService() {
     }
 
+    std::shared_ptr<RoutingMatrixResult> RoutingService::calculateMatrix(const std::shared_ptr<RoutingMatrixRequest>& request) const {
+        if (!request) {
+            throw NullArgumentException("Null request");
+        }
+
+        const std::vector<MapPos>& sources = request->getSources();
+        const std::vector<MapPos>& targets = request->getTargets();
+        Variant customParams = request->getCustomParameters();
+
+        std::vector<double> times(sources.size() * targets.size(), std::numeric_limits<double>::quiet_NaN());
+        std::vector<double> distances(sources.size() * targets.size(), std::numeric_limits<double>::quiet_NaN());
+        for (std::size_t i = 0; i < sources.size(); i++) {
+            for (std::size_t j = 0; j < targets.size(); j++) {
+                auto routingRequest = std::make_shared<RoutingRequest>(request->getProjection(), std::vector<MapPos> { sources[i], targets[j] });
+                if (customParams.getType() == VariantType::VARIANT_TYPE_OBJECT) {
+                    for (const std::string& key : customParams.getObjectKeys()) {
+                        routingRequest->setCustomParameter(key, customParams.getObjectElement(key));
+                    }
+                }
+
+                // A failed route only means the target is not reachable, IO errors are passed on
+                std::shared_ptr<RoutingResult> result;
+                try {
+                    result = calculateRoute(routingRequest);
+                }
+                catch (const GenericException& ex) {
+                    continue;
+                }
+                if (result) {
+                    times[i * targets.size() + j] = result->getTotalTime();
+                    distances[i * targets.size() + j] = result->getTotalDistance();
+                }
+            }
+        }
+        return std::make_shared<RoutingMatrixResult>(static_cast<int>(sources.size()), static_cast<int>(targets.size()), std::move(times), std::move(distances));
+    }
+
 }
 
 #endif
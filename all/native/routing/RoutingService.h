@@ -13,6 +13,8 @@
 #include "routing/RoutingResult.h"
 #include "routing/RouteMatchingRequest.h"
 #include "routing/RouteMatchingResult.h"
+#include "routing/RoutingMatrixRequest.h"
+#include "routing/RoutingMatrixResult.h"
 
 #include <memory>
 
@@ -52,6 +54,16 @@ namespace massif {
          */
         virtual std::shared_ptr<RoutingResult> calculateRoute(const std::shared_ptr<RoutingRequest>& request) const = 0;
 
+        /**
+         * Calculates the travel times and distances from each source to each target of the request.
+         * The default implementation calculates a full route for each pair, services that can search
+         * from one source to many targets at once override it.
+         * @param request The matrix request defining source and target points.
+         * @return The matrix result. Unreachable targets have NaN time and distance.
+         * @throws std::runtime_error If IO error occured during the calculation.
+         */
+        virtual std::shared_ptr<RoutingMatrixResult> calculateMatrix(const std::shared_ptr<RoutingMatrixRequest>& request) const;
+
     protected:
         /**
          * The default constructor.
@@ -8,7 +8,11 @@
 #include "routing/utils/RoutingResultBuilder.h"
 #include "utils/Log.h"
 
+#include <functional>
 #include <limits>
+#include <map>
+#include <tuple>
+#include <utility>
 
 #include <sgre/Graph.h>
 #include <sgre/GraphBuilder.h>
@@ -20,13 +24,32 @@
 
 namespace massif {
 
+    namespace {
+        using GraphPtr = decltype(std::declval<sgre::GraphBuilder&>().build());
+
+        // Built graphs by input hash and profile. The graphs are not modified by the route finders,
+        // so services created from the same data share them for as long as any of them is alive.
+        std::mutex graphCacheMutex;
+        std::map<std::pair<std::size_t, std::string>, std::weak_ptr<GraphPtr::element_type> > graphCache;
+
+        std::size_t CalculateInputHash(const picojson::value& featureData, const picojson::value& config) {
+            std::hash<std::string> hasher;
+            std::size_t hash = hasher(featureData.serialize());
+            if (config.contains("rules")) {
+                hash ^= hasher(config.get("rules").serialize()) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            }
+            return hash;
+        }
+    }
+
     SGREOfflineRoutingService::SGREOfflineRoutingService(const Variant& geoJSON, const Variant& config) :
         RoutingService(),
         _featureData(geoJSON.toPicoJSON()),
         _config(config.toPicoJSON()),
+        _inputHash(CalculateInputHash(_featureData, _config)),
         _profile(),
         _routingParameters(),
-        _cachedRouteFinder(),
+        _cachedRouteFinders(),
         _mutex()
     {
     }
@@ -35,9 +58,10 @@ namespace massif {
         RoutingService(),
         _featureData(),
         _config(config.toPicoJSON()),
+        _inputHash(0),
         _profile(),
         _routingParameters(),
-        _cachedRouteFinder(),
+        _cachedRouteFinders(),
         _mutex()
     {
         if (!featureCollection) {
@@ -51,6 +75,7 @@ namespace massif {
         if (!err.empty()) {
             throw GenericException("Error while serializing feature data", err);
         }
+        _inputHash = CalculateInputHash(_featureData, _config);
     }
 
     SGREOfflineRoutingService::~SGREOfflineRoutingService() {
@@ -77,10 +102,7 @@ namespace massif {
 
     void SGREOfflineRoutingService::setProfile(const std::string& profile) {
         std::lock_guard<std::mutex> lock(_mutex);
-        if (profile != _profile) {
-            _profile = profile;
-            _cachedRouteFinder.reset();
-        }
+        _profile = profile;
     }
 
     std::shared_ptr<RouteMatchingResult> SGREOfflineRoutingService::matchRoute(const std::shared_ptr<RouteMatchingRequest>& request) const {
@@ -93,24 +115,7 @@ namespace massif {
         }
 
         std::lock_guard<std::mutex> lock(_mutex);
-        if (!_cachedRouteFinder) {
-            try {
-                sgre::RuleList ruleList;
-                if (_config.contains("rules")) {
-                    ruleList = sgre::RuleList::parse(_config.get("rules"));
-                }
-                ruleList.filter(_profile);
-                sgre::GraphBuilder graphBuilder(std::move(ruleList));
-                graphBuilder.importGeoJSON(_featureData);
-                _cachedRouteFinder = sgre::RouteFinder::create(graphBuilder.build(), _config);
-            }
-            catch (const std::exception& ex) {
-                throw GenericException("Failed to create routing graph", ex.what());
-            }
-        }
-
-        std::shared_ptr<sgre::RouteFinder> routeFinder = _cachedRouteFinder;
-        routeFinder->setParameters(_routingParameters);
+        std::shared_ptr<sgre::RouteFinder> routeFinder = getRouteFinder();
 
         std::shared_ptr<Projection> proj = request->getProjection();
 
@@ -187,6 +192,95 @@ namespace massif {
         return resultBuilder.buildRoutingResult();
     }
 
+    std::shared_ptr<RoutingMatrixResult> SGREOfflineRoutingService::calculateMatrix(const std::shared_ptr<RoutingMatrixRequest>& request) const {
+        if (!request) {
+            throw NullArgumentException("Null request");
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::shared_ptr<sgre::RouteFinder> routeFinder = getRouteFinder();
+
+        std::shared_ptr<Projection> proj = request->getProjection();
+
+        auto toSGREPoints = [&proj](const std::vector<MapPos>& points) {
+            std::vector<sgre::Point> sgrePoints;
+            sgrePoints.reserve(points.size());
+            for (const MapPos& point : points) {
+                MapPos posWgs84 = proj->toWgs84(point);
+                sgrePoints.emplace_back(posWgs84.getX(), posWgs84.getY(), point.getZ());
+            }
+            return sgrePoints;
+        };
+        std::vector<sgre::Point> sources = toSGREPoints(request->getSources());
+        std::vector<sgre::Point> targets = toSGREPoints(request->getTargets());
+
+        // The route finder only answers point-to-point queries, but the graph is shared by all of them
+        // and only the instruction totals are read - no geometry is converted and no result is built.
+        std::vector<double> times(sources.size() * targets.size(), std::numeric_limits<double>::quiet_NaN());
+        std::vector<double> distances(sources.size() * targets.size(), std::numeric_limits<double>::quiet_NaN());
+        for (std::size_t i = 0; i < sources.size(); i++) {
+            for (std::size_t j = 0; j < targets.size(); j++) {
+                sgre::Result result = routeFinder->find(sgre::Query(sources[i], targets[j]));
+                if (result.getStatus() == sgre::Result::Status::FAILED) {
+                    continue;
+                }
+
+                double time = 0;
+                double distance = 0;
+                for (const sgre::Instruction& instr : result.getInstructions()) {
+                    time += instr.getTime();
+                    distance += instr.getDistance();
+                }
+                times[i * targets.size() + j] = time;
+                distances[i * targets.size() + j] = distance;
+            }
+        }
+        return std::make_shared<RoutingMatrixResult>(static_cast<int>(sources.size()), static_cast<int>(targets.size()), std::move(times), std::move(distances));
+    }
+
+    std::shared_ptr<sgre::RouteFinder> SGREOfflineRoutingService::getRouteFinder() const {
+        // Graphs are kept for each profile used, switching back to a profile does not build its graph again
+        std::shared_ptr<sgre::RouteFinder>& cachedRouteFinder = _cachedRouteFinders[_profile];
+        if (!cachedRouteFinder) {
+            try {
+                std::pair<std::size_t, std::string> graphKey(_inputHash, _profile);
+                GraphPtr graph;
+                {
+                    std::lock_guard<std::mutex> lock(graphCacheMutex);
+                    auto it = graphCache.find(graphKey);
+                    if (it != graphCache.end()) {
+                        graph = it->second.lock();
+                    }
+                }
+                if (!graph) {
+                    sgre::RuleList ruleList;
+                    if (_config.contains("rules")) {
+                        ruleList = sgre::RuleList::parse(_config.get("rules"));
+                    }
+                    ruleList.filter(_profile);
+                    sgre::GraphBuilder graphBuilder(std::move(ruleList));
+                    graphBuilder.importGeoJSON(_featureData);
+                    graph = graphBuilder.build();
+
+                    std::lock_guard<std::mutex> lock(graphCacheMutex);
+                    for (auto it = graphCache.begin(); it != graphCache.end(); ) {
+                        it = (it->second.expired() ? graphCache.erase(it) : std::next(it));
+                    }
+                    graphCache[graphKey] = graph;
+                }
+                cachedRouteFinder = sgre::RouteFinder::create(graph, _config);
+            }
+            catch (const std::exception& ex) {
+                _cachedRouteFinders.erase(_profile);
+                throw GenericException("Failed to create routing graph", ex.what());
+            }
+        }
+
+        std::shared_ptr<sgre::RouteFinder> routeFinder = cachedRouteFinder;
+        routeFinder->setParameters(_routingParameters);
+        return routeFinder;
+    }
+
     bool SGREOfflineRoutingService::TranslateInstructionCode(int instructionCode, RoutingAction::RoutingAction& action) {
         switch (static_cast<sgre::Instruction::Type>(instructionCode)) {
         case sgre::Instruction::Type::HEAD_ON:
@@ -214,7 +308,7 @@ namespace massif {
             action = RoutingAction::ROUTING_ACTION_WAIT;
             break;
         default:
-            Log::Infof("SGREOfflineRoutingService::TranslateInstructionCode: ignoring instruction %d", instructionCode);
+            LOG_INFOF("SGREOfflineRoutingService::TranslateInstructionCode: ignoring instruction %d", instructionCode);
             return false;
         }
         return true;
@@ -30,6 +30,8 @@ namespace massif {
 
     /**
      * An offline routing service that uses SGRE routing engine.
+     * The routing graph of each profile is built in memory when the profile is first used. Services
+     * with the same feature data and rules share their graphs, but the graphs are not persisted.
      * Note: this class is experimental and may change or even be removed in future SDK versions.
      */
     class SGREOfflineRoutingService : public RoutingService {
@@ -71,15 +73,20 @@ namespace massif {
 
         virtual std::shared_ptr<RoutingResult> calculateRoute(const std::shared_ptr<RoutingRequest>& request) const;
 
+        virtual std::shared_ptr<RoutingMatrixResult> calculateMatrix(const std::shared_ptr<RoutingMatrixRequest>& request) const;
+
     protected:
+        std::shared_ptr<sgre::RouteFinder> getRouteFinder() const;
+
         static bool TranslateInstructionCode(int instructionCode, RoutingAction::RoutingAction& action);
 
         picojson::value _featureData;
         picojson::value _config;
+        std::size_t _inputHash; // of the feature data and rules, identifies the graphs built
         std::string _profile;
         std::map<std::string, float> _routingParameters;
 
-        mutable std::shared_ptr<sgre::RouteFinder> _cachedRouteFinder;
+        mutable std::map<std::string, std::shared_ptr<sgre::RouteFinder> > _cachedRouteFinders; // by profile
 
         mutable std::mutex _mutex;
     };
@@ -16,6 +16,7 @@ namespace massif {
         _database(std::make_unique<sqlite3pp::database>()),
         _profile("pedestrian"),
         _configuration(ValhallaRoutingProxy::GetDefaultConfiguration()),
+        _routingContext(),
         _mutex()
     {
         if (_database->connect_v2(path.c_str(), SQLITE_OPEN_READONLY | SQLITE_OPEN_FULLMUTEX) != SQLITE_OK) {
@@ -55,6 +56,7 @@ namespace massif {
         }
         *subValue = value.toPicoJSON();
         _configuration = Variant::FromPicoJSON(config);
+        _routingContext.reset();
     }
 
     std::string ValhallaOfflineRoutingService::getProfile() const {
@@ -73,14 +75,14 @@ namespace massif {
         }
 
         std::string profile;
-        Variant configuration;
+        std::shared_ptr<ValhallaRoutingProxy::RoutingContext> routingContext;
         {
             std::lock_guard<std::mutex> lock(_mutex);
 
             profile = _profile;
-            configuration = _configuration;
+            routingContext = getRoutingContext();
         }
-        return ValhallaRoutingProxy::MatchRoute(std::vector<std::shared_ptr<sqlite3pp::database> > { _database }, profile, configuration, request);
+        return ValhallaRoutingProxy::MatchRoute(*routingContext, profile, request);
     }
 
     std::shared_ptr<RoutingResult> ValhallaOfflineRoutingService::calculateRoute(const std::shared_ptr<RoutingRequest>& request) const {
@@ -89,15 +91,39 @@ namespace massif {
         }
 
         std::string profile;
-        Variant configuration;
+        std::shared_ptr<ValhallaRoutingProxy::RoutingContext> routingContext;
         {
             std::lock_guard<std::mutex> lock(_mutex);
 
             profile = _profile;
-            configuration = _configuration;
+            routingContext = getRoutingContext();
         }
 
-        return ValhallaRoutingProxy::CalculateRoute(std::vector<std::shared_ptr<sqlite3pp::database> > { _database }, profile, configuration, request);
+        return ValhallaRoutingProxy::CalculateRoute(*routingContext, profile, request);
+    }
+
+    std::shared_ptr<RoutingMatrixResult> ValhallaOfflineRoutingService::calculateMatrix(const std::shared_ptr<RoutingMatrixRequest>& request) const {
+        if (!request) {
+            throw NullArgumentException("Null request");
+        }
+
+        std::string profile;
+        std::shared_ptr<ValhallaRoutingProxy::RoutingContext> routingContext;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            profile = _profile;
+            routingContext = getRoutingContext();
+        }
+
+        return ValhallaRoutingProxy::CalculateMatrix(*routingContext, profile, request);
+    }
+
+    std::shared_ptr<ValhallaRoutingProxy::RoutingContext> ValhallaOfflineRoutingService::getRoutingContext() const {
+        if (!_routingContext) {
+            _routingContext = std::make_shared<ValhallaRoutingProxy::RoutingContext>(std::vector<std::shared_ptr<sqlite3pp::database> > { _database }, _configuration);
+        }
+        return _routingContext;
     }
 
     void ValhallaOfflineRoutingService::addLocale(const std::string& key, const std::string& json) const {
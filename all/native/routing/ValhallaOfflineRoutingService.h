@@ -11,6 +11,7 @@
 
 #include "core/Variant.h"
 #include "routing/RoutingService.h"
+#include "routing/utils/ValhallaRoutingProxy.h"
 
 #include <memory>
 #include <mutex>
@@ -54,13 +55,18 @@ namespace massif {
         virtual std::shared_ptr<RouteMatchingResult> matchRoute(const std::shared_ptr<RouteMatchingRequest>& request) const;
 
         virtual std::shared_ptr<RoutingResult> calculateRoute(const std::shared_ptr<RoutingRequest>& request) const;
+
+        virtual std::shared_ptr<RoutingMatrixResult> calculateMatrix(const std::shared_ptr<RoutingMatrixRequest>& request) const;
         
         void addLocale(const std::string& key, const std::string& json) const;
 
     private:
+        std::shared_ptr<ValhallaRoutingProxy::RoutingContext> getRoutingContext() const;
+
         std::shared_ptr<sqlite3pp::database> _database;
         std::string _profile;
         Variant _configuration;
+        mutable std::shared_ptr<ValhallaRoutingProxy::RoutingContext> _routingContext; // created on first use
         mutable std::mutex _mutex;
     };
     
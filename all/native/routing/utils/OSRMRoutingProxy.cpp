@@ -202,7 +202,7 @@ namespace massif {
             action = RoutingAction::ROUTING_ACTION_FINISH;
             break;
         default:
-            Log::Infof("OSRMRoutingProxy::TranslateInstructionCode: ignoring instruction %d", instructionCode);
+            LOG_INFOF("OSRMRoutingProxy::TranslateInstructionCode: ignoring instruction %d", instructionCode);
             return false;
         }
         return true;
@@ -8,6 +8,8 @@
 #include "projections/Projection.h"
 #include "routing/RoutingRequest.h"
 #include "routing/RoutingResult.h"
+#include "routing/RoutingMatrixRequest.h"
+#include "routing/RoutingMatrixResult.h"
 #include "routing/RouteMatchingRequest.h"
 #include "routing/RouteMatchingResult.h"
 #include "routing/RouteMatchingPoint.h"
@@ -17,12 +19,15 @@
 #include "utils/NetworkUtils.h"
 #include "utils/Log.h"
 
+#include <algorithm>
 #include <ctime>
+#include <limits>
 #include <vector>
 #include <string>
 #include <vector>
 #include <cstdint>
 #include <sstream>
+#include <stdexcept>
 #include <utility>
 
 #include <boost/property_tree/ptree.hpp>
@@ -62,104 +67,6 @@
 #include <valhalla/tyr/serializers.h>
 #include <valhalla/odin/util.h>
 #include <valhalla/odin/directionsbuilder.h>
-
-#else
-
-namespace valhalla { namespace midgard {
-
-    typedef std::pair<float, float> PointLL;
-
-    template<typename Point>
-    class Shape5Decoder {
-    public:
-        Shape5Decoder(const char* begin, const size_t size) : begin(begin), end(begin + size) {
-        }
-        Point pop() noexcept(false) {
-            lat = next(lat);
-            lon = next(lon);
-            return Point(typename Point::first_type(double(lon) * 1e-6),
-                         typename Point::second_type(double(lat) * 1e-6));
-        }
-        bool empty() const {
-            return begin == end;
-        }
-
-    private:
-        const char* begin;
-        const char* end;
-        int32_t lat = 0;
-        int32_t lon = 0;
-
-        int32_t next(const int32_t previous) noexcept(false) {
-            //grab each 5 bits and mask it in where it belongs using the shift
-            int byte, shift = 0, result = 0;
-              do {
-                if(empty()) throw std::runtime_error("Bad encoded polyline");
-                //take the least significant 5 bits shifted into place
-                byte = int32_t(*begin++) - 63;
-                result |= (byte & 0x1f) << shift;
-                shift += 5;
-                //if the most significant bit is set there is more to this number
-            } while (byte >= 0x20);
-            //handle the bit flipping and add to previous since its an offset
-            return previous + (result & 1 ? ~(result >> 1) : (result >> 1));
-        }
-    };
-
-    // specialized implemetation for std::vector with reserve
-    template<class container_t,
-             class ShapeDecoder = Shape5Decoder<typename container_t::value_type>>
-    container_t decode(const std::string& encoded) {
-        ShapeDecoder shape(encoded.c_str(), encoded.size());
-        container_t c;
-        c.reserve(encoded.size() / 4);
-        while (!shape.empty()) {
-            c.emplace_back(shape.pop());
-        }
-        return c;
-    }
-
-    template<class container_t>
-    std::string encode(const container_t& points) {
-        //a place to keep the output
-        std::string output;
-        //unless the shape is very course you should probably only need about 3 bytes
-        //per coord, which is 6 bytes with 2 coords, so we overshoot to 8 just in case
-        output.reserve(points.size() * 8);
-
-        //handy lambda to turn an integer into an encoded string
-        auto serialize = [&output](int number) {
-            //move the bits left 1 position and flip all the bits if it was a negative number
-            number = number < 0 ? ~(number << 1) : (number << 1);
-            //write 5 bit chunks of the number
-            while (number >= 0x20) {
-                int nextValue = (0x20 | (number & 0x1f)) + 63;
-                output.push_back(static_cast<char>(nextValue));
-                number >>= 5;
-            }
-            //write the last chunk
-            number += 63;
-            output.push_back(static_cast<char>(number));
-        };
-
-        //this is an offset encoding so we remember the last point we saw
-        int last_lon = 0, last_lat = 0;
-        //for each point
-        for (const auto& p : points) {
-            //shift the decimal point 5 places to the right and truncate
-            int lon = static_cast<int>(floor(static_cast<double>(p.first) * 1e6));
-            int lat = static_cast<int>(floor(static_cast<double>(p.second) * 1e6));
-            //encode each coordinate, lat first for some reason
-            serialize(lat - last_lat);
-            serialize(lon - last_lon);
-            //remember the last one we encountered
-            last_lon = lon;
-            last_lat = lat;
-        }
-        return output;
-    }
-
-} }
 #endif
 
 namespace massif {
@@ -168,7 +75,7 @@ namespace massif {
         std::map<std::string, std::string> params;
         params["json"] = SerializeRouteMatchingRequest(profile, request);
         std::string finalURL = NetworkUtils::BuildURLFromParameters(baseURL, params);
-        Log::Debugf("ValhallaRoutingProxy::MatchRoute: Loading %s", finalURL.c_str());
+        LOG_DEBUGF("ValhallaRoutingProxy::MatchRoute: Loading %s", finalURL.c_str());
 
         std::string responseString = MakeHTTPRequest(httpClient, finalURL, headers);
         return ParseRouteMatchingResult(request->getProjection(), responseString);
@@ -178,7 +85,7 @@ namespace massif {
         std::map<std::string, std::string> params;
         params["json"] = SerializeRoutingRequest(profile, request);
         std::string finalURL = NetworkUtils::BuildURLFromParameters(baseURL, params);
-        Log::Debugf("ValhallaRoutingProxy::CalculateRoute: Loading %s", finalURL.c_str());
+        LOG_DEBUGF("ValhallaRoutingProxy::CalculateRoute: Loading %s", finalURL.c_str());
 
         std::string responseString = MakeHTTPRequest(httpClient, finalURL, headers);
         return ParseRoutingResult(request->getProjection(), responseString);
@@ -194,57 +101,189 @@ namespace massif {
         }
     }
 
-    std::shared_ptr<RouteMatchingResult> ValhallaRoutingProxy::MatchRoute(const std::vector<std::shared_ptr<sqlite3pp::database> >& databases, const std::string& profile, const Variant& config, const std::shared_ptr<RouteMatchingRequest>& request) {
-        std::string resultString;
+    ValhallaRoutingProxy::RoutingContext::RoutingContext(const std::vector<std::shared_ptr<sqlite3pp::database> >& databases, const Variant& config) :
+        _databases(databases),
+        _configTree(std::make_shared<boost::property_tree::ptree>()),
+        _idleWorkers(),
+        _mutex()
+    {
         try {
             std::stringstream ss;
             ss << config.toPicoJSON().serialize();
-            boost::property_tree::ptree configTree;
-            rapidjson::read_json(ss, configTree);
-            auto reader = std::make_shared<valhalla::baldr::GraphReader>(databases);
+            rapidjson::read_json(ss, *_configTree);
+
+            // Create the first set of workers eagerly, so that configuration errors are reported here
+            _idleWorkers.push_back(createWorkers());
+        }
+        catch (const std::exception& ex) {
+            throw GenericException("Exception while initializing routing", ex.what());
+        }
+    }
+
+    ValhallaRoutingProxy::RoutingContext::~RoutingContext() {
+    }
 
+    bool ValhallaRoutingProxy::RoutingContext::isForDatabases(const std::vector<std::shared_ptr<sqlite3pp::database> >& databases) const {
+        // The package order is not stable between requests, and does not matter
+        if (databases.size() != _databases.size()) {
+            return false;
+        }
+        return std::all_of(databases.begin(), databases.end(), [this](const std::shared_ptr<sqlite3pp::database>& database) {
+            return std::find(_databases.begin(), _databases.end(), database) != _databases.end();
+        });
+    }
+
+    std::unique_ptr<ValhallaRoutingProxy::RoutingContext::Workers> ValhallaRoutingProxy::RoutingContext::createWorkers() const {
+        auto workers = std::make_unique<Workers>();
+        workers->reader = std::make_shared<valhalla::baldr::GraphReader>(_databases);
+        workers->lokiWorker = std::make_unique<valhalla::loki::loki_worker_t>(*_configTree, workers->reader);
+        workers->thorWorker = std::make_unique<valhalla::thor::thor_worker_t>(*_configTree, workers->reader);
+        workers->odinWorker = std::make_unique<valhalla::odin::odin_worker_t>(*_configTree);
+        return workers;
+    }
+
+    std::unique_ptr<ValhallaRoutingProxy::RoutingContext::Workers> ValhallaRoutingProxy::RoutingContext::acquireWorkers() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_idleWorkers.empty()) {
+                std::unique_ptr<Workers> workers = std::move(_idleWorkers.back());
+                _idleWorkers.pop_back();
+                return workers;
+            }
+        }
+
+        // Creating the workers does not touch the pool, so it is not kept locked meanwhile
+        return createWorkers();
+    }
+
+    void ValhallaRoutingProxy::RoutingContext::releaseWorkers(std::unique_ptr<Workers> workers) {
+        workers->lokiWorker->cleanup();
+        workers->thorWorker->cleanup();
+        workers->odinWorker->cleanup();
+
+        // The tiles read stay cached for the next request on these workers, up to the cache size of the reader
+        if (workers->reader->OverCommitted()) {
+            workers->reader->Trim();
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_idleWorkers.size() < MAX_IDLE_WORKERS) {
+            _idleWorkers.push_back(std::move(workers));
+        }
+    }
+
+    std::shared_ptr<RouteMatchingResult> ValhallaRoutingProxy::MatchRoute(RoutingContext& context, const std::string& profile, const std::shared_ptr<RouteMatchingRequest>& request) {
+        std::string resultString;
+        std::unique_ptr<RoutingContext::Workers> workers = context.acquireWorkers();
+        try {
             valhalla::Api api;
             valhalla::ParseApi(SerializeRouteMatchingRequest(profile, request), valhalla::Options::trace_attributes, api, valhalla_locales);
 
-            valhalla::loki::loki_worker_t lokiworker(configTree, reader);
-            lokiworker.trace(api);
-            valhalla::thor::thor_worker_t thorworker(configTree, reader);
-            resultString = thorworker.trace_attributes(api);
-            lokiworker.cleanup();
+            workers->lokiWorker->trace(api);
+            resultString = workers->thorWorker->trace_attributes(api);
+            context.releaseWorkers(std::move(workers));
         }
         catch (const std::exception& ex) {
+            context.releaseWorkers(std::move(workers));
             throw GenericException("Exception while matching route", ex.what());
         }
         return ParseRouteMatchingResult(request->getProjection(), resultString);
     }
 
-    std::shared_ptr<RoutingResult> ValhallaRoutingProxy::CalculateRoute(const std::vector<std::shared_ptr<sqlite3pp::database> >& databases, const std::string& profile, const Variant& config, const std::shared_ptr<RoutingRequest>& request) {
+    std::shared_ptr<RoutingResult> ValhallaRoutingProxy::CalculateRoute(RoutingContext& context, const std::string& profile, const std::shared_ptr<RoutingRequest>& request) {
+        Variant rawResultParam = request->getCustomParameter(RAW_RESULT_PARAMETER);
+        bool rawResult = rawResultParam.getType() == VariantType::VARIANT_TYPE_BOOL && rawResultParam.getBool();
+
+        valhalla::Api api;
         std::string resultString;
+        std::unique_ptr<RoutingContext::Workers> workers = context.acquireWorkers();
         try {
-            std::stringstream ss;
-            ss << config.toPicoJSON().serialize();
-            boost::property_tree::ptree configTree;
-            rapidjson::read_json(ss, configTree);
-            auto reader = std::make_shared<valhalla::baldr::GraphReader>(databases);
-
-            valhalla::Api api;
             valhalla::ParseApi(SerializeRoutingRequest(profile, request), valhalla::Options::route, api, valhalla_locales);
 
-            valhalla::loki::loki_worker_t lokiworker(configTree, reader);
-            lokiworker.route(api);
-            valhalla::thor::thor_worker_t thorworker(configTree, reader);
-            thorworker.route(api);
-            valhalla::odin::odin_worker_t odinworker(configTree);
-            odinworker.narrate(api);
-            resultString = valhalla::tyr::serializeDirections(api);
-            lokiworker.cleanup();
-            thorworker.cleanup();
-            odinworker.cleanup();
+            workers->lokiWorker->route(api);
+            workers->thorWorker->route(api);
+            workers->odinWorker->narrate(api);
+            context.releaseWorkers(std::move(workers));
+
+            if (rawResult) {
+                resultString = valhalla::tyr::serializeDirections(api);
+            }
         }
         catch (const std::exception& ex) {
+            if (workers) {
+                context.releaseWorkers(std::move(workers));
+            }
             throw GenericException("Exception while calculating route", ex.what());
         }
-        return ParseRoutingResult(request->getProjection(), resultString);
+        // The directions are read from the protobuf trip as they are, parsing the serialized JSON
+        // would cost more than the path search for long routes. The JSON is only built on request.
+        return BuildRoutingResult(request->getProjection(), api, resultString);
+    }
+
+    std::shared_ptr<RoutingMatrixResult> ValhallaRoutingProxy::CalculateMatrix(RoutingContext& context, const std::string& profile, const std::shared_ptr<RoutingMatrixRequest>& request) {
+        std::string resultString;
+        std::unique_ptr<RoutingContext::Workers> workers = context.acquireWorkers();
+        try {
+            valhalla::Api api;
+            valhalla::ParseApi(SerializeRoutingMatrixRequest(profile, request), valhalla::Options::sources_to_targets, api, valhalla_locales);
+
+            // Thor picks CostMatrix or TimeDistanceMatrix depending on the costing
+            workers->lokiWorker->matrix(api);
+            resultString = workers->thorWorker->matrix(api);
+            context.releaseWorkers(std::move(workers));
+        }
+        catch (const std::exception& ex) {
+            context.releaseWorkers(std::move(workers));
+            throw GenericException("Exception while calculating matrix", ex.what());
+        }
+        return ParseRoutingMatrixResult(request, resultString);
+    }
+
+    std::shared_ptr<RoutingResult> ValhallaRoutingProxy::BuildRoutingResult(const std::shared_ptr<Projection>& proj, const valhalla::Api& api, const std::string& rawResult) {
+        if (api.directions().routes_size() == 0) {
+            throw GenericException("No trip info in the result");
+        }
+
+        RoutingResultBuilder resultBuilder(proj, rawResult);
+        try {
+            std::vector<MapPos> points;
+            std::size_t shapeIndex = 0;
+            for (const valhalla::DirectionsLeg& leg : api.directions().routes(0).legs()) {
+                DecodeShape(proj, leg.shape(), points);
+                resultBuilder.addPoints(points);
+
+                const auto& maneuvers = leg.maneuver();
+                for (int i = 0; i < maneuvers.size(); i++) {
+                    const valhalla::DirectionsLeg::Maneuver& maneuver = maneuvers.Get(i);
+
+                    RoutingAction::RoutingAction action = RoutingAction::ROUTING_ACTION_NO_TURN;
+                    TranslateManeuverType(static_cast<int>(maneuver.type()), action);
+                    if (action == RoutingAction::ROUTING_ACTION_FINISH && i + 1 < maneuvers.size()) {
+                        action = RoutingAction::ROUTING_ACTION_REACH_VIA_LOCATION;
+                    }
+
+                    std::string streetName;
+                    for (const valhalla::StreetName& name : maneuver.street_name()) {
+                        streetName += (streetName.empty() ? "" : "/") + name.value();
+                    }
+
+                    int pointIndex = static_cast<int>(shapeIndex + maneuver.begin_shape_index());
+
+                    RoutingInstructionBuilder& instrBuilder = resultBuilder.addInstruction(action, pointIndex);
+                    instrBuilder.setStreetName(streetName);
+                    instrBuilder.setTime(maneuver.time());
+                    instrBuilder.setDistance(maneuver.length() * 1000.0);
+                    instrBuilder.setInstruction(maneuver.text_instruction());
+                }
+                if (maneuvers.size() > 0) {
+                    shapeIndex += maneuvers.Get(maneuvers.size() - 1).begin_shape_index();
+                }
+            }
+        }
+        catch (const std::exception& ex) {
+            throw GenericException("Exception while translating route", ex.what());
+        }
+        return resultBuilder.buildRoutingResult();
     }
 #endif
 
@@ -337,7 +376,7 @@ namespace massif {
             return true;
         }
 
-        Log::Infof("ValhallaRoutingProxy::TranslateManeuverType: ignoring maneuver %d", maneuverType);
+        LOG_INFOF("ValhallaRoutingProxy::TranslateManeuverType: ignoring maneuver %d", maneuverType);
         return false;
     }
 
@@ -399,6 +438,39 @@ namespace massif {
         json["costing"] = picojson::value(profile);
         json["units"] = picojson::value("kilometers");
 
+        picojson::value customParams = request->getCustomParameters().toPicoJSON();
+        if (customParams.is<picojson::object>()) {
+            const picojson::object& customParamsObj = customParams.get<picojson::value::object>();
+            for (auto it = customParamsObj.begin(); it != customParamsObj.end(); it++) {
+                if (it->first != RAW_RESULT_PARAMETER) {
+                    json[it->first] = it->second;
+                }
+            }
+        }
+        return picojson::value(json).serialize();
+    }
+
+    std::string ValhallaRoutingProxy::SerializeRoutingMatrixRequest(const std::string& profile, const std::shared_ptr<RoutingMatrixRequest>& request) {
+        std::shared_ptr<Projection> proj = request->getProjection();
+
+        auto serializeLocations = [&proj](const std::vector<MapPos>& points) {
+            picojson::array locations;
+            for (const MapPos& point : points) {
+                MapPos posWgs84 = proj->toWgs84(point);
+                picojson::object location;
+                location["lon"] = picojson::value(posWgs84.getX());
+                location["lat"] = picojson::value(posWgs84.getY());
+                locations.emplace_back(location);
+            }
+            return locations;
+        };
+
+        picojson::object json;
+        json["sources"] = picojson::value(serializeLocations(request->getSources()));
+        json["targets"] = picojson::value(serializeLocations(request->getTargets()));
+        json["costing"] = picojson::value(profile);
+        json["units"] = picojson::value("kilometers");
+
         picojson::value customParams = request->getCustomParameters().toPicoJSON();
         if (customParams.is<picojson::object>()) {
             const picojson::object& customParamsObj = customParams.get<picojson::value::object>();
@@ -455,6 +527,43 @@ namespace massif {
         return std::make_shared<RouteMatchingResult>(proj, std::move(matchingPoints), std::move(matchingEdges), resultString);
     }
 
+    std::shared_ptr<RoutingMatrixResult> ValhallaRoutingProxy::ParseRoutingMatrixResult(const std::shared_ptr<RoutingMatrixRequest>& request, const std::string& resultString) {
+        picojson::value result;
+        std::string err = picojson::parse(result, resultString);
+        if (!err.empty()) {
+            throw GenericException("Failed to parse result", err);
+        }
+        if (!result.get("sources_to_targets").is<picojson::array>()) {
+            throw GenericException("No matrix info in the result");
+        }
+
+        std::size_t sourceCount = request->getSources().size();
+        std::size_t targetCount = request->getTargets().size();
+        std::vector<double> times(sourceCount * targetCount, std::numeric_limits<double>::quiet_NaN());
+        std::vector<double> distances(sourceCount * targetCount, std::numeric_limits<double>::quiet_NaN());
+        try {
+            for (const picojson::value& row : result.get("sources_to_targets").get<picojson::array>()) {
+                for (const picojson::value& cell : row.get<picojson::array>()) {
+                    // Unreachable targets have null time and distance
+                    if (!cell.get("time").is<double>() || !cell.get("distance").is<double>()) {
+                        continue;
+                    }
+                    std::size_t sourceIndex = static_cast<std::size_t>(cell.get("from_index").get<std::int64_t>());
+                    std::size_t targetIndex = static_cast<std::size_t>(cell.get("to_index").get<std::int64_t>());
+                    if (sourceIndex >= sourceCount || targetIndex >= targetCount) {
+                        continue;
+                    }
+                    times[sourceIndex * targetCount + targetIndex] = cell.get("time").get<double>();
+                    distances[sourceIndex * targetCount + targetIndex] = cell.get("distance").get<double>() * 1000.0;
+                }
+            }
+        }
+        catch (const std::exception& ex) {
+            throw GenericException("Exception while translating matrix", ex.what());
+        }
+        return std::make_shared<RoutingMatrixResult>(static_cast<int>(sourceCount), static_cast<int>(targetCount), std::move(times), std::move(distances));
+    }
+
     std::shared_ptr<RoutingResult> ValhallaRoutingProxy::ParseRoutingResult(const std::shared_ptr<Projection>& proj, const std::string& resultString) {
         picojson::value result;
         std::string err = picojson::parse(result, resultString);
@@ -467,15 +576,10 @@ namespace massif {
 
         RoutingResultBuilder resultBuilder(proj, resultString);
         try {
+            std::vector<MapPos> points;
             std::size_t shapeIndex= 0;
             for (const picojson::value& legInfo : result.get("trip").get("legs").get<picojson::array>()) {
-                std::vector<valhalla::midgard::PointLL> shape = valhalla::midgard::decode<std::vector<valhalla::midgard::PointLL> >(legInfo.get("shape").get<std::string>());
-                std::vector<MapPos> points;
-                points.reserve(shape.size());
-                for (std::size_t i = 0; i < shape.size(); i++) {
-                    const valhalla::midgard::PointLL& point = shape.at(i);
-                    points.push_back(proj->fromLatLong(point.second, point.first));
-                }
+                DecodeShape(proj, legInfo.get("shape").get<std::string>(), points);
                 resultBuilder.addPoints(points);
 
                 const picojson::array& maneuvers = legInfo.get("maneuvers").get<picojson::array>();
@@ -520,6 +624,35 @@ namespace massif {
         return resultBuilder.buildRoutingResult();
     }
 
+    void ValhallaRoutingProxy::DecodeShape(const std::shared_ptr<Projection>& proj, const std::string& encoded, std::vector<MapPos>& points) {
+        // Polyline with 6 digits of precision, latitude first. Points are converted as they are decoded,
+        // without an intermediate list of coordinates.
+        points.clear();
+        points.reserve(encoded.size() / 4);
+
+        const char* it = encoded.data();
+        const char* end = it + encoded.size();
+        auto next = [&it, end]() -> std::int32_t {
+            std::int32_t byte = 0, shift = 0, result = 0;
+            do {
+                if (it == end) {
+                    throw std::runtime_error("Bad encoded polyline");
+                }
+                byte = static_cast<std::int32_t>(*it++) - 63;
+                result |= (byte & 0x1f) << shift;
+                shift += 5;
+            } while (byte >= 0x20);
+            return (result & 1 ? ~(result >> 1) : (result >> 1));
+        };
+
+        std::int32_t lat = 0, lon = 0;
+        while (it != end) {
+            lat += next();
+            lon += next();
+            points.push_back(proj->fromLatLong(lat * 1.0e-6, lon * 1.0e-6));
+        }
+    }
+
     std::string ValhallaRoutingProxy::MakeHTTPRequest(HTTPClient& httpClient, const std::string& url, std::map<std::string, std::string>& headers) {
         std::map<std::string, std::string> requestHeaders;
         requestHeaders["Connection"] = "close";
@@ -537,7 +670,7 @@ namespace massif {
             if (responseString.empty()) {
                 throw NetworkException("Failed to fetch response");
             }
-            Log::Debugf("ValhallaRoutingProxy::MakeHTTPRequest: Failed response %s", responseString.c_str());
+            LOG_DEBUGF("ValhallaRoutingProxy::MakeHTTPRequest: Failed response %s", responseString.c_str());
 
             picojson::value result;
             std::string err = picojson::parse(result, responseString);
@@ -557,6 +690,12 @@ namespace massif {
     ValhallaRoutingProxy::ValhallaRoutingProxy() {
     }
 
+    const std::string ValhallaRoutingProxy::RAW_RESULT_PARAMETER = "raw_result";
+
+#ifdef _MASSIF_VALHALLA_ROUTING_SUPPORT
+    const std::size_t ValhallaRoutingProxy::RoutingContext::MAX_IDLE_WORKERS = 4;
+#endif
+
 }
 
 #endif
@@ -13,17 +13,44 @@
 #include "routing/RoutingInstruction.h"
 
 #include <memory>
+#include <mutex>
 #include <vector>
 
+#ifdef _MASSIF_VALHALLA_ROUTING_SUPPORT
+#include <boost/property_tree/ptree_fwd.hpp>
+#endif
+
 namespace sqlite3pp {
     class database;
 }
 
+#ifdef _MASSIF_VALHALLA_ROUTING_SUPPORT
+namespace valhalla {
+    class Api;
+
+    namespace baldr {
+        class GraphReader;
+    }
+    namespace loki {
+        class loki_worker_t;
+    }
+    namespace thor {
+        class thor_worker_t;
+    }
+    namespace odin {
+        class odin_worker_t;
+    }
+}
+#endif
+
 namespace massif {
     class HTTPClient;
+    class MapPos;
     class Projection;
     class RoutingRequest;
     class RoutingResult;
+    class RoutingMatrixRequest;
+    class RoutingMatrixResult;
     class RouteMatchingRequest;
     class RouteMatchingResult;
     class TileDataSource;
@@ -35,8 +62,41 @@ namespace massif {
         static std::shared_ptr<RoutingResult> CalculateRoute(HTTPClient& httpClient, const std::string& baseURL, const std::string& profile, const std::shared_ptr<RoutingRequest>& request, std::map<std::string, std::string>& headers);
 
 #ifdef _MASSIF_VALHALLA_ROUTING_SUPPORT
-        static std::shared_ptr<RouteMatchingResult> MatchRoute(const std::vector<std::shared_ptr<sqlite3pp::database> >& databases, const std::string& profile, const Variant& config, const std::shared_ptr<RouteMatchingRequest>& request);
-        static std::shared_ptr<RoutingResult> CalculateRoute(const std::vector<std::shared_ptr<sqlite3pp::database> >& databases, const std::string& profile, const Variant& config, const std::shared_ptr<RoutingRequest>& request);
+        // The parsed configuration and workers for one set of packages, kept between requests so that
+        // the graph tiles already read stay cached. Concurrent requests each take a set of workers from
+        // a pool. The tile cache of a graph reader is not synchronized, so every set has its own reader.
+        class RoutingContext {
+        public:
+            RoutingContext(const std::vector<std::shared_ptr<sqlite3pp::database> >& databases, const Variant& config);
+            ~RoutingContext();
+
+            bool isForDatabases(const std::vector<std::shared_ptr<sqlite3pp::database> >& databases) const;
+
+        private:
+            friend class ValhallaRoutingProxy;
+
+            struct Workers {
+                std::shared_ptr<valhalla::baldr::GraphReader> reader;
+                std::unique_ptr<valhalla::loki::loki_worker_t> lokiWorker;
+                std::unique_ptr<valhalla::thor::thor_worker_t> thorWorker;
+                std::unique_ptr<valhalla::odin::odin_worker_t> odinWorker;
+            };
+
+            std::unique_ptr<Workers> createWorkers() const;
+            std::unique_ptr<Workers> acquireWorkers();
+            void releaseWorkers(std::unique_ptr<Workers> workers);
+
+            static const std::size_t MAX_IDLE_WORKERS;
+
+            const std::vector<std::shared_ptr<sqlite3pp::database> > _databases;
+            std::shared_ptr<boost::property_tree::ptree> _configTree;
+            std::vector<std::unique_ptr<Workers> > _idleWorkers;
+            std::mutex _mutex; // guards the worker pool
+        };
+
+        static std::shared_ptr<RouteMatchingResult> MatchRoute(RoutingContext& context, const std::string& profile, const std::shared_ptr<RouteMatchingRequest>& request);
+        static std::shared_ptr<RoutingResult> CalculateRoute(RoutingContext& context, const std::string& profile, const std::shared_ptr<RoutingRequest>& request);
+        static std::shared_ptr<RoutingMatrixResult> CalculateMatrix(RoutingContext& context, const std::string& profile, const std::shared_ptr<RoutingMatrixRequest>& request);
         static void AddLocale(const std::string& key, const std::string& json);
 #endif
 
@@ -51,11 +111,23 @@ namespace massif {
 
         static std::string SerializeRoutingRequest(const std::string& profile, const std::shared_ptr<RoutingRequest>& request);
 
+        static std::string SerializeRoutingMatrixRequest(const std::string& profile, const std::shared_ptr<RoutingMatrixRequest>& request);
+
         static std::shared_ptr<RouteMatchingResult> ParseRouteMatchingResult(const std::shared_ptr<Projection>& proj, const std::string& resultString);
 
         static std::shared_ptr<RoutingResult> ParseRoutingResult(const std::shared_ptr<Projection>& proj, const std::string& resultString);
 
+        static std::shared_ptr<RoutingMatrixResult> ParseRoutingMatrixResult(const std::shared_ptr<RoutingMatrixRequest>& request, const std::string& resultString);
+
+#ifdef _MASSIF_VALHALLA_ROUTING_SUPPORT
+        static std::shared_ptr<RoutingResult> BuildRoutingResult(const std::shared_ptr<Projection>& proj, const valhalla::Api& api, const std::string& rawResult);
+#endif
+
+        static void DecodeShape(const std::shared_ptr<Projection>& proj, const std::string& encoded, std::vector<MapPos>& points);
+
         static std::string MakeHTTPRequest(HTTPClient& httpClient, const std::string& url, std::map<std::string, std::string>& headers);
+
+        static const std::string RAW_RESULT_PARAMETER;
   };
 
 }
@@ -1,12 +1,15 @@
 #ifdef _MASSIF_SEARCH_SUPPORT
 
 #include "VectorTileSearchService.h"
+#include "components/CancelableTask.h"
+#include "components/CancelableThreadPool.h"
 #include "components/Exceptions.h"
 #include "datasources/TileDataSource.h"
 #include "geometry/Geometry.h"
 #include "geometry/VectorTileFeature.h"
 #include "geometry/VectorTileFeatureCollection.h"
 #include "search/utils/SearchProxy.h"
+#include "vectortiles/NativeVectorTile.h"
 #include "vectortiles/VectorTileDecoder.h"
 #include "projections/Projection.h"
 #include "utils/TileUtils.h"
@@ -14,15 +17,103 @@
 
 #include <vt/TileId.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+    // Hands the layer, expression and regex filters of the request to the decoder, to be tested before the geometries are decoded
+    class SearchFeatureFilter : public massif::VectorTileDecoder::FeatureFilter {
+    public:
+        explicit SearchFeatureFilter(const massif::SearchProxy& proxy) : _proxy(proxy) { }
+
+        virtual bool testLayer(const std::string& layerName) const {
+            return _proxy.testAttributes(&layerName, nullptr, nullptr);
+        }
+
+        virtual bool testFeature(const std::string& layerName, const massif::VectorTileDecoder::FeatureAttributes& attributes) const {
+            return _proxy.testAttributes(&layerName, [&attributes](const std::string& name, massif::Variant& value) {
+                return attributes.getAttribute(name, value);
+            }, [&attributes]() {
+                return attributes.getAttributes();
+            });
+        }
+
+    private:
+        const massif::SearchProxy& _proxy;
+    };
+
+    // Runs a search worker on the pool. The searching thread cancels the task once it is done itself:
+    // a task that has not started yet then never runs, and a running task is waited for.
+    class SearchTask : public massif::CancelableTask {
+    public:
+        explicit SearchTask(std::function<void()> searchFn) : _searchFn(std::move(searchFn)), _running(false), _mutex(), _condition() { }
+
+        virtual void cancel() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            massif::CancelableTask::cancel();
+            _condition.wait(lock, [this]() { return !_running; });
+        }
+
+        virtual void run() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (isCanceled()) {
+                    return;
+                }
+                _running = true;
+            }
+            _searchFn();
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _running = false;
+            }
+            _condition.notify_all();
+        }
+
+    private:
+        std::function<void()> _searchFn;
+        bool _running;
+        std::mutex _mutex;
+        std::condition_variable _condition;
+    };
+
+    // Features are duplicates if they share the layer and name and their geometries touch - the same feature
+    // clipped to neighbouring tiles, or read from several zoom levels. Only features with equal keys are compared.
+    class DuplicateIndex {
+    public:
+        bool insert(const std::shared_ptr<massif::VectorTileFeature>& feature) {
+            std::string key = feature->getLayerName() + '\n' + feature->getProperties().getObjectElement("name").toString();
+            std::vector<std::shared_ptr<massif::Geometry> >& geometries = _geometries[key];
+            for (const std::shared_ptr<massif::Geometry>& geometry : geometries) {
+                if (massif::SearchProxy::calculateDistance(geometry, feature->getGeometry()) <= 0.001) {
+                    return false;
+                }
+            }
+            geometries.push_back(feature->getGeometry());
+            return true;
+        }
+
+    private:
+        std::unordered_map<std::string, std::vector<std::shared_ptr<massif::Geometry> > > _geometries;
+    };
+
+}
+
 namespace massif {
 
     VectorTileSearchService::VectorTileSearchService(const std::shared_ptr<TileDataSource>& dataSource, const std::shared_ptr<VectorTileDecoder>& tileDecoder) :
         _dataSource(dataSource),
         _tileDecoder(tileDecoder),
+        _searchThreadPool(std::make_shared<CancelableThreadPool>()),
         _minZoom(0),
         _maxZoom(0),
         _maxResults(1000),
         _sortByDistance(false),
+        _preventDuplicates(false),
         _layers({}),
         _mutex()
     {
@@ -35,9 +126,12 @@ namespace massif {
 
         _minZoom = _dataSource->getMinZoom();
         _maxZoom = _dataSource->getMaxZoom();
+
+        _searchThreadPool->setPoolSize(std::min(static_cast<int>(std::max(1u, std::thread::hardware_concurrency())), MAX_SEARCH_THREADS) - 1);
     }
 
     VectorTileSearchService::~VectorTileSearchService() {
+        _searchThreadPool->deinit();
     }
 
     const std::shared_ptr<TileDataSource>& VectorTileSearchService::getDataSource() const {
@@ -79,6 +173,7 @@ namespace massif {
     }
 
     bool VectorTileSearchService::getSortByDistance() const {
+        std::lock_guard<std::mutex> lock(_mutex);
         return _sortByDistance;
     }
 
@@ -88,6 +183,7 @@ namespace massif {
     }
 
     bool VectorTileSearchService::getPreventDuplicates() const {
+        std::lock_guard<std::mutex> lock(_mutex);
         return _preventDuplicates;
     }
 
@@ -118,71 +214,137 @@ namespace massif {
         int minZoom = _dataSource->getMinZoom();
         int maxZoom = _dataSource->getMaxZoom();
         int maxResults = 0;
+        bool sortByDistance = false;
+        bool preventDuplicates = false;
+        std::vector<std::string> layers;
         {
             std::lock_guard<std::mutex> lock(_mutex);
             minZoom = std::max(minZoom, _minZoom);
             maxZoom = std::min(maxZoom, _maxZoom);
             maxResults = _maxResults;
+            sortByDistance = _sortByDistance;
+            preventDuplicates = _preventDuplicates;
+            layers = _layers;
         }
 
-        std::vector<std::shared_ptr<VectorTileFeature> > features;
+        // Tiles in the order a sequential search would visit them: results are merged in this order,
+        // so they do not depend on which worker finished first
+        std::vector<MapTile> mapTiles;
+        for (int zoom = minZoom; zoom <= maxZoom; zoom++) {
+            MapTile mapTile1 = TileUtils::CalculateClippedMapTile(searchBounds.getMin(), zoom, _dataSource->getProjection());
+            MapTile mapTile2 = TileUtils::CalculateClippedMapTile(searchBounds.getMax(), zoom, _dataSource->getProjection());
+            for (int y = std::min(mapTile1.getY(), mapTile2.getY()); y <= std::max(mapTile1.getY(), mapTile2.getY()); y++) {
+                for (int x = std::min(mapTile1.getX(), mapTile2.getX()); x <= std::max(mapTile1.getX(), mapTile2.getX()); x++) {
+                    mapTiles.emplace_back(x, y, zoom, 0);
+                }
+            }
+        }
 
-        auto testTile = [&](const MapTile& mapTile, const MapBounds& tileBounds) {
-            if (std::shared_ptr<TileData> tileData = _dataSource->loadTile(mapTile.getFlipped())) {
-                if (std::shared_ptr<VectorTileFeatureCollection> featureCollection = _tileDecoder->decodeFeatures(vt::TileId(mapTile.getZoom(), mapTile.getX(), mapTile.getY()), tileData->getData(), tileBounds, _layers)) {
-                    for (int i = 0; i < featureCollection->getFeatureCount(); i++) {
-                        if (static_cast<int>(features.size()) >= maxResults) {
-                            break;
-                        }
+        auto filter = std::make_shared<SearchFeatureFilter>(proxy);
+        std::vector<std::vector<std::shared_ptr<VectorTileFeature> > > tileFeatures(mapTiles.size());
+        std::atomic<std::size_t> nextTileIndex(0);
+        std::atomic<int> matchCount(0);
+
+        // Workers claim whole tiles until enough matches are found. A claimed tile is always finished,
+        // so the claimed tiles are a prefix of the visiting order and the result is that of a sequential search.
+        auto searchTiles = [&]() {
+            while (matchCount.load() < maxResults) {
+                std::size_t tileIndex = nextTileIndex.fetch_add(1);
+                if (tileIndex >= mapTiles.size()) {
+                    break;
+                }
 
+                try {
+                    const MapTile& mapTile = mapTiles[tileIndex];
+                    MapBounds tileBounds = TileUtils::CalculateMapTileBounds(mapTile, _dataSource->getProjection());
+                    if (!proxy.testBounds(tileBounds)) {
+                        continue;
+                    }
+
+                    std::shared_ptr<TileData> tileData = _dataSource->loadTile(mapTile.getFlipped());
+                    if (!tileData) {
+                        continue;
+                    }
+                    vt::TileId vtTile(mapTile.getZoom(), mapTile.getX(), mapTile.getY());
+                    std::shared_ptr<const NativeVectorTile> nativeTile = tileData->getNativeTile();
+                    std::shared_ptr<VectorTileFeatureCollection> featureCollection = nativeTile ? _tileDecoder->decodeFeatures(vtTile, nativeTile, tileBounds, layers, filter) : _tileDecoder->decodeFeatures(vtTile, tileData->getData(), tileBounds, layers, filter);
+                    if (!featureCollection) {
+                        continue;
+                    }
+
+                    std::vector<std::shared_ptr<VectorTileFeature> >& features = tileFeatures[tileIndex];
+                    for (int i = 0; i < featureCollection->getFeatureCount(); i++) {
                         const std::shared_ptr<VectorTileFeature>& feature = featureCollection->getFeature(i);
 
                         double distance = proxy.testElement(feature->getGeometry(), &feature->getLayerName(), feature->getProperties());
                         if (distance >= 0) {
-                            if (_preventDuplicates) {
-                                auto it = std::find_if(features.begin(), features.end(), [&](const std::shared_ptr<VectorTileFeature> sFeature)
-                                {
-                                    return sFeature->getLayerName() == feature->getLayerName() && sFeature->getProperties().getObjectElement("name") == feature->getProperties().getObjectElement("name") && SearchProxy::calculateDistance(sFeature->getGeometry(), feature->getGeometry()) <= 0.001;
-                                });
-                                if (it != features.end()) {
-                                    continue;
-                                }
-                            }
                             if (distance > 0) {
                                 feature->setDistance(distance);
                             }
                             features.push_back(feature);
                         }
                     }
+                    matchCount.fetch_add(static_cast<int>(features.size()));
+                }
+                catch (const std::exception& ex) {
+                    Log::Errorf("VectorTileSearchService::findFeatures: Exception while searching tile: %s", ex.what());
                 }
             }
         };
 
-        for (int zoom = minZoom; zoom <= maxZoom; zoom++) {
-            MapTile mapTile1 = TileUtils::CalculateClippedMapTile(searchBounds.getMin(), zoom, _dataSource->getProjection());
-            MapTile mapTile2 = TileUtils::CalculateClippedMapTile(searchBounds.getMax(), zoom, _dataSource->getProjection());
-            for (int y = std::min(mapTile1.getY(), mapTile2.getY()); y <= std::max(mapTile1.getY(), mapTile2.getY()); y++) {
-                for (int x = std::min(mapTile1.getX(), mapTile2.getX()); x <= std::max(mapTile1.getX(), mapTile2.getX()); x++) {
+        std::vector<std::shared_ptr<VectorTileFeature> > features;
+        DuplicateIndex duplicateIndex;
+        std::size_t mergedTileCount = 0;
+        while (static_cast<int>(features.size()) < maxResults && nextTileIndex.load() < mapTiles.size()) {
+            // The pool threads help while they are free, this thread searches in any case
+            std::size_t helperCount = std::min(static_cast<std::size_t>(_searchThreadPool->getPoolSize()), mapTiles.size() - nextTileIndex.load() - 1);
+            std::vector<std::shared_ptr<SearchTask> > tasks;
+            auto cancelTasks = [&tasks]() {
+                for (const std::shared_ptr<SearchTask>& task : tasks) {
+                    task->cancel();
+                }
+            };
+            try {
+                for (std::size_t i = 0; i < helperCount; i++) {
+                    tasks.push_back(std::make_shared<SearchTask>(searchTiles));
+                    _searchThreadPool->execute(tasks.back());
+                }
+            }
+            catch (...) {
+                cancelTasks(); // the started tasks use this frame
+                throw;
+            }
+            searchTiles();
+            cancelTasks();
+
+            std::size_t claimedTileCount = std::min(nextTileIndex.load(), mapTiles.size());
+            for (; mergedTileCount < claimedTileCount; mergedTileCount++) {
+                for (const std::shared_ptr<VectorTileFeature>& feature : tileFeatures[mergedTileCount]) {
                     if (static_cast<int>(features.size()) >= maxResults) {
                         break;
                     }
-
-                    MapTile mapTile(x, y, zoom, 0);
-                    MapBounds tileBounds = TileUtils::CalculateMapTileBounds(mapTile, _dataSource->getProjection());
-                    if (proxy.testBounds(tileBounds)) {
-                        testTile(mapTile, tileBounds);
+                    if (preventDuplicates && !duplicateIndex.insert(feature)) {
+                        continue;
                     }
+                    features.push_back(feature);
                 }
+                tileFeatures[mergedTileCount].clear();
             }
+
+            // Duplicates were counted as matches: if they were dropped, search on from where the workers stopped
+            matchCount.store(static_cast<int>(features.size()));
         }
-        if (_sortByDistance) {
-            std::sort(features.begin(), features.end(), [](const std::shared_ptr<VectorTileFeature> feature1, const std::shared_ptr<VectorTileFeature> feature2) {
+
+        if (sortByDistance) {
+            std::stable_sort(features.begin(), features.end(), [](const std::shared_ptr<VectorTileFeature>& feature1, const std::shared_ptr<VectorTileFeature>& feature2) {
                 return feature1->getDistance() < feature2->getDistance();
             });
         }
         return std::make_shared<VectorTileFeatureCollection>(features);
     }
 
+    const int VectorTileSearchService::MAX_SEARCH_THREADS = 4;
+
 }
 
 #endif
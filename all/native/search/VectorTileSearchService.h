@@ -16,6 +16,7 @@
 #include <vector>
 
 namespace massif {
+    class CancelableThreadPool;
     class Projection;
     class TileDataSource;
     class VectorTileDecoder;
@@ -24,6 +25,7 @@ namespace massif {
     /**
      * A search service for finding features from the specified vector tile data source.
      * Depending on the datasource, searching may perform network requests and must be executed in non-UI background thread.
+     * Tiles are searched in parallel, the order of the results does not depend on it.
      */
     class VectorTileSearchService {
     public:
@@ -126,8 +128,11 @@ namespace massif {
         virtual std::shared_ptr<VectorTileFeatureCollection> findFeatures(const std::shared_ptr<SearchRequest>& request) const;
 
     protected:
+        static const int MAX_SEARCH_THREADS;
+
         const std::shared_ptr<TileDataSource> _dataSource;
         const std::shared_ptr<VectorTileDecoder> _tileDecoder;
+        const std::shared_ptr<CancelableThreadPool> _searchThreadPool; // helpers of the searching thread
 
         int _minZoom;
         int _maxZoom;
@@ -0,0 +1,276 @@
+#include "CompiledQueryExpression.h"
+#include "search/query/QueryContext.h"
+#include "search/query/QueryExpressionImpl.h"
+
+#include <array>
+#include <algorithm>
+
+#include <stdext/unistring.h>
+
+namespace massif {
+
+    // Variable values of one evaluation. Small expressions - all practical ones - keep them on the stack.
+    class CompiledQueryExpression::VariableCache {
+    public:
+        VariableCache(const QueryContext& context, std::size_t variableCount) :
+            _context(context),
+            _inlineValues(),
+            _inlineLoaded(),
+            _values(),
+            _loaded()
+        {
+            if (variableCount > _inlineValues.size()) {
+                _values.resize(variableCount);
+                _loaded.resize(variableCount, false);
+            }
+        }
+
+        const Variant& getValue(int index, const Variable& variable) {
+            bool inlined = _values.empty();
+            Variant& value = inlined ? _inlineValues[index] : _values[index];
+            if (inlined ? !_inlineLoaded[index] : !_loaded[index]) {
+                if (!_context.getVariable(variable.name, value)) {
+                    value = Variant();
+                } else if (variable.nocase && value.getType() == VariantType::VARIANT_TYPE_STRING) {
+                    value = Variant(queryexpressionimpl::VariableOperand::CollateNoCase(value.getString()));
+                }
+                if (inlined) {
+                    _inlineLoaded[index] = true;
+                } else {
+                    _loaded[index] = true;
+                }
+            }
+            return value;
+        }
+
+    private:
+        const QueryContext& _context;
+        std::array<Variant, 16> _inlineValues;
+        std::array<bool, 16> _inlineLoaded;
+        std::vector<Variant> _values;
+        std::vector<bool> _loaded;
+    };
+
+    CompiledQueryExpression::Builder::Builder() :
+        _expr(new CompiledQueryExpression())
+    {
+    }
+
+    int CompiledQueryExpression::Builder::constantOperand(const Variant& value) {
+        _expr->_constants.push_back(value);
+        _expr->_operands.push_back(Operand { false, static_cast<int>(_expr->_constants.size()) - 1 });
+        return static_cast<int>(_expr->_operands.size()) - 1;
+    }
+
+    int CompiledQueryExpression::Builder::variableOperand(const std::string& name, bool nocase) {
+        auto it = std::find_if(_expr->_variables.begin(), _expr->_variables.end(), [&](const Variable& variable) {
+            return variable.name == name && variable.nocase == nocase;
+        });
+        if (it == _expr->_variables.end()) {
+            it = _expr->_variables.insert(it, Variable { name, nocase });
+        }
+        _expr->_operands.push_back(Operand { true, static_cast<int>(it - _expr->_variables.begin()) });
+        return static_cast<int>(_expr->_operands.size()) - 1;
+    }
+
+    int CompiledQueryExpression::Builder::predicateNode(Predicate predicate, int operand1, int operand2) {
+        const Operand& op1 = _expr->_operands.at(operand1);
+        const Operand* op2 = operand2 >= 0 ? &_expr->_operands.at(operand2) : nullptr;
+        const Variant* value1 = op1.variable ? nullptr : &_expr->_constants[op1.index];
+        const Variant* value2 = op2 && !op2->variable ? &_expr->_constants[op2->index] : nullptr;
+
+        if (predicate == Predicate::IS_NULL || predicate == Predicate::IS_NOT_NULL) {
+            if (value1) {
+                return constantNode(EvaluatePredicate(predicate, *value1, Variant()));
+            }
+        } else {
+            if (value1 && value2) {
+                return constantNode(EvaluatePredicate(predicate, *value1, *value2));
+            }
+            // Every binary predicate is false when either side is null
+            if ((value1 && value1->getType() == VariantType::VARIANT_TYPE_NULL) || (value2 && value2->getType() == VariantType::VARIANT_TYPE_NULL)) {
+                return constantNode(false);
+            }
+        }
+
+        int regex = -1;
+        if ((predicate == Predicate::REGEXP_LIKE || predicate == Predicate::REGEXP_ILIKE) && value2) {
+            switch (value2->getType()) {
+            case VariantType::VARIANT_TYPE_ARRAY:
+            case VariantType::VARIANT_TYPE_OBJECT:
+                return constantNode(false);
+            default:
+                break;
+            }
+            unistring::unistring unire = unistring::to_unistring(value2->getString());
+            if (predicate == Predicate::REGEXP_ILIKE) {
+                unire = unistring::to_normalized(unistring::to_upper(unire));
+            }
+            _expr->_regexes.emplace_back(unistring::to_wstring(unire));
+            regex = static_cast<int>(_expr->_regexes.size()) - 1;
+        }
+
+        _expr->_nodes.push_back(Node { NodeType::PREDICATE, predicate, false, operand1, operand2, regex });
+        return static_cast<int>(_expr->_nodes.size()) - 1;
+    }
+
+    int CompiledQueryExpression::Builder::notNode(int node) {
+        bool value = false;
+        if (isConstantNode(node, value)) {
+            return constantNode(!value);
+        }
+        _expr->_nodes.push_back(Node { NodeType::NOT, Predicate::IS_NULL, false, node, -1, -1 });
+        return static_cast<int>(_expr->_nodes.size()) - 1;
+    }
+
+    int CompiledQueryExpression::Builder::andNode(int node1, int node2) {
+        bool value = false;
+        if (isConstantNode(node1, value)) {
+            return value ? node2 : node1;
+        }
+        if (isConstantNode(node2, value)) {
+            return value ? node1 : node2;
+        }
+        _expr->_nodes.push_back(Node { NodeType::AND, Predicate::IS_NULL, false, node1, node2, -1 });
+        return static_cast<int>(_expr->_nodes.size()) - 1;
+    }
+
+    int CompiledQueryExpression::Builder::orNode(int node1, int node2) {
+        bool value = false;
+        if (isConstantNode(node1, value)) {
+            return value ? node1 : node2;
+        }
+        if (isConstantNode(node2, value)) {
+            return value ? node2 : node1;
+        }
+        _expr->_nodes.push_back(Node { NodeType::OR, Predicate::IS_NULL, false, node1, node2, -1 });
+        return static_cast<int>(_expr->_nodes.size()) - 1;
+    }
+
+    std::shared_ptr<CompiledQueryExpression> CompiledQueryExpression::Builder::build(int rootNode) {
+        _expr->_rootNode = rootNode;
+        std::shared_ptr<CompiledQueryExpression> expr = _expr;
+        _expr = std::shared_ptr<CompiledQueryExpression>(new CompiledQueryExpression());
+        return expr;
+    }
+
+    int CompiledQueryExpression::Builder::constantNode(bool value) {
+        _expr->_nodes.push_back(Node { NodeType::CONSTANT, Predicate::IS_NULL, value, -1, -1, -1 });
+        return static_cast<int>(_expr->_nodes.size()) - 1;
+    }
+
+    bool CompiledQueryExpression::Builder::isConstantNode(int node, bool& value) const {
+        const Node& n = _expr->_nodes.at(node);
+        if (n.type != NodeType::CONSTANT) {
+            return false;
+        }
+        value = n.value;
+        return true;
+    }
+
+    CompiledQueryExpression::~CompiledQueryExpression() {
+    }
+
+    std::vector<std::string> CompiledQueryExpression::getVariableNames() const {
+        std::vector<std::string> names;
+        for (const Variable& variable : _variables) {
+            if (std::find(names.begin(), names.end(), variable.name) == names.end()) {
+                names.push_back(variable.name);
+            }
+        }
+        return names;
+    }
+
+    bool CompiledQueryExpression::evaluate(const QueryContext& context) const {
+        VariableCache cache(context, _variables.size());
+        return evaluateNode(_rootNode, cache);
+    }
+
+    CompiledQueryExpression::CompiledQueryExpression() :
+        _nodes(),
+        _operands(),
+        _constants(),
+        _variables(),
+        _regexes(),
+        _rootNode(-1)
+    {
+    }
+
+    bool CompiledQueryExpression::evaluateNode(int index, VariableCache& cache) const {
+        const Node& node = _nodes[index];
+        switch (node.type) {
+        case NodeType::CONSTANT:
+            return node.value;
+        case NodeType::NOT:
+            return !evaluateNode(node.arg1, cache);
+        case NodeType::AND:
+            return evaluateNode(node.arg1, cache) && evaluateNode(node.arg2, cache);
+        case NodeType::OR:
+            return evaluateNode(node.arg1, cache) || evaluateNode(node.arg2, cache);
+        case NodeType::PREDICATE:
+            break;
+        }
+
+        const Variant& value1 = getOperandValue(node.arg1, cache);
+        if (node.regex >= 0) {
+            return MatchRegex(node.predicate == Predicate::REGEXP_ILIKE, value1, _regexes[node.regex]);
+        }
+        if (node.arg2 < 0) {
+            return EvaluatePredicate(node.predicate, value1, Variant());
+        }
+        return EvaluatePredicate(node.predicate, value1, getOperandValue(node.arg2, cache));
+    }
+
+    const Variant& CompiledQueryExpression::getOperandValue(int operand, VariableCache& cache) const {
+        const Operand& op = _operands[operand];
+        if (!op.variable) {
+            return _constants[op.index];
+        }
+        return cache.getValue(op.index, _variables[op.index]);
+    }
+
+    bool CompiledQueryExpression::EvaluatePredicate(Predicate predicate, const Variant& value1, const Variant& value2) {
+        using namespace queryexpressionimpl;
+
+        switch (predicate) {
+        case Predicate::IS_NULL:
+            return IsNullPredicate()(value1);
+        case Predicate::IS_NOT_NULL:
+            return IsNotNullPredicate()(value1);
+        case Predicate::EQ:
+            return EqPredicate()(value1, value2);
+        case Predicate::NEQ:
+            return NeqPredicate()(value1, value2);
+        case Predicate::LT:
+            return LtPredicate()(value1, value2);
+        case Predicate::LTE:
+            return LtePredicate()(value1, value2);
+        case Predicate::GT:
+            return GtPredicate()(value1, value2);
+        case Predicate::GTE:
+            return GtePredicate()(value1, value2);
+        case Predicate::REGEXP_LIKE:
+            return RegexpLikePredicate<false>()(value1, value2);
+        case Predicate::REGEXP_ILIKE:
+            return RegexpLikePredicate<true>()(value1, value2);
+        }
+        return false;
+    }
+
+    bool CompiledQueryExpression::MatchRegex(bool caseInsensitive, const Variant& value, const std::wregex& re) {
+        switch (value.getType()) {
+        case VariantType::VARIANT_TYPE_NULL:
+        case VariantType::VARIANT_TYPE_ARRAY:
+        case VariantType::VARIANT_TYPE_OBJECT:
+            return false;
+        default:
+            break;
+        }
+        unistring::unistring unistr = unistring::to_unistring(value.getString());
+        if (caseInsensitive) {
+            unistr = unistring::to_normalized(unistring::to_upper(unistr));
+        }
+        return std::regex_match(unistring::to_wstring(unistr), re);
+    }
+
+}
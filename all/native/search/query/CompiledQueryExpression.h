@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _MASSIF_COMPILEDQUERYEXPRESSION_H_
+#define _MASSIF_COMPILEDQUERYEXPRESSION_H_
+
+#include "core/Variant.h"
+#include "search/query/QueryExpression.h"
+
+#include <memory>
+#include <optional>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace massif {
+    class QueryContext;
+
+    /**
+     * Query filter expression compiled into a flat table of nodes.
+     * Constant subexpressions are folded, variables are numbered and read from the context
+     * at most once per evaluation, and regular expressions with constant patterns are compiled once.
+     */
+    class CompiledQueryExpression : public QueryExpression {
+    public:
+        enum class Predicate {
+            IS_NULL,
+            IS_NOT_NULL,
+            EQ,
+            NEQ,
+            LT,
+            LTE,
+            GT,
+            GTE,
+            REGEXP_LIKE,
+            REGEXP_ILIKE
+        };
+
+        /**
+         * Collects the nodes of an expression, children before their parents.
+         * Node and operand ids returned by the builder are only meaningful for the same builder.
+         */
+        class Builder {
+        public:
+            Builder();
+
+            int constantOperand(const Variant& value);
+            int variableOperand(const std::string& name, bool nocase);
+
+            int predicateNode(Predicate predicate, int operand1, int operand2);
+            int notNode(int node);
+            int andNode(int node1, int node2);
+            int orNode(int node1, int node2);
+
+            std::shared_ptr<CompiledQueryExpression> build(int rootNode);
+
+        private:
+            int constantNode(bool value);
+            bool isConstantNode(int node, bool& value) const;
+
+            std::shared_ptr<CompiledQueryExpression> _expr;
+        };
+
+        virtual ~CompiledQueryExpression();
+
+        /**
+         * Returns the names of the context variables the expression reads.
+         * @return The variable names, in the order they were first referenced.
+         */
+        std::vector<std::string> getVariableNames() const;
+
+        virtual bool evaluate(const QueryContext& context) const;
+
+    private:
+        enum class NodeType {
+            CONSTANT,
+            PREDICATE,
+            NOT,
+            AND,
+            OR
+        };
+
+        struct Operand {
+            bool variable;
+            int index; // into _constants or _variables
+        };
+
+        struct Node {
+            NodeType type;
+            Predicate predicate;
+            bool value;
+            int arg1; // child nodes, or operands for predicates
+            int arg2;
+            int regex; // precompiled pattern of a regexp predicate, or -1
+        };
+
+        struct Variable {
+            std::string name;
+            bool nocase;
+        };
+
+        class VariableCache;
+
+        CompiledQueryExpression();
+
+        bool evaluateNode(int index, VariableCache& cache) const;
+        const Variant& getOperandValue(int operand, VariableCache& cache) const;
+
+        static bool EvaluatePredicate(Predicate predicate, const Variant& value1, const Variant& value2);
+        static bool MatchRegex(bool caseInsensitive, const Variant& value, const std::wregex& re);
+
+        std::vector<Node> _nodes;
+        std::vector<Operand> _operands;
+        std::vector<Variant> _constants;
+        std::vector<Variable> _variables;
+        std::vector<std::wregex> _regexes;
+        int _rootNode;
+    };
+
+}
+
+#endif
@@ -7,6 +7,7 @@
 #ifndef _MASSIF_QUERYEXPRESSIONIMPL_H_
 #define _MASSIF_QUERYEXPRESSIONIMPL_H_
 
+#include "search/query/CompiledQueryExpression.h"
 #include "search/query/QueryContext.h"
 #include "search/query/QueryExpression.h"
 
@@ -21,20 +22,30 @@ namespace massif {
     namespace queryexpressionimpl {
         using Value = Variant;
 
-        using Expression = QueryExpression;
-
         using Context = QueryContext;
 
+        using Compiler = CompiledQueryExpression::Builder;
+
+        using PredicateType = CompiledQueryExpression::Predicate;
+
+        // The parsed expression tree. It can be evaluated as such, but is normally only compiled.
+        struct Expression : public QueryExpression {
+            virtual int compile(Compiler& compiler) const = 0;
+        };
+
         struct IsNullPredicate {
+            static constexpr PredicateType TYPE = PredicateType::IS_NULL;
             bool operator() (const Value& val) const { return val.getType() == VariantType::VARIANT_TYPE_NULL; }
         };
 
         struct IsNotNullPredicate {
+            static constexpr PredicateType TYPE = PredicateType::IS_NOT_NULL;
             bool operator() (const Value& val) const { return val.getType() != VariantType::VARIANT_TYPE_NULL; }
         };
 
         template <bool CaseInsensitive>
         struct RegexpLikePredicate {
+            static constexpr PredicateType TYPE = CaseInsensitive ? PredicateType::REGEXP_ILIKE : PredicateType::REGEXP_LIKE;
             bool operator() (const Value& val1, const Value& val2) const {
                 switch (val1.getType()) {
                 case VariantType::VARIANT_TYPE_NULL:
@@ -69,6 +80,7 @@ namespace massif {
         };
 
         struct EqPredicate {
+            static constexpr PredicateType TYPE = PredicateType::EQ;
             bool operator() (const Value& val1, const Value& val2) const {
                 if (val1.getType() == VariantType::VARIANT_TYPE_NULL || val2.getType() == VariantType::VARIANT_TYPE_NULL) {
                     return false;
@@ -78,6 +90,7 @@ namespace massif {
         };
 
         struct NeqPredicate {
+            static constexpr PredicateType TYPE = PredicateType::NEQ;
             bool operator() (const Value& val1, const Value& val2) const {
                 if (val1.getType() == VariantType::VARIANT_TYPE_NULL || val2.getType() == VariantType::VARIANT_TYPE_NULL) {
                     return false;
@@ -86,8 +99,9 @@ namespace massif {
             }
         };
 
-        template <template <typename T> class Op>
+        template <template <typename T> class Op, PredicateType Type>
         struct ComparisonPredicate {
+            static constexpr PredicateType TYPE = Type;
             bool operator() (const Value& val1, const Value& val2) const {
                 switch (val1.getType()) {
                 case VariantType::VARIANT_TYPE_NULL:
@@ -130,16 +144,18 @@ namespace massif {
         };
 
 
-        using GtPredicate = ComparisonPredicate<std::greater>;
-        using LtPredicate = ComparisonPredicate<std::less>;
+        using GtPredicate = ComparisonPredicate<std::greater, PredicateType::GT>;
+        using LtPredicate = ComparisonPredicate<std::less, PredicateType::LT>;
 
         struct GtePredicate {
+            static constexpr PredicateType TYPE = PredicateType::GTE;
             bool operator() (const Value& val1, const Value& val2) const {
                 return EqPredicate()(val1, val2) || GtPredicate()(val1, val2);
             }
         };
 
         struct LtePredicate {
+            static constexpr PredicateType TYPE = PredicateType::LTE;
             bool operator() (const Value& val1, const Value& val2) const {
                 return EqPredicate()(val1, val2) || LtPredicate()(val1, val2);
             }
@@ -148,11 +164,13 @@ namespace massif {
         struct Operand {
             virtual ~Operand() = default;
             virtual Value evaluate(const Context& context) const = 0;
+            virtual int compile(Compiler& compiler) const = 0;
         };
 
         struct ConstOperand : public Operand {
             explicit ConstOperand(const Value& value) : _value(value) { }
             virtual Value evaluate(const Context& context) const { return _value; }
+            virtual int compile(Compiler& compiler) const { return compiler.constantOperand(_value); }
             static std::shared_ptr<ConstOperand> create(const Value& value) { return std::make_shared<ConstOperand>(value); }
         private:
             Value _value;
@@ -172,15 +190,17 @@ namespace massif {
                 return value;
             }
 
+            virtual int compile(Compiler& compiler) const { return compiler.variableOperand(_name, _nocase); }
+
             static std::shared_ptr<VariableOperand> create(const std::string& name) { return std::make_shared<VariableOperand>(name, false); }
             static std::shared_ptr<VariableOperand> createEx(const std::string& name, const std::string& collateSeq) { return std::make_shared<VariableOperand>(name, CollateNoCase(collateSeq) == CollateNoCase("nocase")); }
 
-        private:
             static std::string CollateNoCase(const std::string& str) {
                 unistring::unistring unistr = unistring::to_unistring(str);
                 return unistring::to_utf8string(unistring::to_upper(unistr));
             }
 
+        private:
             std::string _name;
             bool _nocase;
         };
@@ -188,6 +208,7 @@ namespace massif {
         struct NotExpression : public Expression {
             explicit NotExpression(const std::shared_ptr<Expression>& expr) : _expr(expr) { }
             virtual bool evaluate(const Context& context) const { return !_expr->evaluate(context); }
+            virtual int compile(Compiler& compiler) const { return compiler.notNode(_expr->compile(compiler)); }
             static std::shared_ptr<NotExpression> create(const std::shared_ptr<Expression>& expr) { return std::make_shared<NotExpression>(expr); }
         private:
             std::shared_ptr<Expression> _expr;
@@ -196,6 +217,7 @@ namespace massif {
         struct OrExpression : public Expression {
             OrExpression(const std::shared_ptr<Expression>& expr1, const std::shared_ptr<Expression>& expr2) : _expr1(expr1), _expr2(expr2) { }
             virtual bool evaluate(const Context& context) const { return _expr1->evaluate(context) || _expr2->evaluate(context); }
+            virtual int compile(Compiler& compiler) const { int node1 = _expr1->compile(compiler); return compiler.orNode(node1, _expr2->compile(compiler)); }
             static std::shared_ptr<OrExpression> create(const std::shared_ptr<Expression>& expr1, const std::shared_ptr<Expression>& expr2) { return std::make_shared<OrExpression>(expr1, expr2); }
         private:
             std::shared_ptr<Expression> _expr1, _expr2;
@@ -204,6 +226,7 @@ namespace massif {
         struct AndExpression : public Expression {
             AndExpression(const std::shared_ptr<Expression>& expr1, const std::shared_ptr<Expression>& expr2) : _expr1(expr1), _expr2(expr2) { }
             virtual bool evaluate(const Context& context) const { return _expr1->evaluate(context) && _expr2->evaluate(context); }
+            virtual int compile(Compiler& compiler) const { int node1 = _expr1->compile(compiler); return compiler.andNode(node1, _expr2->compile(compiler)); }
             static std::shared_ptr<AndExpression> create(const std::shared_ptr<Expression>& expr1, const std::shared_ptr<Expression>& expr2) { return std::make_shared<AndExpression>(expr1, expr2); }
         private:
             std::shared_ptr<Expression> _expr1, _expr2;
@@ -213,6 +236,7 @@ namespace massif {
         struct UnaryPredicateExpression : public Expression {
             UnaryPredicateExpression(const std::shared_ptr<Pred>& pred, const std::shared_ptr<Operand>& op) : _pred(pred), _op(op) { }
             virtual bool evaluate(const Context& context) const { return (*_pred)(_op->evaluate(context)); }
+            virtual int compile(Compiler& compiler) const { return compiler.predicateNode(Pred::TYPE, _op->compile(compiler), -1); }
             static std::shared_ptr<UnaryPredicateExpression> create(const std::shared_ptr<Operand>& op) { return std::make_shared<UnaryPredicateExpression>(std::make_shared<Pred>(), op); }
         private:
             std::shared_ptr<Pred> _pred;
@@ -223,6 +247,7 @@ namespace massif {
         struct BinaryPredicateExpression : public Expression {
             BinaryPredicateExpression(const std::shared_ptr<Pred>& pred, const std::shared_ptr<Operand>& op1, const std::shared_ptr<Operand>& op2) : _pred(pred), _op1(op1), _op2(op2) { }
             virtual bool evaluate(const Context& context) const { return (*_pred)(_op1->evaluate(context), _op2->evaluate(context)); }
+            virtual int compile(Compiler& compiler) const { int op1 = _op1->compile(compiler); return compiler.predicateNode(Pred::TYPE, op1, _op2->compile(compiler)); }
             static std::shared_ptr<BinaryPredicateExpression> create(const std::shared_ptr<Operand>& op1, const std::shared_ptr<Operand>& op2) { return std::make_shared<BinaryPredicateExpression>(std::make_shared<Pred>(), op1, op2); }
         private:
             std::shared_ptr<Pred> _pred;
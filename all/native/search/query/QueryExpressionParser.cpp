@@ -1,5 +1,6 @@
 #include "QueryExpressionParser.h"
 #include "components/Exceptions.h"
+#include "search/query/CompiledQueryExpression.h"
 #include "search/query/QueryExpression.h"
 #include "search/query/QueryExpressionImpl.h"
 #include "utils/Log.h"
@@ -16,7 +17,7 @@ namespace massif {
         using Skipper = boost::spirit::iso8859_1::space_type;
     
         template <typename Iterator>
-        struct Grammar : boost::spirit::qi::grammar<Iterator, std::shared_ptr<QueryExpression>(), Skipper> {
+        struct Grammar : boost::spirit::qi::grammar<Iterator, std::shared_ptr<Expression>(), Skipper> {
             Grammar() : Grammar::base_type(expression) {
                 using namespace boost;
                 using namespace boost::spirit;
@@ -106,7 +107,7 @@ namespace massif {
     std::shared_ptr<QueryExpression> QueryExpressionParser::parse(const std::string& expr) {
         std::string::const_iterator it = expr.begin();
         std::string::const_iterator end = expr.end();
-        std::shared_ptr<QueryExpression> queryExpr;
+        std::shared_ptr<queryexpressionimpl::Expression> queryExpr;
         bool result = false;
         try {
             queryexpressionimpl::Skipper skipper;
@@ -120,7 +121,9 @@ namespace massif {
         } else if (it != expr.end()) {
             throw ParseException("Could not parse to the end of query expression", expr, static_cast<int>(it - expr.begin()));
         }
-        return queryExpr;
+
+        CompiledQueryExpression::Builder builder;
+        return builder.build(queryExpr->compile(builder));
     }
 
     QueryExpressionParser::QueryExpressionParser() {
@@ -21,6 +21,7 @@ namespace massif {
     public:
         /**
          * Parse the query string and return corresponding parsed expression.
+         * The expression is compiled, so that it is cheap to evaluate for many features.
          * @param expr The string expression to parse.
          * @return The parsed query expression object.
          */
@@ -226,6 +226,37 @@ namespace {
         const massif::Variant& _variant;
     };
 
+    // Evaluates the expression before the geometry is known. Whatever is not known yet reads as missing,
+    // and is flagged - a false result is then not final, the element has to be tested in full.
+    class AttributeQueryContext : public massif::QueryContext {
+    public:
+        explicit AttributeQueryContext(const std::string* layerName, const std::function<bool(const std::string&, massif::Variant&)>& getAttribute) : _layerName(layerName), _getAttribute(getAttribute), _incomplete(false) { }
+        virtual ~AttributeQueryContext() { }
+
+        bool isIncomplete() const {
+            return _incomplete;
+        }
+
+        virtual bool getVariable(const std::string& name, massif::Variant& value) const {
+            if (name == "layer::name") {
+                value = (_layerName ? massif::Variant(*_layerName) : massif::Variant());
+                return true;
+            }
+
+            if (name == "geometry::type" || name == "geometry::vertices" || !_getAttribute) {
+                _incomplete = true;
+                return false;
+            }
+
+            return _getAttribute(name, value);
+        }
+
+    private:
+        const std::string* _layerName;
+        const std::function<bool(const std::string&, massif::Variant&)>& _getAttribute;
+        mutable bool _incomplete;
+    };
+
 }
 
 namespace massif {
@@ -351,6 +382,21 @@ namespace massif {
         return distance;
     }
 
+    bool SearchProxy::testAttributes(const std::string* layerName, const std::function<bool(const std::string&, Variant&)>& getAttribute, const std::function<Variant()>& getAttributes) const {
+        if (_expr) {
+            AttributeQueryContext context(layerName, getAttribute);
+            if (!_expr->evaluate(context) && !context.isIncomplete()) {
+                return false;
+            }
+        }
+        if (_re && getAttributes) {
+            if (!matchRegexFilter(getAttributes(), *_re)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
 }
 
 #endif
@@ -12,6 +12,7 @@
 #include "core/MapBounds.h"
 #include "search/SearchRequest.h"
 
+#include <functional>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -33,6 +34,10 @@ namespace massif {
 
         double testElement(const std::shared_ptr<Geometry>& geometry, const std::string* layerName, const Variant& var) const;
 
+        // Tests the filters that do not need the geometry. False only if no element with these attributes can match:
+        // an expression that reads the geometry, or attributes when getAttribute is empty, passes.
+        bool testAttributes(const std::string* layerName, const std::function<bool(const std::string&, Variant&)>& getAttribute, const std::function<Variant()>& getAttributes) const;
+
         static double calculateDistance(const std::shared_ptr<massif::Geometry>& geometry1, const std::shared_ptr<massif::Geometry>& geometry2);
 
     protected:
@@ -11,6 +11,7 @@
 #include "utils/Const.h"
 #include "utils/Log.h"
 #include "utils/TileUtils.h"
+#include "utils/TraceProfiler.h"
 
 #include <algorithm>
 #include <cmath>
@@ -32,6 +33,12 @@ namespace massif {
     static constexpr double DEFAULT_MAX_ELEVATION = 9000.0;
     static constexpr int RAY_MARCH_MAX_STEPS = 256;
     static constexpr int RAY_BISECT_STEPS = 24;
+    // Bounds the pyramid traversal; a ray grazing a whole tile of rough terrain at the finest level takes a few hundred.
+    // Each grid the ray enters adds RAY_TRAVERSAL_STEPS_PER_CELL steps per level-0 cell it crosses in that grid.
+    static constexpr int RAY_TRAVERSAL_MAX_STEPS = 4096;
+    static constexpr int RAY_TRAVERSAL_STEPS_PER_CELL = 4;
+    // getDisplayScale is quantised (see below), so a block's top is raised by a hair to stay an upper bound
+    static constexpr double RAY_BLOCK_SCALE_MARGIN = 1.0e-5;
     // Latitude quantum of the metres-to-internal scale memo, ~40 m of world (see getDisplayScale).
     static const double DISPLAY_SCALE_STEP = Const::WORLD_SIZE / 1048576.0;
 
@@ -59,6 +66,7 @@ namespace massif {
         _instanceId(NextInstanceId()),
         _exaggeration(1.0f),
         _seamlessTileEdges(true),
+        _decodedHeights(true),
         _surfaceResolution(32),
         _gridSizeHint(256),
         _neighbourPrefetch(true),
@@ -130,6 +138,14 @@ namespace massif {
         }
     }
 
+    bool ElevationManager::isDecodedHeightsEnabled() const {
+        return _decodedHeights.load();
+    }
+
+    void ElevationManager::setDecodedHeightsEnabled(bool enabled) {
+        _decodedHeights.store(enabled); // applies to grids decoded from now on, the heights do not change
+    }
+
     bool ElevationManager::isNeighbourPrefetchEnabled() const {
         return _neighbourPrefetch.load();
     }
@@ -316,7 +332,7 @@ namespace massif {
                 // MIN_CACHED_GRIDS). Only ever grows, and a caller that set its own capacity keeps it.
                 std::size_t minCapacity = grid->getDataSize() * MIN_CACHED_GRIDS;
                 if (!_gridCacheCapacityFixed && _gridCache.capacity() < minCapacity) {
-                    Log::Infof("ElevationManager: elevation grid cache %d -> %d MB (%d grids of %d KB)",
+                    LOG_INFOF("ElevationManager: elevation grid cache %d -> %d MB (%d grids of %d KB)",
                                static_cast<int>(_gridCache.capacity() >> 20), static_cast<int>(minCapacity >> 20),
                                static_cast<int>(MIN_CACHED_GRIDS), static_cast<int>(grid->getDataSize() >> 10));
                     _gridCache.resize(minCapacity);
@@ -424,6 +440,7 @@ namespace massif {
     }
 
     void ElevationManager::runPrefetchWorker() const {
+        TRACE_THREAD_NAME("ElevationPrefetch");
         while (true) {
             MapTile tile(0, 0, 0, 0);
             {
@@ -441,6 +458,7 @@ namespace massif {
                 _prefetchTileIds.erase(tile.getTileId());
             }
             try {
+                TRACE_SCOPE("ElevationManager::prefetchTileGrid");
                 getDataTileGrid(tile, LoadMode::LOAD_EXACT); // queued tiles are elevation tiles already
             }
             catch (const std::exception& ex) {
@@ -486,10 +504,6 @@ namespace massif {
     }
 
     bool ElevationManager::intersectRay(const cglib::ray3<double>& ray, double& t) const {
-        if (ray.direction(2) >= 0) {
-            return false; // upward/horizontal rays can not hit terrain from above
-        }
-
         float exaggeration = _exaggeration.load();
         double maxElevation = std::max(static_cast<double>(_maxSeenElevation.load()), DEFAULT_MAX_ELEVATION);
 
@@ -508,55 +522,182 @@ namespace massif {
         };
 
         // Conservative display-space search interval. Use the largest latitude scale along the ray
-        // to be safe; heights are re-sampled precisely at each march step anyway.
-        double tGround = -ray.origin(2) / ray.direction(2);
+        // to be safe; heights are re-sampled precisely at each march step anyway. A ray that does not
+        // descend (an occlusion test towards a higher point) is followed for at most a world width.
+        double horizontalLength = std::sqrt(ray.direction(0) * ray.direction(0) + ray.direction(1) * ray.direction(1));
+        double tWorld = horizontalLength > 0 ? Const::WORLD_SIZE / horizontalLength : std::numeric_limits<double>::infinity();
+        double tEnd = ray.direction(2) < 0 ? -ray.origin(2) / ray.direction(2) : tWorld;
+        if (!std::isfinite(tEnd)) {
+            return false; // degenerate direction
+        }
         double scale0 = getDisplayScale(ray.origin(1));
-        double scale1 = getDisplayScale(ray(tGround)(1));
+        double scale1 = getDisplayScale(ray(tEnd)(1));
         double maxScale = std::max(scale0, scale1);
         double zTop = maxElevation * exaggeration * maxScale;
         double zBottom = DEFAULT_MIN_ELEVATION * exaggeration * maxScale;
 
         double t0 = 0;
-        if (ray.origin(2) > zTop) {
-            t0 = (zTop - ray.origin(2)) / ray.direction(2);
+        double t1 = 0;
+        if (ray.direction(2) < 0) {
+            if (ray.origin(2) > zTop) {
+                t0 = (zTop - ray.origin(2)) / ray.direction(2);
+            }
+            t1 = (zBottom - ray.origin(2)) / ray.direction(2);
+        } else {
+            if (ray.origin(2) > zTop) {
+                return false; // above all terrain and not descending
+            }
+            t1 = ray.direction(2) > 0 ? std::min(tWorld, (zTop - ray.origin(2)) / ray.direction(2)) : tWorld;
         }
-        double t1 = (zBottom - ray.origin(2)) / ray.direction(2);
         if (!(t1 > t0)) {
             return false;
         }
 
-        // March with quadratically increasing steps (dense near the origin, coarse far away),
-        // then refine the first crossing with bisection.
-        double prevT = t0;
+        // Refine a crossing between a point above and a point below the terrain with bisection.
+        auto bisect = [&](double tLow, double tHigh) -> double {
+            for (int j = 0; j < RAY_BISECT_STEPS; j++) {
+                double tMid = (tLow + tHigh) * 0.5;
+                cglib::vec3<double> midPos = ray(tMid);
+                if (midPos(2) - sampleDisplayHeight(midPos(0), midPos(1)) <= 0) {
+                    tHigh = tMid;
+                } else {
+                    tLow = tMid;
+                }
+            }
+            return (tLow + tHigh) * 0.5;
+        };
+
         cglib::vec3<double> pos = ray(t0);
-        double prevDelta = pos(2) - sampleDisplayHeight(pos(0), pos(1));
-        if (prevDelta <= 0) {
+        if (pos(2) - sampleDisplayHeight(pos(0), pos(1)) <= 0) {
             t = t0;
             return true;
         }
-        for (int i = 1; i <= RAY_MARCH_MAX_STEPS; i++) {
-            double f = static_cast<double>(i) / RAY_MARCH_MAX_STEPS;
-            double curT = t0 + (t1 - t0) * f * f;
+
+        // Walk the grids' max-height pyramids: a block the ray passes above is skipped as a whole,
+        // a block it may hit is descended into, and only at the finest level (one texel cell) is
+        // the height actually sampled. A plain march (still used where no grid is cached) samples
+        // RAY_MARCH_MAX_STEPS steps whatever the terrain, and can step over a peak narrower than a step.
+        double tEpsilon = (t1 - t0) * 1.0e-9;
+        double curT = t0;
+        int level = -1; // -1: start from the top of the current grid's pyramid
+        std::shared_ptr<ElevationTileGrid> levelGrid;
+        long long maxSteps = RAY_TRAVERSAL_MAX_STEPS;
+        for (long long i = 0; i < maxSteps && curT < t1; i++) {
             pos = ray(curT);
-            double delta = pos(2) - sampleDisplayHeight(pos(0), pos(1));
-            if (delta <= 0) {
-                double tLow = prevT;
-                double tHigh = curT;
-                for (int j = 0; j < RAY_BISECT_STEPS; j++) {
-                    double tMid = (tLow + tHigh) * 0.5;
-                    pos = ray(tMid);
-                    double midDelta = pos(2) - sampleDisplayHeight(pos(0), pos(1));
-                    if (midDelta <= 0) {
-                        tHigh = tMid;
-                    } else {
-                        tLow = tMid;
-                    }
+            double wrappedX = wrapInternalX(pos(0));
+            if (!cachedGrid || !cachedGrid->getInternalBounds().contains(MapPos(wrappedX, pos(1), 0))) {
+                cachedGrid = getGridForInternalPos(wrappedX, pos(1), LoadMode::CACHED_ONLY);
+            }
+            if (!cachedGrid) {
+                // No elevation data here, the ground is at sea level: fall back to plain march steps
+                double nextT = std::min(t1, curT + (t1 - t0) / RAY_MARCH_MAX_STEPS);
+                pos = ray(nextT);
+                if (pos(2) - sampleDisplayHeight(pos(0), pos(1)) <= 0) {
+                    t = bisect(curT, nextT);
+                    return true;
+                }
+                curT = nextT;
+                continue;
+            }
+            if (cachedGrid != levelGrid) {
+                levelGrid = cachedGrid;
+                level = -1;
+
+                // Budget the level-0 cells the ray crosses in this grid, so that a long grazing ray is not cut short
+                const MapBounds& gridBounds = levelGrid->getInternalBounds();
+                double cellWidth = (gridBounds.getMax().getX() - gridBounds.getMin().getX()) / std::max(1, levelGrid->getWidth() - 1);
+                double cellHeight = (gridBounds.getMax().getY() - gridBounds.getMin().getY()) / std::max(1, levelGrid->getHeight() - 1);
+                double gridCells = (std::abs(ray.direction(0)) / cellWidth + std::abs(ray.direction(1)) / cellHeight) * (t1 - curT);
+                double gridSpan = levelGrid->getWidth() + levelGrid->getHeight();
+                maxSteps += static_cast<long long>(std::min(gridCells, gridSpan) + 1) * RAY_TRAVERSAL_STEPS_PER_CELL;
+            }
+            if (level < 0) {
+                level = levelGrid->getMaxHeightLevelCount() - 1;
+            }
+
+            MapBounds blockBounds;
+            float blockMaxHeight = 0;
+            levelGrid->findMaxHeightBlock(wrappedX, pos(1), level, blockBounds, blockMaxHeight);
+            double blockTop = std::max(blockMaxHeight * exaggeration * getDisplayScale(blockBounds.getMin().getY()), blockMaxHeight * exaggeration * getDisplayScale(blockBounds.getMax().getY()));
+            blockTop += std::abs(blockTop) * RAY_BLOCK_SCALE_MARGIN;
+
+            // Where the ray leaves the block horizontally (the block is in wrapped coordinates)
+            double offsetX = pos(0) - wrappedX;
+            double tExit = t1;
+            if (ray.direction(0) > 0) {
+                tExit = std::min(tExit, (blockBounds.getMax().getX() + offsetX - ray.origin(0)) / ray.direction(0));
+            } else if (ray.direction(0) < 0) {
+                tExit = std::min(tExit, (blockBounds.getMin().getX() + offsetX - ray.origin(0)) / ray.direction(0));
+            }
+            if (ray.direction(1) > 0) {
+                tExit = std::min(tExit, (blockBounds.getMax().getY() - ray.origin(1)) / ray.direction(1));
+            } else if (ray.direction(1) < 0) {
+                tExit = std::min(tExit, (blockBounds.getMin().getY() - ray.origin(1)) / ray.direction(1));
+            }
+            tExit = std::max(tExit, curT);
+
+            if (pos(2) > blockTop) {
+                double tTop = ray.direction(2) < 0 ? (blockTop - ray.origin(2)) / ray.direction(2) : std::numeric_limits<double>::infinity();
+                if (tTop >= tExit) {
+                    // Above the block all the way across: skip it, and continue one level coarser
+                    curT = tExit + tEpsilon;
+                    level = std::min(level + 1, levelGrid->getMaxHeightLevelCount() - 1);
+                    continue;
                 }
-                t = (tLow + tHigh) * 0.5;
+                curT = std::max(curT, tTop); // the ray can not hit anything in the block before dropping to its top
+            }
+            if (level > 0) {
+                level--;
+                continue;
+            }
+
+            // A single texel cell the ray may hit. The height is bilinear in the cell, so along the
+            // ray the clearance is a parabola: three samples pin it down, and a ray clipping a
+            // ridge between the cell edges is found even though both edges are above the ground.
+            double nextT = std::min(t1, tExit + tEpsilon);
+            double midT = (curT + nextT) * 0.5;
+            auto clearance = [&](double tSample) {
+                cglib::vec3<double> samplePos = ray(tSample);
+                return samplePos(2) - sampleDisplayHeight(samplePos(0), samplePos(1));
+            };
+            double d0 = clearance(curT);
+            double dMid = clearance(midT);
+            if (d0 <= 0) {
+                t = curT;
+                return true;
+            }
+            if (dMid <= 0) {
+                t = bisect(curT, midT);
+                return true;
+            }
+            double d1 = clearance(nextT);
+            double a = 2 * (d0 - 2 * dMid + d1);
+            double b = d1 - d0 - a;
+            if (a > 0 && -b < 2 * a && -b > 0 && d0 - b * b / (4 * a) <= 0) {
+                // The fit is exact only up to the latitude scale, so the dip is confirmed by a sample
+                double minT = curT + (nextT - curT) * (-b / (2 * a));
+                if (clearance(minT) <= 0) {
+                    t = (minT < midT ? bisect(curT, minT) : bisect(midT, minT));
+                    return true;
+                }
+            }
+            if (d1 <= 0) {
+                t = bisect(midT, nextT);
+                return true;
+            }
+            curT = nextT;
+        }
+
+        // Out of traversal steps: finish the rest of the ray with plain march steps instead of reporting a miss
+        double stepT = (t1 - curT) / RAY_MARCH_MAX_STEPS;
+        for (int i = 0; i < RAY_MARCH_MAX_STEPS && curT < t1; i++) {
+            double nextT = std::min(t1, curT + stepT);
+            pos = ray(nextT);
+            if (pos(2) - sampleDisplayHeight(pos(0), pos(1)) <= 0) {
+                t = bisect(curT, nextT);
                 return true;
             }
-            prevT = curT;
-            prevDelta = delta;
+            curT = nextT;
         }
         return false;
     }
@@ -753,7 +894,7 @@ namespace massif {
                                  MapPos(std::max(internalMin.getX(), internalMax.getX()), std::max(internalMin.getY(), internalMax.getY())));
 
         std::array<double, 4> coeffs = _elevationDecoder->getColorComponentCoefficients();
-        std::shared_ptr<ElevationTileGrid> grid = ElevationTileGrid::DecodeBitmap(mapTile, internalBounds, tileBitmap, coeffs);
+        std::shared_ptr<ElevationTileGrid> grid = ElevationTileGrid::DecodeBitmap(mapTile, internalBounds, tileBitmap, coeffs, _decodedHeights.load());
         if (grid && grid->getWidth() > 0) {
             _gridSizeHint.store(grid->getWidth()); // drives the elevation level cap in clampTileZoom
         }
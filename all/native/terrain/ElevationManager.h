@@ -78,6 +78,14 @@ namespace massif {
         bool isNeighbourPrefetchEnabled() const;
         void setNeighbourPrefetchEnabled(bool enabled);
 
+        /**
+         * Keeps the heights of newly decoded grids as floats (see ElevationTileGrid), so CPU-side
+         * sampling does not decode the raster per sample. Grids already cached keep their storage;
+         * either way the heights are the same.
+         */
+        bool isDecodedHeightsEnabled() const;
+        void setDecodedHeightsEnabled(bool enabled);
+
         /**
          * Sets the terrain surface resolution (mesh cells per tile edge). Elevation levels are
          * capped so that one elevation texel covers at most half a surface cell: finer data cannot
@@ -250,6 +258,7 @@ namespace massif {
 
         std::atomic<float> _exaggeration;
         std::atomic<bool> _seamlessTileEdges;
+        std::atomic<bool> _decodedHeights;
         std::atomic<int> _surfaceResolution;      // terrain mesh cells per tile edge
         mutable std::atomic<int> _gridSizeHint;   // texels per elevation tile edge, from the last decoded grid
         std::atomic<bool> _neighbourPrefetch;
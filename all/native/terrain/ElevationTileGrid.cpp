@@ -7,7 +7,7 @@
 
 namespace massif {
 
-    ElevationTileGrid::ElevationTileGrid(const MapTile& tile, const MapBounds& internalBounds, const std::shared_ptr<Bitmap>& bitmap, const std::array<double, 4>& coeffs) :
+    ElevationTileGrid::ElevationTileGrid(const MapTile& tile, const MapBounds& internalBounds, const std::shared_ptr<Bitmap>& bitmap, const std::array<double, 4>& coeffs, bool decodedHeights) :
         _tile(tile),
         _internalBounds(internalBounds),
         _bitmap(bitmap),
@@ -17,26 +17,31 @@ namespace massif {
         _height(bitmap ? bitmap->getHeight() : 0),
         _bytesPerTexel(bitmap ? bitmap->getBytesPerPixel() : 0),
         _minHeight(0),
-        _maxHeight(0)
+        _maxHeight(0),
+        _maxHeightLevels(),
+        _decodedHeights()
     {
         if (_pixelData && _width > 0 && _height > 0) {
-            // One pass for the height range, which culling and the shadow box need. Everything
-            // else is decoded on demand.
-            float minHeight = getHeight(0, 0);
-            float maxHeight = minHeight;
-            std::size_t count = static_cast<std::size_t>(_width) * _height;
-            for (std::size_t i = 0; i < count; i++) {
-                float h = decodeTexel(&_pixelData[i * _bytesPerTexel]);
-                minHeight = std::min(minHeight, h);
-                maxHeight = std::max(maxHeight, h);
+            // One pass for the height range, which culling and the shadow box need, and the
+            // max-height pyramid the raycast skips empty space with. Unless the heights are
+            // kept, everything else is decoded on demand.
+            std::vector<float> heights;
+            decodeHeights(heights);
+            _minHeight = *std::min_element(heights.begin(), heights.end());
+            _maxHeight = *std::max_element(heights.begin(), heights.end());
+            buildMaxHeightLevels(heights);
+            if (decodedHeights) {
+                _decodedHeights = std::move(heights);
             }
-            _minHeight = minHeight;
-            _maxHeight = maxHeight;
         }
     }
 
     std::size_t ElevationTileGrid::getDataSize() const {
-        return (_bitmap ? _bitmap->getPixelData().size() : 0) + sizeof(ElevationTileGrid);
+        std::size_t pyramidSize = 0;
+        for (const MaxHeightLevel& level : _maxHeightLevels) {
+            pyramidSize += level.maxHeights.size() * sizeof(float);
+        }
+        return (_bitmap ? _bitmap->getPixelData().size() : 0) + pyramidSize + _decodedHeights.size() * sizeof(float) + sizeof(ElevationTileGrid);
     }
 
     ColorFormat::ColorFormat ElevationTileGrid::getColorFormat() const {
@@ -115,6 +120,108 @@ namespace massif {
         dhdy = static_cast<float>((sampleHeight(internalX, internalY + texelY) - sampleHeight(internalX, internalY - texelY)) / (2 * texelY));
     }
 
+    void ElevationTileGrid::findMaxHeightBlock(double internalX, double internalY, int level, MapBounds& blockBounds, float& maxHeight) const {
+        double boundsWidth = _internalBounds.getMax().getX() - _internalBounds.getMin().getX();
+        double boundsHeight = _internalBounds.getMax().getY() - _internalBounds.getMin().getY();
+        if (boundsWidth <= 0 || boundsHeight <= 0 || _maxHeightLevels.empty()) {
+            blockBounds = _internalBounds;
+            maxHeight = _maxHeight;
+            return;
+        }
+        level = std::min(std::max(level, 0), static_cast<int>(_maxHeightLevels.size()) - 1);
+        const MaxHeightLevel& maxHeightLevel = _maxHeightLevels[level];
+
+        // The cell is selected exactly like the lower-left texel in sampleHeight, so every sample
+        // inside the returned bounds interpolates texels of this block only.
+        double fx = (internalX - _internalBounds.getMin().getX()) / boundsWidth * _width - 0.5;
+        double fy = (internalY - _internalBounds.getMin().getY()) / boundsHeight * _height - 0.5;
+        int gx = std::min(std::max(static_cast<int>(std::floor(fx)), 0), _width - 1);
+        int gy = std::min(std::max(static_cast<int>(std::floor(fy)), 0), _height - 1);
+        int bx = std::min(gx >> level, maxHeightLevel.width - 1);
+        int by = std::min(gy >> level, maxHeightLevel.height - 1);
+        maxHeight = maxHeightLevel.maxHeights[static_cast<std::size_t>(by) * maxHeightLevel.width + bx];
+
+        // Block edges run through texel centers; the outermost blocks extend to the grid edges,
+        // where the samples are clamped.
+        double x0 = (bx == 0 ? _internalBounds.getMin().getX() : _internalBounds.getMin().getX() + ((bx << level) + 0.5) / _width * boundsWidth);
+        double x1 = (bx == maxHeightLevel.width - 1 ? _internalBounds.getMax().getX() : _internalBounds.getMin().getX() + (((bx + 1) << level) + 0.5) / _width * boundsWidth);
+        double y0 = (by == 0 ? _internalBounds.getMin().getY() : _internalBounds.getMin().getY() + ((by << level) + 0.5) / _height * boundsHeight);
+        double y1 = (by == maxHeightLevel.height - 1 ? _internalBounds.getMax().getY() : _internalBounds.getMin().getY() + (((by + 1) << level) + 0.5) / _height * boundsHeight);
+        blockBounds = MapBounds(MapPos(x0, y0), MapPos(x1, y1));
+    }
+
+    void ElevationTileGrid::decodeHeights(std::vector<float>& heights) const {
+        // Same arithmetic as decodeTexel, with the channel count hoisted out of the loop: the
+        // loops below have a fixed stride and no branches, so the compiler vectorizes them.
+        std::size_t count = static_cast<std::size_t>(_width) * _height;
+        heights.resize(count);
+        const std::uint8_t* p = _pixelData;
+        const double c0 = _coeffs[0], c1 = _coeffs[1], c2 = _coeffs[2], c3 = _coeffs[3];
+        switch (_bytesPerTexel) {
+        case 1:
+            for (std::size_t i = 0; i < count; i++) {
+                heights[i] = static_cast<float>(c3 + c0 * p[i]);
+            }
+            break;
+        case 2:
+            for (std::size_t i = 0; i < count; i++) {
+                heights[i] = static_cast<float>(c3 + c0 * p[i * 2] + c1 * p[i * 2 + 1]);
+            }
+            break;
+        case 3:
+            for (std::size_t i = 0; i < count; i++) {
+                heights[i] = static_cast<float>(c3 + c0 * p[i * 3] + c1 * p[i * 3 + 1] + c2 * p[i * 3 + 2]);
+            }
+            break;
+        case 4: // alpha is ignored, as in decodeTexel
+            for (std::size_t i = 0; i < count; i++) {
+                heights[i] = static_cast<float>(c3 + c0 * p[i * 4] + c1 * p[i * 4 + 1] + c2 * p[i * 4 + 2]);
+            }
+            break;
+        default:
+            for (std::size_t i = 0; i < count; i++) {
+                heights[i] = decodeTexel(&p[i * _bytesPerTexel]);
+            }
+            break;
+        }
+    }
+
+    void ElevationTileGrid::buildMaxHeightLevels(const std::vector<float>& heights) {
+        // Level 0: the maximum of the texels a bilinear sample in the cell interpolates between.
+        // Bilinear interpolation never exceeds its corner texels, so the bound is exact at the
+        // finest level and conservative above it.
+        MaxHeightLevel cellLevel { _width, _height, std::vector<float>(static_cast<std::size_t>(_width) * _height) };
+        for (int gy = 0; gy < _height; gy++) {
+            int gy1 = std::min(gy + 1, _height - 1);
+            for (int gx = 0; gx < _width; gx++) {
+                int gx1 = std::min(gx + 1, _width - 1);
+                float h = std::max(std::max(heights[static_cast<std::size_t>(gy) * _width + gx], heights[static_cast<std::size_t>(gy) * _width + gx1]),
+                                   std::max(heights[static_cast<std::size_t>(gy1) * _width + gx], heights[static_cast<std::size_t>(gy1) * _width + gx1]));
+                cellLevel.maxHeights[static_cast<std::size_t>(gy) * _width + gx] = h;
+            }
+        }
+        _maxHeightLevels.push_back(std::move(cellLevel));
+
+        // Coarser levels: 2x2 maxima of the level below, until a single block is left
+        while (_maxHeightLevels.back().width > 1 || _maxHeightLevels.back().height > 1) {
+            const MaxHeightLevel& fine = _maxHeightLevels.back();
+            MaxHeightLevel coarse { (fine.width + 1) / 2, (fine.height + 1) / 2, std::vector<float>() };
+            coarse.maxHeights.resize(static_cast<std::size_t>(coarse.width) * coarse.height);
+            for (int by = 0; by < coarse.height; by++) {
+                int fy0 = by * 2;
+                int fy1 = std::min(fy0 + 1, fine.height - 1);
+                for (int bx = 0; bx < coarse.width; bx++) {
+                    int fx0 = bx * 2;
+                    int fx1 = std::min(fx0 + 1, fine.width - 1);
+                    float h = std::max(std::max(fine.maxHeights[static_cast<std::size_t>(fy0) * fine.width + fx0], fine.maxHeights[static_cast<std::size_t>(fy0) * fine.width + fx1]),
+                                       std::max(fine.maxHeights[static_cast<std::size_t>(fy1) * fine.width + fx0], fine.maxHeights[static_cast<std::size_t>(fy1) * fine.width + fx1]));
+                    coarse.maxHeights[static_cast<std::size_t>(by) * coarse.width + bx] = h;
+                }
+            }
+            _maxHeightLevels.push_back(std::move(coarse));
+        }
+    }
+
     std::function<void(int, int, std::uint8_t*)> ElevationTileGrid::makeTexelSampler(const std::array<std::shared_ptr<ElevationTileGrid>, 8>& neighbours) const {
         // Same DEM level, grid size and encoding: the border texel is one of the neighbour's own
         // texels, so it can be copied bit-exactly by index.
@@ -298,7 +405,7 @@ namespace massif {
         }
     }
 
-    std::shared_ptr<ElevationTileGrid> ElevationTileGrid::DecodeBitmap(const MapTile& tile, const MapBounds& internalBounds, const std::shared_ptr<Bitmap>& bitmap, const std::array<double, 4>& coeffs) {
+    std::shared_ptr<ElevationTileGrid> ElevationTileGrid::DecodeBitmap(const MapTile& tile, const MapBounds& internalBounds, const std::shared_ptr<Bitmap>& bitmap, const std::array<double, 4>& coeffs, bool decodedHeights) {
         if (!bitmap) {
             return std::shared_ptr<ElevationTileGrid>();
         }
@@ -322,7 +429,7 @@ namespace massif {
         // Bitmap pixel data rows are stored bottom-up relative to the image, which means
         // row 0 of the pixel data corresponds to the southern (minimum y) edge of the tile.
         // This matches the grid row order, so the raster can be used as it is.
-        auto grid = std::make_shared<ElevationTileGrid>(tile, internalBounds, bitmap, coeffs);
+        auto grid = std::make_shared<ElevationTileGrid>(tile, internalBounds, bitmap, coeffs, decodedHeights);
         if (grid->getMinHeight() < -12000.0f || grid->getMaxHeight() > 10000.0f) {
             Log::Warnf("ElevationTileGrid::DecodeBitmap: Implausible elevation range %g..%g m for tile %d/%d/%d - check that the elevation data source encoding ('terrarium'/'mapbox') matches the data",
                        grid->getMinHeight(), grid->getMaxHeight(), tile.getZoom(), tile.getX(), tile.getY());
@@ -29,13 +29,18 @@ namespace massif {
      * offers - 1/256m for terrarium, 0.1m for mapbox - and the GPU texture is a copy of the same
      * texels, decoded in the shader with the source's own coefficients.
      *
+     * Optionally the heights are also decoded once into a float array, which every CPU-side
+     * sample then reads instead of the raster. That trades 4 bytes a texel (counted in
+     * getDataSize) for the per-sample decode, which dense consumers - contour tracing, the
+     * raycast, label anchoring - otherwise pay on every sample. The values are identical.
+     *
      * Grid rows are stored south-to-north (row 0 corresponds to the minimum internal y), which is
      * the Bitmap row order.
      * Internal class, not exposed in the public API.
      */
     class ElevationTileGrid {
     public:
-        ElevationTileGrid(const MapTile& tile, const MapBounds& internalBounds, const std::shared_ptr<Bitmap>& bitmap, const std::array<double, 4>& coeffs);
+        ElevationTileGrid(const MapTile& tile, const MapBounds& internalBounds, const std::shared_ptr<Bitmap>& bitmap, const std::array<double, 4>& coeffs, bool decodedHeights);
 
         const MapTile& getTile() const { return _tile; }
         const MapBounds& getInternalBounds() const { return _internalBounds; }
@@ -48,6 +53,8 @@ namespace massif {
         /** The texture built from this grid has the source raster's own format. */
         ColorFormat::ColorFormat getColorFormat() const;
         int getBytesPerTexel() const { return _bytesPerTexel; }
+        /** True if the heights are kept decoded (see the class comment). */
+        bool hasDecodedHeights() const { return !_decodedHeights.empty(); }
 
         /**
          * Bilinearly sampled elevation in meters at the given internal coordinates.
@@ -59,6 +66,19 @@ namespace massif {
          */
         void sampleGradient(double internalX, double internalY, float& dhdx, float& dhdy) const;
 
+        /**
+         * Number of levels of the max-height pyramid. Level 0 has one entry per texel cell (the
+         * 2x2 texels a bilinear sample interpolates between), each further level halves the
+         * resolution, and the last level is a single block covering the whole grid.
+         */
+        int getMaxHeightLevelCount() const { return static_cast<int>(_maxHeightLevels.size()); }
+        /**
+         * The max-height pyramid block at the given level that contains the internal position:
+         * its internal bounds and an upper bound of sampleHeight over them. A ray passing above
+         * the bound can skip the whole block, which is how intersectRay avoids sampling empty space.
+         */
+        void findMaxHeightBlock(double internalX, double internalY, int level, MapBounds& blockBounds, float& maxHeight) const;
+
         /**
          * The decode the shader applies to a texture sample: meters = dot(sample, decode) +
          * getDecodeOffset(). The source coefficients apply to the raw 0..255 byte values, so they
@@ -110,9 +130,10 @@ namespace massif {
 
         /**
          * Wraps a DEM bitmap (mapbox/terrarium RGB encoded) in an elevation grid using the given
-         * color component coefficients. Returns null if the bitmap has an unsupported format.
+         * color component coefficients, optionally keeping the decoded heights.
+         * Returns null if the bitmap has an unsupported format.
          */
-        static std::shared_ptr<ElevationTileGrid> DecodeBitmap(const MapTile& tile, const MapBounds& internalBounds, const std::shared_ptr<Bitmap>& bitmap, const std::array<double, 4>& coeffs);
+        static std::shared_ptr<ElevationTileGrid> DecodeBitmap(const MapTile& tile, const MapBounds& internalBounds, const std::shared_ptr<Bitmap>& bitmap, const std::array<double, 4>& coeffs, bool decodedHeights);
 
     private:
         // The padded texture's texel at (gx, gy), gx in [-1, width] and gy in [-1, height], written
@@ -139,7 +160,22 @@ namespace massif {
         // of a plain greedy division by the coefficients, largest first.
         void encodeHeight(float height, std::uint8_t* dst) const;
 
-        float getHeight(int gx, int gy) const { return decodeTexel(texel(gx, gy)); }
+        float getHeight(int gx, int gy) const {
+            if (!_decodedHeights.empty()) {
+                return _decodedHeights[static_cast<std::size_t>(gy) * _width + gx];
+            }
+            return decodeTexel(texel(gx, gy));
+        }
+
+        void decodeHeights(std::vector<float>& heights) const;
+
+        void buildMaxHeightLevels(const std::vector<float>& heights);
+
+        struct MaxHeightLevel {
+            int width;
+            int height;
+            std::vector<float> maxHeights;
+        };
 
         const MapTile _tile;
         const MapBounds _internalBounds;
@@ -151,6 +187,8 @@ namespace massif {
         int _bytesPerTexel;
         float _minHeight;
         float _maxHeight;
+        std::vector<MaxHeightLevel> _maxHeightLevels;
+        std::vector<float> _decodedHeights;
     };
 }
 
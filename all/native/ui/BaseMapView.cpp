@@ -59,7 +59,7 @@ namespace massif {
         setTilt(90, 0);
         setZoom(0, 0);
 
-        Log::Infof("BaseMapView: %s", GetSDKVersion().c_str());
+        LOG_INFOF("BaseMapView: %s", GetSDKVersion().c_str());
     }
     
     BaseMapView::~BaseMapView() {
@@ -77,7 +77,7 @@ namespace massif {
     }
     
     void BaseMapView::onSurfaceChanged(int width, int height) {
-        Log::Infof("BaseMapView::onSurfaceChanged(): width: %d, height: %d", width, height);
+        LOG_INFOF("BaseMapView::onSurfaceChanged(): width: %d, height: %d", width, height);
         _mapRenderer->onSurfaceChanged(width, height);
     }
     
@@ -199,7 +199,7 @@ namespace massif {
         }
         if (MeasuredFrames == 0) {
             if (DisjointFrames > 0) {
-                Log::Infof("PROF GPU: no frame read back, %d dropped (disjoint)", DisjointFrames);
+                LOG_INFOF("PROF GPU: no frame read back, %d dropped (disjoint)", DisjointFrames);
                 DisjointFrames = 0;
             }
             return;
@@ -216,7 +216,7 @@ namespace massif {
             totalMs += avgMs[i];
             totalDrops += SectionDrops[i];
         }
-        Log::Infof("PROF GPU: %d frames, %d dropped (disjoint), %d sections untimed | sky %.1f background %.1f prelude %.1f prepare %.1f cover %.1f drape %.1f layers %.1f layers3D %.1f billboards %.1f shadowCast %.1f shadowMask %.1f groundAO %.1f labelOcc %.1f total %.1f",
+        LOG_INFOF("PROF GPU: %d frames, %d dropped (disjoint), %d sections untimed | sky %.1f background %.1f prelude %.1f prepare %.1f cover %.1f drape %.1f layers %.1f layers3D %.1f billboards %.1f shadowCast %.1f shadowMask %.1f groundAO %.1f labelOcc %.1f total %.1f",
             MeasuredFrames, DisjointFrames, totalDrops,
             avgMs[SECTION_SKY], avgMs[SECTION_BACKGROUND], avgMs[SECTION_PRELUDE], avgMs[SECTION_PREPARE], avgMs[SECTION_COVER],
             avgMs[SECTION_DRAPE], avgMs[SECTION_LAYERS], avgMs[SECTION_LAYERS3D], avgMs[SECTION_BILLBOARDS], avgMs[SECTION_SHADOWCAST], avgMs[SECTION_SHADOWMASK], avgMs[SECTION_GROUNDAO], avgMs[SECTION_LABELOCC],
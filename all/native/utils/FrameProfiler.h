@@ -20,7 +20,8 @@
  * macros expand to nothing, and their arguments are never evaluated.
  *
  * Enable it for a debug build with -DMASSIF_FRAME_PROFILER=1 (scripts/android-dev passes
- * CMake flags through to the native build), then read the 'PROF' lines from logcat.
+ * CMake flags through to the native build), then read the 'PROF' lines from logcat. The same
+ * build records the timeline of all threads, see TraceProfiler.h.
  */
 #ifndef MASSIF_FRAME_PROFILER
 #define MASSIF_FRAME_PROFILER 0
@@ -30,8 +31,10 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstdint>
 
 #include "utils/Log.h"
+#include "utils/TraceProfiler.h"
 
 namespace massif {
     /**
@@ -97,6 +100,14 @@ namespace massif {
         static void resetFrame() {
             skyMs = preludeMs = prepareMs = coverMs = drapeMs = layerMs = layer3DMs = billboardMs = 0;
             GpuFrameProfiler::beginFrame();
+            TraceProfiler::setThreadName("RenderThread");
+        }
+
+        // Adds a section to its field and to the trace, named after the field.
+        static void addSection(const char* name, double& sectionMs, double startMs) {
+            double endMs = now();
+            sectionMs += endMs - startMs;
+            TraceProfiler::addEvent(name, static_cast<std::int64_t>(startMs * 1000.0), static_cast<std::int64_t>(endMs * 1000.0));
         }
 
         // Accumulates one frame and prints the running averages once a second. 'frameMs' is
@@ -107,6 +118,9 @@ namespace massif {
             static int count = 0;
             static std::chrono::steady_clock::time_point lastLog = std::chrono::steady_clock::now();
 
+            double endMs = now();
+            TraceProfiler::addEvent("frame", static_cast<std::int64_t>((endMs - frameMs) * 1000.0), static_cast<std::int64_t>(endMs * 1000.0));
+
             sumMs += frameMs;
             maxMs = std::max(maxMs, frameMs);
             sumSky += skyMs; sumPrelude += preludeMs; sumPrepare += prepareMs; sumCover += coverMs;
@@ -118,12 +132,13 @@ namespace massif {
                 return;
             }
             double intervalMs = std::chrono::duration<double, std::milli>(currentTime - lastLog).count();
-            Log::Infof("PROF: %d frames in %.0f ms (%.1f fps), frame avg %.1f max %.1f | sky %.1f prelude %.1f prepare %.1f cover %.1f drape %.1f layers %.1f layers3D %.1f billboards %.1f other %.1f",
+            LOG_INFOF("PROF: %d frames in %.0f ms (%.1f fps), frame avg %.1f max %.1f | sky %.1f prelude %.1f prepare %.1f cover %.1f drape %.1f layers %.1f layers3D %.1f billboards %.1f other %.1f",
                 count, intervalMs, count * 1000.0 / intervalMs, sumMs / count, maxMs,
                 sumSky / count, sumPrelude / count, sumPrepare / count, sumCover / count,
                 sumDrape / count, sumLayer / count, sumLayer3D / count, sumBillboard / count,
                 (sumMs - sumSky - sumPrelude - sumPrepare - sumCover - sumDrape - sumLayer - sumLayer3D - sumBillboard) / count);
             GpuFrameProfiler::logInterval();
+            TraceProfiler::pollDumpRequest();
             sumMs = maxMs = sumSky = sumPrelude = sumPrepare = sumCover = sumDrape = sumLayer = sumLayer3D = sumBillboard = 0;
             count = 0;
             lastLog = currentTime;
@@ -133,7 +148,7 @@ namespace massif {
 
 #define FRAME_PROF_RESET() (massif::FrameProfiler::resetFrame())
 #define FRAME_PROF_NOW(var) double var = massif::FrameProfiler::now()
-#define FRAME_PROF_ADD(field, startVar) (massif::FrameProfiler::field += massif::FrameProfiler::now() - (startVar))
+#define FRAME_PROF_ADD(field, startVar) (massif::FrameProfiler::addSection(#field, massif::FrameProfiler::field, (startVar)))
 #define FRAME_PROF_SET(field, value) (massif::FrameProfiler::field = (value))
 #define FRAME_PROF_END(startVar) (massif::FrameProfiler::endFrame(massif::FrameProfiler::now() - (startVar)))
 #define FRAME_PROF_GPU_BEGIN(section) (massif::GpuFrameProfiler::beginSection(massif::GpuFrameProfiler::section))
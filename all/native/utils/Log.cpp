@@ -1,6 +1,10 @@
 #include "Log.h"
 #include "utils/LogEventListener.h"
 
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
 #ifdef __ANDROID__
 #include <android/log.h>
 #include <unistd.h>
@@ -15,6 +19,10 @@
 #include <windows.h>
 #endif
 
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <cstdio>
+#endif
+
 namespace massif {
 
 #ifdef __ANDROID__
@@ -39,45 +47,157 @@ namespace massif {
         OutputDebugStringA("\n");
     }
 #endif
+#if defined(__linux__) && !defined(__ANDROID__)
+    enum LogType { LOG_TYPE_FATAL, LOG_TYPE_ERROR, LOG_TYPE_WARNING, LOG_TYPE_INFO, LOG_TYPE_DEBUG };
+
+    static void OutputLog(LogType logType, const std::string& tag, const char* text) {
+        // stderr, so that the log never mixes with the output of a command line tool
+        static const char* const prefixes[] = { "F", "E", "W", "I", "D" };
+        std::fprintf(stderr, "%s/%s: %s\n", prefixes[logType], tag.c_str(), text);
+    }
+#endif
+
+    // Fixed size ring buffer of messages, written to the log by a background thread when asynchronous output is enabled.
+    // The message strings of the slots are reused, so queueing does not allocate once the buffer has warmed up.
+    class AsyncOutputQueue {
+    public:
+        static AsyncOutputQueue& GetInstance() {
+            static AsyncOutputQueue instance;
+            return instance;
+        }
+
+        void start() {
+            std::lock_guard<std::mutex> controlLock(_controlMutex);
+            if (_thread.joinable()) {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stopped = false;
+            }
+            _thread = std::thread(&AsyncOutputQueue::run, this);
+        }
+
+        void stop() {
+            std::lock_guard<std::mutex> controlLock(_controlMutex);
+            if (!_thread.joinable()) {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stopped = true;
+            }
+            _condition.notify_all();
+            _thread.join();
+        }
+
+        void flush() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _flushCondition.wait(lock, [this]() { return _stopped || (_count == 0 && _droppedCount == 0 && !_writing); });
+        }
+
+        void push(LogType logType, const char* message) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_count == _entries.size()) {
+                    _droppedCount++;
+                    return;
+                }
+                Entry& entry = _entries[(_head + _count) % _entries.size()];
+                entry.logType = logType;
+                entry.message.assign(message);
+                _count++;
+            }
+            _condition.notify_one();
+        }
+
+    private:
+        struct Entry {
+            LogType logType = LOG_TYPE_INFO;
+            std::string message;
+        };
+
+        AsyncOutputQueue() : _entries(CAPACITY), _head(0), _count(0), _droppedCount(0), _stopped(true), _writing(false), _thread(), _mutex(), _controlMutex(), _condition(), _flushCondition() {
+        }
+
+        ~AsyncOutputQueue() {
+            stop();
+        }
+
+        void run() {
+            LogType logType = LOG_TYPE_INFO;
+            std::string message;
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (true) {
+                _condition.wait(lock, [this]() { return _stopped || _count > 0 || _droppedCount > 0; });
+                if (_count > 0) {
+                    logType = _entries[_head].logType;
+                    message.assign(_entries[_head].message);
+                    _head = (_head + 1) % _entries.size();
+                    _count--;
+                } else if (_droppedCount > 0) {
+                    logType = LOG_TYPE_WARNING;
+                    message = "Log: " + std::to_string(_droppedCount) + " messages dropped";
+                    _droppedCount = 0;
+                } else {
+                    break;
+                }
+
+                _writing = true;
+                lock.unlock();
+                OutputLog(logType, Log::GetTag(), message.c_str());
+                lock.lock();
+                _writing = false;
+                _flushCondition.notify_all();
+            }
+            _flushCondition.notify_all();
+        }
+
+        static const std::size_t CAPACITY = 1024;
+
+        std::vector<Entry> _entries;
+        std::size_t _head;
+        std::size_t _count;
+        std::size_t _droppedCount;
+        bool _stopped;
+        bool _writing;
+        std::thread _thread;
+        std::mutex _mutex;
+        std::mutex _controlMutex;
+        std::condition_variable _condition;
+        std::condition_variable _flushCondition;
+    };
 
     bool Log::IsShowError() {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        return _ShowError;
+        return _ShowError.load();
     }
 
     void Log::SetShowError(bool showError) {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        _ShowError = showError;
+        _ShowError.store(showError);
     }
 
     bool Log::IsShowWarn() {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        return _ShowWarn;
+        return _ShowWarn.load();
     }
 
     void Log::SetShowWarn(bool showWarn) {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        _ShowWarn = showWarn;
+        _ShowWarn.store(showWarn);
     }
 
     bool Log::IsShowInfo() {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        return _ShowInfo;
+        return _ShowInfo.load();
     }
 
     void Log::SetShowInfo(bool showInfo) {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        _ShowInfo = showInfo;
+        _ShowInfo.store(showInfo);
     }
 
     bool Log::IsShowDebug() {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        return _ShowDebug;
+        return _ShowDebug.load();
     }
 
     void Log::SetShowDebug(bool showDebug) {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        _ShowDebug = showDebug;
+        _ShowDebug.store(showDebug);
     }
 
     std::string Log::GetTag() {
@@ -96,6 +216,22 @@ namespace massif {
     
     void Log::SetLogEventListener(const std::shared_ptr<LogEventListener>& listener) {
         _LogEventListener.set(listener);
+        _HasLogEventListener.store(static_cast<bool>(listener));
+    }
+
+    bool Log::IsAsyncOutput() {
+        return _AsyncOutput.load();
+    }
+
+    void Log::SetAsyncOutput(bool asyncOutput) {
+        // Start the writer before messages are queued, stop it only after they no longer are
+        if (asyncOutput) {
+            AsyncOutputQueue::GetInstance().start();
+            _AsyncOutput.store(true);
+        } else {
+            _AsyncOutput.store(false);
+            AsyncOutputQueue::GetInstance().stop();
+        }
     }
 
     void Log::Fatal(const char* message) {
@@ -106,6 +242,8 @@ namespace massif {
             }
         }
 
+        AsyncOutputQueue::GetInstance().flush(); // keep the messages preceding the fatal one
+
         std::lock_guard<std::mutex> lock(_Mutex);
         OutputLog(LOG_TYPE_FATAL, _Tag, message);
     }
@@ -118,10 +256,15 @@ namespace massif {
             }
         }
 
-        std::lock_guard<std::mutex> lock(_Mutex);
-        if (_ShowError) {
-            OutputLog(LOG_TYPE_ERROR, _Tag, message);
+        if (!_ShowError.load()) {
+            return;
         }
+        if (_AsyncOutput.load()) {
+            AsyncOutputQueue::GetInstance().push(LOG_TYPE_ERROR, message);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(_Mutex);
+        OutputLog(LOG_TYPE_ERROR, _Tag, message);
     }
 
     void Log::Warn(const char* message) {
@@ -132,10 +275,15 @@ namespace massif {
             }
         }
 
-        std::lock_guard<std::mutex> lock(_Mutex);
-        if (_ShowWarn) {
-            OutputLog(LOG_TYPE_WARNING, _Tag, message);
+        if (!_ShowWarn.load()) {
+            return;
+        }
+        if (_AsyncOutput.load()) {
+            AsyncOutputQueue::GetInstance().push(LOG_TYPE_WARNING, message);
+            return;
         }
+        std::lock_guard<std::mutex> lock(_Mutex);
+        OutputLog(LOG_TYPE_WARNING, _Tag, message);
     }
 
     void Log::Info(const char* message) {
@@ -146,10 +294,15 @@ namespace massif {
             }
         }
 
-        std::lock_guard<std::mutex> lock(_Mutex);
-        if (_ShowInfo) {
-            OutputLog(LOG_TYPE_INFO, _Tag, message);
+        if (!_ShowInfo.load()) {
+            return;
         }
+        if (_AsyncOutput.load()) {
+            AsyncOutputQueue::GetInstance().push(LOG_TYPE_INFO, message);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(_Mutex);
+        OutputLog(LOG_TYPE_INFO, _Tag, message);
     }
 
     void Log::Debug(const char* message) {
@@ -160,23 +313,30 @@ namespace massif {
             }
         }
 
-        std::lock_guard<std::mutex> lock(_Mutex);
-        if (_ShowDebug) {
-            OutputLog(LOG_TYPE_DEBUG, _Tag, message);
+        if (!_ShowDebug.load()) {
+            return;
+        }
+        if (_AsyncOutput.load()) {
+            AsyncOutputQueue::GetInstance().push(LOG_TYPE_DEBUG, message);
+            return;
         }
+        std::lock_guard<std::mutex> lock(_Mutex);
+        OutputLog(LOG_TYPE_DEBUG, _Tag, message);
     }
 
     Log::Log() {
     }
 
-    bool Log::_ShowError = true;
-    bool Log::_ShowWarn = true;
-    bool Log::_ShowInfo = true;
-    bool Log::_ShowDebug = false;
+    std::atomic<bool> Log::_ShowError(true);
+    std::atomic<bool> Log::_ShowWarn(true);
+    std::atomic<bool> Log::_ShowInfo(true);
+    std::atomic<bool> Log::_ShowDebug(false);
+    std::atomic<bool> Log::_AsyncOutput(false);
 
     std::string Log::_Tag = "massif";
 
     DirectorPtr<LogEventListener> Log::_LogEventListener;
+    std::atomic<bool> Log::_HasLogEventListener(false);
 
     std::mutex Log::_Mutex;
 
@@ -9,6 +9,7 @@
 
 #include "components/DirectorPtr.h"
 
+#include <atomic>
 #include <mutex>
 #include <string>
 #include <memory>
@@ -86,6 +87,20 @@ namespace massif {
          */
         static void SetLogEventListener(const std::shared_ptr<LogEventListener>& listener);
 
+        /**
+         * Returns the state of asynchronous log output.
+         * @return True if messages are written to the log by a background thread.
+         */
+        static bool IsAsyncOutput();
+        /**
+         * Enables or disables asynchronous log output. When enabled, messages are queued in a fixed size
+         * ring buffer and written to the log by a background thread, so logging threads do not wait for the
+         * system log. If the buffer is full, new messages are dropped and the number of dropped messages is logged later.
+         * The log event listener is still called on the logging thread. By default, asynchronous output is disabled.
+         * @param asyncOutput If true, messages will be written to the log asynchronously.
+         */
+        static void SetAsyncOutput(bool asyncOutput);
+
         /**
          * Logs specified fatal error message and terminates.
          * @param message The message to log.
@@ -113,6 +128,24 @@ namespace massif {
         static void Debug(const char* message);
 
 #ifndef SWIG
+        // Checks whether a message of the given level would reach the log or the log event listener.
+        // Lock-free, the LOG_*F macros below use these to skip formatting (and argument evaluation) of disabled levels.
+        static bool IsErrorEnabled() {
+            return _ShowError.load(std::memory_order_relaxed) || _HasLogEventListener.load(std::memory_order_relaxed);
+        }
+
+        static bool IsWarnEnabled() {
+            return _ShowWarn.load(std::memory_order_relaxed) || _HasLogEventListener.load(std::memory_order_relaxed);
+        }
+
+        static bool IsInfoEnabled() {
+            return _ShowInfo.load(std::memory_order_relaxed) || _HasLogEventListener.load(std::memory_order_relaxed);
+        }
+
+        static bool IsDebugEnabled() {
+            return _ShowDebug.load(std::memory_order_relaxed) || _HasLogEventListener.load(std::memory_order_relaxed);
+        }
+
         template <typename... Args>
         static void Fatalf(const char* formatString, const Args&... args) {
             std::string msg = tfm::format(formatString, args...);
@@ -121,24 +154,36 @@ namespace massif {
 
         template <typename... Args>
         static void Errorf(const char* formatString, const Args&... args) {
+            if (!IsErrorEnabled()) {
+                return;
+            }
             std::string msg = tfm::format(formatString, args...);
             Error(msg.c_str());
         }
 
         template <typename... Args>
         static void Warnf(const char* formatString, const Args&... args) {
+            if (!IsWarnEnabled()) {
+                return;
+            }
             std::string msg = tfm::format(formatString, args...);
             Warn(msg.c_str());
         }
 
         template <typename... Args>
         static void Infof(const char* formatString, const Args&... args) {
+            if (!IsInfoEnabled()) {
+                return;
+            }
             std::string msg = tfm::format(formatString, args...);
             Info(msg.c_str());
         }
 
         template <typename... Args>
         static void Debugf(const char* formatString, const Args&... args) {
+            if (!IsDebugEnabled()) {
+                return;
+            }
             std::string msg = tfm::format(formatString, args...);
             Debug(msg.c_str());
         }
@@ -147,18 +192,28 @@ namespace massif {
     private:
         Log();
 
-        static bool _ShowError;
-        static bool _ShowWarn;
-        static bool _ShowInfo;
-        static bool _ShowDebug;
+        static std::atomic<bool> _ShowError;
+        static std::atomic<bool> _ShowWarn;
+        static std::atomic<bool> _ShowInfo;
+        static std::atomic<bool> _ShowDebug;
+        static std::atomic<bool> _AsyncOutput;
 
         static std::string _Tag;
 
         static DirectorPtr<LogEventListener> _LogEventListener;
+        static std::atomic<bool> _HasLogEventListener;
 
         static std::mutex _Mutex;
     };
 
 }
 
+#ifndef SWIG
+// Level-gated logging: the arguments are evaluated only if the level is enabled
+#define LOG_ERRORF(...) do { if (massif::Log::IsErrorEnabled()) { massif::Log::Errorf(__VA_ARGS__); } } while (false)
+#define LOG_WARNF(...) do { if (massif::Log::IsWarnEnabled()) { massif::Log::Warnf(__VA_ARGS__); } } while (false)
+#define LOG_INFOF(...) do { if (massif::Log::IsInfoEnabled()) { massif::Log::Infof(__VA_ARGS__); } } while (false)
+#define LOG_DEBUGF(...) do { if (massif::Log::IsDebugEnabled()) { massif::Log::Debugf(__VA_ARGS__); } } while (false)
+#endif
+
 #endif
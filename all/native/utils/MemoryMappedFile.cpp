@@ -0,0 +1,67 @@
+#include "MemoryMappedFile.h"
+#include "utils/Log.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace massif {
+
+    MemoryMappedFile::MemoryMappedFile(const std::string& path) :
+        _data(nullptr),
+        _size(0)
+    {
+#if !defined(_WIN32)
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            Log::Warnf("MemoryMappedFile: Failed to open %s", path.c_str());
+            return;
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* ptr = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (ptr != MAP_FAILED) {
+                // Tile archives are read in small scattered pieces, readahead would only evict useful pages
+                ::madvise(ptr, static_cast<std::size_t>(st.st_size), MADV_RANDOM);
+                _data = static_cast<const std::uint8_t*>(ptr);
+                _size = static_cast<std::size_t>(st.st_size);
+            } else {
+                Log::Warnf("MemoryMappedFile: Failed to map %s", path.c_str());
+            }
+        }
+        ::close(fd); // the mapping keeps its own reference to the file
+#endif
+    }
+
+    MemoryMappedFile::~MemoryMappedFile() {
+#if !defined(_WIN32)
+        if (_data) {
+            ::munmap(const_cast<std::uint8_t*>(_data), _size);
+        }
+#endif
+    }
+
+    bool MemoryMappedFile::isOpen() const {
+        return _data != nullptr;
+    }
+
+    const std::uint8_t* MemoryMappedFile::data() const {
+        return _data;
+    }
+
+    std::size_t MemoryMappedFile::size() const {
+        return _size;
+    }
+
+    const std::uint8_t* MemoryMappedFile::range(std::uint64_t offset, std::uint64_t length) const {
+        if (!_data || offset > _size || length > _size - offset) {
+            return nullptr;
+        }
+        return _data + offset;
+    }
+
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _MASSIF_MEMORYMAPPEDFILE_H_
+#define _MASSIF_MEMORYMAPPEDFILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace massif {
+
+    /**
+     * A read-only memory mapping of a whole file. Reads from the mapping need no
+     * locking and no seek state, so any number of threads can read concurrently.
+     * Mapping is not available on every platform (WinRT): isOpen returns false there
+     * and the caller is expected to fall back to stream reads.
+     */
+    class MemoryMappedFile {
+    public:
+        explicit MemoryMappedFile(const std::string& path);
+        virtual ~MemoryMappedFile();
+
+        bool isOpen() const;
+
+        const std::uint8_t* data() const;
+        std::size_t size() const;
+
+        /**
+         * Returns a pointer to the given byte range, or null if the range is not inside the file.
+         */
+        const std::uint8_t* range(std::uint64_t offset, std::uint64_t length) const;
+
+    private:
+        MemoryMappedFile(const MemoryMappedFile&) = delete;
+        MemoryMappedFile& operator =(const MemoryMappedFile&) = delete;
+
+        const std::uint8_t* _data;
+        std::size_t _size;
+    };
+
+}
+
+#endif
@@ -20,7 +20,8 @@ namespace massif {
             PLATFORM_TYPE_WINDOWS,
             PLATFORM_TYPE_WINDOWS_PHONE,
             PLATFORM_TYPE_XAMARIN_IOS,
-            PLATFORM_TYPE_XAMARIN_ANDROID
+            PLATFORM_TYPE_XAMARIN_ANDROID,
+            PLATFORM_TYPE_LINUX
         };
     }
     
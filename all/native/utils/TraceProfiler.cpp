@@ -0,0 +1,166 @@
+#include "utils/TraceProfiler.h"
+
+#if MASSIF_FRAME_PROFILER
+
+#include "utils/Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef __ANDROID__
+#include <sys/system_properties.h>
+#endif
+
+namespace massif {
+
+    namespace {
+        // Events kept per thread. At 24 bytes each this is under 400 KB per thread, several seconds
+        // of a busy render thread.
+        const std::uint64_t EVENT_CAPACITY = 16384;
+
+        // Written by the owning thread only. The fields are atomics so that the export can read
+        // them concurrently; relaxed stores compile to plain stores.
+        struct Event {
+            std::atomic<const char*> name;
+            std::atomic<std::int64_t> startUs;
+            std::atomic<std::int64_t> durationUs;
+        };
+
+        struct ThreadBuffer {
+            int threadId;
+            std::atomic<const char*> threadName;
+            std::atomic<std::uint64_t> eventCount;
+            std::unique_ptr<Event[]> events;
+
+            explicit ThreadBuffer(int threadId) : threadId(threadId), threadName(nullptr), eventCount(0), events(new Event[EVENT_CAPACITY]) { }
+        };
+
+        // Buffers outlive their threads, so the events of a finished thread are still exported.
+        std::mutex BuffersMutex;
+        std::vector<std::shared_ptr<ThreadBuffer> > Buffers;
+
+        std::string LastDumpFileName;
+
+        ThreadBuffer& GetThreadBuffer() {
+            thread_local std::shared_ptr<ThreadBuffer> buffer;
+            if (!buffer) {
+                std::lock_guard<std::mutex> lock(BuffersMutex);
+                buffer = std::make_shared<ThreadBuffer>(static_cast<int>(Buffers.size()) + 1);
+                Buffers.push_back(buffer);
+            }
+            return *buffer;
+        }
+
+        void AppendJSONString(std::string& json, const char* str) {
+            json += '"';
+            for (const char* c = str; *c; c++) {
+                if (*c == '"' || *c == '\\') {
+                    json += '\\';
+                }
+                if (static_cast<unsigned char>(*c) >= 0x20) {
+                    json += *c;
+                }
+            }
+            json += '"';
+        }
+    }
+
+    void TraceProfiler::addEvent(const char* name, std::int64_t startUs, std::int64_t endUs) {
+        ThreadBuffer& buffer = GetThreadBuffer();
+        std::uint64_t index = buffer.eventCount.load(std::memory_order_relaxed);
+        Event& event = buffer.events[index % EVENT_CAPACITY];
+        event.name.store(name, std::memory_order_relaxed);
+        event.startUs.store(startUs, std::memory_order_relaxed);
+        event.durationUs.store(endUs - startUs, std::memory_order_relaxed);
+        buffer.eventCount.store(index + 1, std::memory_order_release);
+    }
+
+    void TraceProfiler::setThreadName(const char* name) {
+        GetThreadBuffer().threadName.store(name, std::memory_order_relaxed);
+    }
+
+    std::string TraceProfiler::getChromeTrace() {
+        std::vector<std::shared_ptr<ThreadBuffer> > buffers;
+        {
+            std::lock_guard<std::mutex> lock(BuffersMutex);
+            buffers = Buffers;
+        }
+
+        std::vector<std::string> elements;
+        char text[128];
+        for (const std::shared_ptr<ThreadBuffer>& buffer : buffers) {
+            if (const char* threadName = buffer->threadName.load(std::memory_order_relaxed)) {
+                std::snprintf(text, sizeof(text), "{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":", buffer->threadId);
+                std::string element = text;
+                AppendJSONString(element, threadName);
+                element += "}}";
+                elements.push_back(std::move(element));
+            }
+
+            std::uint64_t endIndex = buffer->eventCount.load(std::memory_order_acquire);
+            std::uint64_t startIndex = endIndex > EVENT_CAPACITY ? endIndex - EVENT_CAPACITY : 0;
+            std::vector<std::string> events;
+            events.reserve(static_cast<std::size_t>(endIndex - startIndex));
+            for (std::uint64_t i = startIndex; i < endIndex; i++) {
+                const Event& event = buffer->events[i % EVENT_CAPACITY];
+                std::snprintf(text, sizeof(text), "{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%lld,\"name\":", buffer->threadId, static_cast<long long>(event.startUs.load(std::memory_order_relaxed)), static_cast<long long>(event.durationUs.load(std::memory_order_relaxed)));
+                std::string element = text;
+                AppendJSONString(element, event.name.load(std::memory_order_relaxed));
+                element += '}';
+                events.push_back(std::move(element));
+            }
+
+            // Drop the events the thread overwrote while they were being read. The fence keeps the event
+            // reads above from moving past the count load. The writer may already be filling the slot of
+            // index currentCount, which overwrites the event currentCount - EVENT_CAPACITY.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            std::uint64_t currentCount = buffer->eventCount.load(std::memory_order_relaxed);
+            std::uint64_t validIndex = std::max(startIndex, currentCount + 1 > EVENT_CAPACITY ? currentCount + 1 - EVENT_CAPACITY : 0);
+            for (std::uint64_t i = validIndex; i < endIndex; i++) {
+                elements.push_back(std::move(events[static_cast<std::size_t>(i - startIndex)]));
+            }
+        }
+
+        std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        for (std::size_t i = 0; i < elements.size(); i++) {
+            if (i > 0) {
+                json += ',';
+            }
+            json += elements[i];
+        }
+        json += "]}";
+        return json;
+    }
+
+    bool TraceProfiler::writeChromeTrace(const std::string& fileName) {
+        std::string json = getChromeTrace();
+        std::ofstream stream(fileName, std::ios::binary);
+        stream << json;
+        stream.close();
+        if (!stream) {
+            Log::Errorf("TraceProfiler: Failed to write trace to %s", fileName);
+            return false;
+        }
+        LOG_INFOF("TraceProfiler: Wrote %d bytes of trace to %s", static_cast<int>(json.size()), fileName);
+        return true;
+    }
+
+    void TraceProfiler::pollDumpRequest() {
+#ifdef __ANDROID__
+        char property[PROP_VALUE_MAX] = { 0 };
+        if (__system_property_get("debug.massif.trace", property) <= 0 || LastDumpFileName == property) {
+            return;
+        }
+        LastDumpFileName = property;
+        writeChromeTrace(LastDumpFileName);
+#endif
+    }
+
+}
+
+#endif
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _MASSIF_TRACEPROFILER_H_
+#define _MASSIF_TRACEPROFILER_H_
+
+/**
+ * Timeline of what every thread was doing, exported as Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+ *
+ * FrameProfiler says how long the render thread sections took on average; a jank is one frame,
+ * and its cause is usually on another thread (a tile decode holding a lock, an elevation encode
+ * competing for the CPU). The trace keeps the individual events of all threads on one time axis.
+ *
+ * Each thread records into its own fixed size ring buffer, without locks: an event is two clock
+ * reads and a few relaxed stores. The oldest events are overwritten, so the buffers always hold
+ * the last few seconds. The export reads the buffers while they are written and drops the events
+ * that were overwritten meanwhile.
+ *
+ * It is part of the MASSIF_FRAME_PROFILER build (see FrameProfiler.h); otherwise the TRACE_*
+ * macros expand to nothing. The FRAME_PROF_ADD sections of the render thread are traced as well.
+ * On Android, 'adb shell setprop debug.massif.trace /sdcard/Android/data/<package>/files/trace.json'
+ * writes the trace to that file; set a different file name for the next dump.
+ */
+#ifndef MASSIF_FRAME_PROFILER
+#define MASSIF_FRAME_PROFILER 0
+#endif
+
+#if MASSIF_FRAME_PROFILER
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace massif {
+
+    struct TraceProfiler {
+        // Records a scope of the current thread as a complete event. 'name' must be a string literal.
+        class Scope {
+        public:
+            explicit Scope(const char* name) : _name(name), _startUs(now()) { }
+            ~Scope() { addEvent(_name, _startUs, now()); }
+
+        private:
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+            const char* _name;
+            std::int64_t _startUs;
+        };
+
+        static std::int64_t now() {
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // 'name' must be a string literal, only the pointer is stored.
+        static void addEvent(const char* name, std::int64_t startUs, std::int64_t endUs);
+        static void setThreadName(const char* name);
+
+        static std::string getChromeTrace();
+        static bool writeChromeTrace(const std::string& fileName);
+
+        // Called once a second from the render thread; writes the trace if a dump was requested.
+        static void pollDumpRequest();
+    };
+}
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) massif::TraceProfiler::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_THREAD_NAME(name) (massif::TraceProfiler::setThreadName(name))
+
+#else
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+
+#endif
+
+#endif
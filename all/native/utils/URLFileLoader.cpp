@@ -75,7 +75,7 @@ namespace massif {
     bool URLFileLoader::stream(const std::string& url, HandlerFunc handlerFn) const {
         // Check if http:// or https:// protocol is used
         if (url.substr(0, 7) == "http://" || url.substr(0, 8) == "https://") {
-            Log::Debugf("URLFileLoader: Streaming from network: %s", url.c_str());
+            LOG_DEBUGF("URLFileLoader: Streaming from network: %s", url.c_str());
             std::map<std::string, std::string> requestHeaders;
             std::map<std::string, std::string> responseHeaders;
             return NetworkUtils::StreamHTTPResponse("GET", url, requestHeaders, responseHeaders, [&](std::uint64_t offset, std::uint64_t length, const unsigned char* buf, std::size_t size) -> bool {
@@ -85,7 +85,7 @@ namespace massif {
         
         // Use synchronous loading for assets://
         if (url.substr(0, 9) == "assets://") {
-            Log::Debugf("URLFileLoader: Streaming asset: %s", url.c_str());
+            LOG_DEBUGF("URLFileLoader: Streaming asset: %s", url.c_str());
             std::shared_ptr<BinaryData> data = AssetUtils::LoadAsset(url.substr(9)); // TODO: stream asset
             if (!data) {
                 Log::Errorf("URLFileLoader: Failed to load %s", url.c_str());
@@ -97,7 +97,7 @@ namespace massif {
         // Local files? Only if explicitly enabled due to security reasons
         if (url.substr(0, 7) == "file://") {
             if (_localFiles) {
-                Log::Debugf("URLFileLoader: Streaming local file: %s", url.c_str());
+                LOG_DEBUGF("URLFileLoader: Streaming local file: %s", url.c_str());
                 FILE* fpRaw = utf8_filesystem::fopen(url.substr(7).c_str(), "rb");
                 if (!fpRaw) {
                     Log::Errorf("URLFileLoader: Failed to load %s", url.c_str());
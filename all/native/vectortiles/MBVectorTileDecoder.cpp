@@ -17,9 +17,11 @@
 #include "graphics/Bitmap.h"
 #include "styles/CompiledStyleSet.h"
 #include "styles/CartoCSSStyleSet.h"
+#include "vectortiles/NativeVectorTile.h"
 #include "vectortiles/utils/MVTGeometryConverter.h"
 #include "vectortiles/utils/MVTValueConverter.h"
 #include "vectortiles/utils/MVTLogger.h"
+#include "vectortiles/utils/NativeFeatureDecoder.h"
 #include "vectortiles/utils/VTBitmapLoader.h"
 #include "vectortiles/utils/CartoCSSAssetLoader.h"
 #include "utils/AssetPackage.h"
@@ -121,6 +123,34 @@ namespace massif {
             return std::get_if<std::shared_ptr<const mvt::ValueObject>>(&value) || std::get_if<std::shared_ptr<const mvt::ValueArray>>(&value);
         }
 
+        // The attributes straight from the tile's tag tables: a filter that reads one converts only that one
+        class MVTFeatureAttributes : public VectorTileDecoder::FeatureAttributes {
+        public:
+            explicit MVTFeatureAttributes(const std::shared_ptr<const mvt::FeatureData>& featureData) : _featureData(featureData) { }
+
+            virtual bool getAttribute(const std::string& name, Variant& value) const {
+                mvt::Value mvtValue;
+                if (!_featureData || !_featureData->getVariable(name, mvtValue)) {
+                    return false;
+                }
+                value = std::visit(MVTValueConverter(), mvtValue);
+                return true;
+            }
+
+            virtual Variant getAttributes() const {
+                std::map<std::string, Variant> attributes;
+                if (_featureData) {
+                    for (const std::pair<std::string, mvt::Value>& var : _featureData->getVariables()) {
+                        attributes[var.first] = std::visit(MVTValueConverter(), var.second);
+                    }
+                }
+                return Variant(attributes);
+            }
+
+        private:
+            const std::shared_ptr<const mvt::FeatureData>& _featureData;
+        };
+
         // Compiled maps, shared between decoders. Parsing and compiling a style is 0.5-0.7 s for a
         // 23-layer project, and an app that switches between two styles of one asset package - day
         // and night - or builds several layers from the same style, pays it every time otherwise.
@@ -696,36 +726,7 @@ namespace massif {
 
         try {
             std::shared_ptr<mvt::LayerFeatureDecoder> decoder = getCachedFeatureDecoder(tileData);
-
-            std::string mvtLayerName;
-            mvt::Feature mvtFeature;
-            if (!decoder->findFeature(id, mvtLayerName, mvtFeature)) {
-                return std::shared_ptr<VectorTileFeature>();
-            }
-
-            std::shared_ptr<const mvt::Geometry> mvtGeometry = mvtFeature.getGeometry();
-            if (!mvtGeometry) {
-                return std::shared_ptr<VectorTileFeature>();
-            }
-            std::shared_ptr<Geometry> geometry = std::visit(MVTGeometryConverter(tileBounds), *mvtGeometry);
-
-            Variant propertiesVariant;
-            std::map<std::string, Variant> featureData;
-            if (std::shared_ptr<const mvt::FeatureData> mvtFeatureData = mvtFeature.getFeatureData()) {
-                mvt::Value value;
-                if (mvtFeatureData->getVariable("$$properties$$", value)) {
-                    propertiesVariant = Variant::FromString(std::get<std::string>( value));
-                } else {
-                    for (const std::pair<std::string, mvt::Value>& var : mvtFeatureData->getVariables()) {
-                        featureData[var.first] = std::visit(MVTValueConverter(), var.second);
-                    }
-                    propertiesVariant = Variant(featureData);
-                }
-
-            }
-
-            auto feature = std::make_shared<VectorTileFeature>(mvtFeature.getId(), MapTile(tile.x, tile.y, tile.zoom, 0), mvtLayerName, geometry, propertiesVariant);
-            return feature;
+            return readFeature(*decoder, id, tile, tileBounds);
         }
         catch (const std::exception& ex) {
             Log::Errorf("MBVectorTileDecoder::decodeFeature: Exception while decoding: %s", ex.what());
@@ -739,42 +740,31 @@ namespace massif {
             return std::shared_ptr<VectorTileFeatureCollection>();
         }
 
-        std::vector<std::shared_ptr<VectorTileFeature> > tileFeatures;
         try {
             std::shared_ptr<mvt::LayerFeatureDecoder> decoder = getCachedFeatureDecoder(tileData);
-            std::vector<std::string> layers = decoder->getLayerNames();
-            if (onlyLayers.size() > 0) {
-                std::vector<std::string> result;
-                std::copy_if(onlyLayers.begin(), onlyLayers.end(), std::back_inserter(result), [&layers](std::string str) {
-                    return std::find(layers.begin(), layers.end(), str) != layers.end();
-                });
-                layers = result;
-            }
-            for (const std::string& mvtLayerName : layers) {
-                for (std::shared_ptr<mvt::FeatureDecoder::FeatureIterator> mvtIt = decoder->createLayerFeatureIterator(mvtLayerName, nullptr); mvtIt->valid(); mvtIt->advance()) {
-                    std::shared_ptr<const mvt::Geometry> mvtGeometry = mvtIt->getGeometry();
-                    if (!mvtGeometry) {
-                        continue;
-                    }
-                    std::shared_ptr<Geometry> geometry = std::visit(MVTGeometryConverter(tileBounds), *mvtGeometry);
+            return readFeatures(*decoder, tile, tileBounds, onlyLayers, nullptr);
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("MBVectorTileDecoder::decodeFeatures: Exception while decoding: %s", ex.what());
+        }
+        return std::shared_ptr<VectorTileFeatureCollection>();
+    }
 
-                    std::map<std::string, Variant> featureData;
-                    if (std::shared_ptr<const mvt::FeatureData> mvtFeatureData = mvtIt->getFeatureData(false, nullptr)) {
-                        for (const std::pair<std::string, mvt::Value>& var : mvtFeatureData->getVariables()) {
-                            featureData[var.first] = std::visit(MVTValueConverter(), var.second);
-                        }
-                    }
+    std::shared_ptr<VectorTileFeatureCollection> MBVectorTileDecoder::decodeFeatures(const vt::TileId& tile, const std::shared_ptr<BinaryData>& tileData, const MapBounds& tileBounds, const std::vector<std::string>& onlyLayers, const std::shared_ptr<const FeatureFilter>& filter) const {
+        if (!tileData) {
+            Log::Warn("MBVectorTileDecoder::decodeFeatures: Null tile data");
+            return std::shared_ptr<VectorTileFeatureCollection>();
+        }
 
-                    auto feature = std::make_shared<VectorTileFeature>(mvtIt->getFeatureId(), MapTile(tile.x, tile.y, tile.zoom, 0), mvtLayerName, geometry, Variant(featureData));
-                    tileFeatures.push_back(feature);
-                }
-            }
+        try {
+            // Not the cached decoder: filtered decoding walks many tiles once each and would only evict it
+            std::shared_ptr<mvt::LayerFeatureDecoder> decoder = createFeatureDecoder(tileData);
+            return readFeatures(*decoder, tile, tileBounds, onlyLayers, filter.get());
         }
         catch (const std::exception& ex) {
             Log::Errorf("MBVectorTileDecoder::decodeFeatures: Exception while decoding: %s", ex.what());
-            return std::shared_ptr<VectorTileFeatureCollection>();
         }
-        return std::make_shared<VectorTileFeatureCollection>(tileFeatures);
+        return std::shared_ptr<VectorTileFeatureCollection>();
     }
 
     std::shared_ptr<MBVectorTileDecoder::TileMap> MBVectorTileDecoder::decodeTile(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<vt::TileTransformer>& tileTransformer, const std::shared_ptr<BinaryData>& tileData) const {
@@ -783,6 +773,153 @@ namespace massif {
             return std::shared_ptr<TileMap>();
         }
 
+        try {
+            std::shared_ptr<mvt::LayerFeatureDecoder> decoder = createFeatureDecoder(tileData);
+            return readTile(*decoder, tile, targetTile, tileTransformer);
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("MBVectorTileDecoder::decodeTile: Exception while decoding: %s", ex.what());
+        }
+        return std::shared_ptr<TileMap>();
+    }
+
+    std::shared_ptr<VectorTileFeature> MBVectorTileDecoder::decodeFeature(long long id, const vt::TileId& tile, const std::shared_ptr<const NativeVectorTile>& nativeTile, const MapBounds& tileBounds) const {
+        if (!nativeTile) {
+            Log::Warn("MBVectorTileDecoder::decodeFeature: Null native tile");
+            return std::shared_ptr<VectorTileFeature>();
+        }
+
+        try {
+            NativeFeatureDecoder decoder(nativeTile);
+            return readFeature(decoder, id, tile, tileBounds);
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("MBVectorTileDecoder::decodeFeature: Exception while decoding: %s", ex.what());
+        }
+        return std::shared_ptr<VectorTileFeature>();
+    }
+
+    std::shared_ptr<VectorTileFeatureCollection> MBVectorTileDecoder::decodeFeatures(const vt::TileId& tile, const std::shared_ptr<const NativeVectorTile>& nativeTile, const MapBounds& tileBounds, const std::vector<std::string>& onlyLayers) const {
+        if (!nativeTile) {
+            Log::Warn("MBVectorTileDecoder::decodeFeatures: Null native tile");
+            return std::shared_ptr<VectorTileFeatureCollection>();
+        }
+
+        try {
+            NativeFeatureDecoder decoder(nativeTile);
+            return readFeatures(decoder, tile, tileBounds, onlyLayers, nullptr);
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("MBVectorTileDecoder::decodeFeatures: Exception while decoding: %s", ex.what());
+        }
+        return std::shared_ptr<VectorTileFeatureCollection>();
+    }
+
+    std::shared_ptr<VectorTileFeatureCollection> MBVectorTileDecoder::decodeFeatures(const vt::TileId& tile, const std::shared_ptr<const NativeVectorTile>& nativeTile, const MapBounds& tileBounds, const std::vector<std::string>& onlyLayers, const std::shared_ptr<const FeatureFilter>& filter) const {
+        if (!nativeTile) {
+            Log::Warn("MBVectorTileDecoder::decodeFeatures: Null native tile");
+            return std::shared_ptr<VectorTileFeatureCollection>();
+        }
+
+        try {
+            NativeFeatureDecoder decoder(nativeTile);
+            return readFeatures(decoder, tile, tileBounds, onlyLayers, filter.get());
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("MBVectorTileDecoder::decodeFeatures: Exception while decoding: %s", ex.what());
+        }
+        return std::shared_ptr<VectorTileFeatureCollection>();
+    }
+
+    std::shared_ptr<MBVectorTileDecoder::TileMap> MBVectorTileDecoder::decodeTile(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<vt::TileTransformer>& tileTransformer, const std::shared_ptr<const NativeVectorTile>& nativeTile) const {
+        if (!nativeTile) {
+            Log::Warn("MBVectorTileDecoder::decodeTile: Null native tile");
+            return std::shared_ptr<TileMap>();
+        }
+
+        try {
+            // The features are already decoded: the reader walks them as they are, nothing is inflated or parsed
+            NativeFeatureDecoder decoder(nativeTile);
+            return readTile(decoder, tile, targetTile, tileTransformer);
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("MBVectorTileDecoder::decodeTile: Exception while decoding: %s", ex.what());
+        }
+        return std::shared_ptr<TileMap>();
+    }
+
+    std::shared_ptr<VectorTileFeature> MBVectorTileDecoder::readFeature(mvt::LayerFeatureDecoder& decoder, long long id, const vt::TileId& tile, const MapBounds& tileBounds) const {
+        std::string mvtLayerName;
+        mvt::Feature mvtFeature;
+        if (!decoder.findFeature(id, mvtLayerName, mvtFeature)) {
+            return std::shared_ptr<VectorTileFeature>();
+        }
+
+        std::shared_ptr<const mvt::Geometry> mvtGeometry = mvtFeature.getGeometry();
+        if (!mvtGeometry) {
+            return std::shared_ptr<VectorTileFeature>();
+        }
+        std::shared_ptr<Geometry> geometry = std::visit(MVTGeometryConverter(tileBounds), *mvtGeometry);
+
+        Variant propertiesVariant;
+        std::map<std::string, Variant> featureData;
+        if (std::shared_ptr<const mvt::FeatureData> mvtFeatureData = mvtFeature.getFeatureData()) {
+            mvt::Value value;
+            if (mvtFeatureData->getVariable("$$properties$$", value)) {
+                propertiesVariant = Variant::FromString(std::get<std::string>( value));
+            } else {
+                for (const std::pair<std::string, mvt::Value>& var : mvtFeatureData->getVariables()) {
+                    featureData[var.first] = std::visit(MVTValueConverter(), var.second);
+                }
+                propertiesVariant = Variant(featureData);
+            }
+
+        }
+
+        return std::make_shared<VectorTileFeature>(mvtFeature.getId(), MapTile(tile.x, tile.y, tile.zoom, 0), mvtLayerName, geometry, propertiesVariant);
+    }
+
+    std::shared_ptr<VectorTileFeatureCollection> MBVectorTileDecoder::readFeatures(mvt::LayerFeatureDecoder& decoder, const vt::TileId& tile, const MapBounds& tileBounds, const std::vector<std::string>& onlyLayers, const FeatureFilter* filter) const {
+        std::vector<std::shared_ptr<VectorTileFeature> > tileFeatures;
+        std::vector<std::string> layers = decoder.getLayerNames();
+        if (onlyLayers.size() > 0) {
+            std::vector<std::string> result;
+            std::copy_if(onlyLayers.begin(), onlyLayers.end(), std::back_inserter(result), [&layers](std::string str) {
+                return std::find(layers.begin(), layers.end(), str) != layers.end();
+            });
+            layers = result;
+        }
+        for (const std::string& mvtLayerName : layers) {
+            if (filter && !filter->testLayer(mvtLayerName)) {
+                continue;
+            }
+            for (std::shared_ptr<mvt::FeatureDecoder::FeatureIterator> mvtIt = decoder.createLayerFeatureIterator(mvtLayerName, nullptr); mvtIt->valid(); mvtIt->advance()) {
+                std::shared_ptr<const mvt::FeatureData> mvtFeatureData = mvtIt->getFeatureData(false, nullptr);
+                if (filter && !filter->testFeature(mvtLayerName, MVTFeatureAttributes(mvtFeatureData))) {
+                    continue;
+                }
+
+                std::shared_ptr<const mvt::Geometry> mvtGeometry = mvtIt->getGeometry();
+                if (!mvtGeometry) {
+                    continue;
+                }
+                std::shared_ptr<Geometry> geometry = std::visit(MVTGeometryConverter(tileBounds), *mvtGeometry);
+
+                std::map<std::string, Variant> featureData;
+                if (mvtFeatureData) {
+                    for (const std::pair<std::string, mvt::Value>& var : mvtFeatureData->getVariables()) {
+                        featureData[var.first] = std::visit(MVTValueConverter(), var.second);
+                    }
+                }
+
+                auto feature = std::make_shared<VectorTileFeature>(mvtIt->getFeatureId(), MapTile(tile.x, tile.y, tile.zoom, 0), mvtLayerName, geometry, Variant(featureData));
+                tileFeatures.push_back(feature);
+            }
+        }
+        return std::make_shared<VectorTileFeatureCollection>(tileFeatures);
+    }
+
+    std::shared_ptr<MBVectorTileDecoder::TileMap> MBVectorTileDecoder::readTile(mvt::LayerFeatureDecoder& decoder, const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<vt::TileTransformer>& tileTransformer) const {
         std::shared_ptr<const mvt::Map> map;
         std::shared_ptr<const mvt::SymbolizerContext> symbolizerContext;
         bool featureIdOverride;
@@ -795,22 +932,16 @@ namespace massif {
             layerNameOverride = _layerNameOverride;
         }
     
-        try {
-            std::shared_ptr<mvt::LayerFeatureDecoder> decoder = createFeatureDecoder(tileData);
-            decoder->setTransform(calculateTileTransform(tile, targetTile));
-            decoder->setFeatureIdOverride(featureIdOverride, MapTile(tile.x, tile.y, tile.zoom, 0).getTileId());
+        decoder.setTransform(calculateTileTransform(tile, targetTile));
+        decoder.setFeatureIdOverride(featureIdOverride, MapTile(tile.x, tile.y, tile.zoom, 0).getTileId());
 
-            mvt::LayerTileReader reader(map, tileTransformer, *symbolizerContext, *decoder, _logger);
-            reader.setLayerNameOverride(layerNameOverride);
+        mvt::LayerTileReader reader(map, tileTransformer, *symbolizerContext, decoder, _logger);
+        reader.setLayerNameOverride(layerNameOverride);
 
-            if (std::shared_ptr<vt::Tile> tile = reader.readTile(targetTile)) {
-                auto tileMap = std::make_shared<TileMap>();
-                (*tileMap)[0] = tile;
-                return tileMap;
-            }
-        }
-        catch (const std::exception& ex) {
-            Log::Errorf("MBVectorTileDecoder::decodeTile: Exception while decoding: %s", ex.what());
+        if (std::shared_ptr<vt::Tile> tile = reader.readTile(targetTile)) {
+            auto tileMap = std::make_shared<TileMap>();
+            (*tileMap)[0] = tile;
+            return tileMap;
         }
         return std::shared_ptr<TileMap>();
     }
@@ -245,7 +245,17 @@ namespace massif {
 
         virtual std::shared_ptr<VectorTileFeatureCollection> decodeFeatures(const vt::TileId& tile, const std::shared_ptr<BinaryData>& tileData, const MapBounds& tileBounds, const std::vector<std::string>& onlyLayers) const;
 
+        virtual std::shared_ptr<VectorTileFeatureCollection> decodeFeatures(const vt::TileId& tile, const std::shared_ptr<BinaryData>& tileData, const MapBounds& tileBounds, const std::vector<std::string>& onlyLayers, const std::shared_ptr<const FeatureFilter>& filter) const;
+
         virtual std::shared_ptr<TileMap> decodeTile(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<vt::TileTransformer>& tileTransformer, const std::shared_ptr<BinaryData>& tileData) const;
+
+        virtual std::shared_ptr<VectorTileFeature> decodeFeature(long long id, const vt::TileId& tile, const std::shared_ptr<const NativeVectorTile>& nativeTile, const MapBounds& tileBounds) const;
+
+        virtual std::shared_ptr<VectorTileFeatureCollection> decodeFeatures(const vt::TileId& tile, const std::shared_ptr<const NativeVectorTile>& nativeTile, const MapBounds& tileBounds, const std::vector<std::string>& onlyLayers) const;
+
+        virtual std::shared_ptr<VectorTileFeatureCollection> decodeFeatures(const vt::TileId& tile, const std::shared_ptr<const NativeVectorTile>& nativeTile, const MapBounds& tileBounds, const std::vector<std::string>& onlyLayers, const std::shared_ptr<const FeatureFilter>& filter) const;
+
+        virtual std::shared_ptr<TileMap> decodeTile(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<vt::TileTransformer>& tileTransformer, const std::shared_ptr<const NativeVectorTile>& nativeTile) const;
     
     protected:
         void updateCurrentStyleSet(const std::variant<std::shared_ptr<CompiledStyleSet>, std::shared_ptr<CartoCSSStyleSet> >& styleSet);
@@ -292,6 +302,12 @@ namespace massif {
         std::shared_ptr<mvt::LayerFeatureDecoder> getCachedFeatureDecoder(const std::shared_ptr<BinaryData>& tileData) const;
 
         mutable std::pair<std::shared_ptr<BinaryData>, std::shared_ptr<mvt::LayerFeatureDecoder> > _cachedFeatureDecoder;
+
+        // The decodeFeature(s)/decodeTile bodies, shared by binary and in-memory tiles: they differ only in the feature decoder
+        std::shared_ptr<VectorTileFeature> readFeature(mvt::LayerFeatureDecoder& decoder, long long id, const vt::TileId& tile, const MapBounds& tileBounds) const;
+        // With a filter, the attributes of each feature are tested before its geometry is decoded
+        std::shared_ptr<VectorTileFeatureCollection> readFeatures(mvt::LayerFeatureDecoder& decoder, const vt::TileId& tile, const MapBounds& tileBounds, const std::vector<std::string>& onlyLayers, const FeatureFilter* filter) const;
+        std::shared_ptr<TileMap> readTile(mvt::LayerFeatureDecoder& decoder, const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<vt::TileTransformer>& tileTransformer) const;
     
         mutable std::mutex _mutex;
     };
@@ -0,0 +1,74 @@
+#include "NativeVectorTile.h"
+
+#include <algorithm>
+
+namespace {
+
+    struct GeometryVertexCounter {
+        std::size_t operator() (const massif::mvt::PointGeometry& point) const {
+            return point.getVertices().size();
+        }
+
+        std::size_t operator() (const massif::mvt::LineGeometry& line) const {
+            std::size_t count = 0;
+            for (const auto& vertices : line.getVerticesList()) {
+                count += vertices.size();
+            }
+            return count;
+        }
+
+        std::size_t operator() (const massif::mvt::PolygonGeometry& polygon) const {
+            std::size_t count = 0;
+            for (const auto& verticesList : polygon.getPolygonList()) {
+                for (const auto& vertices : verticesList) {
+                    count += vertices.size();
+                }
+            }
+            return count;
+        }
+    };
+
+}
+
+namespace massif {
+
+    NativeVectorTile::NativeVectorTile() :
+        _layers(),
+        _dataSize(0)
+    {
+    }
+
+    NativeVectorTile::NativeVectorTile(std::vector<Layer> layers) :
+        _layers(std::move(layers)),
+        _dataSize(0)
+    {
+        // Feature data is usually shared between features of the same attributes, so count it as
+        // a pointer; the vertices are what the tile actually holds.
+        for (const Layer& layer : _layers) {
+            _dataSize += sizeof(Layer) + layer.name.size();
+            for (const Feature& feature : layer.features) {
+                _dataSize += sizeof(Feature);
+                if (feature.geometry) {
+                    _dataSize += std::visit(GeometryVertexCounter(), *feature.geometry) * sizeof(float) * 2;
+                }
+            }
+        }
+    }
+
+    NativeVectorTile::~NativeVectorTile() {
+    }
+
+    const std::vector<NativeVectorTile::Layer>& NativeVectorTile::getLayers() const {
+        return _layers;
+    }
+
+    const NativeVectorTile::Layer* NativeVectorTile::getLayer(const std::string& name) const {
+        auto it = std::find_if(_layers.begin(), _layers.end(), [&name](const Layer& layer) { return layer.name == name; });
+        return it != _layers.end() ? &*it : nullptr;
+    }
+
+    std::size_t NativeVectorTile::getDataSize() const {
+        return _dataSize;
+    }
+
+}
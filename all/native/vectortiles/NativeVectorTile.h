@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _MASSIF_NATIVEVECTORTILE_H_
+#define _MASSIF_NATIVEVECTORTILE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mapnikvt/Geometry.h>
+#include <mapnikvt/FeatureData.h>
+
+namespace massif {
+
+    /**
+     * A vector tile held as features in memory rather than as an encoded blob. Data sources that
+     * generate their features (contours, GeoJSON) return it with their tile data, and the decoder
+     * reads it as is - nothing is encoded to protobuf and parsed back on the way to the renderer.
+     *
+     * Coordinates are tile-local, as the MVT decoders produce them: (0, 0) is the north-west corner
+     * of the tile and (1, 1) the south-east corner. The tile is immutable once built, so it can be
+     * shared between caches and decoder threads without locking.
+     */
+    class NativeVectorTile {
+    public:
+        struct Feature {
+            long long id;
+            std::shared_ptr<const mvt::Geometry> geometry;
+            std::shared_ptr<const mvt::FeatureData> featureData;
+
+            Feature(long long id, std::shared_ptr<const mvt::Geometry> geometry, std::shared_ptr<const mvt::FeatureData> featureData) : id(id), geometry(std::move(geometry)), featureData(std::move(featureData)) { }
+        };
+
+        struct Layer {
+            std::string name;
+            std::vector<Feature> features;
+
+            explicit Layer(std::string name) : name(std::move(name)), features() { }
+        };
+
+        NativeVectorTile();
+        explicit NativeVectorTile(std::vector<Layer> layers);
+        virtual ~NativeVectorTile();
+
+        /**
+         * Returns the layers of the tile, in the order they were added.
+         * @return The layers of the tile.
+         */
+        const std::vector<Layer>& getLayers() const;
+        /**
+         * Returns the layer with the given name.
+         * @param name The name of the layer.
+         * @return The layer, or null if the tile has no such layer.
+         */
+        const Layer* getLayer(const std::string& name) const;
+
+        /**
+         * Returns the approximate memory footprint of the tile, for cache accounting.
+         * @return The footprint in bytes.
+         */
+        std::size_t getDataSize() const;
+
+    private:
+        std::vector<Layer> _layers;
+        std::size_t _dataSize;
+    };
+
+}
+
+#endif
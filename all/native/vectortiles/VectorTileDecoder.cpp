@@ -1,15 +1,50 @@
 #include "VectorTileDecoder.h"
+#include "core/Variant.h"
+#include "geometry/VectorTileFeature.h"
+#include "geometry/VectorTileFeatureCollection.h"
 
 #include <vt/TileId.h>
 
 #include <algorithm>
 
+namespace {
+
+    class VariantFeatureAttributes : public massif::VectorTileDecoder::FeatureAttributes {
+    public:
+        explicit VariantFeatureAttributes(const massif::Variant& properties) : _properties(properties) { }
+
+        virtual bool getAttribute(const std::string& name, massif::Variant& value) const {
+            if (_properties.getType() != massif::VariantType::VARIANT_TYPE_OBJECT || !_properties.containsObjectKey(name)) {
+                return false;
+            }
+            value = _properties.getObjectElement(name);
+            return true;
+        }
+
+        virtual massif::Variant getAttributes() const {
+            return _properties;
+        }
+
+    private:
+        const massif::Variant& _properties;
+    };
+
+}
+
 namespace massif {
 
     VectorTileDecoder::~VectorTileDecoder()
     {
     }
 
+    std::shared_ptr<VectorTileFeatureCollection> VectorTileDecoder::decodeFeatures(const vt::TileId& tile, const std::shared_ptr<BinaryData>& tileData, const MapBounds& tileBounds, const std::vector<std::string>& onlyLayers, const std::shared_ptr<const FeatureFilter>& filter) const {
+        return filterFeatures(decodeFeatures(tile, tileData, tileBounds, onlyLayers), filter);
+    }
+
+    std::shared_ptr<VectorTileFeatureCollection> VectorTileDecoder::decodeFeatures(const vt::TileId& tile, const std::shared_ptr<const NativeVectorTile>& nativeTile, const MapBounds& tileBounds, const std::vector<std::string>& onlyLayers, const std::shared_ptr<const FeatureFilter>& filter) const {
+        return filterFeatures(decodeFeatures(tile, nativeTile, tileBounds, onlyLayers), filter);
+    }
+
     void VectorTileDecoder::notifyDecoderChanged() {
         std::vector<std::shared_ptr<OnChangeListener> > onChangeListeners;
         {
@@ -56,4 +91,19 @@ namespace massif {
         return cglib::translate3_matrix(cglib::vec3<float>(-x, -y, 1)) * cglib::scale3_matrix(cglib::vec3<float>(s, s, 1));
     }
 
+    std::shared_ptr<VectorTileFeatureCollection> VectorTileDecoder::filterFeatures(const std::shared_ptr<VectorTileFeatureCollection>& featureCollection, const std::shared_ptr<const FeatureFilter>& filter) {
+        if (!featureCollection || !filter) {
+            return featureCollection;
+        }
+
+        std::vector<std::shared_ptr<VectorTileFeature> > features;
+        for (int i = 0; i < featureCollection->getFeatureCount(); i++) {
+            const std::shared_ptr<VectorTileFeature>& feature = featureCollection->getFeature(i);
+            if (filter->testLayer(feature->getLayerName()) && filter->testFeature(feature->getLayerName(), VariantFeatureAttributes(feature->getProperties()))) {
+                features.push_back(feature);
+            }
+        }
+        return std::make_shared<VectorTileFeatureCollection>(features);
+    }
+
 }
@@ -28,6 +28,8 @@ namespace massif {
     }
 
     class BinaryData;
+    class NativeVectorTile;
+    class Variant;
     class VectorTileFeature;
     class VectorTileFeatureCollection;
     class MapBounds;
@@ -57,6 +59,50 @@ namespace massif {
              */
             virtual void onDecoderRefreshed() { onDecoderChanged(); }
         };
+
+        /**
+         * Read access to the attributes of a feature whose geometry has not been decoded yet.
+         */
+        struct FeatureAttributes {
+            virtual ~FeatureAttributes() { }
+
+            /**
+             * Looks up a single attribute, converting only that one.
+             * @param name The name of the attribute.
+             * @param value The attribute value, used as an output parameter.
+             * @return True if the feature has the attribute, false otherwise.
+             */
+            virtual bool getAttribute(const std::string& name, Variant& value) const = 0;
+
+            /**
+             * Converts all attributes of the feature.
+             * @return The attributes as an object variant.
+             */
+            virtual Variant getAttributes() const = 0;
+        };
+
+        /**
+         * Interface for rejecting features from their layer and attributes, before their geometries are decoded.
+         * Filters are called from the decoding thread and must not modify shared state.
+         */
+        struct FeatureFilter {
+            virtual ~FeatureFilter() { }
+
+            /**
+             * Tests whether any feature of the specified layer can pass the filter.
+             * @param layerName The name of the layer.
+             * @return False if the whole layer can be skipped, true otherwise.
+             */
+            virtual bool testLayer(const std::string& layerName) const { return true; }
+
+            /**
+             * Tests whether the specified feature can pass the filter.
+             * @param layerName The name of the layer of the feature.
+             * @param attributes The attributes of the feature.
+             * @return False if the feature can be skipped, true otherwise.
+             */
+            virtual bool testFeature(const std::string& layerName, const FeatureAttributes& attributes) const = 0;
+        };
     
         virtual ~VectorTileDecoder();
     
@@ -117,6 +163,19 @@ namespace massif {
          */
         virtual std::shared_ptr<VectorTileFeatureCollection> decodeFeatures(const vt::TileId& tile, const std::shared_ptr<BinaryData>& tileData, const MapBounds& tileBounds, const std::vector<std::string>& onlyLayers) const = 0;
 
+        /**
+         * Decodes the features from the tile that pass the specified filter.
+         * The default implementation decodes all features and filters them afterwards,
+         * decoders that can read the attributes separately skip the geometries of the rejected features.
+         * @param tile The tile coordinates.
+         * @param tileData The tile data to use.
+         * @param tileBounds The bounds for the tile (used for coordinate transformation).
+         * @param onlyLayers layers to filter (can be much faster)
+         * @param filter The feature filter to apply. Can be null.
+         * @return The list of tile features.
+         */
+        virtual std::shared_ptr<VectorTileFeatureCollection> decodeFeatures(const vt::TileId& tile, const std::shared_ptr<BinaryData>& tileData, const MapBounds& tileBounds, const std::vector<std::string>& onlyLayers, const std::shared_ptr<const FeatureFilter>& filter) const;
+
         /**
          * Loads the specified vector tile.
          * @param tile The id of the tile to load.
@@ -125,6 +184,48 @@ namespace massif {
          * @return The vector tile data, for each frame. If the tile is not available, null is returned.
          */
         virtual std::shared_ptr<TileMap> decodeTile(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<vt::TileTransformer>& tileTransformer, const std::shared_ptr<BinaryData>& tileData) const = 0;
+
+        /**
+         * Decodes the specified feature from an in-memory tile. Decoders that only read binary tiles do not find any.
+         * @param id The id of the feature to decode.
+         * @param tile The tile coordinates.
+         * @param nativeTile The in-memory tile to use.
+         * @param tileBounds The bounds for the tile (used for coordinate transformation).
+         * @return The feature, if found. Null if not found.
+         */
+        virtual std::shared_ptr<VectorTileFeature> decodeFeature(long long id, const vt::TileId& tile, const std::shared_ptr<const NativeVectorTile>& nativeTile, const MapBounds& tileBounds) const { return std::shared_ptr<VectorTileFeature>(); }
+
+        /**
+         * Decodes all features from an in-memory tile. Decoders that only read binary tiles return null.
+         * @param tile The tile coordinates.
+         * @param nativeTile The in-memory tile to use.
+         * @param tileBounds The bounds for the tile (used for coordinate transformation).
+         * @param onlyLayers layers to filter
+         * @return The list of tile features.
+         */
+        virtual std::shared_ptr<VectorTileFeatureCollection> decodeFeatures(const vt::TileId& tile, const std::shared_ptr<const NativeVectorTile>& nativeTile, const MapBounds& tileBounds, const std::vector<std::string>& onlyLayers) const { return std::shared_ptr<VectorTileFeatureCollection>(); }
+
+        /**
+         * Decodes the features from an in-memory tile that pass the specified filter.
+         * The default implementation decodes all features and filters them afterwards.
+         * @param tile The tile coordinates.
+         * @param nativeTile The in-memory tile to use.
+         * @param tileBounds The bounds for the tile (used for coordinate transformation).
+         * @param onlyLayers layers to filter
+         * @param filter The feature filter to apply. Can be null.
+         * @return The list of tile features.
+         */
+        virtual std::shared_ptr<VectorTileFeatureCollection> decodeFeatures(const vt::TileId& tile, const std::shared_ptr<const NativeVectorTile>& nativeTile, const MapBounds& tileBounds, const std::vector<std::string>& onlyLayers, const std::shared_ptr<const FeatureFilter>& filter) const;
+
+        /**
+         * Loads the specified vector tile from an in-memory tile, without the binary encoding in between.
+         * Decoders that only read binary tiles return null.
+         * @param tile The id of the tile to load.
+         * @param targetTile The target tile id that will be created from the data.
+         * @param nativeTile The in-memory tile to decode.
+         * @return The vector tile data, for each frame. If the tile is not available, null is returned.
+         */
+        virtual std::shared_ptr<TileMap> decodeTile(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<vt::TileTransformer>& tileTransformer, const std::shared_ptr<const NativeVectorTile>& nativeTile) const { return std::shared_ptr<TileMap>(); }
     
         /**
          * Notifies listeners that the decoder parameters have changed. Action taken depends on the implementation of the
@@ -149,6 +250,8 @@ namespace massif {
         VectorTileDecoder();
 
         static cglib::mat3x3<float> calculateTileTransform(const massif::vt::TileId& tileId, const massif::vt::TileId& targetTileId);
+
+        static std::shared_ptr<VectorTileFeatureCollection> filterFeatures(const std::shared_ptr<VectorTileFeatureCollection>& featureCollection, const std::shared_ptr<const FeatureFilter>& filter);
         
     private:
         std::vector<std::shared_ptr<OnChangeListener> > _onChangeListeners;
@@ -20,7 +20,7 @@ namespace massif {
         virtual void write(Severity severity, const std::string& msg) {
             switch (severity) {
             case Severity::INFO:
-                Log::Infof("%s: %s", _tag.c_str(), msg.c_str());
+                LOG_INFOF("%s: %s", _tag.c_str(), msg.c_str());
                 break;
             case Severity::WARNING:
                 Log::Warnf("%s: %s", _tag.c_str(), msg.c_str());
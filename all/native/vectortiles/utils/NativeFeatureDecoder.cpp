@@ -0,0 +1,152 @@
+#include "NativeFeatureDecoder.h"
+#include "vectortiles/NativeVectorTile.h"
+
+#include <utility>
+
+namespace {
+
+    struct GeometryTransformer {
+        explicit GeometryTransformer(const cglib::mat3x3<float>& transform) : _transform(transform) { }
+
+        massif::mvt::Geometry operator() (const massif::mvt::PointGeometry& point) const {
+            return massif::mvt::PointGeometry(transformVertices(point.getVertices()));
+        }
+
+        massif::mvt::Geometry operator() (const massif::mvt::LineGeometry& line) const {
+            std::vector<std::vector<cglib::vec2<float> > > verticesList;
+            verticesList.reserve(line.getVerticesList().size());
+            for (const std::vector<cglib::vec2<float> >& vertices : line.getVerticesList()) {
+                verticesList.push_back(transformVertices(vertices));
+            }
+            return massif::mvt::LineGeometry(std::move(verticesList));
+        }
+
+        massif::mvt::Geometry operator() (const massif::mvt::PolygonGeometry& polygon) const {
+            std::vector<std::vector<std::vector<cglib::vec2<float> > > > polygonList;
+            polygonList.reserve(polygon.getPolygonList().size());
+            for (const std::vector<std::vector<cglib::vec2<float> > >& rings : polygon.getPolygonList()) {
+                std::vector<std::vector<cglib::vec2<float> > > verticesList;
+                verticesList.reserve(rings.size());
+                for (const std::vector<cglib::vec2<float> >& vertices : rings) {
+                    verticesList.push_back(transformVertices(vertices));
+                }
+                polygonList.push_back(std::move(verticesList));
+            }
+            return massif::mvt::PolygonGeometry(std::move(polygonList));
+        }
+
+    private:
+        std::vector<cglib::vec2<float> > transformVertices(const std::vector<cglib::vec2<float> >& vertices) const {
+            std::vector<cglib::vec2<float> > result;
+            result.reserve(vertices.size());
+            for (const cglib::vec2<float>& v : vertices) {
+                result.emplace_back(_transform(0, 0) * v(0) + _transform(0, 1) * v(1) + _transform(0, 2),
+                                    _transform(1, 0) * v(0) + _transform(1, 1) * v(1) + _transform(1, 2));
+            }
+            return result;
+        }
+
+        const cglib::mat3x3<float>& _transform;
+    };
+
+}
+
+namespace massif {
+
+    class NativeFeatureDecoder::NativeFeatureIterator : public mvt::FeatureDecoder::FeatureIterator {
+    public:
+        NativeFeatureIterator(const NativeFeatureDecoder& decoder, const NativeVectorTile::Layer* layer, std::size_t firstIndex) : _decoder(decoder), _layer(layer), _firstIndex(firstIndex), _index(0) { }
+
+        virtual bool valid() const {
+            return _layer && _index < _layer->features.size();
+        }
+
+        virtual void advance() {
+            _index++;
+        }
+
+        virtual long long getFeatureId() const {
+            return _decoder.getFeatureId(_layer->features[_index].id, _firstIndex + _index);
+        }
+
+        virtual std::shared_ptr<const mvt::FeatureData> getFeatureData(bool geometryTypeOnly, const std::set<std::string>* fields) const {
+            // Kept whole: the data is shared with the tile, so subsetting it would only cost a copy.
+            return _layer->features[_index].featureData;
+        }
+
+        virtual std::shared_ptr<const mvt::Geometry> getGeometry() const {
+            return _decoder.transformGeometry(_layer->features[_index].geometry);
+        }
+
+    private:
+        const NativeFeatureDecoder& _decoder;
+        const NativeVectorTile::Layer* _layer;
+        std::size_t _firstIndex;
+        std::size_t _index;
+    };
+
+    NativeFeatureDecoder::NativeFeatureDecoder(const std::shared_ptr<const NativeVectorTile>& tile) :
+        mvt::LayerFeatureDecoder(),
+        _tile(tile)
+    {
+    }
+
+    NativeFeatureDecoder::~NativeFeatureDecoder() {
+    }
+
+    std::vector<std::string> NativeFeatureDecoder::getLayerNames() const {
+        std::vector<std::string> layerNames;
+        layerNames.reserve(_tile->getLayers().size());
+        for (const NativeVectorTile::Layer& layer : _tile->getLayers()) {
+            layerNames.push_back(layer.name);
+        }
+        return layerNames;
+    }
+
+    bool NativeFeatureDecoder::hasLayer(const std::string& name) const {
+        return _tile->getLayer(name) != nullptr;
+    }
+
+    bool NativeFeatureDecoder::findFeature(long long id, std::string& layerName, mvt::Feature& feature) const {
+        std::size_t index = 0;
+        for (const NativeVectorTile::Layer& layer : _tile->getLayers()) {
+            for (const NativeVectorTile::Feature& nativeFeature : layer.features) {
+                if (getFeatureId(nativeFeature.id, index++) == id) {
+                    layerName = layer.name;
+                    feature = mvt::Feature(id, transformGeometry(nativeFeature.geometry), nativeFeature.featureData);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    std::shared_ptr<mvt::FeatureDecoder::FeatureIterator> NativeFeatureDecoder::createLayerFeatureIterator(const std::string& name, const std::set<std::string>* fields) const {
+        // Overridden ids number the features through all layers, so the walk has to know where its layer starts.
+        std::size_t firstIndex = 0;
+        for (const NativeVectorTile::Layer& layer : _tile->getLayers()) {
+            if (layer.name == name) {
+                return std::make_shared<NativeFeatureIterator>(*this, &layer, firstIndex);
+            }
+            firstIndex += layer.features.size();
+        }
+        return std::make_shared<NativeFeatureIterator>(*this, nullptr, firstIndex);
+    }
+
+    long long NativeFeatureDecoder::getFeatureId(long long id, std::size_t index) const {
+        if (_featureIdOverride) {
+            return _tileIdOffset * FEATURE_ID_TILE_STRIDE + static_cast<long long>(index);
+        }
+        return id;
+    }
+
+    std::shared_ptr<const mvt::Geometry> NativeFeatureDecoder::transformGeometry(const std::shared_ptr<const mvt::Geometry>& geometry) const {
+        if (!geometry || _transform == cglib::mat3x3<float>::identity()) {
+            return geometry;
+        }
+        return std::make_shared<const mvt::Geometry>(std::visit(GeometryTransformer(_transform), *geometry));
+    }
+
+    const long long NativeFeatureDecoder::FEATURE_ID_TILE_STRIDE = 1LL << 20;
+
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _MASSIF_NATIVEFEATUREDECODER_H_
+#define _MASSIF_NATIVEFEATUREDECODER_H_
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <mapnikvt/Feature.h>
+#include <mapnikvt/FeatureDecoder.h>
+
+namespace massif {
+    class NativeVectorTile;
+
+    /**
+     * Feature decoder over a NativeVectorTile: the features are already in memory, so this only
+     * walks them. The transform and the feature-id override are the base decoder's; geometry is
+     * shared with the tile as long as the transform is the identity (the tile is decoded for
+     * itself), and transformed per feature otherwise (a parent tile overzoomed).
+     */
+    class NativeFeatureDecoder : public mvt::LayerFeatureDecoder {
+    public:
+        explicit NativeFeatureDecoder(const std::shared_ptr<const NativeVectorTile>& tile);
+        virtual ~NativeFeatureDecoder();
+
+        virtual std::vector<std::string> getLayerNames() const;
+        virtual bool hasLayer(const std::string& name) const;
+        virtual bool findFeature(long long id, std::string& layerName, mvt::Feature& feature) const;
+        virtual std::shared_ptr<FeatureIterator> createLayerFeatureIterator(const std::string& name, const std::set<std::string>* fields) const;
+
+    private:
+        class NativeFeatureIterator;
+
+        long long getFeatureId(long long id, std::size_t index) const;
+        std::shared_ptr<const mvt::Geometry> transformGeometry(const std::shared_ptr<const mvt::Geometry>& geometry) const;
+
+        // Room for this many features per tile in an overridden id, which is tile id x stride + index.
+        static const long long FEATURE_ID_TILE_STRIDE;
+
+        const std::shared_ptr<const NativeVectorTile> _tile;
+    };
+
+}
+
+#endif
@@ -98,7 +98,7 @@ namespace massif {
                     }
                     closedir(dir);
                 }
-                Log::Infof("SystemFontUtils: found %d system fonts", static_cast<int>(fontMap.size()));
+                LOG_INFOF("SystemFontUtils: found %d system fonts", static_cast<int>(fontMap.size()));
             }
             return fontMap;
         }
@@ -252,7 +252,7 @@ namespace massif {
             Log::Errorf("SystemFontUtils::LoadFont: Failed to read %s", fileName.c_str());
             return std::shared_ptr<BinaryData>();
         }
-        Log::Infof("SystemFontUtils::LoadFont: Using %s for %s", fileName.c_str(), name.c_str());
+        LOG_INFOF("SystemFontUtils::LoadFont: Using %s for %s", fileName.c_str(), name.c_str());
         return std::make_shared<BinaryData>(std::move(data));
     }
 
@@ -100,7 +100,7 @@ namespace massif {
         std::vector<unsigned char> data;
         const unsigned char* bytes = static_cast<const unsigned char*>([fileData bytes]);
         data.assign(bytes, bytes + [fileData length]);
-        Log::Infof("SystemFontUtils::LoadFont: Using %s for %s", [filePath UTF8String], name.c_str());
+        LOG_INFOF("SystemFontUtils::LoadFont: Using %s for %s", [filePath UTF8String], name.c_str());
         return std::make_shared<BinaryData>(std::move(data));
     }
 
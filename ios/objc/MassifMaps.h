@@ -216,6 +216,8 @@
 #import "MSFRoutingInstruction.h"
 #import "MSFRoutingRequest.h"
 #import "MSFRoutingResult.h"
+#import "MSFRoutingMatrixRequest.h"
+#import "MSFRoutingMatrixResult.h"
 #import "MSFRoutingService.h"
 #import "MSFRouteMatchingRequest.h"
 #import "MSFRouteMatchingResult.h"
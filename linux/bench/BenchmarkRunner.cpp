@@ -0,0 +1,150 @@
+#include "BenchmarkRunner.h"
+#include "utils/Log.h"
+#include "utils/PlatformUtils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <thread>
+
+#include <picojson/picojson.h>
+
+namespace massif {
+
+    namespace {
+        double percentile(const std::vector<double>& sortedValues, double fraction) {
+            if (sortedValues.empty()) {
+                return 0;
+            }
+            double pos = fraction * (sortedValues.size() - 1);
+            std::size_t index = static_cast<std::size_t>(pos);
+            if (index + 1 >= sortedValues.size()) {
+                return sortedValues.back();
+            }
+            return sortedValues[index] + (sortedValues[index + 1] - sortedValues[index]) * (pos - index);
+        }
+    }
+
+    BenchmarkRunner::BenchmarkRunner(int warmupIterations, int iterations, const std::string& filter) :
+        _warmupIterations(std::max(0, warmupIterations)),
+        _iterations(std::max(1, iterations)),
+        _filter(filter),
+        _results()
+    {
+    }
+
+    bool BenchmarkRunner::isSelected(const std::string& name) const {
+        return _filter.empty() || name.find(_filter) != std::string::npos;
+    }
+
+    void BenchmarkRunner::run(const std::string& name, const std::string& kind, int items, const Body& body) {
+        if (!isSelected(name)) {
+            return;
+        }
+
+        Result result;
+        result.name = name;
+        result.kind = kind;
+        result.items = items;
+        result.iterations = _iterations;
+
+        for (int i = 0; i < _warmupIterations; i++) {
+            result.checksum = body();
+        }
+        result.iterationMs.reserve(_iterations);
+        for (int i = 0; i < _iterations; i++) {
+            auto startTime = std::chrono::steady_clock::now();
+            std::uint64_t checksum = body();
+            auto endTime = std::chrono::steady_clock::now();
+            result.iterationMs.push_back(std::chrono::duration<double, std::milli>(endTime - startTime).count());
+            if (i > 0 && checksum != result.checksum) {
+                LOG_WARNF("BenchmarkRunner: %s: Checksum changed between iterations", name.c_str());
+            }
+            result.checksum = checksum;
+        }
+
+        std::vector<double> sortedMs = result.iterationMs;
+        std::sort(sortedMs.begin(), sortedMs.end());
+        LOG_INFOF("BenchmarkRunner: %s: median %.3f ms, min %.3f ms (%d items)", name.c_str(), percentile(sortedMs, 0.5), sortedMs.front(), items);
+        _results.push_back(std::move(result));
+    }
+
+    void BenchmarkRunner::skip(const std::string& name, const std::string& kind, const std::string& reason) {
+        if (!isSelected(name)) {
+            return;
+        }
+
+        LOG_INFOF("BenchmarkRunner: %s: skipped, %s", name.c_str(), reason.c_str());
+        Result result;
+        result.name = name;
+        result.kind = kind;
+        result.skipReason = reason;
+        _results.push_back(std::move(result));
+    }
+
+    std::string BenchmarkRunner::toJSON(const std::string& label, const std::string& fixturePath) const {
+        picojson::object environment;
+        environment["platform"] = picojson::value(PlatformUtils::GetPlatformId());
+        environment["os"] = picojson::value(PlatformUtils::GetDeviceOS());
+        environment["arch"] = picojson::value(PlatformUtils::GetDeviceType());
+        environment["hardware_threads"] = picojson::value(static_cast<double>(std::thread::hardware_concurrency()));
+#ifdef NDEBUG
+        environment["build_type"] = picojson::value("release");
+#else
+        environment["build_type"] = picojson::value("debug");
+#endif
+        environment["compiler"] = picojson::value(__VERSION__);
+
+        picojson::array benchmarks;
+        for (const Result& result : _results) {
+            picojson::object benchmark;
+            benchmark["name"] = picojson::value(result.name);
+            benchmark["kind"] = picojson::value(result.kind);
+            if (!result.skipReason.empty()) {
+                benchmark["skipped"] = picojson::value(result.skipReason);
+                benchmarks.push_back(picojson::value(benchmark));
+                continue;
+            }
+
+            std::vector<double> sortedMs = result.iterationMs;
+            std::sort(sortedMs.begin(), sortedMs.end());
+            double meanMs = std::accumulate(sortedMs.begin(), sortedMs.end(), 0.0) / sortedMs.size();
+            double variance = 0;
+            for (double ms : sortedMs) {
+                variance += (ms - meanMs) * (ms - meanMs);
+            }
+            double medianMs = percentile(sortedMs, 0.5);
+
+            benchmark["items"] = picojson::value(static_cast<double>(result.items));
+            benchmark["iterations"] = picojson::value(static_cast<double>(result.iterations));
+            // As a string, a double would lose the high bits of a 64-bit checksum
+            benchmark["checksum"] = picojson::value(std::to_string(result.checksum));
+            benchmark["min_ms"] = picojson::value(sortedMs.front());
+            benchmark["median_ms"] = picojson::value(medianMs);
+            benchmark["mean_ms"] = picojson::value(meanMs);
+            benchmark["p90_ms"] = picojson::value(percentile(sortedMs, 0.9));
+            benchmark["max_ms"] = picojson::value(sortedMs.back());
+            benchmark["stddev_ms"] = picojson::value(std::sqrt(variance / sortedMs.size()));
+            if (result.items > 0 && medianMs > 0) {
+                benchmark["items_per_s"] = picojson::value(result.items * 1000.0 / medianMs);
+            }
+            picojson::array iterationMs;
+            for (double ms : result.iterationMs) {
+                iterationMs.push_back(picojson::value(ms));
+            }
+            benchmark["iteration_ms"] = picojson::value(iterationMs);
+            benchmarks.push_back(picojson::value(benchmark));
+        }
+
+        picojson::object root;
+        root["format"] = picojson::value("massif-bench/1");
+        root["label"] = picojson::value(label);
+        root["fixtures"] = picojson::value(fixturePath);
+        root["warmup_iterations"] = picojson::value(static_cast<double>(_warmupIterations));
+        root["environment"] = picojson::value(environment);
+        root["benchmarks"] = picojson::value(benchmarks);
+        return picojson::value(root).serialize(true);
+    }
+
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _MASSIF_BENCHMARKRUNNER_H_
+#define _MASSIF_BENCHMARKRUNNER_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace massif {
+
+    // Runs benchmark bodies a fixed number of times and collects per-iteration timings.
+    // Iteration counts are fixed rather than time-budgeted, so two runs on the same fixtures do exactly the same work.
+    class BenchmarkRunner {
+    public:
+        // One iteration of a benchmark. Returns a checksum of what the iteration produced (feature counts,
+        // hits, ...): it keeps the work from being optimized away, and a changed checksum between two runs
+        // means they did not measure the same thing.
+        typedef std::function<std::uint64_t()> Body;
+
+        struct Result {
+            std::string name;
+            std::string kind; // "micro" or "macro"
+            std::string skipReason;
+            int items = 0; // units of work per iteration (tiles, queries, rays)
+            int iterations = 0;
+            std::uint64_t checksum = 0;
+            std::vector<double> iterationMs;
+        };
+
+        BenchmarkRunner(int warmupIterations, int iterations, const std::string& filter);
+
+        bool isSelected(const std::string& name) const;
+
+        void run(const std::string& name, const std::string& kind, int items, const Body& body);
+        void skip(const std::string& name, const std::string& kind, const std::string& reason);
+
+        const std::vector<Result>& getResults() const { return _results; }
+
+        // The results and the run environment as a JSON document
+        std::string toJSON(const std::string& label, const std::string& fixturePath) const;
+
+    private:
+        int _warmupIterations;
+        int _iterations;
+        std::string _filter;
+        std::vector<Result> _results;
+    };
+
+}
+
+#endif
@@ -0,0 +1,410 @@
+#include "Benchmarks.h"
+#include "BenchmarkRunner.h"
+#include "core/BinaryData.h"
+#include "core/MapEnvelope.h"
+#include "datasources/ContourTileDataSource.h"
+#include "datasources/MBTilesTileDataSource.h"
+#include "datasources/PMTilesTileDataSource.h"
+#include "datasources/components/TileData.h"
+#include "geometry/utils/KDTreeSpatialIndex.h"
+#include "graphics/Bitmap.h"
+#include "projections/Projection.h"
+#include "rastertiles/ElevationDecoder.h"
+#include "styles/CompiledStyleSet.h"
+#include "terrain/ElevationManager.h"
+#include "terrain/ElevationTileGrid.h"
+#include "utils/Const.h"
+#include "utils/GeomUtils.h"
+#include "utils/Log.h"
+#include "utils/TileUtils.h"
+#include "utils/ZippedAssetPackage.h"
+#include "vectortiles/MBVectorTileDecoder.h"
+#include "vectortiles/NativeVectorTile.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+#include <vt/TileTransformer.h>
+
+#ifndef _MASSIF_OFFLINE_SUPPORT
+#error "The benchmarks read MBTiles and PMTiles fixtures, build with the offline support of the standard profile"
+#endif
+
+namespace massif {
+
+    namespace {
+        const char* const MVT_FIXTURE = "vector.mbtiles";
+        const char* const MLT_FIXTURE = "vector-mlt.mbtiles";
+        const char* const PMTILES_FIXTURE = "vector.pmtiles";
+        const char* const STYLE_FIXTURE = "style.zip";
+        const char* const TERRAIN_FIXTURE = "terrain.mbtiles";
+
+        // Tiles benchmarked per source: the 3x3 block around the data extent center on the deepest levels
+        const int TILE_LEVELS = 3;
+        const int TILE_RADIUS = 1;
+
+        const int RAY_GRID_SIZE = 32;
+
+        const int PLACEMENT_LABEL_COUNT = 4000;
+        const int KDTREE_BOX_COUNT = 20000;
+        const int KDTREE_QUERY_COUNT = 10000;
+
+        struct LoadedTile {
+            MapTile tile;
+            std::shared_ptr<BinaryData> data;
+        };
+
+        std::string fixtureFile(const std::string& fixturePath, const char* name) {
+            return fixturePath + "/" + name;
+        }
+
+        bool fixtureExists(const std::string& fixturePath, const char* name) {
+            std::ifstream file(fixtureFile(fixturePath, name).c_str(), std::ios::binary);
+            return file.good();
+        }
+
+        std::shared_ptr<BinaryData> loadFixture(const std::string& fixturePath, const char* name) {
+            std::ifstream file(fixtureFile(fixturePath, name).c_str(), std::ios::binary);
+            std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            return std::make_shared<BinaryData>(std::move(data));
+        }
+
+        // In [0, 1). std::mt19937 output is specified exactly, the standard distributions are not,
+        // so the synthetic inputs are built from the raw output to be the same with every standard library.
+        double nextRandom(std::mt19937& rng) {
+            return rng() / 4294967296.0;
+        }
+
+        // In XYZ convention, as TileDataSource::loadTile expects them
+        std::vector<MapTile> selectTiles(const std::shared_ptr<TileDataSource>& dataSource) {
+            MapPos center = dataSource->getDataExtent().getCenter();
+            std::vector<MapTile> tiles;
+            int maxZoom = dataSource->getMaxZoom();
+            for (int zoom = std::max(dataSource->getMinZoom(), maxZoom - TILE_LEVELS + 1); zoom <= maxZoom; zoom++) {
+                MapTile centerTile = TileUtils::CalculateClippedMapTile(center, zoom, dataSource->getProjection()).getFlipped();
+                int tileCount = 1 << zoom;
+                for (int dy = -TILE_RADIUS; dy <= TILE_RADIUS; dy++) {
+                    for (int dx = -TILE_RADIUS; dx <= TILE_RADIUS; dx++) {
+                        int x = centerTile.getX() + dx;
+                        int y = centerTile.getY() + dy;
+                        if (x >= 0 && y >= 0 && x < tileCount && y < tileCount) {
+                            tiles.emplace_back(x, y, zoom, 0);
+                        }
+                    }
+                }
+            }
+            return tiles;
+        }
+
+        std::vector<LoadedTile> loadTiles(const std::shared_ptr<TileDataSource>& dataSource, const std::vector<MapTile>& tiles) {
+            std::vector<LoadedTile> loadedTiles;
+            for (const MapTile& tile : tiles) {
+                std::shared_ptr<TileData> tileData = dataSource->loadTile(tile);
+                if (tileData && !tileData->isReplaceWithParent() && tileData->getData() && !tileData->getData()->empty()) {
+                    loadedTiles.push_back(LoadedTile { tile, tileData->getData() });
+                }
+            }
+            return loadedTiles;
+        }
+
+        MapBounds calculateInternalBounds(const MapTile& tile, const std::shared_ptr<Projection>& projection) {
+            // Same as ElevationManager::loadTileGrid: TileUtils works in TMS convention
+            MapBounds bounds = TileUtils::CalculateMapTileBounds(tile.getFlipped(), projection);
+            MapPos internalMin = projection->toInternal(bounds.getMin());
+            MapPos internalMax = projection->toInternal(bounds.getMax());
+            return MapBounds(MapPos(std::min(internalMin.getX(), internalMax.getX()), std::min(internalMin.getY(), internalMax.getY())),
+                             MapPos(std::max(internalMin.getX(), internalMax.getX()), std::max(internalMin.getY(), internalMax.getY())));
+        }
+
+        void runVectorDecode(BenchmarkRunner& runner, const std::string& name, const std::string& fixturePath, const char* tileFixture) {
+            if (!runner.isSelected(name)) {
+                return;
+            }
+            if (!fixtureExists(fixturePath, tileFixture) || !fixtureExists(fixturePath, STYLE_FIXTURE)) {
+                runner.skip(name, "macro", std::string("missing fixture ") + tileFixture + " or " + STYLE_FIXTURE);
+                return;
+            }
+
+            auto dataSource = std::make_shared<MBTilesTileDataSource>(fixtureFile(fixturePath, tileFixture));
+            auto styleSet = std::make_shared<CompiledStyleSet>(std::make_shared<ZippedAssetPackage>(loadFixture(fixturePath, STYLE_FIXTURE)));
+            auto decoder = std::make_shared<MBVectorTileDecoder>(styleSet);
+
+            // The declared format, as VectorTileLayer sets it
+            TileFormat::TileFormat format = MBVectorTileDecoder::parseTileFormat(dataSource->getMetaData("encoding"));
+            if (format == TileFormat::TILE_FORMAT_AUTO) {
+                format = MBVectorTileDecoder::parseTileFormat(dataSource->getMetaData("format"));
+            }
+            decoder->setTileFormat(format);
+
+            std::vector<LoadedTile> tiles = loadTiles(dataSource, selectTiles(dataSource));
+            if (tiles.empty()) {
+                runner.skip(name, "macro", std::string("no tiles at the data extent center of ") + tileFixture);
+                return;
+            }
+
+            auto tileTransformer = std::make_shared<vt::DefaultTileTransformer>(static_cast<float>(Const::WORLD_SIZE));
+            runner.run(name, "macro", static_cast<int>(tiles.size()), [&]() {
+                std::uint64_t checksum = 0;
+                for (const LoadedTile& loadedTile : tiles) {
+                    vt::TileId vtTile(loadedTile.tile.getZoom(), loadedTile.tile.getX(), loadedTile.tile.getY());
+                    if (std::shared_ptr<VectorTileDecoder::TileMap> tileMap = decoder->decodeTile(vtTile, vtTile, tileTransformer, loadedTile.data)) {
+                        checksum += tileMap->size() + 1;
+                    }
+                }
+                return checksum;
+            });
+        }
+
+        void runTileReads(BenchmarkRunner& runner, const std::string& name, const std::string& fixturePath, const char* tileFixture, const std::function<std::shared_ptr<TileDataSource>(const std::string&)>& createDataSource) {
+            if (!runner.isSelected(name)) {
+                return;
+            }
+            if (!fixtureExists(fixturePath, tileFixture)) {
+                runner.skip(name, "macro", std::string("missing fixture ") + tileFixture);
+                return;
+            }
+
+            std::shared_ptr<TileDataSource> dataSource = createDataSource(fixtureFile(fixturePath, tileFixture));
+            std::vector<MapTile> tiles = selectTiles(dataSource);
+            runner.run(name, "macro", static_cast<int>(tiles.size()), [&]() {
+                std::uint64_t checksum = 0;
+                for (const MapTile& tile : tiles) {
+                    std::shared_ptr<TileData> tileData = dataSource->loadTile(tile);
+                    if (tileData && tileData->getData()) {
+                        checksum += tileData->getData()->size();
+                    }
+                }
+                return checksum;
+            });
+        }
+
+        struct PlacementLabel {
+            std::vector<MapPos> corners;
+            double priority;
+        };
+
+        std::vector<PlacementLabel> createPlacementLabels() {
+            // A crowded 1920x1080 screen of rotated label boxes
+            std::mt19937 rng(1);
+            std::vector<PlacementLabel> labels;
+            labels.reserve(PLACEMENT_LABEL_COUNT);
+            for (int i = 0; i < PLACEMENT_LABEL_COUNT; i++) {
+                double x = nextRandom(rng) * 1920;
+                double y = nextRandom(rng) * 1080;
+                double halfWidth = 10 + nextRandom(rng) * 50;
+                double halfHeight = 6 + nextRandom(rng) * 6;
+                double angle = (nextRandom(rng) - 0.5) * 0.6;
+                double c = std::cos(angle), s = std::sin(angle);
+
+                PlacementLabel label;
+                for (int j = 0; j < 4; j++) {
+                    double dx = (j == 0 || j == 3 ? -halfWidth : halfWidth);
+                    double dy = (j < 2 ? -halfHeight : halfHeight);
+                    label.corners.emplace_back(x + dx * c - dy * s, y + dx * s + dy * c, 0);
+                }
+                label.priority = nextRandom(rng);
+                labels.push_back(std::move(label));
+            }
+            std::stable_sort(labels.begin(), labels.end(), [](const PlacementLabel& label1, const PlacementLabel& label2) {
+                return label1.priority > label2.priority;
+            });
+            return labels;
+        }
+
+        std::vector<cglib::bbox3<double> > createRandomBoxes(std::mt19937& rng, int count, double maxSize) {
+            std::vector<cglib::bbox3<double> > boxes;
+            boxes.reserve(count);
+            for (int i = 0; i < count; i++) {
+                cglib::vec3<double> min(nextRandom(rng) * 1920, nextRandom(rng) * 1080, 0);
+                cglib::vec3<double> size(nextRandom(rng) * maxSize, nextRandom(rng) * maxSize, 0);
+                boxes.emplace_back(min, min + size);
+            }
+            return boxes;
+        }
+    }
+
+    void Benchmarks::RunAll(BenchmarkRunner& runner, const std::string& fixturePath) {
+        RunVectorTileBenchmarks(runner, fixturePath);
+        RunTerrainBenchmarks(runner, fixturePath);
+        RunPlacementBenchmarks(runner);
+    }
+
+    void Benchmarks::RunVectorTileBenchmarks(BenchmarkRunner& runner, const std::string& fixturePath) {
+        runVectorDecode(runner, "vectortile.decode.mvt", fixturePath, MVT_FIXTURE);
+        runVectorDecode(runner, "vectortile.decode.mlt", fixturePath, MLT_FIXTURE);
+
+        runTileReads(runner, "datasource.read.mbtiles", fixturePath, MVT_FIXTURE, [](const std::string& fileName) {
+            return std::make_shared<MBTilesTileDataSource>(fileName);
+        });
+        runTileReads(runner, "datasource.read.pmtiles", fixturePath, PMTILES_FIXTURE, [](const std::string& fileName) {
+            return std::make_shared<PMTilesTileDataSource>(fileName);
+        });
+    }
+
+    void Benchmarks::RunTerrainBenchmarks(BenchmarkRunner& runner, const std::string& fixturePath) {
+        const std::pair<const char*, const char*> benchmarks[] = {
+            { "terrain.decode.png", "macro" }, { "terrain.decode.grid", "macro" }, { "terrain.intersect_ray", "micro" }, { "contour.load_tile", "macro" }
+        };
+        if (std::none_of(std::begin(benchmarks), std::end(benchmarks), [&](const std::pair<const char*, const char*>& benchmark) { return runner.isSelected(benchmark.first); })) {
+            return;
+        }
+        if (!fixtureExists(fixturePath, TERRAIN_FIXTURE)) {
+            for (const std::pair<const char*, const char*>& benchmark : benchmarks) {
+                runner.skip(benchmark.first, benchmark.second, std::string("missing fixture ") + TERRAIN_FIXTURE);
+            }
+            return;
+        }
+
+        auto dataSource = std::make_shared<MBTilesTileDataSource>(fixtureFile(fixturePath, TERRAIN_FIXTURE));
+        std::vector<LoadedTile> tiles = loadTiles(dataSource, selectTiles(dataSource));
+        std::shared_ptr<ElevationDecoder> elevationDecoder = ElevationManager::ResolveDecoder(dataSource, std::shared_ptr<ElevationDecoder>());
+
+        runner.run("terrain.decode.png", "macro", static_cast<int>(tiles.size()), [&]() {
+            std::uint64_t checksum = 0;
+            for (const LoadedTile& loadedTile : tiles) {
+                if (std::shared_ptr<Bitmap> bitmap = Bitmap::CreateFromCompressed(loadedTile.data)) {
+                    checksum += bitmap->getWidth() * bitmap->getHeight();
+                }
+            }
+            return checksum;
+        });
+
+        std::vector<std::pair<LoadedTile, std::shared_ptr<Bitmap> > > bitmaps;
+        for (const LoadedTile& loadedTile : tiles) {
+            if (std::shared_ptr<Bitmap> bitmap = Bitmap::CreateFromCompressed(loadedTile.data)) {
+                bitmaps.emplace_back(loadedTile, bitmap);
+            }
+        }
+        std::array<double, 4> coeffs = elevationDecoder->getColorComponentCoefficients();
+        runner.run("terrain.decode.grid", "macro", static_cast<int>(bitmaps.size()), [&]() {
+            std::uint64_t checksum = 0;
+            for (const std::pair<LoadedTile, std::shared_ptr<Bitmap> >& bitmap : bitmaps) {
+                const MapTile& tile = bitmap.first.tile;
+                if (std::shared_ptr<ElevationTileGrid> grid = ElevationTileGrid::DecodeBitmap(tile, calculateInternalBounds(tile, dataSource->getProjection()), bitmap.second, coeffs, true)) {
+                    checksum += static_cast<std::uint64_t>(grid->getMaxHeight() - grid->getMinHeight());
+                }
+            }
+            return checksum;
+        });
+
+        // Rays from above the center tile of the deepest level down across its 3x3 block. intersectRay samples
+        // cached grids only, so the block is loaded first.
+        auto elevationManager = std::make_shared<ElevationManager>(dataSource, elevationDecoder);
+        elevationManager->setNeighbourPrefetchEnabled(false);
+        MapBounds rayBounds;
+        double tileSize = 0;
+        for (const LoadedTile& loadedTile : tiles) {
+            if (loadedTile.tile.getZoom() != dataSource->getMaxZoom()) {
+                continue;
+            }
+            if (std::shared_ptr<ElevationTileGrid> grid = elevationManager->getDataTileGrid(loadedTile.tile, ElevationManager::LoadMode::LOAD_EXACT)) {
+                rayBounds.expandToContain(grid->getInternalBounds());
+                tileSize = grid->getInternalBounds().getDelta().getX();
+            }
+        }
+        if (tileSize <= 0) {
+            runner.skip("terrain.intersect_ray", "micro", std::string("no tiles at the data extent center of ") + TERRAIN_FIXTURE);
+        } else {
+            MapPos rayOrigin = rayBounds.getCenter();
+            runner.run("terrain.intersect_ray", "micro", RAY_GRID_SIZE * RAY_GRID_SIZE, [&]() {
+                std::uint64_t checksum = 0;
+                for (int j = 0; j < RAY_GRID_SIZE; j++) {
+                    for (int i = 0; i < RAY_GRID_SIZE; i++) {
+                        cglib::vec3<double> origin(rayOrigin.getX(), rayOrigin.getY(), tileSize * 2);
+                        cglib::vec3<double> target(rayBounds.getMin().getX() + (i + 0.5) / RAY_GRID_SIZE * rayBounds.getDelta().getX(), rayBounds.getMin().getY() + (j + 0.5) / RAY_GRID_SIZE * rayBounds.getDelta().getY(), 0);
+                        double t = 0;
+                        if (elevationManager->intersectRay(cglib::ray3<double>(origin, target - origin), t)) {
+                            checksum += 1 + static_cast<std::uint64_t>(t * 1000);
+                        }
+                    }
+                }
+                return checksum;
+            });
+        }
+
+        // A new data source per iteration, so that its DEM bitmap cache starts cold every time
+        runner.run("contour.load_tile", "macro", static_cast<int>(tiles.size()), [&]() {
+            auto contourDataSource = std::make_shared<ContourTileDataSource>(dataSource, elevationDecoder);
+            std::uint64_t checksum = 0;
+            for (const LoadedTile& loadedTile : tiles) {
+                // Contour tiles are native tiles without encoded data, so count their features and geometry size
+                std::shared_ptr<TileData> tileData = contourDataSource->loadTile(loadedTile.tile);
+                if (!tileData) {
+                    continue;
+                }
+                if (std::shared_ptr<const NativeVectorTile> nativeTile = tileData->getNativeTile()) {
+                    for (const NativeVectorTile::Layer& layer : nativeTile->getLayers()) {
+                        checksum += layer.features.size();
+                    }
+                    checksum += nativeTile->getDataSize();
+                } else if (tileData->getData()) {
+                    checksum += tileData->getData()->size();
+                }
+                checksum += 1;
+            }
+            return checksum;
+        });
+    }
+
+    void Benchmarks::RunPlacementBenchmarks(BenchmarkRunner& runner) {
+        // The overlap pass of BillboardPlacementWorker::calculateBillboardPlacement on already projected
+        // labels: convex hull, KD-tree candidates, exact envelope test, highest priority first.
+        std::vector<PlacementLabel> labels = createPlacementLabels();
+        runner.run("billboard.placement", "micro", static_cast<int>(labels.size()), [&]() {
+            KDTreeSpatialIndex<MapEnvelope> kdTree;
+            std::uint64_t visibleCount = 0;
+            for (const PlacementLabel& label : labels) {
+                cglib::bbox3<double> bounds = cglib::bbox3<double>::smallest();
+                for (const MapPos& corner : label.corners) {
+                    bounds.add(cglib::vec3<double>(corner.getX(), corner.getY(), 0));
+                }
+                MapEnvelope envelope(GeomUtils::CalculateConvexHull(label.corners));
+
+                bool overlapped = false;
+                for (const MapEnvelope& overlappedEnvelope : kdTree.query(bounds)) {
+                    if (overlappedEnvelope.intersects(envelope)) {
+                        overlapped = true;
+                        break;
+                    }
+                }
+                if (!overlapped) {
+                    kdTree.insert(bounds, envelope);
+                    visibleCount++;
+                }
+            }
+            return visibleCount;
+        });
+
+        std::mt19937 rng(2);
+        std::vector<cglib::bbox3<double> > boxes = createRandomBoxes(rng, KDTREE_BOX_COUNT, 40);
+        runner.run("kdtree.insert", "micro", static_cast<int>(boxes.size()), [&]() {
+            KDTreeSpatialIndex<int> kdTree;
+            for (std::size_t i = 0; i < boxes.size(); i++) {
+                kdTree.insert(boxes[i], static_cast<int>(i));
+            }
+            return static_cast<std::uint64_t>(kdTree.size());
+        });
+
+        KDTreeSpatialIndex<int> kdTree;
+        for (std::size_t i = 0; i < boxes.size(); i++) {
+            kdTree.insert(boxes[i], static_cast<int>(i));
+        }
+        std::vector<cglib::bbox3<double> > queries = createRandomBoxes(rng, KDTREE_QUERY_COUNT, 120);
+        runner.run("kdtree.query", "micro", static_cast<int>(queries.size()), [&]() {
+            std::uint64_t checksum = 0;
+            for (const cglib::bbox3<double>& query : queries) {
+                checksum += kdTree.query(query).size();
+            }
+            return checksum;
+        });
+    }
+
+    Benchmarks::Benchmarks() {
+    }
+
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _MASSIF_BENCHMARKS_H_
+#define _MASSIF_BENCHMARKS_H_
+
+#include <string>
+
+namespace massif {
+    class BenchmarkRunner;
+
+    // The benchmark suite. Fixture files are read from a directory (see README.md for the expected names);
+    // the benchmarks of a missing fixture are reported as skipped, not failed.
+    class Benchmarks {
+    public:
+        static void RunAll(BenchmarkRunner& runner, const std::string& fixturePath);
+
+    private:
+        Benchmarks();
+
+        static void RunVectorTileBenchmarks(BenchmarkRunner& runner, const std::string& fixturePath);
+        static void RunTerrainBenchmarks(BenchmarkRunner& runner, const std::string& fixturePath);
+        static void RunPlacementBenchmarks(BenchmarkRunner& runner);
+    };
+
+}
+
+#endif
@@ -0,0 +1,85 @@
+#include "BenchmarkRunner.h"
+#include "Benchmarks.h"
+#include "utils/Log.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program << " --fixtures <dir> [options]\n"
+            << "  --fixtures <dir>     Directory of the fixture files (see linux/bench/README.md)\n"
+            << "  --output <file>      Write the JSON results to a file instead of stdout\n"
+            << "  --filter <text>      Run only the benchmarks whose name contains the text\n"
+            << "  --iterations <n>     Measured iterations per benchmark (default 10)\n"
+            << "  --warmup <n>         Unmeasured iterations before them (default 2)\n"
+            << "  --label <text>       Free-form label stored in the results, e.g. a commit id\n"
+            << "  --verbose            Log debug messages as well\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    using namespace massif;
+
+    std::string fixturePath;
+    std::string outputFileName;
+    std::string filter;
+    std::string label;
+    int iterations = 10;
+    int warmupIterations = 2;
+    bool verbose = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--fixtures" && hasValue) {
+            fixturePath = argv[++i];
+        } else if (arg == "--output" && hasValue) {
+            outputFileName = argv[++i];
+        } else if (arg == "--filter" && hasValue) {
+            filter = argv[++i];
+        } else if (arg == "--label" && hasValue) {
+            label = argv[++i];
+        } else if (arg == "--iterations" && hasValue) {
+            iterations = std::atoi(argv[++i]);
+        } else if (arg == "--warmup" && hasValue) {
+            warmupIterations = std::atoi(argv[++i]);
+        } else if (arg == "--verbose") {
+            verbose = true;
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (fixturePath.empty() || iterations <= 0 || warmupIterations < 0) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    // The SDK logs to stderr on Linux, the results go to stdout or the output file
+    Log::SetShowDebug(verbose);
+    Log::SetTag("massif-bench");
+
+    BenchmarkRunner runner(warmupIterations, iterations, filter);
+    Benchmarks::RunAll(runner, fixturePath);
+    if (runner.getResults().empty()) {
+        Log::Errorf("massif-bench: No benchmark matches the filter '%s'", filter.c_str());
+        return 1;
+    }
+
+    std::string json = runner.toJSON(label, fixturePath);
+    if (outputFileName.empty()) {
+        std::cout << json << std::endl;
+        return 0;
+    }
+    std::ofstream file(outputFileName.c_str(), std::ios::binary);
+    file << json << '\n';
+    file.close();
+    if (!file) {
+        Log::Errorf("massif-bench: Failed to write %s", outputFileName.c_str());
+        return 1;
+    }
+    return 0;
+}
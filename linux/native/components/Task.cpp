@@ -0,0 +1,9 @@
+#include "components/Task.h"
+
+namespace massif {
+
+    void Task::operator()() {
+        run();
+    }
+    
+}
@@ -0,0 +1,222 @@
+#include "BitmapCanvasLinuxImpl.h"
+#include "utils/Const.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace massif {
+
+    BitmapCanvas::LinuxImpl::LinuxImpl(int width, int height) :
+        _width(std::max(0, width)),
+        _height(std::max(0, height)),
+        _pixels(static_cast<std::size_t>(std::max(0, width)) * std::max(0, height) * 4, 0),
+        _clipRects(),
+        _drawMode(FILL),
+        _color { 0, 0, 0, 255 },
+        _strokeWidth(1),
+        _fontSize(12)
+    {
+        _clipRects.push_back(ClipRect { 0, 0, _width, _height });
+    }
+
+    BitmapCanvas::LinuxImpl::~LinuxImpl() {
+    }
+
+    void BitmapCanvas::LinuxImpl::setDrawMode(DrawMode mode) {
+        _drawMode = mode;
+    }
+
+    void BitmapCanvas::LinuxImpl::setColor(const Color& color) {
+        unsigned int alpha = color.getA();
+        _color[0] = static_cast<std::uint8_t>(color.getR() * alpha / 255);
+        _color[1] = static_cast<std::uint8_t>(color.getG() * alpha / 255);
+        _color[2] = static_cast<std::uint8_t>(color.getB() * alpha / 255);
+        _color[3] = static_cast<std::uint8_t>(alpha);
+    }
+
+    void BitmapCanvas::LinuxImpl::setStrokeWidth(float width) {
+        _strokeWidth = width;
+    }
+
+    void BitmapCanvas::LinuxImpl::setFont(const std::string& familyName, const std::string& fileName, float size) {
+        _fontSize = size;
+    }
+
+    void BitmapCanvas::LinuxImpl::pushClipRect(const ScreenBounds& clipRect) {
+        const ClipRect& current = _clipRects.back();
+        ClipRect clip;
+        clip.x0 = std::max(current.x0, static_cast<int>(std::floor(clipRect.getMin().getX())));
+        clip.y0 = std::max(current.y0, static_cast<int>(std::floor(clipRect.getMin().getY())));
+        clip.x1 = std::min(current.x1, static_cast<int>(std::ceil(clipRect.getMax().getX())));
+        clip.y1 = std::min(current.y1, static_cast<int>(std::ceil(clipRect.getMax().getY())));
+        _clipRects.push_back(clip);
+    }
+
+    void BitmapCanvas::LinuxImpl::popClipRect() {
+        if (_clipRects.size() > 1) {
+            _clipRects.pop_back();
+        }
+    }
+
+    void BitmapCanvas::LinuxImpl::drawText(std::string text, const ScreenPos& pos, int maxWidth, bool breakLines) {
+        // No glyph rendering without a text engine; the layout is still reported by measureTextSize
+    }
+
+    void BitmapCanvas::LinuxImpl::drawPolygon(const std::vector<ScreenPos>& poses) {
+        if (poses.size() < 2) {
+            return;
+        }
+
+        if (_drawMode == FILL) {
+            fillPolygon(poses);
+            return;
+        }
+
+        // Stroke each edge of the closed outline as a quad
+        float halfWidth = _strokeWidth * 0.5f;
+        for (std::size_t i = 0; i < poses.size(); i++) {
+            const ScreenPos& p0 = poses[i];
+            const ScreenPos& p1 = poses[(i + 1) % poses.size()];
+            float dx = p1.getX() - p0.getX();
+            float dy = p1.getY() - p0.getY();
+            float length = std::sqrt(dx * dx + dy * dy);
+            if (length <= 0) {
+                continue;
+            }
+            float nx = -dy / length * halfWidth;
+            float ny = dx / length * halfWidth;
+            fillPolygon(std::vector<ScreenPos> {
+                ScreenPos(p0.getX() + nx, p0.getY() + ny), ScreenPos(p1.getX() + nx, p1.getY() + ny),
+                ScreenPos(p1.getX() - nx, p1.getY() - ny), ScreenPos(p0.getX() - nx, p0.getY() - ny)
+            });
+        }
+    }
+
+    void BitmapCanvas::LinuxImpl::drawRoundRect(const ScreenBounds& rect, float radius) {
+        radius = std::max(0.0f, std::min(radius, std::min(rect.getWidth(), rect.getHeight()) * 0.5f));
+        const int arcSegments = 8;
+
+        std::vector<ScreenPos> poses;
+        poses.reserve(4 * (arcSegments + 1));
+        const ScreenPos corners[4] = {
+            ScreenPos(rect.getMax().getX() - radius, rect.getMin().getY() + radius),
+            ScreenPos(rect.getMax().getX() - radius, rect.getMax().getY() - radius),
+            ScreenPos(rect.getMin().getX() + radius, rect.getMax().getY() - radius),
+            ScreenPos(rect.getMin().getX() + radius, rect.getMin().getY() + radius)
+        };
+        for (int corner = 0; corner < 4; corner++) {
+            for (int i = 0; i <= arcSegments; i++) {
+                double angle = (corner - 1 + static_cast<double>(i) / arcSegments) * Const::PI * 0.5;
+                poses.emplace_back(corners[corner].getX() + static_cast<float>(std::cos(angle) * radius), corners[corner].getY() + static_cast<float>(std::sin(angle) * radius));
+            }
+        }
+        drawPolygon(poses);
+    }
+
+    void BitmapCanvas::LinuxImpl::drawBitmap(const ScreenBounds& rect, const std::shared_ptr<Bitmap>& bitmap) {
+        if (!bitmap || rect.getWidth() <= 0 || rect.getHeight() <= 0) {
+            return;
+        }
+        std::shared_ptr<Bitmap> rgbaBitmap = bitmap->getRGBABitmap();
+        const std::vector<unsigned char>& pixelData = rgbaBitmap->getPixelData();
+
+        const ClipRect& clip = _clipRects.back();
+        int x0 = std::max(clip.x0, static_cast<int>(std::floor(rect.getMin().getX())));
+        int y0 = std::max(clip.y0, static_cast<int>(std::floor(rect.getMin().getY())));
+        int x1 = std::min(clip.x1, static_cast<int>(std::ceil(rect.getMax().getX())));
+        int y1 = std::min(clip.y1, static_cast<int>(std::ceil(rect.getMax().getY())));
+        for (int y = y0; y < y1; y++) {
+            int srcY = static_cast<int>((y + 0.5f - rect.getMin().getY()) / rect.getHeight() * rgbaBitmap->getHeight());
+            srcY = std::max(0, std::min(static_cast<int>(rgbaBitmap->getHeight()) - 1, srcY));
+            for (int x = x0; x < x1; x++) {
+                int srcX = static_cast<int>((x + 0.5f - rect.getMin().getX()) / rect.getWidth() * rgbaBitmap->getWidth());
+                srcX = std::max(0, std::min(static_cast<int>(rgbaBitmap->getWidth()) - 1, srcX));
+                blendPixel(x, y, &pixelData[(static_cast<std::size_t>(srcY) * rgbaBitmap->getWidth() + srcX) * 4]);
+            }
+        }
+    }
+
+    ScreenBounds BitmapCanvas::LinuxImpl::measureTextSize(std::string text, int maxWidth, bool breakLines) const {
+        if (text.empty()) {
+            return ScreenBounds(ScreenPos(0, 0), ScreenPos(0, 0));
+        }
+
+        float charWidth = _fontSize * CHAR_WIDTH_FACTOR;
+        int maxChars = (maxWidth < 0 ? -1 : std::max(1, static_cast<int>(maxWidth / charWidth)));
+        int lineCount = 1;
+        int lineChars = 0;
+        int widestLine = 0;
+        for (std::size_t i = 0; i < text.size(); i++) {
+            if ((text[i] & 0xc0) == 0x80) {
+                continue; // UTF-8 continuation byte
+            }
+            if (text[i] == '\n' || (breakLines && maxChars > 0 && lineChars >= maxChars)) {
+                lineCount++;
+                lineChars = 0;
+                if (text[i] == '\n') {
+                    continue;
+                }
+            }
+            lineChars++;
+            widestLine = std::max(widestLine, lineChars);
+        }
+        if (maxChars > 0) {
+            widestLine = std::min(widestLine, maxChars);
+        }
+        return ScreenBounds(ScreenPos(0, 0), ScreenPos(std::ceil(widestLine * charWidth), std::ceil(lineCount * _fontSize * LINE_HEIGHT_FACTOR)));
+    }
+
+    std::shared_ptr<Bitmap> BitmapCanvas::LinuxImpl::buildBitmap() const {
+        if (_width == 0 || _height == 0) {
+            const unsigned char pixel[] = { 0, 0, 0, 0 };
+            return std::make_shared<Bitmap>(pixel, 1, 1, ColorFormat::COLOR_FORMAT_RGBA, 4);
+        }
+        return std::make_shared<Bitmap>(_pixels.data(), _width, _height, ColorFormat::COLOR_FORMAT_RGBA, _width * 4);
+    }
+
+    void BitmapCanvas::LinuxImpl::fillPolygon(const std::vector<ScreenPos>& poses) {
+        const ClipRect& clip = _clipRects.back();
+        float minY = poses[0].getY(), maxY = poses[0].getY();
+        for (const ScreenPos& pos : poses) {
+            minY = std::min(minY, pos.getY());
+            maxY = std::max(maxY, pos.getY());
+        }
+        int y0 = std::max(clip.y0, static_cast<int>(std::floor(minY)));
+        int y1 = std::min(clip.y1, static_cast<int>(std::ceil(maxY)));
+
+        // Even-odd scanline fill, sampled at pixel centers
+        std::vector<float> crossings;
+        for (int y = y0; y < y1; y++) {
+            float sampleY = y + 0.5f;
+            crossings.clear();
+            for (std::size_t i = 0; i < poses.size(); i++) {
+                const ScreenPos& p0 = poses[i];
+                const ScreenPos& p1 = poses[(i + 1) % poses.size()];
+                if ((p0.getY() <= sampleY) != (p1.getY() <= sampleY)) {
+                    float t = (sampleY - p0.getY()) / (p1.getY() - p0.getY());
+                    crossings.push_back(p0.getX() + t * (p1.getX() - p0.getX()));
+                }
+            }
+            std::sort(crossings.begin(), crossings.end());
+            for (std::size_t i = 0; i + 1 < crossings.size(); i += 2) {
+                int x0 = std::max(clip.x0, static_cast<int>(std::ceil(crossings[i] - 0.5f)));
+                int x1 = std::min(clip.x1, static_cast<int>(std::ceil(crossings[i + 1] - 0.5f)));
+                for (int x = x0; x < x1; x++) {
+                    blendPixel(x, y, _color);
+                }
+            }
+        }
+    }
+
+    void BitmapCanvas::LinuxImpl::blendPixel(int x, int y, const std::uint8_t* premultipliedColor) {
+        std::uint8_t* dst = &_pixels[(static_cast<std::size_t>(y) * _width + x) * 4];
+        unsigned int inverseAlpha = 255 - premultipliedColor[3];
+        for (int i = 0; i < 4; i++) {
+            dst[i] = static_cast<std::uint8_t>(premultipliedColor[i] + dst[i] * inverseAlpha / 255);
+        }
+    }
+
+    const float BitmapCanvas::LinuxImpl::CHAR_WIDTH_FACTOR = 0.55f;
+    const float BitmapCanvas::LinuxImpl::LINE_HEIGHT_FACTOR = 1.2f;
+
+}
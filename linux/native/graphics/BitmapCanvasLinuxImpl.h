@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _MASSIF_BITMAPCANVASLINUXIMPL_H_
+#define _MASSIF_BITMAPCANVASLINUXIMPL_H_
+
+#include "graphics/BitmapCanvas.h"
+
+#include <cstdint>
+
+namespace massif {
+
+    // Headless software canvas for the Linux build. Shapes and bitmaps are rasterized without
+    // antialiasing; there is no text engine, so text is laid out with fixed per-character metrics
+    // and not drawn. Enough for the vector element bitmaps (balloon popups) to have the right size.
+    class BitmapCanvas::LinuxImpl : public BitmapCanvas::Impl {
+    public:
+        LinuxImpl(int width, int height);
+        virtual ~LinuxImpl();
+
+        virtual void setDrawMode(DrawMode mode);
+        virtual void setColor(const Color& color);
+        virtual void setStrokeWidth(float width);
+        virtual void setFont(const std::string& familyName, const std::string& fileName, float size);
+
+        virtual void pushClipRect(const ScreenBounds& clipRect);
+        virtual void popClipRect();
+
+        virtual void drawText(std::string text, const ScreenPos& pos, int maxWidth, bool breakLines);
+        virtual void drawPolygon(const std::vector<ScreenPos>& poses);
+        virtual void drawRoundRect(const ScreenBounds& rect, float radius);
+        virtual void drawBitmap(const ScreenBounds& rect, const std::shared_ptr<Bitmap>& bitmap);
+
+        virtual ScreenBounds measureTextSize(std::string text, int maxWidth, bool breakLines) const;
+
+        virtual std::shared_ptr<Bitmap> buildBitmap() const;
+
+    private:
+        struct ClipRect {
+            int x0, y0, x1, y1;
+        };
+
+        void fillPolygon(const std::vector<ScreenPos>& poses);
+        void blendPixel(int x, int y, const std::uint8_t* premultipliedColor);
+
+        static const float CHAR_WIDTH_FACTOR;
+        static const float LINE_HEIGHT_FACTOR;
+
+        int _width;
+        int _height;
+        std::vector<std::uint8_t> _pixels;
+        std::vector<ClipRect> _clipRects;
+        DrawMode _drawMode;
+        std::uint8_t _color[4];
+        float _strokeWidth;
+        float _fontSize;
+    };
+
+}
+
+#endif
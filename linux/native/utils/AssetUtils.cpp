@@ -0,0 +1,47 @@
+#include "AssetUtils.h"
+#include "core/BinaryData.h"
+#include "utils/Log.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace massif {
+
+    void AssetUtils::SetAssetPath(const std::string& path) {
+        std::lock_guard<std::mutex> lock(_Mutex);
+        _AssetPath = path;
+    }
+
+    std::shared_ptr<BinaryData> AssetUtils::LoadAsset(const std::string& path) {
+        std::string fullPath = GetAssetPath() + "/" + path;
+        std::ifstream file(fullPath.c_str(), std::ios::binary);
+        if (!file) {
+            Log::Errorf("AssetUtils::LoadAsset: Asset not found: %s", path.c_str());
+            return std::shared_ptr<BinaryData>();
+        }
+        std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (file.bad()) {
+            Log::Errorf("AssetUtils::LoadAsset: Failed to read asset: %s", path.c_str());
+            return std::shared_ptr<BinaryData>();
+        }
+        return std::make_shared<BinaryData>(std::move(data));
+    }
+
+    std::string AssetUtils::GetAssetPath() {
+        std::lock_guard<std::mutex> lock(_Mutex);
+        if (_AssetPath.empty()) {
+            const char* envPath = std::getenv("MASSIF_ASSET_PATH");
+            _AssetPath = (envPath && *envPath ? envPath : "assets");
+        }
+        return _AssetPath;
+    }
+
+    AssetUtils::AssetUtils() {
+    }
+
+    std::string AssetUtils::_AssetPath;
+    std::mutex AssetUtils::_Mutex;
+
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _MASSIF_ASSETUTILS_H_
+#define _MASSIF_ASSETUTILS_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace massif {
+    class BinaryData;
+
+    /**
+     * A helper class for managing application-bundled assets.
+     * Linux has no application bundle, the assets are plain files under an asset directory.
+     */
+    class AssetUtils {
+    public:
+        /**
+         * Sets the directory the assets are loaded from.
+         * The default is the MASSIF_ASSET_PATH environment variable, or the 'assets' folder of the working directory if it is not set.
+         * @param path The asset directory.
+         */
+        static void SetAssetPath(const std::string& path);
+
+        /**
+         * Loads the specified bundled asset.
+         * @param path The path of the asset to load. The path is relative to the asset directory.
+         * @return The loaded asset as a byte vector or null if the asset was not found or could not be loaded.
+         */
+        static std::shared_ptr<BinaryData> LoadAsset(const std::string& path);
+
+    private:
+        AssetUtils();
+
+        static std::string GetAssetPath();
+
+        static std::string _AssetPath;
+        static std::mutex _Mutex;
+    };
+
+}
+
+#endif
@@ -0,0 +1,38 @@
+#include "BitmapUtils.h"
+#include "core/BinaryData.h"
+#include "graphics/Bitmap.h"
+#include "utils/AssetUtils.h"
+#include "utils/Log.h"
+
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace massif {
+
+    std::shared_ptr<Bitmap> BitmapUtils::LoadBitmapFromAssets(const std::string& assetPath) {
+        std::shared_ptr<BinaryData> data = AssetUtils::LoadAsset(assetPath);
+        if (!data) {
+            return std::shared_ptr<Bitmap>();
+        }
+        return Bitmap::CreateFromCompressed(data);
+    }
+
+    std::shared_ptr<Bitmap> BitmapUtils::LoadBitmapFromFile(const std::string& filePath) {
+        std::ifstream file(filePath.c_str(), std::ios::binary);
+        if (!file) {
+            Log::Errorf("BitmapUtils::LoadBitmapFromFile: Failed to load: %s", filePath.c_str());
+            return std::shared_ptr<Bitmap>();
+        }
+        std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (data.empty()) {
+            Log::Errorf("BitmapUtils::LoadBitmapFromFile: Ignore load of empty file: %s", filePath.c_str());
+            return std::shared_ptr<Bitmap>();
+        }
+        return Bitmap::CreateFromCompressed(data.data(), data.size());
+    }
+
+    BitmapUtils::BitmapUtils() {
+    }
+
+}
@@ -0,0 +1,63 @@
+#include "utils/PlatformUtils.h"
+#include "utils/Log.h"
+
+#include <fstream>
+
+#include <errno.h>
+#include <sys/utsname.h>
+
+namespace massif {
+
+    PlatformType::PlatformType PlatformUtils::GetPlatformType() {
+        return PlatformType::PLATFORM_TYPE_LINUX;
+    }
+    
+    std::string PlatformUtils::GetDeviceId() {
+        std::ifstream file("/etc/machine-id");
+        std::string id;
+        if (!(file >> id)) {
+            Log::Error("PlatformUtils::GetDeviceId: Failed to read /etc/machine-id");
+        }
+        return id;
+    }
+
+    std::string PlatformUtils::GetDeviceType() {
+        struct utsname name;
+        if (::uname(&name) != 0) {
+            Log::Error("PlatformUtils::GetDeviceType: Failed to read system information");
+            return std::string();
+        }
+        return name.machine;
+    }
+    
+    std::string PlatformUtils::GetDeviceOS() {
+        struct utsname name;
+        if (::uname(&name) != 0) {
+            Log::Error("PlatformUtils::GetDeviceOS: Failed to read system information");
+            return std::string();
+        }
+        return std::string(name.sysname) + " " + name.release;
+    }
+    
+    std::string PlatformUtils::GetAppIdentifier() {
+        return program_invocation_short_name;
+    }
+    
+    std::string PlatformUtils::GetAppDeviceId() {
+        std::string appId = GetAppIdentifier();
+        std::string deviceId = GetDeviceId();
+        if (deviceId.empty()) {
+            return appId;
+        }
+        return appId + ":" + deviceId;
+    }
+    
+    bool PlatformUtils::ExcludeFolderFromBackup(const std::string &folder) {
+        // This is iOS-specific method, simply ignore it on Linux
+        return true;
+    }
+
+    PlatformUtils::PlatformUtils() {
+    }
+
+}
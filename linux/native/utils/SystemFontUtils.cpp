@@ -0,0 +1,153 @@
+#include "utils/SystemFontUtils.h"
+#include "core/BinaryData.h"
+#include "utils/Log.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <dirent.h>
+
+#include <vt/FontNames.h>
+
+namespace massif {
+
+    namespace {
+
+        const char* const DEFAULT_FONTS[] = { "notosansregular", "dejavusans", "liberationsansregular", "robotoregular", nullptr };
+
+        std::string normalizeFontName(const std::string& name) {
+            std::string normalized;
+            for (char c : name) {
+                if (std::isalnum(static_cast<unsigned char>(c))) {
+                    normalized.append(1, static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+                }
+            }
+            return normalized;
+        }
+
+        // Maps normalized font names to font files. Only the directories listed in MASSIF_FONT_PATH (separated by ':')
+        // are scanned, not the fonts of the desktop: the result of a headless run must not depend on the machine it ran on.
+        const std::map<std::string, std::string>& getSystemFontMap() {
+            static std::mutex mutex;
+            static std::map<std::string, std::string> fontMap;
+            static bool initialized = false;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!initialized) {
+                initialized = true;
+                const char* fontPath = std::getenv("MASSIF_FONT_PATH");
+                std::string dirNames = (fontPath ? fontPath : "");
+                for (std::size_t pos = 0; pos < dirNames.size(); ) {
+                    std::size_t sepPos = dirNames.find(':', pos);
+                    std::string dirName = dirNames.substr(pos, sepPos == std::string::npos ? std::string::npos : sepPos - pos);
+                    pos = (sepPos == std::string::npos ? dirNames.size() : sepPos + 1);
+
+                    DIR* dir = opendir(dirName.c_str());
+                    if (!dir) {
+                        continue;
+                    }
+                    while (struct dirent* entry = readdir(dir)) {
+                        std::string fileName = entry->d_name;
+                        std::size_t extPos = fileName.rfind('.');
+                        if (extPos == std::string::npos) {
+                            continue;
+                        }
+                        std::string ext = normalizeFontName(fileName.substr(extPos));
+                        if (ext != "ttf" && ext != "otf" && ext != "ttc") {
+                            continue;
+                        }
+                        fontMap.emplace(normalizeFontName(fileName.substr(0, extPos)), dirName + "/" + fileName);
+                    }
+                    closedir(dir);
+                }
+                LOG_INFOF("SystemFontUtils: found %d system fonts", static_cast<int>(fontMap.size()));
+            }
+            return fontMap;
+        }
+
+        std::string findFontFile(const std::map<std::string, std::string>& fontMap, const std::string& normalizedName) {
+            if (normalizedName.empty()) {
+                return std::string();
+            }
+
+            auto it = fontMap.find(normalizedName);
+            if (it != fontMap.end()) {
+                return it->second;
+            }
+            it = fontMap.find(normalizedName + "regular");
+            if (it != fontMap.end()) {
+                return it->second;
+            }
+
+            // Accept a variant of the family ('dejavusans' -> 'dejavusansbold'), preferring the shortest name
+            it = fontMap.lower_bound(normalizedName);
+            if (it != fontMap.end() && it->first.compare(0, normalizedName.size(), normalizedName) == 0) {
+                return it->second;
+            }
+            return std::string();
+        }
+
+        std::string resolveFontFile(const std::string& name, bool allowFallback) {
+            const std::map<std::string, std::string>& fontMap = getSystemFontMap();
+            std::string fileName = findFontFile(fontMap, normalizeFontName(name));
+            if (!fileName.empty() || !allowFallback) {
+                return fileName;
+            }
+
+            // Unresolved name, use the default system font
+            for (int i = 0; DEFAULT_FONTS[i]; i++) {
+                fileName = findFontFile(fontMap, DEFAULT_FONTS[i]);
+                if (!fileName.empty()) {
+                    return fileName;
+                }
+            }
+            return fontMap.empty() ? std::string() : fontMap.begin()->second;
+        }
+
+    }
+
+    SystemFontUtils::FontMatch SystemFontUtils::MatchFont(const std::string& names) {
+        // There is no platform text API on Linux, a match is always a font file
+        FontMatch match;
+        for (const std::string& name : vt::parseFontNames(names)) {
+            match.fileName = resolveFontFile(name, false);
+            if (!match.fileName.empty()) {
+                break;
+            }
+        }
+        return match;
+    }
+
+    std::shared_ptr<BinaryData> SystemFontUtils::LoadFont(const std::string& name, bool allowFallback) {
+        std::string fileName = resolveFontFile(name, allowFallback);
+        if (fileName.empty()) {
+            // Not an error without the fallback: the caller is walking a font list and tries the next name
+            if (allowFallback) {
+                Log::Errorf("SystemFontUtils::LoadFont: No system font for %s", name.c_str());
+            }
+            return std::shared_ptr<BinaryData>();
+        }
+
+        std::ifstream file(fileName.c_str(), std::ios::binary);
+        if (!file) {
+            Log::Errorf("SystemFontUtils::LoadFont: Failed to open %s", fileName.c_str());
+            return std::shared_ptr<BinaryData>();
+        }
+        std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (data.empty()) {
+            Log::Errorf("SystemFontUtils::LoadFont: Failed to read %s", fileName.c_str());
+            return std::shared_ptr<BinaryData>();
+        }
+        LOG_INFOF("SystemFontUtils::LoadFont: Using %s for %s", fileName.c_str(), name.c_str());
+        return std::make_shared<BinaryData>(std::move(data));
+    }
+
+    SystemFontUtils::SystemFontUtils() {
+    }
+
+}
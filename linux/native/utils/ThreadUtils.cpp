@@ -0,0 +1,26 @@
+#include "utils/ThreadUtils.h"
+#include "components/ThreadWorker.h"
+#include "utils/Log.h"
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+namespace massif {
+
+    void ThreadUtils::SetThreadPriority(ThreadPriority::ThreadPriority priority) {
+        // As on Android, setpriority with a thread id sets the nice value of that thread only on Linux.
+        // Raising the priority needs CAP_SYS_NICE, so a failure is expected for an unprivileged process and is not an error.
+        int posixPriority = std::min(19, (static_cast<int>(priority) - static_cast<int>(ThreadPriority::MAXIMUM)) * 40 / (static_cast<int>(ThreadPriority::MINIMUM) - static_cast<int>(ThreadPriority::MAXIMUM)) - 20);
+        int hasError = ::setpriority(PRIO_PROCESS, static_cast<id_t>(::syscall(SYS_gettid)), posixPriority);
+        if (hasError != 0) {
+            LOG_DEBUGF("ThreadUtils::SetThreadPriority: Failed to set thread priority: %d", posixPriority);
+        }
+    }
+
+    ThreadUtils::ThreadUtils() {
+    }
+
+}
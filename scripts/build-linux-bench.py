@@ -0,0 +1,57 @@
+import os
+import sys
+import argparse
+from build.sdk_build_utils import *
+
+def buildLinuxBench(args):
+  baseDir = getBaseDir()
+  buildDir = getBuildDir('linux-bench')
+  defines = ["-D%s" % define for define in args.defines.split(';') if define]
+  options = ["-D%s" % option for option in args.cmakeoptions.split(';') if option]
+
+  resetBuildDirOnGeneratorChange(args, buildDir)
+  if not cmake(args, buildDir, options + getGeneratorOptions(args) + getCCacheOptions(args) + [
+    "-DCMAKE_EXPORT_COMPILE_COMMANDS:BOOL=ON",
+    "-DCMAKE_BUILD_TYPE=%s" % args.configuration,
+    "-DBUILD_BENCHMARKS:BOOL=ON",
+    "-DSDK_CPP_DEFINES=%s" % " ".join(defines),
+    "-DSDK_VERSION='%s'" % 'Devel',
+    "-DSDK_PLATFORM='Linux'",
+    '%s/scripts/build' % baseDir
+  ]):
+    return False
+  if not cmake(args, buildDir, [
+    '--build', '.',
+    '--parallel', str(os.cpu_count()),
+    '--config', args.configuration,
+    '--target', 'massif-bench'
+  ]):
+    return False
+  print("Benchmark executable available in:\n%s/massif-bench" % buildDir)
+  return True
+
+parser = argparse.ArgumentParser()
+parser.add_argument('--profile', dest='profile', default=getDefaultProfileId(), type=validProfile, help='Build profile')
+parser.add_argument('--defines', dest='defines', default='', help='Defines for compilation')
+parser.add_argument('--make', dest='make', default='make', help='Make executable, used only when no ninja is available')
+parser.add_argument('--ninja', dest='ninja', default='auto', help="Ninja executable, 'auto' to detect one, 'none' to build with make")
+parser.add_argument('--ccache', dest='ccache', default='auto', help="Ccache executable, 'auto' to detect one, 'none' to compile without a launcher")
+parser.add_argument('--cmake', dest='cmake', default='cmake', help='CMake executable')
+parser.add_argument('--cmake-options', dest='cmakeoptions', default='', help='CMake options')
+parser.add_argument('--configuration', dest='configuration', default='Release', choices=['Release', 'RelWithDebInfo', 'Debug'], help='Configuration')
+args = parser.parse_args()
+args.defines += ';' + getProfile(args.profile).get('defines', '')
+args.cmakeoptions += ';' + getProfile(args.profile).get('cmake-options', '')
+
+if not checkExecutable(args.cmake, '--help'):
+  print('Failed to find CMake executable. Use --cmake to specify its location')
+  sys.exit(-1)
+
+resolveBuildTools(args)
+
+if not args.ninjapath and not checkExecutable(args.make, '--help'):
+  print('Failed to find ninja or make executable. Use --ninja or --make to specify its location')
+  sys.exit(-1)
+
+if not buildLinuxBench(args):
+  sys.exit(-1)